@@ -0,0 +1,168 @@
+#include <stdlib.h>
+
+#include "oge/oge.h"
+
+// Measures job system scaling in a headless application. The
+// OGE_JOBS_WORKERS environment variable sets a number of worker
+// threads (unset means one per core), so a 1 to N core curve is a
+// series of runs with 1 to N-1 workers, the serial time being its
+// 1 core point. Every parallel result is checked against the serial
+// one.
+#define JOBS_BENCH_RUNS           5
+#define JOBS_BENCH_JOB_COUNT      4096
+#define JOBS_BENCH_JOB_ITERATIONS 20000
+#define JOBS_BENCH_EMPTY_COUNT    65536
+#define JOBS_BENCH_BATCH_SIZE     256
+
+typedef struct WorkJob {
+  u64 seed;
+  u64 result;
+} WorkJob;
+
+static WorkJob s_jobs[JOBS_BENCH_JOB_COUNT];
+static u64     s_serialResults[JOBS_BENCH_JOB_COUNT];
+
+// OGE configuration
+const OgeLoggingInitInfo loggingInitInfo = {
+  .logLevel  = OGE_LOG_LEVEL_INFO,
+  .fileName  = "jobs-bench-logs.txt",
+};
+
+const OgePlatformInitInfo platformInitInfo = {
+  .applicationName = "OGE jobs benchmark",
+  .width           = 640,
+  .height          = 360,
+  .headless        = OGE_TRUE,
+};
+
+OgeJobsInitInfo jobsInitInfo = { 0 };
+
+const OgeInitInfo ogeInitInfo = {
+  .loggingInitInfo  = &loggingInitInfo,
+  .platformInitInfo = &platformInitInfo,
+  .jobsInitInfo     = &jobsInitInfo,
+};
+
+// Jobs, the work isn't inlined so the serial loop can't interleave
+// independent iterations the jobs can't
+OGE_NOINLINE u64 work(u64 seed) {
+  u64 x = seed * 0x9E3779B97F4A7C15ull + 1;
+  for (u32 i = 0; i < JOBS_BENCH_JOB_ITERATIONS; ++i) {
+    x ^= x << 13;
+    x ^= x >> 7;
+    x ^= x << 17;
+  }
+  return x;
+}
+
+void workJob(void *data) {
+  WorkJob *job = data;
+  job->result = work(job->seed);
+}
+
+void emptyJob(void *data) { }
+
+// Benchmarks, every one returns its best time of JOBS_BENCH_RUNS
+u64 benchSerial() {
+  u64 best = (u64)-1;
+  for (u32 run = 0; run < JOBS_BENCH_RUNS; ++run) {
+    const u64 start = ogeClockNow();
+    for (u32 i = 0; i < JOBS_BENCH_JOB_COUNT; ++i) {
+      s_serialResults[i] = work(i);
+    }
+    best = OGE_MIN(best, ogeClockNow() - start);
+  }
+  return best;
+}
+
+u64 benchParallel() {
+  OgeJob jobs[JOBS_BENCH_BATCH_SIZE];
+
+  u64 best = (u64)-1;
+  for (u32 run = 0; run < JOBS_BENCH_RUNS; ++run) {
+    for (u32 i = 0; i < JOBS_BENCH_JOB_COUNT; ++i) {
+      s_jobs[i] = (WorkJob){ .seed = i, .result = 0 };
+    }
+
+    OgeJobCounter counter = { 0 };
+    const u64 start = ogeClockNow();
+    for (u32 i = 0; i < JOBS_BENCH_JOB_COUNT; i += JOBS_BENCH_BATCH_SIZE) {
+      for (u32 j = 0; j < JOBS_BENCH_BATCH_SIZE; ++j) {
+        jobs[j] = (OgeJob){ workJob, &s_jobs[i + j] };
+      }
+      ogeJobsSubmit(jobs, JOBS_BENCH_BATCH_SIZE, &counter);
+    }
+    ogeJobsWait(&counter);
+    best = OGE_MIN(best, ogeClockNow() - start);
+  }
+  return best;
+}
+
+u64 benchEmpty() {
+  OgeJob jobs[JOBS_BENCH_BATCH_SIZE];
+  for (u32 j = 0; j < JOBS_BENCH_BATCH_SIZE; ++j) {
+    jobs[j] = (OgeJob){ emptyJob, 0 };
+  }
+
+  u64 best = (u64)-1;
+  for (u32 run = 0; run < JOBS_BENCH_RUNS; ++run) {
+    OgeJobCounter counter = { 0 };
+    const u64 start = ogeClockNow();
+    for (u32 i = 0; i < JOBS_BENCH_EMPTY_COUNT; i += JOBS_BENCH_BATCH_SIZE) {
+      ogeJobsSubmit(jobs, JOBS_BENCH_BATCH_SIZE, &counter);
+    }
+    ogeJobsWait(&counter);
+    best = OGE_MIN(best, ogeClockNow() - start);
+  }
+  return best;
+}
+
+// Application functions
+b8 applicationInit(void *pState) {
+  return OGE_TRUE;
+}
+
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
+  const u32 threadCount  = ogeJobsGetThreadCount();
+  const u64 serialTime   = benchSerial();
+  const u64 parallelTime = benchParallel();
+  const u64 emptyTime    = benchEmpty();
+
+  for (u32 i = 0; i < JOBS_BENCH_JOB_COUNT; ++i) {
+    if (s_jobs[i].result != s_serialResults[i]) {
+      OGE_ERROR("Job %u result doesn't match the serial one.", i);
+      return OGE_FALSE;
+    }
+  }
+
+  OGE_INFO("%u threads: %u jobs in %.3f ms, serial %.3f ms, "
+           "speedup %.2fx.", threadCount, JOBS_BENCH_JOB_COUNT,
+           OGE_NS_TO_MILLISECONDS(parallelTime),
+           OGE_NS_TO_MILLISECONDS(serialTime),
+           (f64)serialTime / (f64)parallelTime);
+  OGE_INFO("%u threads: %.1f ns per empty job.", threadCount,
+           (f64)emptyTime / JOBS_BENCH_EMPTY_COUNT);
+
+  ogeRequestTerminate();
+  return OGE_TRUE;
+}
+
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
+  return OGE_TRUE;
+}
+
+void applicationTerminate(void *pState) { }
+
+// Application create function
+b8 ogeApplicationCreate(OgeApplication *pApplication) {
+  const char *workers = getenv("OGE_JOBS_WORKERS");
+  jobsInitInfo.workerCount = workers ? (u32)atoi(workers) : 0;
+
+  pApplication->ogeInitInfo = &ogeInitInfo;
+  pApplication->init        = applicationInit;
+  pApplication->update      = applicationUpdate;
+  pApplication->render      = applicationRender;
+  pApplication->terminate   = applicationTerminate;
+
+  return OGE_TRUE;
+}
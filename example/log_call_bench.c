@@ -0,0 +1,80 @@
+#include <stdlib.h>
+
+#include "oge/oge.h"
+
+// Measures log call latency on the calling thread in a headless
+// application. The OGE_LOG_BENCH_DEFERRED environment variable turns
+// deferred formatting on, so the two runs compare it against eager
+// formatting. Batches are smaller than the logging queue, so calls
+// never wait for the logging thread, and it drains the queue between
+// batches out of the measured time.
+#define LOG_BENCH_BATCH_COUNT 200
+#define LOG_BENCH_BATCH_SIZE  512
+
+// OGE configuration
+OgeLoggingInitInfo loggingInitInfo = {
+  .logLevel = OGE_LOG_LEVEL_INFO,
+};
+
+const OgePlatformInitInfo platformInitInfo = {
+  .applicationName = "OGE log call benchmark",
+  .width           = 640,
+  .height          = 360,
+  .headless        = OGE_TRUE,
+};
+
+const OgeInitInfo ogeInitInfo = {
+  .loggingInitInfo  = &loggingInitInfo,
+  .platformInitInfo = &platformInitInfo,
+};
+
+// Application functions
+b8 applicationInit(void *pState) {
+  return OGE_TRUE;
+}
+
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
+  u64 total = 0;
+  u64 best  = (u64)-1;
+  for (u32 batch = 0; batch < LOG_BENCH_BATCH_COUNT; ++batch) {
+    const u64 start = ogeClockNow();
+    for (u32 i = 0; i < LOG_BENCH_BATCH_SIZE; ++i) {
+      OGE_INFO("Benchmark message %u, entity %s, position %.3f %.3f.",
+               i, "player", i * 0.5, batch * 0.25);
+    }
+    const u64 time = ogeClockNow() - start;
+    total += time;
+    best   = OGE_MIN(best, time);
+
+    ogeLoggingFlush();
+  }
+
+  OGE_INFO("%s formatting: %.1f ns per call on average, %.1f ns in "
+           "the best batch.",
+           loggingInitInfo.deferredFormatting ? "deferred" : "eager",
+           (f64)total / (LOG_BENCH_BATCH_COUNT * LOG_BENCH_BATCH_SIZE),
+           (f64)best / LOG_BENCH_BATCH_SIZE);
+
+  ogeRequestTerminate();
+  return OGE_TRUE;
+}
+
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
+  return OGE_TRUE;
+}
+
+void applicationTerminate(void *pState) { }
+
+// Application create function
+b8 ogeApplicationCreate(OgeApplication *pApplication) {
+  loggingInitInfo.deferredFormatting =
+    getenv("OGE_LOG_BENCH_DEFERRED") != 0;
+
+  pApplication->ogeInitInfo = &ogeInitInfo;
+  pApplication->init        = applicationInit;
+  pApplication->update      = applicationUpdate;
+  pApplication->render      = applicationRender;
+  pApplication->terminate   = applicationTerminate;
+
+  return OGE_TRUE;
+}
@@ -0,0 +1,79 @@
+#include <stdlib.h>
+
+#include "oge/oge.h"
+
+// Measures logging throughput in a headless application. Without
+// the OGE_LOG_BENCH_FILE environment variable messages go only to
+// the console, with it they also go to the named log file, so the
+// two runs compare the file sink against the console path. Redirect
+// stdout to compare the sinks rather than a terminal.
+// OGE_LOG_BENCH_COUNT sets a number of messages.
+#define LOG_BENCH_DEFAULT_COUNT 200000
+
+// OGE configuration
+OgeLoggingInitInfo loggingInitInfo = {
+  .logLevel       = OGE_LOG_LEVEL_INFO,
+  .overflowPolicy = OGE_LOG_OVERFLOW_POLICY_BLOCK,
+  .fileFormat     = OGE_LOG_FILE_FORMAT_PLAIN,
+};
+
+const OgePlatformInitInfo platformInitInfo = {
+  .applicationName = "OGE log file benchmark",
+  .width           = 640,
+  .height          = 360,
+  .headless        = OGE_TRUE,
+};
+
+const OgeInitInfo ogeInitInfo = {
+  .loggingInitInfo  = &loggingInitInfo,
+  .platformInitInfo = &platformInitInfo,
+};
+
+// Application functions
+b8 applicationInit(void *pState) {
+  return OGE_TRUE;
+}
+
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
+  const char *countVariable = getenv("OGE_LOG_BENCH_COUNT");
+  const u32 count = countVariable ? (u32)atoi(countVariable)
+                                  : LOG_BENCH_DEFAULT_COUNT;
+  if (count == 0) { return OGE_FALSE; }
+
+  // Flushing waits for the logging thread, so the time covers
+  // writing every message, not only queueing it
+  const u64 start = ogeClockNow();
+  for (u32 i = 0; i < count; ++i) {
+    OGE_INFO("Benchmark message %u, frame %llu, value %.3f.", i,
+             frameInfo->frameIndex, i * 0.5);
+  }
+  ogeLoggingFlush();
+  const u64 time = ogeClockNow() - start;
+
+  OGE_INFO("%s: %u messages in %.3f ms, %.0f messages/s.",
+           loggingInitInfo.fileName ? "console + file" : "console",
+           count, OGE_NS_TO_MILLISECONDS(time),
+           count / OGE_NS_TO_SECONDS(time));
+
+  ogeRequestTerminate();
+  return OGE_TRUE;
+}
+
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
+  return OGE_TRUE;
+}
+
+void applicationTerminate(void *pState) { }
+
+// Application create function
+b8 ogeApplicationCreate(OgeApplication *pApplication) {
+  loggingInitInfo.fileName = getenv("OGE_LOG_BENCH_FILE");
+
+  pApplication->ogeInitInfo = &ogeInitInfo;
+  pApplication->init        = applicationInit;
+  pApplication->update      = applicationUpdate;
+  pApplication->render      = applicationRender;
+  pApplication->terminate   = applicationTerminate;
+
+  return OGE_TRUE;
+}
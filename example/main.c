@@ -31,11 +31,11 @@ b8 applicationInit(void *pState) {
   return OGE_TRUE;
 }
 
-b8 applicationUpdate(void *pState) {
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
   return OGE_TRUE;
 }
 
-b8 applicationRender(void *pState) {
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
   ogeRendererStartScene();
   ogeRendererEndScene();
   return OGE_TRUE;
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include <stddef.h>
+
+#include "oge/oge.h"
+
+// Measures the parallel algorithms against their serial versions
+// in a headless application. The OGE_PARALLEL_COUNT environment
+// variable sets a number of elements (1M to 100M are the sizes of
+// interest) and OGE_PARALLEL_WORKERS a number of job system
+// workers. Every parallel result is checked against the serial one.
+#define PARALLEL_BENCH_DEFAULT_COUNT 10000000
+#define PARALLEL_BENCH_RUNS          3
+#define PARALLEL_BENCH_KEY_MASK      0xFFFFFFFFFFull // 40-bit keys
+
+typedef struct SortElement {
+  u64 key;
+  u32 index;
+  u32 padding;
+} SortElement;
+
+typedef struct BenchTimes {
+  u64 serial;
+  u64 parallel;
+} BenchTimes;
+
+static u64 s_count;
+static u64 s_randomState = 0x9E3779B97F4A7C15ull;
+
+// OGE configuration
+const OgeLoggingInitInfo loggingInitInfo = {
+  .logLevel  = OGE_LOG_LEVEL_INFO,
+  .fileName  = "parallel-bench-logs.txt",
+};
+
+const OgePlatformInitInfo platformInitInfo = {
+  .applicationName = "OGE parallel benchmark",
+  .width           = 640,
+  .height          = 360,
+  .headless        = OGE_TRUE,
+};
+
+OgeJobsInitInfo jobsInitInfo = { 0 };
+
+const OgeInitInfo ogeInitInfo = {
+  .loggingInitInfo  = &loggingInitInfo,
+  .platformInitInfo = &platformInitInfo,
+  .jobsInitInfo     = &jobsInitInfo,
+};
+
+// Helpers
+u64 nextRandom() {
+  s_randomState ^= s_randomState << 13;
+  s_randomState ^= s_randomState >> 7;
+  s_randomState ^= s_randomState << 17;
+  return s_randomState;
+}
+
+void* allocArray(u64 stride) {
+  void *darray = ogeDArrayAlloc(s_count, stride);
+  ogeDArrayLength(darray) = s_count;
+  return darray;
+}
+
+void logTimes(const char *name, const BenchTimes *times) {
+  OGE_INFO("%s: %llu elements, %u threads, serial %.3f ms, parallel "
+           "%.3f ms, speedup %.2fx.", name, s_count,
+           ogeJobsGetThreadCount(), OGE_NS_TO_MILLISECONDS(times->serial),
+           OGE_NS_TO_MILLISECONDS(times->parallel),
+           (f64)times->serial / (f64)times->parallel);
+}
+
+// Range functions
+void scaleRange(void *darray, u64 begin, u64 end, void *userData) {
+  f32 *values = darray;
+  for (u64 i = begin; i < end; ++i) {
+    values[i] = values[i] * 1.5f + 0.25f;
+  }
+}
+
+void sumRange(const void *darray, u64 begin, u64 end, void *result,
+              void *userData) {
+  const u32 *values = darray;
+  u64 sum = 0;
+  for (u64 i = begin; i < end; ++i) {
+    sum += values[i];
+  }
+  *(u64*)result += sum;
+}
+
+void combineSums(void *result, const void *partial, void *userData) {
+  *(u64*)result += *(const u64*)partial;
+}
+
+u32 prefixSum(u32 *values, u64 count) {
+  u32 sum = 0;
+  for (u64 i = 0; i < count; ++i) {
+    const u32 value = values[i];
+    values[i] = sum;
+    sum += value;
+  }
+  return sum;
+}
+
+// Indices break ties, so the result equals a stable sort
+int compareElements(const void *first, const void *second) {
+  const SortElement *a = first;
+  const SortElement *b = second;
+  if (a->key != b->key) { return a->key < b->key ? -1 : 1; }
+  return a->index < b->index ? -1 : a->index > b->index;
+}
+
+// Benchmarks, times are the best of PARALLEL_BENCH_RUNS
+b8 benchFor() {
+  f32 *serial   = allocArray(sizeof(f32));
+  f32 *parallel = allocArray(sizeof(f32));
+  for (u64 i = 0; i < s_count; ++i) {
+    serial[i] = parallel[i] = (f32)(nextRandom() & 0xFFFF) / 256.0f;
+  }
+
+  BenchTimes times = { (u64)-1, (u64)-1 };
+  for (u32 run = 0; run < PARALLEL_BENCH_RUNS; ++run) {
+    u64 start = ogeClockNow();
+    scaleRange(serial, 0, s_count, 0);
+    times.serial = OGE_MIN(times.serial, ogeClockNow() - start);
+
+    start = ogeClockNow();
+    ogeParallelFor(parallel, 0, s_count, 0, scaleRange, 0);
+    times.parallel = OGE_MIN(times.parallel, ogeClockNow() - start);
+  }
+
+  const b8 result =
+    ogeMemCmp(serial, parallel, s_count * sizeof(f32)) == 0;
+  ogeDArrayFree(serial);
+  ogeDArrayFree(parallel);
+
+  logTimes("for", &times);
+  return result;
+}
+
+b8 benchReduce() {
+  u32 *values = allocArray(sizeof(u32));
+  for (u64 i = 0; i < s_count; ++i) {
+    values[i] = (u32)nextRandom();
+  }
+
+  BenchTimes times = { (u64)-1, (u64)-1 };
+  u64 serialSum = 0, parallelSum = 0;
+  for (u32 run = 0; run < PARALLEL_BENCH_RUNS; ++run) {
+    serialSum = parallelSum = 0;
+
+    u64 start = ogeClockNow();
+    sumRange(values, 0, s_count, &serialSum, 0);
+    times.serial = OGE_MIN(times.serial, ogeClockNow() - start);
+
+    start = ogeClockNow();
+    ogeParallelReduce(values, 0, s_count, 0, &parallelSum, sizeof(u64),
+                      sumRange, combineSums, 0);
+    times.parallel = OGE_MIN(times.parallel, ogeClockNow() - start);
+  }
+
+  ogeDArrayFree(values);
+
+  logTimes("reduce", &times);
+  return serialSum == parallelSum;
+}
+
+b8 benchPrefixSum() {
+  u32 *source   = allocArray(sizeof(u32));
+  u32 *serial   = allocArray(sizeof(u32));
+  u32 *parallel = allocArray(sizeof(u32));
+  for (u64 i = 0; i < s_count; ++i) {
+    source[i] = (u32)nextRandom() & 0xFF;
+  }
+
+  BenchTimes times = { (u64)-1, (u64)-1 };
+  u32 serialSum = 0, parallelSum = 0;
+  for (u32 run = 0; run < PARALLEL_BENCH_RUNS; ++run) {
+    ogeMemCpy(serial, source, s_count * sizeof(u32));
+    ogeMemCpy(parallel, source, s_count * sizeof(u32));
+
+    u64 start = ogeClockNow();
+    serialSum = prefixSum(serial, s_count);
+    times.serial = OGE_MIN(times.serial, ogeClockNow() - start);
+
+    start = ogeClockNow();
+    parallelSum = ogeParallelPrefixSumU32(parallel, 0, s_count);
+    times.parallel = OGE_MIN(times.parallel, ogeClockNow() - start);
+  }
+
+  const b8 result = serialSum == parallelSum &&
+    ogeMemCmp(serial, parallel, s_count * sizeof(u32)) == 0;
+  ogeDArrayFree(source);
+  ogeDArrayFree(serial);
+  ogeDArrayFree(parallel);
+
+  logTimes("prefix sum", &times);
+  return result;
+}
+
+b8 benchSort() {
+  SortElement *source   = allocArray(sizeof(SortElement));
+  SortElement *serial   = allocArray(sizeof(SortElement));
+  SortElement *parallel = allocArray(sizeof(SortElement));
+  for (u64 i = 0; i < s_count; ++i) {
+    source[i] = (SortElement){
+      .key   = nextRandom() & PARALLEL_BENCH_KEY_MASK,
+      .index = (u32)i,
+    };
+  }
+
+  BenchTimes times = { (u64)-1, (u64)-1 };
+  for (u32 run = 0; run < PARALLEL_BENCH_RUNS; ++run) {
+    ogeMemCpy(serial, source, s_count * sizeof(SortElement));
+    ogeMemCpy(parallel, source, s_count * sizeof(SortElement));
+
+    u64 start = ogeClockNow();
+    qsort(serial, s_count, sizeof(SortElement), compareElements);
+    times.serial = OGE_MIN(times.serial, ogeClockNow() - start);
+
+    start = ogeClockNow();
+    ogeParallelSort(parallel, 0, s_count, offsetof(SortElement, key),
+                    sizeof(u64));
+    times.parallel = OGE_MIN(times.parallel, ogeClockNow() - start);
+  }
+
+  const b8 result =
+    ogeMemCmp(serial, parallel, s_count * sizeof(SortElement)) == 0;
+  ogeDArrayFree(source);
+  ogeDArrayFree(serial);
+  ogeDArrayFree(parallel);
+
+  logTimes("sort (serial is qsort)", &times);
+  return result;
+}
+
+// Application functions
+b8 applicationInit(void *pState) {
+  const char *count = getenv("OGE_PARALLEL_COUNT");
+  s_count = count ? strtoull(count, 0, 10) : PARALLEL_BENCH_DEFAULT_COUNT;
+  return s_count > 0;
+}
+
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
+  const char *names[] = { "for", "reduce", "prefix sum", "sort" };
+  const b8 results[] = {
+    benchFor(), benchReduce(), benchPrefixSum(), benchSort(),
+  };
+
+  for (u32 i = 0; i < sizeof(results) / sizeof(results[0]); ++i) {
+    if (!results[i]) {
+      OGE_ERROR("Parallel %s result doesn't match the serial one.",
+                names[i]);
+      return OGE_FALSE;
+    }
+  }
+
+  ogeRequestTerminate();
+  return OGE_TRUE;
+}
+
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
+  return OGE_TRUE;
+}
+
+void applicationTerminate(void *pState) { }
+
+// Application create function
+b8 ogeApplicationCreate(OgeApplication *pApplication) {
+  const char *workers = getenv("OGE_PARALLEL_WORKERS");
+  jobsInitInfo.workerCount = workers ? (u32)atoi(workers) : 0;
+
+  pApplication->ogeInitInfo = &ogeInitInfo;
+  pApplication->init        = applicationInit;
+  pApplication->update      = applicationUpdate;
+  pApplication->render      = applicationRender;
+  pApplication->terminate   = applicationTerminate;
+
+  return OGE_TRUE;
+}
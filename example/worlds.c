@@ -0,0 +1,187 @@
+#include <stdlib.h>
+
+#include "oge/oge.h"
+
+// Runs many independent worlds in a headless application and logs
+// how long ticking all of them takes. The OGE_WORLDS_COUNT and
+// OGE_WORLDS_WORKERS environment variables set a number of worlds
+// and job system workers, so scaling can be measured across runs.
+#define WORLDS_DEFAULT_COUNT   64
+#define WORLDS_MEASURED_FRAMES 600
+#define WORLDS_PARTICLE_COUNT  4096
+#define WORLDS_BOUNCE_EVENT    1
+
+typedef struct Particle {
+  f32 x, y;
+  f32 vx, vy;
+} Particle;
+
+typedef struct WorldsSharedData {
+  f32 gravity;
+  f32 bounce;
+} WorldsSharedData;
+
+typedef struct WorldData {
+  Particle *particles;
+  u64       bounceCount;
+} WorldData;
+
+typedef struct WorldsState {
+  OgeWorld  **worlds;
+  WorldData  *data;
+  u32         count;
+  u64         tickTime;
+} WorldsState;
+
+static const WorldsSharedData s_sharedData = {
+  .gravity = -9.8f,
+  .bounce  = 0.8f,
+};
+
+static WorldsState s_state;
+
+// OGE configuration
+const OgeLoggingInitInfo loggingInitInfo = {
+  .logLevel  = OGE_LOG_LEVEL_INFO,
+  .fileName  = "worlds-logs.txt",
+};
+
+const OgePlatformInitInfo platformInitInfo = {
+  .applicationName = "OGE worlds",
+  .width           = 640,
+  .height          = 360,
+  .headless        = OGE_TRUE,
+};
+
+OgeJobsInitInfo jobsInitInfo = { 0 };
+
+const OgeInitInfo ogeInitInfo = {
+  .loggingInitInfo  = &loggingInitInfo,
+  .platformInitInfo = &platformInitInfo,
+  .jobsInitInfo     = &jobsInitInfo,
+};
+
+// World functions
+b8 worldBounce(void *invoker, OgeEventData data) {
+  u64 *bounceCount = invoker;
+  *bounceCount += data.u64[0];
+  return OGE_FALSE;
+}
+
+b8 worldUpdate(OgeWorld *world, const OgeFrameInfo *frameInfo) {
+  const WorldsSharedData *shared = ogeWorldGetSharedData(world);
+  WorldData *data = ogeWorldGetUserData(world);
+  const f32 deltaTime = (f32)frameInfo->deltaTime;
+
+  u64 bounces = 0;
+  for (u32 i = 0; i < WORLDS_PARTICLE_COUNT; ++i) {
+    Particle *particle = &data->particles[i];
+    particle->vy += shared->gravity * deltaTime;
+    particle->x  += particle->vx * deltaTime;
+    particle->y  += particle->vy * deltaTime;
+
+    if (particle->y < 0.0f) {
+      particle->y  = -particle->y;
+      particle->vy = -particle->vy * shared->bounce;
+      ++bounces;
+    }
+  }
+
+  const OgeEventData eventData = { .u64 = { bounces } };
+  ogeEventsContextInvoke(ogeWorldGetEvents(world), WORLDS_BOUNCE_EVENT,
+                         &data->bounceCount, eventData);
+  return OGE_TRUE;
+}
+
+// Application functions
+b8 applicationInit(void *pState) {
+  const char *count = getenv("OGE_WORLDS_COUNT");
+  s_state.count = count ? (u32)atoi(count) : WORLDS_DEFAULT_COUNT;
+
+  s_state.worlds = ogeAlloc(sizeof(OgeWorld*) * s_state.count,
+                            OGE_MEMORY_TAG_GAME);
+  s_state.data   = ogeAlloc(sizeof(WorldData) * s_state.count,
+                            OGE_MEMORY_TAG_GAME);
+
+  for (u32 i = 0; i < s_state.count; ++i) {
+    WorldData *data = &s_state.data[i];
+
+    const OgeWorldInitInfo initInfo = {
+      .loopInitInfo = { .fixedTimestep = OGE_TRUE, .tickRate = 60 },
+      .update       = worldUpdate,
+      .userData     = data,
+      .sharedData   = &s_sharedData,
+    };
+
+    OgeWorld *world = ogeWorldCreate(&initInfo);
+    if (!world) { return OGE_FALSE; }
+    s_state.worlds[i] = world;
+
+    data->bounceCount = 0;
+    data->particles   = ogeWorldAlloc(
+      world, sizeof(Particle) * WORLDS_PARTICLE_COUNT, OGE_MEMORY_TAG_GAME
+    );
+
+    for (u32 j = 0; j < WORLDS_PARTICLE_COUNT; ++j) {
+      data->particles[j] = (Particle){
+        .x  = (f32)j,
+        .y  = (f32)(i + j % 100),
+        .vx = 1.0f,
+        .vy = 0.0f,
+      };
+    }
+
+    ogeEventsContextSubscribe(ogeWorldGetEvents(world),
+                              WORLDS_BOUNCE_EVENT, worldBounce);
+  }
+
+  OGE_INFO("Ticking %u worlds on %u threads.",
+           s_state.count, ogeJobsGetThreadCount());
+  return OGE_TRUE;
+}
+
+b8 applicationUpdate(const OgeFrameInfo *frameInfo) {
+  const u64 frameTime = OGE_NANOSECONDS_PER_SECOND / 60;
+
+  const u64 start = ogeClockNow();
+  if (!ogeWorldsTick(s_state.worlds, s_state.count, frameTime)) {
+    return OGE_FALSE;
+  }
+  s_state.tickTime += ogeClockNow() - start;
+
+  if (frameInfo->frameIndex + 1 == WORLDS_MEASURED_FRAMES) {
+    OGE_INFO("%u worlds, %u threads: %.3f ms per tick of all worlds.",
+             s_state.count, ogeJobsGetThreadCount(),
+             OGE_NS_TO_MILLISECONDS(s_state.tickTime) /
+             WORLDS_MEASURED_FRAMES);
+    ogeRequestTerminate();
+  }
+  return OGE_TRUE;
+}
+
+b8 applicationRender(const OgeFrameInfo *frameInfo) {
+  return OGE_TRUE;
+}
+
+void applicationTerminate(void *pState) {
+  for (u32 i = 0; i < s_state.count; ++i) {
+    ogeWorldFree(s_state.worlds[i], s_state.data[i].particles);
+    ogeWorldDestroy(s_state.worlds[i]);
+  }
+  ogeFree(s_state.worlds);
+  ogeFree(s_state.data);
+}
+
+// Application create function
+b8 ogeApplicationCreate(OgeApplication *pApplication) {
+  const char *workers = getenv("OGE_WORLDS_WORKERS");
+  jobsInitInfo.workerCount = workers ? (u32)atoi(workers) : 0;
+
+  pApplication->ogeInitInfo = &ogeInitInfo;
+  pApplication->init        = applicationInit;
+  pApplication->update      = applicationUpdate;
+  pApplication->render      = applicationRender;
+  pApplication->terminate   = applicationTerminate;
+
+  return OGE_TRUE;
+}
@@ -0,0 +1,144 @@
+/**
+ * @file parallel.h
+ * @brief The header of the parallel algorithms over darrays
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A minimum number of elements per chunk if a grain size
+ *        is selected automatically.
+ */
+#define OGE_PARALLEL_MIN_GRAIN_SIZE 4096
+
+/**
+ * @brief Range function pointer.
+ * @param darray A pointer to a darray.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @param userData A user defined data.
+ */
+typedef void (*OgeParallelForFunction)(void *darray, u64 begin, u64 end,
+                                       void *userData);
+
+/**
+ * @brief Range reduction function pointer.
+ * @param darray A pointer to a darray.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @param result A pointer to a partial result to accumulate
+ *               a range into, it starts as an identity value.
+ * @param userData A user defined data.
+ */
+typedef void (*OgeParallelReduceFunction)(const void *darray, u64 begin,
+                                          u64 end, void *result,
+                                          void *userData);
+
+/**
+ * @brief Partial results combination function pointer.
+ * @param result A pointer to a result to combine into.
+ * @param partial A pointer to a partial result of a range that
+ *                follows the ranges already combined into result.
+ * @param userData A user defined data.
+ */
+typedef void (*OgeParallelCombineFunction)(void *result,
+                                           const void *partial,
+                                           void *userData);
+
+/**
+ * @brief Calls a function for chunks of a darray range in
+ *        parallel.
+ *
+ * Chunks run as jobs of the job system, the calling thread runs
+ * some of them too. Returns once every chunk is finished.
+ *
+ * @param darray A pointer to a darray.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @param grainSize A minimum number of elements per chunk, 0 selects
+ *                  it from a range length and a number of threads.
+ * @param function A function to call for every chunk.
+ * @param userData A user defined data passed to a function.
+ */
+OGE_API void ogeParallelFor(void *darray, u64 begin, u64 end,
+                            u64 grainSize, OgeParallelForFunction function,
+                            void *userData);
+
+/**
+ * @brief Reduces a darray range in parallel.
+ *
+ * Every chunk is reduced into its own copy of an identity value,
+ * then partial results are combined in chunk order on the calling
+ * thread, so the result doesn't depend on scheduling.
+ *
+ * @param darray A pointer to a darray.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @param grainSize A minimum number of elements per chunk, 0 selects
+ *                  it from a range length and a number of threads.
+ * @param result A pointer to an identity value, the reduced value
+ *               is written to it.
+ * @param resultSize A size of a result in bytes.
+ * @param reduce A function reducing a chunk.
+ * @param combine A function combining partial results.
+ * @param userData A user defined data passed to functions.
+ */
+OGE_API void ogeParallelReduce(const void *darray, u64 begin, u64 end,
+                               u64 grainSize, void *result, u64 resultSize,
+                               OgeParallelReduceFunction reduce,
+                               OgeParallelCombineFunction combine,
+                               void *userData);
+
+/**
+ * @brief Replaces every element of a darray range of u32 with a sum
+ *        of the elements before it (exclusive prefix sum) in
+ *        parallel.
+ * @param darray A pointer to a darray of u32.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @return Returns a sum of the whole range.
+ */
+OGE_API u32 ogeParallelPrefixSumU32(u32 *darray, u64 begin, u64 end);
+
+/**
+ * @brief Replaces every element of a darray range of u64 with a sum
+ *        of the elements before it (exclusive prefix sum) in
+ *        parallel.
+ * @param darray A pointer to a darray of u64.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @return Returns a sum of the whole range.
+ */
+OGE_API u64 ogeParallelPrefixSumU64(u64 *darray, u64 begin, u64 end);
+
+/**
+ * @brief Sorts a darray range by an unsigned integer key in
+ *        parallel.
+ *
+ * The sort is a stable LSD radix sort, passes over key bytes that
+ * are the same for every element are skipped. A temporary buffer
+ * of the range size is allocated.
+ *
+ * @param darray A pointer to a darray.
+ * @param begin An index of the first element of a range.
+ * @param end An index past the last element of a range.
+ * @param keyOffset An offset of a key in an element in bytes.
+ * @param keySize A size of a key in bytes, either 4 or 8.
+ */
+OGE_API void ogeParallelSort(void *darray, u64 begin, u64 end,
+                             u64 keyOffset, u64 keySize);
@@ -0,0 +1,146 @@
+/**
+ * @file actions.h
+ * @brief The header of the input actions system
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <opl/opl.h>
+
+#include "oge/defines.h"
+#include "oge/core/input.h"
+
+/**
+ * @brief Maximum number of actions.
+ *
+ * Actions are identified by application defined indices
+ * from 0 to OGE_MAX_ACTIONS - 1.
+ */
+#ifndef OGE_MAX_ACTIONS
+  #define OGE_MAX_ACTIONS 256
+#endif
+
+/**
+ * @brief Action state flags.
+ *
+ * @var OGE_ACTION_STATE_DOWN
+ * An action chord is held this frame.
+ *
+ * @var OGE_ACTION_STATE_PRESSED
+ * An action chord was completed this frame.
+ *
+ * @var OGE_ACTION_STATE_RELEASED
+ * An action chord was broken this frame.
+ */
+typedef enum OgeActionStateFlags {
+  OGE_ACTION_STATE_DOWN     = 1 << 0,
+  OGE_ACTION_STATE_PRESSED  = 1 << 1,
+  OGE_ACTION_STATE_RELEASED = 1 << 2,
+} OgeActionStateFlags;
+
+/**
+ * @brief Action binding.
+ *
+ * A binding is a chord: it's down when all of it's keys and
+ * mouse buttons are down.
+ *
+ * @var OgeActionBinding::keys
+ * A pointer to an array of keys.
+ *
+ * @var OgeActionBinding::keyCount
+ * A number of keys.
+ *
+ * @var OgeActionBinding::mouseButtons
+ * A pointer to an array of mouse buttons.
+ *
+ * @var OgeActionBinding::mouseButtonCount
+ * A number of mouse buttons.
+ */
+typedef struct OgeActionBinding {
+  const OplKey         *keys;
+  u32                   keyCount;
+  const OplMouseButton *mouseButtons;
+  u32                   mouseButtonCount;
+} OgeActionBinding;
+
+/**
+ * @brief Current frame action states.
+ *
+ * A flat array of OgeActionStateFlags indexed by an action. Read
+ * it directly or through the query functions below.
+ */
+OGE_API extern u8 g_ogeActionStates[OGE_MAX_ACTIONS];
+
+/**
+ * @brief Initializes actions system.
+ */
+void ogeActionsInit();
+
+/**
+ * @brief Terminates actions system.
+ */
+void ogeActionsTerminate();
+
+/**
+ * @brief Evaluates all of the action bindings.
+ *
+ * Bindings are compiled to key and mouse button masks that are
+ * tested against OgeInputBits in a single batch.
+ *
+ * This function should be called after ogeInputBeginFrame.
+ */
+void ogeActionsUpdate();
+
+/**
+ * @brief Binds a chord to an action.
+ *
+ * An action can have several bindings, it's down if any of
+ * them is down.
+ *
+ * @param action An action index.
+ * @param binding A pointer to a binding. Arrays are copied.
+ */
+OGE_API void ogeActionBind(u16 action, const OgeActionBinding *binding);
+
+/**
+ * @brief Removes all of an action's bindings.
+ * @param action An action index.
+ */
+OGE_API void ogeActionUnbind(u16 action);
+
+/**
+ * @brief Returns wheter an action is down this frame or not.
+ * @param action An action index.
+ */
+OGE_INLINE b8 ogeActionIsDown(u16 action) {
+  return (g_ogeActionStates[action] & OGE_ACTION_STATE_DOWN) != 0;
+}
+
+/**
+ * @brief Returns wheter an action was pressed this frame or not.
+ * @param action An action index.
+ */
+OGE_INLINE b8 ogeActionIsPressed(u16 action) {
+  return (g_ogeActionStates[action] & OGE_ACTION_STATE_PRESSED) != 0;
+}
+
+/**
+ * @brief Returns wheter an action was released this frame or not.
+ * @param action An action index.
+ */
+OGE_INLINE b8 ogeActionIsReleased(u16 action) {
+  return (g_ogeActionStates[action] & OGE_ACTION_STATE_RELEASED) != 0;
+}
@@ -19,6 +19,7 @@
 #pragma once
 
 #include "oge/core/engine.h"
+#include "oge/renderer/packets.h"
 
 /**
  * @brief OGE application struct
@@ -36,11 +37,24 @@
  *
  * @var OgeApplication::update
  * A pointer to the application update function. This function
- * is called after pumping OPL messages.
+ * is called after pumping OPL messages, once per frame or, in fixed
+ * timestep mode, once per simulation tick (zero or more times per
+ * frame). Receives a pointer to the current OgeFrameInfo.
  *
  * @var OgeApplication::render
  * A pointer to the application render function. This function
- * is called after the application update function.
+ * is called once per frame after the application update function.
+ * Receives a pointer to the current OgeFrameInfo, its alpha should
+ * be used to interpolate between simulation states. If the
+ * application has a submit function, render function should only
+ * fill the current render packet with ogeRenderPacketAlloc.
+ *
+ * @var OgeApplication::submit
+ * A pointer to the application render packet submission function.
+ * Optional, if set it's the only function that should call the
+ * renderer. It's called with every packet the render function
+ * built, on the render thread if it's enabled, so the next frame
+ * update overlaps the previous frame submission.
  *
  * @var OgeApplication::terminate
  * A pointer to the application terminate function.
@@ -50,8 +64,9 @@ typedef struct OgeApplication {
   const OgeInitInfo *ogeInitInfo;
 
   b8   (*init)      ();
-  b8   (*update)    ();
-  b8   (*render)    ();
+  b8   (*update)    (const OgeFrameInfo *frameInfo);
+  b8   (*render)    (const OgeFrameInfo *frameInfo);
+  b8   (*submit)    (const OgeRenderPacket *packet);
   void (*terminate) ();
 } OgeApplication;
 
@@ -0,0 +1,133 @@
+/**
+ * @file benchmark.h
+ * @brief The header of the benchmark mode
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A name of an environment variable with a number of
+ *        measured frames, enables benchmark of any application.
+ */
+#define OGE_BENCHMARK_FRAMES_ENV "OGE_BENCHMARK_FRAMES"
+
+/**
+ * @brief A name of an environment variable with a number of warmup
+ *        frames.
+ */
+#define OGE_BENCHMARK_WARMUP_FRAMES_ENV "OGE_BENCHMARK_WARMUP_FRAMES"
+
+/**
+ * @brief A name of an environment variable with a name of a results
+ *        file.
+ */
+#define OGE_BENCHMARK_OUTPUT_ENV "OGE_BENCHMARK_OUTPUT"
+
+/**
+ * @brief A default name of a benchmark results file.
+ */
+#define OGE_BENCHMARK_DEFAULT_FILE_NAME "benchmark.json"
+
+/**
+ * @brief Benchmark initialization info.
+ *
+ * @var OgeBenchmarkInitInfo::warmupFrameCount
+ * A number of frames run before the measured ones, so caches, pools
+ * and a driver settle down.
+ *
+ * @var OgeBenchmarkInitInfo::frameCount
+ * A number of measured frames, 0 disables benchmark.
+ *
+ * @var OgeBenchmarkInitInfo::fileName
+ * A name of a JSON file results are written to, 0 means
+ * OGE_BENCHMARK_DEFAULT_FILE_NAME.
+ */
+typedef struct OgeBenchmarkInitInfo {
+  u32         warmupFrameCount;
+  u32         frameCount;
+  const char *fileName;
+} OgeBenchmarkInitInfo;
+
+/**
+ * @brief Timings of a single frame reported by the engine, all of
+ *        the times are in nanoseconds.
+ *
+ * A frame time is the time between the ends of consecutive frames.
+ *
+ * @var OgeBenchmarkFrame::endTime
+ * A time the frame ended at, in nanoseconds of ogeClockNow(). With
+ * render packets a frame is reported once its packet is submitted,
+ * which may be a few frames after it ended.
+ *
+ * @var OgeBenchmarkFrame::cpuTime
+ * A time the main thread spent on a frame, including time blocked
+ * in renderer but not the frame limiter wait.
+ *
+ * @var OgeBenchmarkFrame::gpuTime
+ * A time GPU spent executing a frame.
+ *
+ * @var OgeBenchmarkFrame::fenceWaitTime
+ * A time spent waiting for a frame in flight to finish on GPU.
+ *
+ * @var OgeBenchmarkFrame::acquireTime
+ * A time spent acquiring a swapchain image.
+ *
+ * @var OgeBenchmarkFrame::gpuTimeValid
+ * OGE_FALSE if GPU time wasn't measured.
+ */
+typedef struct OgeBenchmarkFrame {
+  u64 endTime;
+  u64 cpuTime;
+  u64 gpuTime;
+  u64 fenceWaitTime;
+  u64 acquireTime;
+  b8  gpuTimeValid;
+} OgeBenchmarkFrame;
+
+/**
+ * @brief Initializes benchmark.
+ *
+ * The OGE_BENCHMARK_FRAMES_ENV, OGE_BENCHMARK_WARMUP_FRAMES_ENV and
+ * OGE_BENCHMARK_OUTPUT_ENV environment variables override the init
+ * info, so any application can be benchmarked without rebuilding.
+ * While benchmark runs the frame limiter is unlimited.
+ *
+ * @param initInfo A pointer to OgeBenchmarkInitInfo struct or 0
+ *                 to run only if the environment asks to.
+ * @return Returns OGE_TRUE if benchmark was successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeBenchmarkInit(const OgeBenchmarkInitInfo *initInfo);
+
+/**
+ * @brief Terminates benchmark, warns if it didn't finish.
+ */
+void ogeBenchmarkTerminate();
+
+/**
+ * @brief Records timings of a frame.
+ *
+ * Called by the engine for every frame in order, does nothing if
+ * benchmark is disabled. After the last measured frame writes
+ * results.
+ *
+ * @param frame A pointer to timings of a frame.
+ * @return Returns OGE_FALSE once the last measured frame was
+ *         recorded and the main cycle should stop.
+ */
+b8 ogeBenchmarkEndFrame(const OgeBenchmarkFrame *frame);
@@ -0,0 +1,97 @@
+/**
+ * @file clock.h
+ * @brief The header of the clock
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <time.h>
+
+#include "oge/defines.h"
+
+#define OGE_NANOSECONDS_PER_SECOND      1000000000ULL
+#define OGE_NANOSECONDS_PER_MILLISECOND 1000000ULL
+#define OGE_NANOSECONDS_PER_MICROSECOND 1000ULL
+
+/**
+ * @brief OGE clock struct.
+ *
+ * All of the values are in nanoseconds.
+ *
+ * @var OgeClock::startTime
+ * A time the clock was started at.
+ *
+ * @var OgeClock::endTime
+ * A time the clock was stopped at.
+ *
+ * @var OgeClock::elapsedTime
+ * A difference between end and start time.
+ */
+typedef struct OgeClock {
+  u64 startTime;
+  u64 endTime;
+  u64 elapsedTime;
+} OgeClock;
+
+/**
+ * @brief Returns a current time of a monotonic high resolution clock.
+ *
+ * The value doesn't relate to a wall time and only meant to be
+ * used for measuring time intervals.
+ *
+ * @return Returns a current time in nanoseconds.
+ */
+OGE_INLINE u64 ogeClockNow() {
+  struct timespec time;
+  clock_gettime(CLOCK_MONOTONIC, &time);
+  return (u64)time.tv_sec * OGE_NANOSECONDS_PER_SECOND + (u64)time.tv_nsec;
+}
+
+/**
+ * @brief Starts a clock.
+ * @param clock A pointer to a clock.
+ */
+OGE_INLINE void ogeClockStart(OgeClock *clock) {
+  clock->startTime   = ogeClockNow();
+  clock->endTime     = clock->startTime;
+  clock->elapsedTime = 0;
+}
+
+/**
+ * @brief Stops a clock and updates it's elapsed time.
+ * @param clock A pointer to a clock.
+ */
+OGE_INLINE void ogeClockStop(OgeClock *clock) {
+  clock->endTime     = ogeClockNow();
+  clock->elapsedTime = clock->endTime - clock->startTime;
+}
+
+/**
+ * @brief Converts nanoseconds to seconds.
+ */
+#define OGE_NS_TO_SECONDS(ns) ((f64)(ns) / (f64)OGE_NANOSECONDS_PER_SECOND)
+
+/**
+ * @brief Converts nanoseconds to milliseconds.
+ */
+#define OGE_NS_TO_MILLISECONDS(ns) \
+  ((f64)(ns) / (f64)OGE_NANOSECONDS_PER_MILLISECOND)
+
+/**
+ * @brief Converts nanoseconds to microseconds.
+ */
+#define OGE_NS_TO_MICROSECONDS(ns) \
+  ((f64)(ns) / (f64)OGE_NANOSECONDS_PER_MICROSECOND)
@@ -19,13 +19,98 @@
 #pragma once
 
 #include "oge/defines.h"
+#include "oge/core/jobs.h"
 #include "oge/core/logging.h"
 #include "oge/core/platform.h"
+#include "oge/core/tasks.h"
+#include "oge/core/profiler.h"
+#include "oge/core/replay.h"
+#include "oge/core/limiter.h"
+#include "oge/core/startup.h"
+#include "oge/core/recorder.h"
+#include "oge/core/benchmark.h"
 #include "oge/renderer/renderer.h"
 
 // forward decl for struct from oge/core/application.h
 typedef struct OgeApplication OgeApplication;
 
+// forward decl for struct from oge/renderer/packets.h
+typedef struct OgeRenderPacketsInitInfo OgeRenderPacketsInitInfo;
+
+/**
+ * @brief A default fixed timestep tick rate in ticks per second.
+ */
+#define OGE_DEFAULT_TICK_RATE 60
+
+/**
+ * @brief A default maximum number of fixed timestep ticks per frame.
+ */
+#define OGE_DEFAULT_MAX_TICKS_PER_FRAME 8
+
+/**
+ * @brief A default maximum frame time in seconds.
+ */
+#define OGE_DEFAULT_MAX_FRAME_TIME 0.25
+
+/**
+ * @brief Main cycle initialization info.
+ *
+ * @var OgeLoopInitInfo::fixedTimestep
+ * If set to OGE_TRUE application update function is called with
+ * a fixed delta time as many times as needed to catch up with real
+ * time, otherwise it's called once per frame with a frame time.
+ *
+ * @var OgeLoopInitInfo::tickRate
+ * A number of fixed timestep updates per second, 0 means
+ * OGE_DEFAULT_TICK_RATE.
+ *
+ * @var OgeLoopInitInfo::maxTicksPerFrame
+ * A maximum number of fixed timestep updates per frame, 0 means
+ * OGE_DEFAULT_MAX_TICKS_PER_FRAME. If a machine can't keep up,
+ * the simulation slows down instead of spending more and more
+ * time catching up.
+ *
+ * @var OgeLoopInitInfo::maxFrameTime
+ * A frame time in seconds longer frames (e.g. after a breakpoint
+ * or a window drag) are clamped to, 0 means
+ * OGE_DEFAULT_MAX_FRAME_TIME.
+ */
+typedef struct OgeLoopInitInfo {
+  b8  fixedTimestep;
+  u32 tickRate;
+  u32 maxTicksPerFrame;
+  f64 maxFrameTime;
+} OgeLoopInitInfo;
+
+/**
+ * @brief Frame timing info passed to application functions.
+ *
+ * @var OgeFrameInfo::deltaTime
+ * A time in seconds the update advances a simulation by. In fixed
+ * timestep mode it's always 1 / tick rate.
+ *
+ * @var OgeFrameInfo::alpha
+ * How far real time is between the previous and the current
+ * simulation states in range [0, 1), render should interpolate
+ * between them with it. Always 1 if fixed timestep is disabled.
+ *
+ * @var OgeFrameInfo::time
+ * A total simulated time in seconds.
+ *
+ * @var OgeFrameInfo::frameIndex
+ * An index of the current frame.
+ *
+ * @var OgeFrameInfo::tickIndex
+ * An index of the current update call.
+ */
+typedef struct OgeFrameInfo {
+  f64 deltaTime;
+  f64 alpha;
+  f64 time;
+  u64 frameIndex;
+  u64 tickIndex;
+} OgeFrameInfo;
+
 /** 
  * @brief OGE initialization info.
  *
@@ -36,12 +121,60 @@ typedef struct OgeApplication OgeApplication;
  * A pointer to a OgeLoggingInitInfo struct.
  *
  * @var OgeInitInfo ::rendererInitInfo
- * A pointer to a OgeRendererInitInfo struct.
+ * A pointer to a OgeRendererInitInfo struct. Optional, set to 0
+ * to run without renderer, e.g. a headless simulation.
+ *
+ * @var OgeInitInfo::replayInitInfo
+ * A pointer to a OgeReplayInitInfo struct. Optional, set to 0
+ * to disable replay recording and playback.
+ *
+ * @var OgeInitInfo::recorderInitInfo
+ * A pointer to a OgeRecorderInitInfo struct. Optional, set to 0
+ * to use the default flight recorder settings.
+ *
+ * @var OgeInitInfo::loopInitInfo
+ * A pointer to a OgeLoopInitInfo struct. Optional, set to 0
+ * to update once per frame with a frame time.
+ *
+ * @var OgeInitInfo::limiterInitInfo
+ * A pointer to a OgeLimiterInitInfo struct. Optional, set to 0
+ * to run with an unlimited frame rate.
+ *
+ * @var OgeInitInfo::jobsInitInfo
+ * A pointer to a OgeJobsInitInfo struct. Optional, set to 0
+ * to start a worker per logical processor.
+ *
+ * @var OgeInitInfo::renderPacketsInitInfo
+ * A pointer to a OgeRenderPacketsInitInfo struct. Optional, set to
+ * 0 to submit render packets on the game thread. Used only if
+ * the application has a submit function.
+ *
+ * @var OgeInitInfo::profilerInitInfo
+ * A pointer to a OgeProfilerInitInfo struct. Optional, set to 0
+ * to use default settings. Scopes are recorded only if the engine
+ * is built with OGE_PROFILE.
+ *
+ * @var OgeInitInfo::benchmarkInitInfo
+ * A pointer to a OgeBenchmarkInitInfo struct. Optional, set to 0
+ * to run benchmark only if the environment asks to.
+ *
+ * @var OgeInitInfo::startupInitInfo
+ * A pointer to a OgeStartupInitInfo struct. Optional, set to 0
+ * only to log the startup report.
  */
 typedef struct OgeInitInfo {
   const OgeLoggingInitInfo  *loggingInitInfo;
   const OgePlatformInitInfo *platformInitInfo;
   const OgeRendererInitInfo *rendererInitInfo;
+  const OgeReplayInitInfo   *replayInitInfo;
+  const OgeRecorderInitInfo *recorderInitInfo;
+  const OgeLoopInitInfo     *loopInitInfo;
+  const OgeLimiterInitInfo  *limiterInitInfo;
+  const OgeJobsInitInfo     *jobsInitInfo;
+  const OgeRenderPacketsInitInfo *renderPacketsInitInfo;
+  const OgeProfilerInitInfo *profilerInitInfo;
+  const OgeBenchmarkInitInfo *benchmarkInitInfo;
+  const OgeStartupInitInfo  *startupInitInfo;
 } OgeInitInfo;
 
 /**
@@ -66,3 +199,8 @@ OGE_API void ogeTerminate();
  * @brief Requests OGE termination.
  */
 OGE_API void ogeRequestTerminate();
+
+/**
+ * @brief Returns the current frame timing info.
+ */
+OGE_API const OgeFrameInfo* ogeGetFrameInfo();
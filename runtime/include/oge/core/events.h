@@ -93,10 +93,173 @@ OGE_API void ogeEventsUnsubscribe(u16 code, OgeEventCallback callback);
  */
 OGE_API void ogeEventsInvoke(u16 code, void *invoker, OgeEventData data);
 
+/**
+ * @brief Events context, an independent set of event subscriptions.
+ *
+ * The ogeEvents* functions above work with the process context,
+ * which receives platform events. Worlds have their own contexts,
+ * so simulations don't see each other's events. A context isn't
+ * synchronized, it should be used by one thread at a time.
+ */
+typedef struct OgeEventsContext OgeEventsContext;
+
+/**
+ * @brief Creates an events context.
+ * @return Returns a pointer to a new events context.
+ */
+OGE_API OgeEventsContext* ogeEventsContextCreate();
+
+/**
+ * @brief Destroys an events context.
+ * @param context A pointer to an events context.
+ */
+OGE_API void ogeEventsContextDestroy(OgeEventsContext *context);
+
+/**
+ * @brief Adds a function pointer to a list of an event's callbacks
+ *        in a context.
+ * @param context A pointer to an events context.
+ * @param code A code of an event.
+ * @param callback A pointer to a function.
+ */
+OGE_API void ogeEventsContextSubscribe(OgeEventsContext *context, u16 code,
+                                       OgeEventCallback callback);
+
+/**
+ * @brief Removes a function pointer from a list of an event's
+ *        callbacks in a context.
+ * @param context A pointer to an events context.
+ * @param code A code of an event.
+ * @param callback A pointer to a function.
+ */
+OGE_API void ogeEventsContextUnsubscribe(OgeEventsContext *context, u16 code,
+                                         OgeEventCallback callback);
+
+/**
+ * @brief Calls an event's callbacks of a context in subscription
+ *        order.
+ *
+ * Unlike ogeEventsInvoke, events aren't recorded by the flight
+ * recorder and replay.
+ *
+ * @param context A pointer to an events context.
+ * @param code A code of an event.
+ * @param invoker A pointer to an invoker.
+ * @param data An event data.
+ */
+OGE_API void ogeEventsContextInvoke(OgeEventsContext *context, u16 code,
+                                    void *invoker, OgeEventData data);
+
+#ifdef OGE_EVENTS_STATS
+/**
+ * @brief Event code dispatch statistics.
+ *
+ * All of the times are in nanoseconds.
+ *
+ * @var OgeEventStats::invokeCount
+ * A number of ogeEventsInvoke calls with the event code.
+ *
+ * @var OgeEventStats::subscriberCount
+ * A number of subscribers at the last invocation.
+ *
+ * @var OgeEventStats::totalTime
+ * A cumulative dispatch time.
+ *
+ * @var OgeEventStats::maxTime
+ * The longest single dispatch time.
+ */
+typedef struct OgeEventStats {
+  u64 invokeCount;
+  u64 subscriberCount;
+  u64 totalTime;
+  u64 maxTime;
+} OgeEventStats;
+
+/**
+ * @brief Event callback statistics.
+ *
+ * All of the times are in nanoseconds.
+ *
+ * @var OgeEventCallbackStats::callback
+ * A callback address the statistics are attributed to.
+ *
+ * @var OgeEventCallbackStats::callCount
+ * A number of the callback calls.
+ *
+ * @var OgeEventCallbackStats::totalTime
+ * A cumulative time spent in the callback.
+ *
+ * @var OgeEventCallbackStats::maxTime
+ * The longest single callback call time.
+ */
+typedef struct OgeEventCallbackStats {
+  OgeEventCallback callback;
+  u64 callCount;
+  u64 totalTime;
+  u64 maxTime;
+} OgeEventCallbackStats;
+
+/**
+ * @brief Returns dispatch statistics of an event code.
+ * @param code A code of an event.
+ * @return Returns a pointer to the event code statistics.
+ */
+OGE_API const OgeEventStats* ogeEventsGetStats(u16 code);
+
+/**
+ * @brief Returns statistics of an event's callbacks.
+ *
+ * Statistics are stored in subscription order, so an index of
+ * a callback statistics matches it's dispatch order.
+ *
+ * @param code A code of an event.
+ * @param count A pointer to a variable that will hold a number
+ *              of callbacks.
+ * @return Returns a pointer to an array of callback statistics.
+ */
+OGE_API const OgeEventCallbackStats* ogeEventsGetCallbackStats(
+  u16 code, u64 *count);
+
+/**
+ * @brief Resets all of the event statistics.
+ */
+OGE_API void ogeEventsResetStats();
+
+/**
+ * @brief Logs an event statistics summary.
+ *
+ * Prints every invoked event code along with it's slowest callback.
+ */
+OGE_API void ogeEventsLogStats();
+
+/**
+ * @brief Updates event statistics.
+ *
+ * Logs a statistics summary every OGE_EVENTS_STATS_LOG_PERIOD
+ * nanoseconds. This function should be called once per frame.
+ */
+void ogeEventsStatsUpdate();
+#endif
+
 /**
  * @brief OGE reserved event codes.
  *
  * OGE reserved all event codes up to 255.
+ *
+ * Input event data layout:
+ * - OGE_EVENT_KEY_*:           data.u16[0] is an OplKey;
+ * - OGE_EVENT_MOUSE_BUTTON_*:  data.u16[0] is an OplMouseButton;
+ * - OGE_EVENT_MOUSE_WHEEL:     data.i8[0] is a wheel scroll;
+ * - OGE_EVENT_MOUSE_MOVE:      data.u16[0] and data.u16[1] are
+ *                              x and y cursor coordinates.
+ *
+ * Application event data layout:
+ * - OGE_EVENT_APPLICATION_FOCUS: data.u8[0] is OGE_TRUE if a window
+ *                                gained focus and OGE_FALSE if it
+ *                                lost it.
+ *
+ * OGE_EVENT_APPLICATION_RESTORE is invoked when a window is
+ * restored after being minimized.
  */
 typedef enum OgeEventCode {
   OGE_EVENT_UNKOWN,
@@ -114,5 +277,9 @@ typedef enum OgeEventCode {
   OGE_EVENT_MOUSE_WHEEL,
   OGE_EVENT_MOUSE_MOVE,
 
+  // Appended to keep the codes above (and recorded replays) stable
+  OGE_EVENT_APPLICATION_RESTORE,
+  OGE_EVENT_APPLICATION_FOCUS,
+
   OGE_EVENT_MAX_ENUM = 255,
 } OgeEventCode;
@@ -0,0 +1,54 @@
+/**
+ * @file file.h
+ * @brief The header of read-only file mappings
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief Read-only file mapping struct.
+ *
+ * Mapped pages are read from a file on first access and shared with
+ * the page cache, so a file is never copied into process memory.
+ *
+ * @var OgeFileMapping::data
+ * A pointer to the file contents, aligned to a page.
+ *
+ * @var OgeFileMapping::size
+ * A size of the file in bytes.
+ */
+typedef struct OgeFileMapping {
+  const void *data;
+  u64         size;
+} OgeFileMapping;
+
+/**
+ * @brief Maps a whole file into memory for reading.
+ * @param fileName A name of a file.
+ * @param mapping A pointer to a mapping struct to fill.
+ * @return Returns OGE_TRUE if a file was mapped, otherwise returns
+ *         OGE_FALSE. Empty files can't be mapped.
+ */
+OGE_API b8 ogeFileMap(const char *fileName, OgeFileMapping *mapping);
+
+/**
+ * @brief Unmaps a file mapped by ogeFileMap and zeroes the mapping.
+ * @param mapping A pointer to a mapping, does nothing if it's
+ *                zeroed.
+ */
+OGE_API void ogeFileUnmap(OgeFileMapping *mapping);
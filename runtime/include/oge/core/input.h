@@ -22,6 +22,20 @@
 
 #include "oge/defines.h"
 
+/**
+ * @brief A number of keys in OplKeyboardState.
+ */
+#define OGE_KEY_COUNT \
+  (sizeof(((OplKeyboardState*)0)->keys) / \
+   sizeof(((OplKeyboardState*)0)->keys[0]))
+
+/**
+ * @brief A number of mouse buttons in OplMouseState.
+ */
+#define OGE_MOUSE_BUTTON_COUNT \
+  (sizeof(((OplMouseState*)0)->buttons) / \
+   sizeof(((OplMouseState*)0)->buttons[0]))
+
 /**
  * @brief Initialized input system.
  */
@@ -32,6 +46,17 @@ void ogeInputInit();
  */
 void ogeInputTerminate();
 
+/**
+ * @brief Begins a new input frame.
+ *
+ * Packs OPL keyboard and mouse state into g_ogeInputBits and marks
+ * keys and mouse buttons that changed since the previous frame.
+ *
+ * This function should be called after pumping OPL messages
+ * and before the application update function.
+ */
+void ogeInputBeginFrame();
+
 /**
  * @brief Updates input system.
  * 
@@ -40,13 +65,61 @@ void ogeInputTerminate();
  */
 void ogeInputUpdate();
 
+/**
+ * @brief A number of 64-bit words in a keys bitset.
+ */
+#define OGE_KEY_WORD_COUNT ((OGE_KEY_COUNT + 63) / 64)
+
+/**
+ * @brief Packed per-frame input state.
+ *
+ * Updated once per frame by ogeInputBeginFrame. Bit i % 64 of
+ * word i / 64 corresponds to a key (or a mouse button) i.
+ *
+ * @var OgeInputBits::keysDown
+ * Keys that are down this frame.
+ *
+ * @var OgeInputBits::keysChanged
+ * Keys that changed their state since the previous frame.
+ *
+ * @var OgeInputBits::mouseButtonsDown
+ * Mouse buttons that are down this frame.
+ *
+ * @var OgeInputBits::mouseButtonsChanged
+ * Mouse buttons that changed their state since the previous frame.
+ */
+typedef struct OgeInputBits {
+  u64 keysDown[OGE_KEY_WORD_COUNT];
+  u64 keysChanged[OGE_KEY_WORD_COUNT];
+  u64 mouseButtonsDown;
+  u64 mouseButtonsChanged;
+} OgeInputBits;
+
+_OGE_STATIC_ASSERT(OGE_MOUSE_BUTTON_COUNT <= 64,
+                   "Expected mouse buttons to fit a 64-bit word.");
+
+/**
+ * @brief Current frame input bits.
+ *
+ * Read it through the query functions below, they are inlined
+ * into the caller and don't cross the shared library boundary.
+ */
+OGE_API extern OgeInputBits g_ogeInputBits;
+
+#define OGE_KEY_WORD(bits, key) ((bits)[(key) / 64])
+#define OGE_KEY_MASK(key)       (1ULL << ((key) % 64))
+
 /**
  * @brief Returns wheter a key was pressed this frame or not.
  * @param key A key.
  * @return Returns OGE_TRUE if a key was pressed this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeKeyIsPressed(OplKey key);
+OGE_INLINE b8 ogeKeyIsPressed(OplKey key) {
+  return (OGE_KEY_WORD(g_ogeInputBits.keysDown, key)    &
+          OGE_KEY_WORD(g_ogeInputBits.keysChanged, key) &
+          OGE_KEY_MASK(key)) != 0;
+}
 
 /**
  * @brief Returns wheter a key was down this frame or not.
@@ -54,7 +127,10 @@ OGE_API b8 ogeKeyIsPressed(OplKey key);
  * @return Returns OGE_TRUE if a key was down this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeKeyIsDown(OplKey key);
+OGE_INLINE b8 ogeKeyIsDown(OplKey key) {
+  return (OGE_KEY_WORD(g_ogeInputBits.keysDown, key) &
+          OGE_KEY_MASK(key)) != 0;
+}
 
 /**
  * @brief Returns wheter a key was released this frame or not.
@@ -62,7 +138,11 @@ OGE_API b8 ogeKeyIsDown(OplKey key);
  * @return Returns OGE_TRUE if a key was released this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeKeyIsReleased(OplKey key);
+OGE_INLINE b8 ogeKeyIsReleased(OplKey key) {
+  return (~OGE_KEY_WORD(g_ogeInputBits.keysDown, key)   &
+          OGE_KEY_WORD(g_ogeInputBits.keysChanged, key) &
+          OGE_KEY_MASK(key)) != 0;
+}
 
 /**
  * @brief Returns wheter a key was up this frame or not.
@@ -70,7 +150,9 @@ OGE_API b8 ogeKeyIsReleased(OplKey key);
  * @return Returns OGE_TRUE if a key was up this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeKeyIsUp(OplKey key);
+OGE_INLINE b8 ogeKeyIsUp(OplKey key) {
+  return !ogeKeyIsDown(key);
+}
 
 /**
  * @brief Returns wheter a mouseButton was pressed this frame or not.
@@ -78,7 +160,11 @@ OGE_API b8 ogeKeyIsUp(OplKey key);
  * @return Returns OGE_TRUE if a mouseButton was pressed this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeMouseButtonIsPressed(OplMouseButton mouseButton);
+OGE_INLINE b8 ogeMouseButtonIsPressed(OplMouseButton mouseButton) {
+  return (g_ogeInputBits.mouseButtonsDown    &
+          g_ogeInputBits.mouseButtonsChanged &
+          (1ULL << mouseButton)) != 0;
+}
 
 /**
  * @brief Returns wheter a mouseButton was down this frame or not.
@@ -86,7 +172,9 @@ OGE_API b8 ogeMouseButtonIsPressed(OplMouseButton mouseButton);
  * @return Returns OGE_TRUE if a mouseButton was down this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeMouseButtonIsDown(OplMouseButton mouseButton);
+OGE_INLINE b8 ogeMouseButtonIsDown(OplMouseButton mouseButton) {
+  return (g_ogeInputBits.mouseButtonsDown & (1ULL << mouseButton)) != 0;
+}
 
 /**
  * @brief Returns wheter a mouse button was released this frame or not.
@@ -94,7 +182,11 @@ OGE_API b8 ogeMouseButtonIsDown(OplMouseButton mouseButton);
  * @return Returns OGE_TRUE if a mouse button was released this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeMouseButtonIsReleased(OplMouseButton mouseButton);
+OGE_INLINE b8 ogeMouseButtonIsReleased(OplMouseButton mouseButton) {
+  return (~g_ogeInputBits.mouseButtonsDown   &
+          g_ogeInputBits.mouseButtonsChanged &
+          (1ULL << mouseButton)) != 0;
+}
 
 /**
  * @brief Returns wheter a mouse button was up this frame or not.
@@ -102,7 +194,76 @@ OGE_API b8 ogeMouseButtonIsReleased(OplMouseButton mouseButton);
  * @return Returns OGE_TRUE if a mouse button was up this frame,
  *         otherwise returns OGE_FALSE.
  */
-OGE_API b8 ogeMouseButtonIsUp(OplMouseButton mouseButton);
+OGE_INLINE b8 ogeMouseButtonIsUp(OplMouseButton mouseButton) {
+  return !ogeMouseButtonIsDown(mouseButton);
+}
+
+/**
+ * @brief Iterator over keys that changed their state this frame.
+ *
+ * Usage:
+ * @code
+ * OgeKeyIterator it = ogeKeyIteratePressed();
+ * OplKey key;
+ * while (ogeKeyIteratorNext(&it, &key)) { ... }
+ * @endcode
+ */
+typedef struct OgeKeyIterator {
+  u64 bits;
+  u32 wordIndex;
+  b8  pressed;
+} OgeKeyIterator;
+
+OGE_INLINE u64 ogeKeyIteratorWord(u32 wordIndex, b8 pressed) {
+  const u64 down = g_ogeInputBits.keysDown[wordIndex];
+  return g_ogeInputBits.keysChanged[wordIndex] & (pressed ? down : ~down);
+}
+
+/**
+ * @brief Returns an iterator over keys pressed this frame.
+ */
+OGE_INLINE OgeKeyIterator ogeKeyIteratePressed() {
+  const OgeKeyIterator iterator = {
+    .bits      = ogeKeyIteratorWord(0, OGE_TRUE),
+    .wordIndex = 0,
+    .pressed   = OGE_TRUE,
+  };
+  return iterator;
+}
+
+/**
+ * @brief Returns an iterator over keys released this frame.
+ */
+OGE_INLINE OgeKeyIterator ogeKeyIterateReleased() {
+  const OgeKeyIterator iterator = {
+    .bits      = ogeKeyIteratorWord(0, OGE_FALSE),
+    .wordIndex = 0,
+    .pressed   = OGE_FALSE,
+  };
+  return iterator;
+}
+
+/**
+ * @brief Advances a key iterator.
+ *
+ * Costs a number of changed keys plus OGE_KEY_WORD_COUNT.
+ *
+ * @param iterator A pointer to a key iterator.
+ * @param key A pointer to a variable that will hold the next key.
+ * @return Returns OGE_FALSE when there are no more keys, otherwise
+ *         returns OGE_TRUE.
+ */
+OGE_INLINE b8 ogeKeyIteratorNext(OgeKeyIterator *iterator, OplKey *key) {
+  while (!iterator->bits) {
+    if (++iterator->wordIndex >= OGE_KEY_WORD_COUNT) { return OGE_FALSE; }
+    iterator->bits =
+      ogeKeyIteratorWord(iterator->wordIndex, iterator->pressed);
+  }
+
+  *key = (OplKey)(iterator->wordIndex * 64 + OGE_CTZ64(iterator->bits));
+  iterator->bits &= iterator->bits - 1;
+  return OGE_TRUE;
+}
 
 /**
  * @brief Returns a mouse wheel scroll.
@@ -0,0 +1,145 @@
+/**
+ * @file jobs.h
+ * @brief The header of the job system
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A maximum number of job system worker threads.
+ */
+#define OGE_JOBS_MAX_WORKERS 64
+
+/**
+ * @brief A default capacity of a per thread job queue.
+ */
+#define OGE_JOBS_DEFAULT_QUEUE_CAPACITY 4096
+
+/**
+ * @brief Job function pointer.
+ * @param data A user defined job data.
+ */
+typedef void (*OgeJobFunction)(void *data);
+
+/**
+ * @brief Job struct.
+ *
+ * @var OgeJob::function
+ * A function to run.
+ *
+ * @var OgeJob::data
+ * A pointer passed to a function, must stay valid until a job is
+ * finished.
+ */
+typedef struct OgeJob {
+  OgeJobFunction  function;
+  void           *data;
+} OgeJob;
+
+/**
+ * @brief A counter of unfinished jobs.
+ *
+ * Should be zero initialized, submitting jobs with a counter
+ * increments it and every finished job decrements it.
+ *
+ * @var OgeJobCounter::value
+ * A number of unfinished jobs, accessed atomically.
+ */
+typedef struct OgeJobCounter {
+  u32 value;
+} OgeJobCounter;
+
+/**
+ * @brief Job system initialization info.
+ *
+ * @var OgeJobsInitInfo::workerCount
+ * A number of worker threads, 0 means one per logical processor
+ * except the one of the main thread. Clamped to
+ * OGE_JOBS_MAX_WORKERS.
+ *
+ * @var OgeJobsInitInfo::queueCapacity
+ * A number of jobs every thread can have queued, rounded up to a
+ * power of 2. 0 means OGE_JOBS_DEFAULT_QUEUE_CAPACITY.
+ */
+typedef struct OgeJobsInitInfo {
+  u32 workerCount;
+  u32 queueCapacity;
+} OgeJobsInitInfo;
+
+/**
+ * @brief Initializes job system and starts its worker threads.
+ *
+ * Every thread of the job system has its own work-stealing queue,
+ * jobs are submitted to the queue of the submitting thread and
+ * idle threads steal them from the others.
+ *
+ * Should be called from the main thread.
+ *
+ * @param initInfo A pointer to OgeJobsInitInfo struct or 0 to use
+ *                 default settings.
+ * @return Returns OGE_TRUE if job system was successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeJobsInit(const OgeJobsInitInfo *initInfo);
+
+/**
+ * @brief Stops worker threads and terminates job system.
+ *
+ * Jobs that weren't started yet are dropped.
+ */
+void ogeJobsTerminate();
+
+/**
+ * @brief Submits jobs.
+ *
+ * Jobs can be submitted from any thread. If there are no worker
+ * threads or a queue is full, jobs run right away on the calling
+ * thread.
+ *
+ * @param jobs A pointer to an array of jobs.
+ * @param count A number of jobs in the array.
+ * @param counter A pointer to a counter to increment by the number
+ *                of jobs or 0.
+ */
+OGE_API void ogeJobsSubmit(const OgeJob *jobs, u32 count,
+                           OgeJobCounter *counter);
+
+/**
+ * @brief Waits until a counter drops to zero.
+ *
+ * The calling thread runs queued jobs while waiting instead of
+ * blocking, so jobs can wait on the jobs they submit.
+ *
+ * @param counter A pointer to a counter.
+ */
+OGE_API void ogeJobsWait(OgeJobCounter *counter);
+
+/**
+ * @brief Returns a number of threads running jobs, the main thread
+ *        included.
+ */
+OGE_API u32 ogeJobsGetThreadCount();
+
+/**
+ * @brief Returns an index of the calling thread in range
+ *        [0, ogeJobsGetThreadCount()), 0 is the main thread.
+ *
+ * Returns ogeJobsGetThreadCount() if the calling thread isn't a
+ * job system thread.
+ */
+OGE_API u32 ogeJobsGetThreadIndex();
@@ -0,0 +1,145 @@
+/**
+ * @file limiter.h
+ * @brief The header of the frame limiter
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A default frame rate while a window is out of focus.
+ */
+#define OGE_LIMITER_DEFAULT_BACKGROUND_FRAME_RATE 30
+
+/**
+ * @brief A default frame rate while a window is minimized.
+ */
+#define OGE_LIMITER_DEFAULT_HIDDEN_FRAME_RATE 10
+
+/**
+ * @brief Frame limiter initialization info.
+ *
+ * @var OgeLimiterInitInfo::targetFrameRate
+ * A maximum number of frames per second, 0 means unlimited.
+ *
+ * @var OgeLimiterInitInfo::backgroundFrameRate
+ * A maximum number of frames per second while a window is out of
+ * focus, 0 means OGE_LIMITER_DEFAULT_BACKGROUND_FRAME_RATE.
+ *
+ * @var OgeLimiterInitInfo::hiddenFrameRate
+ * A maximum number of frames per second while a window is
+ * minimized, 0 means OGE_LIMITER_DEFAULT_HIDDEN_FRAME_RATE.
+ */
+typedef struct OgeLimiterInitInfo {
+  u32 targetFrameRate;
+  u32 backgroundFrameRate;
+  u32 hiddenFrameRate;
+} OgeLimiterInitInfo;
+
+/**
+ * @brief Frame pacing statistics, all of the times are in
+ *        nanoseconds.
+ *
+ * @var OgeLimiterStats::frameCount
+ * A number of paced frames.
+ *
+ * @var OgeLimiterStats::targetFrameTime
+ * A current frame time the limiter paces to, 0 if unlimited.
+ *
+ * @var OgeLimiterStats::meanFrameTime
+ * A mean time between frame starts.
+ *
+ * @var OgeLimiterStats::minFrameTime
+ * A shortest time between frame starts.
+ *
+ * @var OgeLimiterStats::maxFrameTime
+ * A longest time between frame starts.
+ *
+ * @var OgeLimiterStats::jitter
+ * A standard deviation of a time between frame starts.
+ *
+ * @var OgeLimiterStats::missedDeadlines
+ * A number of frames that started noticeably after their deadline,
+ * either because the previous frame took too long or because a
+ * sleep overshot.
+ *
+ * @var OgeLimiterStats::maxLateness
+ * The longest time a frame started after its deadline.
+ */
+typedef struct OgeLimiterStats {
+  u64 frameCount;
+  u64 targetFrameTime;
+  f64 meanFrameTime;
+  u64 minFrameTime;
+  u64 maxFrameTime;
+  f64 jitter;
+  u64 missedDeadlines;
+  u64 maxLateness;
+} OgeLimiterStats;
+
+/**
+ * @brief Initializes frame limiter.
+ *
+ * Subscribes to OGE_EVENT_APPLICATION_MINIMIZE,
+ * OGE_EVENT_APPLICATION_MAXIMIZE, OGE_EVENT_APPLICATION_RESTORE and
+ * OGE_EVENT_APPLICATION_FOCUS to throttle a hidden or an
+ * unfocused application.
+ *
+ * @param initInfo A pointer to OgeLimiterInitInfo struct or 0
+ *                 to run unlimited.
+ */
+void ogeLimiterInit(const OgeLimiterInitInfo *initInfo);
+
+/**
+ * @brief Terminates frame limiter and logs its statistics.
+ */
+void ogeLimiterTerminate();
+
+/**
+ * @brief Waits until the start of the next frame.
+ *
+ * Sleeps the most of the remaining time and spins the rest of it,
+ * the spin window adapts to the observed sleep overshoot. Called
+ * by the engine at the end of every frame.
+ */
+void ogeLimiterWait();
+
+/**
+ * @brief Returns OGE_TRUE if a window is minimized.
+ */
+b8 ogeLimiterIsHidden();
+
+/**
+ * @brief Sets a maximum number of frames per second.
+ * @param frameRate A frame rate, 0 means unlimited.
+ */
+OGE_API void ogeLimiterSetTargetFrameRate(u32 frameRate);
+
+/**
+ * @brief Returns frame pacing statistics.
+ */
+OGE_API const OgeLimiterStats* ogeLimiterGetStats();
+
+/**
+ * @brief Resets frame pacing statistics.
+ */
+OGE_API void ogeLimiterResetStats();
+
+/**
+ * @brief Logs frame pacing statistics.
+ */
+OGE_API void ogeLimiterLogStats();
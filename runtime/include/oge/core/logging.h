@@ -34,17 +34,137 @@ typedef enum OgeLogLevel {
   OGE_LOG_LEVEL_FATAL,
 } OgeLogLevel;
 
+/**
+ * @brief Logging category.
+ *
+ * Every category has its own runtime logging level and compile
+ * time logging level. Log macros use a category set with
+ * OGE_LOG_CATEGORY define.
+ */
+typedef enum OgeLogCategory {
+  OGE_LOG_CATEGORY_GENERAL,
+  OGE_LOG_CATEGORY_CORE,
+  OGE_LOG_CATEGORY_PLATFORM,
+  OGE_LOG_CATEGORY_EVENTS,
+  OGE_LOG_CATEGORY_INPUT,
+  OGE_LOG_CATEGORY_RENDERER,
+  OGE_LOG_CATEGORY_MAX_ENUM,
+} OgeLogCategory;
+
+/**
+ * @brief Logging queue overflow policy.
+ *
+ * Specifies what an ogeLog call does when the logging thread
+ * queue is full.
+ *
+ * @var OGE_LOG_OVERFLOW_POLICY_BLOCK
+ * Wait until the logging thread frees a queue slot.
+ *
+ * @var OGE_LOG_OVERFLOW_POLICY_DROP
+ * Silently drop a message.
+ *
+ * @var OGE_LOG_OVERFLOW_POLICY_COUNT
+ * Drop a message and report a number of dropped messages once
+ * the queue has room again.
+ */
+typedef enum OgeLogOverflowPolicy {
+  OGE_LOG_OVERFLOW_POLICY_BLOCK,
+  OGE_LOG_OVERFLOW_POLICY_DROP,
+  OGE_LOG_OVERFLOW_POLICY_COUNT,
+} OgeLogOverflowPolicy;
+
+/**
+ * @brief Log file format.
+ *
+ * @var OGE_LOG_FILE_FORMAT_PLAIN
+ * Plain text lines with a timestamp and a level name.
+ *
+ * @var OGE_LOG_FILE_FORMAT_ANSI
+ * Same as plain, but a level name is colored with ANSI escape
+ * sequences the way it's colored in the console.
+ */
+typedef enum OgeLogFileFormat {
+  OGE_LOG_FILE_FORMAT_PLAIN,
+  OGE_LOG_FILE_FORMAT_ANSI,
+} OgeLogFileFormat;
+
+/**
+ * @brief A default time between log file flushes in nanoseconds.
+ */
+#define OGE_LOG_FILE_DEFAULT_FLUSH_INTERVAL 1000000000ULL
+
+/**
+ * @brief A default period of repeated messages reports in nanoseconds.
+ */
+#define OGE_LOG_DEFAULT_REPEAT_PERIOD 1000000000ULL
+
 /**
  * @brief Logging system initialization info.
  *
- * @var fileName A name of a file to write logs to.
+ * @var fileName A name of a file to write logs to or 0 to write
+ *               logs only to the console.
  * @vat logLevel A logging level.
+ * @var synchronous If set to OGE_TRUE messages are written on the
+ *                  calling thread, otherwise they are queued to
+ *                  the logging thread.
+ * @var overflowPolicy A logging queue overflow policy.
+ * @var deferredFormatting If set to OGE_TRUE trace, info and warning
+ *                         messages capture only a format string
+ *                         pointer and raw arguments, and the logging
+ *                         thread formats them. Only messages of log
+ *                         macros with string literal formats are
+ *                         deferred, the rest are formatted eagerly.
+ *                         Has no effect in synchronous mode.
+ * @var fileFormat A log file format.
+ * @var fileMaxSize A size of a log file in bytes after which it's
+ *                  rotated, 0 disables rotation.
+ * @var fileBackupCount A number of rotated log files to keep
+ *                      ("<fileName>.1" is the newest one), at least
+ *                      one is kept if rotation is enabled.
+ * @var fileFlushInterval A time in nanoseconds between log file
+ *                        buffer flushes, 0 means
+ *                        OGE_LOG_FILE_DEFAULT_FLUSH_INTERVAL. Errors
+ *                        and fatal messages are flushed right away.
+ * @var repeatPeriod A time in nanoseconds a rate limited message is
+ *                   suppressed for after it was logged, 0 means
+ *                   OGE_LOG_DEFAULT_REPEAT_PERIOD.
  */
 typedef struct OgeLoggingInitInfo {
   const char *fileName;
   OgeLogLevel logLevel;
+  b8 synchronous;
+  OgeLogOverflowPolicy overflowPolicy;
+  b8 deferredFormatting;
+  OgeLogFileFormat fileFormat;
+  u64 fileMaxSize;
+  u32 fileBackupCount;
+  u64 fileFlushInterval;
+  u64 repeatPeriod;
 } OgeLoggingInitInfo;
 
+/**
+ * @brief A state of a rate limited log call site.
+ *
+ * Declared as a static variable by OGE_LOG_LIMITED macro.
+ *
+ * @var OgeLogSite::count
+ * A number of calls since the message was logged last time.
+ *
+ * @var OgeLogSite::registered
+ * Set if the site is in the logging system repeat reports list.
+ */
+typedef struct OgeLogSite {
+  u32 count;
+  b8  registered;
+} OgeLogSite;
+
+/**
+ * @brief Runtime logging levels of every category.
+ *
+ * Use ogeLogSetCategoryLevel to change them.
+ */
+OGE_API extern u8 g_ogeLogCategoryLevels[OGE_LOG_CATEGORY_MAX_ENUM];
+
 /**
  * @brief Initializes logging system.
  * @param initInfo A pointer to OgeLoggingInitInfo struct.
@@ -58,11 +178,41 @@ b8 ogeLoggingInit(const OgeLoggingInitInfo *initInfo);
  */
 void ogeLoggingTerminate();
 
+/**
+ * @brief Updates logging system.
+ *
+ * Reports rate limited messages that were repeated since the last
+ * report once the repeat period elapses. Called by the engine
+ * every frame.
+ */
+void ogeLoggingUpdate();
+
+/**
+ * @brief Sets a runtime logging level of a category.
+ *
+ * Logging system initialization sets every category logging level
+ * to OgeLoggingInitInfo::logLevel.
+ *
+ * @param category A logging category.
+ * @param level A minimum level of messages to show.
+ */
+OGE_API void ogeLogSetCategoryLevel(OgeLogCategory category,
+                                    OgeLogLevel level);
+
+/**
+ * @brief Waits until the logging thread writes all of the
+ *        queued messages and flushes a log file buffer.
+ *
+ * Called automatically on fatal messages and on logging
+ * system termination.
+ */
+OGE_API void ogeLoggingFlush();
+
 /**
  * @brief Ptrints a log message with given logging level.
  *
- * If logging level is lower than current set logging level,
- * message wouldn't be displayed.
+ * If logging level is lower than current set logging level
+ * of the general category, message wouldn't be displayed.
  *
  * @param level A logging level.
  * @param msg A message to print.
@@ -70,46 +220,207 @@ void ogeLoggingTerminate();
  */
 OGE_API void ogeLog(OgeLogLevel level, const char *msg, ...);
 
-#ifdef OGE_DEBUG
-  /**
-   * @brief Prints trace log message.
-   * @param msg A message to print.
-   * @param ... VA arguments.
-   */
-  #define OGE_TRACE(msg, ...) ogeLog(OGE_LOG_LEVEL_TRACE, msg, ##__VA_ARGS__)
-#else
-  /**
-   * @brief Prints trace log message.
-   * @param msg A message to print.
-   * @param ... VA arguments.
-   */
-  #define OGE_TRACE(msg, ...)
+/**
+ * @brief Prints a log message of a category with given logging level.
+ *
+ * Prefer OGE_LOG macros, they check logging levels before the call.
+ *
+ * @param category A logging category.
+ * @param level A logging level.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+OGE_API void ogeLogCategory(OgeLogCategory category, OgeLogLevel level,
+                            const char *msg, ...);
+
+/**
+ * @brief Prints a log message of a category with a format string
+ *        that outlives the logging system.
+ *
+ * Called by OGE_LOG macros for string literal formats. With deferred
+ * formatting only a format pointer is queued and the logging thread
+ * reads it later, so the format must have a static storage duration.
+ *
+ * @param category A logging category.
+ * @param level A logging level.
+ * @param msg A message to print, e.g. a string literal.
+ * @param ... VA arguments.
+ */
+OGE_API void ogeLogCategoryLiteral(OgeLogCategory category,
+                                   OgeLogLevel level,
+                                   const char *msg, ...);
+
+/**
+ * @brief Prints a rate limited log message.
+ *
+ * Called by OGE_LOG_LIMITED macro only for the first call of a site
+ * in a repeat period. The site keeps a format pointer to report
+ * repeats, so the format must have a static storage duration.
+ *
+ * @param site A pointer to a call site state.
+ * @param category A logging category.
+ * @param level A logging level.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+OGE_API void ogeLogSite(OgeLogSite *site, OgeLogCategory category,
+                        OgeLogLevel level, const char *msg, ...);
+
+/**
+ * @brief Minimum logging level compiled in.
+ *
+ * Log macros of a lower level compile to nothing. Defaults to
+ * OGE_LOG_LEVEL_TRACE in debug builds and to OGE_LOG_LEVEL_INFO
+ * otherwise. Every category can override it with
+ * OGE_LOG_COMPILE_LEVEL_<CATEGORY> define,
+ * e.g. -DOGE_LOG_COMPILE_LEVEL_RENDERER=OGE_LOG_LEVEL_WARN.
+ */
+#ifndef OGE_LOG_COMPILE_LEVEL
+  #ifdef OGE_DEBUG
+    #define OGE_LOG_COMPILE_LEVEL OGE_LOG_LEVEL_TRACE
+  #else
+    #define OGE_LOG_COMPILE_LEVEL OGE_LOG_LEVEL_INFO
+  #endif
 #endif
 
+#ifndef OGE_LOG_COMPILE_LEVEL_GENERAL
+  #define OGE_LOG_COMPILE_LEVEL_GENERAL OGE_LOG_COMPILE_LEVEL
+#endif
+#ifndef OGE_LOG_COMPILE_LEVEL_CORE
+  #define OGE_LOG_COMPILE_LEVEL_CORE OGE_LOG_COMPILE_LEVEL
+#endif
+#ifndef OGE_LOG_COMPILE_LEVEL_PLATFORM
+  #define OGE_LOG_COMPILE_LEVEL_PLATFORM OGE_LOG_COMPILE_LEVEL
+#endif
+#ifndef OGE_LOG_COMPILE_LEVEL_EVENTS
+  #define OGE_LOG_COMPILE_LEVEL_EVENTS OGE_LOG_COMPILE_LEVEL
+#endif
+#ifndef OGE_LOG_COMPILE_LEVEL_INPUT
+  #define OGE_LOG_COMPILE_LEVEL_INPUT OGE_LOG_COMPILE_LEVEL
+#endif
+#ifndef OGE_LOG_COMPILE_LEVEL_RENDERER
+  #define OGE_LOG_COMPILE_LEVEL_RENDERER OGE_LOG_COMPILE_LEVEL
+#endif
+
+/**
+ * @brief A category of log macros in the current translation unit.
+ *
+ * A category name without OGE_LOG_CATEGORY_ prefix. Should be
+ * defined before including any OGE header, e.g.
+ * "#define OGE_LOG_CATEGORY RENDERER".
+ */
+#ifndef OGE_LOG_CATEGORY
+  #define OGE_LOG_CATEGORY GENERAL
+#endif
+
+// Checks both logging levels, the compile time check is a constant
+// expression, so the whole call is removed if it fails
+#define _OGE_LOG_ENABLED(category, level)                     \
+  ((level) >= OGE_LOG_COMPILE_LEVEL_##category &&             \
+   (level) >= g_ogeLogCategoryLevels[OGE_LOG_CATEGORY_##category])
+
+// Only string literal formats may be deferred, the logging thread
+// reads them after the call. The check doesn't evaluate msg.
+#define _OGE_LOG(category, level, msg, ...)                   \
+  do {                                                        \
+    if (_OGE_LOG_ENABLED(category, level)) {                  \
+      (__builtin_constant_p(msg) ? ogeLogCategoryLiteral      \
+                                 : ogeLogCategory)(           \
+        OGE_LOG_CATEGORY_##category, level,                   \
+        msg, ##__VA_ARGS__);                                  \
+    }                                                         \
+  } while (0)
+
+// After the first call in a repeat period a call costs a single
+// atomic increment, the logging system reports the count later.
+// A site keeps its format, so msg has to be a string literal.
+#define _OGE_LOG_LIMITED(category, level, msg, ...)           \
+  do {                                                        \
+    static OgeLogSite _ogeLogSite;                            \
+    if (_OGE_LOG_ENABLED(category, level) &&                  \
+        __atomic_fetch_add(&_ogeLogSite.count, 1,             \
+                           __ATOMIC_RELAXED) == 0) {          \
+      ogeLogSite(&_ogeLogSite, OGE_LOG_CATEGORY_##category,   \
+                 level, "" msg "", ##__VA_ARGS__);            \
+    }                                                         \
+  } while (0)
+
+/**
+ * @brief Prints a log message of a category.
+ * @param category A category name without OGE_LOG_CATEGORY_ prefix.
+ * @param level A logging level.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+#define OGE_LOG(category, level, msg, ...) \
+  _OGE_LOG(category, level, msg, ##__VA_ARGS__)
+
+/**
+ * @brief Prints a rate limited log message of a category.
+ *
+ * A message is printed once per repeat period, the number of
+ * suppressed calls is reported at the end of the period.
+ *
+ * @param category A category name without OGE_LOG_CATEGORY_ prefix.
+ * @param level A logging level.
+ * @param msg A message to print, must be a string literal.
+ * @param ... VA arguments.
+ */
+#define OGE_LOG_LIMITED(category, level, msg, ...) \
+  _OGE_LOG_LIMITED(category, level, msg, ##__VA_ARGS__)
+
+/**
+ * @brief Prints trace log message.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+#define OGE_TRACE(msg, ...) \
+  OGE_LOG(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_TRACE, msg, ##__VA_ARGS__)
+
 /**
  * @brief Prints info log message.
  * @param msg A message to print.
  * @param ... VA arguments.
  */
-#define OGE_INFO(msg, ...)  ogeLog(OGE_LOG_LEVEL_INFO,  msg, ##__VA_ARGS__)
+#define OGE_INFO(msg, ...) \
+  OGE_LOG(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_INFO, msg, ##__VA_ARGS__)
 
 /**
  * @brief Prints warn log message.
  * @param msg A message to print.
  * @param ... VA arguments.
  */
-#define OGE_WARN(msg, ...)  ogeLog(OGE_LOG_LEVEL_WARN,  msg, ##__VA_ARGS__)
+#define OGE_WARN(msg, ...) \
+  OGE_LOG(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_WARN, msg, ##__VA_ARGS__)
 
 /**
  * @brief Prints error log message.
  * @param msg A message to print.
  * @param ... VA arguments.
  */
-#define OGE_ERROR(msg, ...) ogeLog(OGE_LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
+#define OGE_ERROR(msg, ...) \
+  OGE_LOG(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
 
 /**
  * @brief Prints fatal log message.
  * @param msg A message to print.
  * @param ... VA arguments.
  */
-#define OGE_FATAL(msg, ...) ogeLog(OGE_LOG_LEVEL_FATAL, msg, ##__VA_ARGS__)
+#define OGE_FATAL(msg, ...) \
+  OGE_LOG(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_FATAL, msg, ##__VA_ARGS__)
+
+/**
+ * @brief Prints rate limited warn log message.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+#define OGE_WARN_LIMITED(msg, ...) \
+  OGE_LOG_LIMITED(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_WARN, msg, ##__VA_ARGS__)
+
+/**
+ * @brief Prints rate limited error log message.
+ * @param msg A message to print.
+ * @param ... VA arguments.
+ */
+#define OGE_ERROR_LIMITED(msg, ...) \
+  OGE_LOG_LIMITED(OGE_LOG_CATEGORY, OGE_LOG_LEVEL_ERROR, msg, ##__VA_ARGS__)
@@ -48,6 +48,28 @@ typedef enum OgeMemoryTag {
   OGE_MEMORY_TAG_MAX_ENUM
 } OgeMemoryTag;
 
+/**
+ * @brief Memory usage statistics, all of the sizes are in bytes.
+ *
+ * @var OgeMemoryStats::totalUsage
+ * A size of currently allocated memory.
+ *
+ * @var OgeMemoryStats::peakUsage
+ * The largest size of memory allocated at once.
+ *
+ * @var OgeMemoryStats::perTagUsage
+ * A size of currently allocated memory per tag.
+ *
+ * @var OgeMemoryStats::perTagPeakUsage
+ * The largest size of memory allocated at once per tag.
+ */
+typedef struct OgeMemoryStats {
+  u64 totalUsage;
+  u64 peakUsage;
+  u64 perTagUsage[OGE_MEMORY_TAG_MAX_ENUM];
+  u64 perTagPeakUsage[OGE_MEMORY_TAG_MAX_ENUM];
+} OgeMemoryStats;
+
 /**
  * @brief Initialized memory system.
  *
@@ -121,6 +143,16 @@ OGE_API i32 ogeMemCmp(const void *block1, const void *block2, u64 size);
  */
 OGE_API const char* ogeMemoryGetDebugInfo();
 
+/**
+ * @brief Fills memory usage statistics.
+ * Memory usage is tracked only in debug builds, in release builds
+ * the statistics are zeroed.
+ * @param stats A pointer to OgeMemoryStats struct to fill.
+ * @return Returns OGE_TRUE if memory usage is tracked, otherwise
+ *         returns OGE_FALSE.
+ */
+OGE_API b8 ogeMemoryGetStats(OgeMemoryStats *stats);
+
 /**
  * @brief Returns a string representation of a memory tag.
  *
@@ -36,11 +36,18 @@
  *
  * @var OplPlatformInitInfo::height
  * A height of the window or surface in pixels.
+ *
+ * @var OplPlatformInitInfo::headless
+ * If set to OGE_TRUE neither OPL nor a window are initialized, so
+ * the engine runs without a display. There are no platform
+ * messages and input is always released, unless it's played back
+ * from a replay.
  */
 typedef struct OgePlatformInitInfo {
   const char *applicationName;
   u16 width;
   u16 height;
+  b8  headless;
 } OgePlatformInitInfo;
 
 /**
@@ -60,11 +67,15 @@ b8 ogePlatformInit(const OgePlatformInitInfo *initInfo);
  */
 void ogePlatformTerminate();
 
+/**
+ * @brief Returns whether platform layer runs without a display.
+ */
+b8 ogePlatformIsHeadless();
+
 /**
  * @brief Pumps platform messages.
  */
-#define ogePlatformPumpMessages() \
-  oplPumpMessages()
+void ogePlatformPumpMessages();
 
 /**
  * @brief Returns wheter platform requested application
@@ -74,8 +85,22 @@ void ogePlatformTerminate();
  */
 b8 ogePlatformAppShouldClose();
 
+/**
+ * @brief Returns the current keyboard state, always released in
+ *        headless mode.
+ */
+const OplKeyboardState* ogePlatformGetKeyboardState();
+
+/**
+ * @brief Returns the current mouse state, always released in
+ *        headless mode.
+ */
+const OplMouseState* ogePlatformGetMouseState();
+
 /**
  * @brief Creates Vulkan surface.
+ *
+ * Shouldn't be called in headless mode.
  */
 VkResult ogePlatformCreateSurface(
   VkInstance instance,
@@ -89,6 +114,8 @@ VkResult ogePlatformCreateSurface(
  *                        a number of required device extensions.
  * @param exntesionsNames A pointer to an array of strings that
  *                        will hold names of required device extensions.
+ *
+ * There are no required extensions in headless mode.
  */
-#define ogePlatformGetDeviceExtensions(extensionsCount, extensionNames) \
-  oplGetDeviceExtensions(extensionsCount, extensionNames)
+void ogePlatformGetDeviceExtensions(u32 *extensionsCount,
+                                    const char **extensionNames);
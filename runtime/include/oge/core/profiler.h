@@ -0,0 +1,211 @@
+/**
+ * @file profiler.h
+ * @brief The header of the CPU frame profiler
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A default number of profiler events kept per thread.
+ */
+#define OGE_PROFILER_DEFAULT_EVENT_COUNT 65536
+
+/**
+ * @brief A maximum number of threads profiler records scopes of.
+ */
+#define OGE_PROFILER_MAX_THREADS 64
+
+/**
+ * @brief A maximum number of nested scopes recorded per thread,
+ *        deeper ones aren't recorded.
+ */
+#define OGE_PROFILER_MAX_DEPTH 32
+
+/**
+ * @brief A maximum number of distinct scope names aggregated.
+ */
+#define OGE_PROFILER_MAX_SCOPES 256
+
+/**
+ * @brief A number of the most recent durations per scope the
+ *        aggregate statistics are computed over.
+ */
+#define OGE_PROFILER_WINDOW_SIZE 256
+
+#ifdef OGE_PROFILE
+  /**
+   * @brief Starts a profiler scope, should be paired with
+   *        OGE_PROFILE_END in the same function.
+   * @param name A name of a scope, should be a string literal.
+   */
+  #define OGE_PROFILE_BEGIN(name) ogeProfilerBegin(name)
+
+  /**
+   * @brief Ends the innermost profiler scope.
+   */
+  #define OGE_PROFILE_END() ogeProfilerEnd()
+
+  #if defined(__GNUC__) || defined(__clang__)
+    #define _OGE_PROFILE_CONCAT_(a, b) a##b
+    #define _OGE_PROFILE_CONCAT(a, b)  _OGE_PROFILE_CONCAT_(a, b)
+
+    /**
+     * @brief Profiles the rest of an enclosing block.
+     *
+     * Relies on the cleanup attribute, so with compilers other
+     * than GCC and Clang it records nothing.
+     *
+     * @param name A name of a scope, should be a string literal.
+     */
+    #define OGE_PROFILE_SCOPE(name)                                    \
+      __attribute__((cleanup(ogeProfilerEndScope))) const char         \
+        *_OGE_PROFILE_CONCAT(_ogeProfileScope, __LINE__) =             \
+          ogeProfilerBeginScope(name)
+  #else
+    #define OGE_PROFILE_SCOPE(name)
+  #endif
+#else
+  #define OGE_PROFILE_BEGIN(name)
+  #define OGE_PROFILE_END()
+  #define OGE_PROFILE_SCOPE(name)
+#endif
+
+/**
+ * @brief Profiler initialization info.
+ *
+ * @var OgeProfilerInitInfo::eventCount
+ * A number of the most recent scopes kept per thread for the trace,
+ * rounded up to a power of 2. 0 means
+ * OGE_PROFILER_DEFAULT_EVENT_COUNT.
+ *
+ * @var OgeProfilerInitInfo::traceFileName
+ * A name of a file the trace is written to on termination. Optional,
+ * set to 0 to not write it.
+ */
+typedef struct OgeProfilerInitInfo {
+  u32         eventCount;
+  const char *traceFileName;
+} OgeProfilerInitInfo;
+
+/**
+ * @brief Profiler scope statistics over the last
+ *        OGE_PROFILER_WINDOW_SIZE durations, all of the times are
+ *        in nanoseconds.
+ *
+ * @var OgeProfilerScopeStats::name
+ * A name of a scope.
+ *
+ * @var OgeProfilerScopeStats::count
+ * A number of times a scope was recorded since initialization.
+ *
+ * @var OgeProfilerScopeStats::meanTime
+ * A mean duration.
+ *
+ * @var OgeProfilerScopeStats::maxTime
+ * The longest duration.
+ *
+ * @var OgeProfilerScopeStats::p99Time
+ * A duration 99% of the durations don't exceed.
+ */
+typedef struct OgeProfilerScopeStats {
+  const char *name;
+  u64         count;
+  f64         meanTime;
+  u64         maxTime;
+  u64         p99Time;
+} OgeProfilerScopeStats;
+
+/**
+ * @brief Initializes profiler.
+ *
+ * Thread event buffers are allocated on the first scope a thread
+ * records, so nothing is allocated if the engine is built without
+ * OGE_PROFILE.
+ *
+ * @param initInfo A pointer to OgeProfilerInitInfo struct or 0
+ *                 to use default settings.
+ * @return Returns OGE_TRUE if profiler was successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeProfilerInit(const OgeProfilerInitInfo *initInfo);
+
+/**
+ * @brief Terminates profiler, writes the trace file if it's set.
+ */
+void ogeProfilerTerminate();
+
+/**
+ * @brief Aggregates scopes recorded since the previous call.
+ *
+ * Called by the engine at the end of every frame.
+ */
+void ogeProfilerEndFrame();
+
+/**
+ * @brief Starts a profiler scope, use OGE_PROFILE_BEGIN instead.
+ * @param name A name of a scope.
+ */
+OGE_API void ogeProfilerBegin(const char *name);
+
+/**
+ * @brief Ends the innermost profiler scope, use OGE_PROFILE_END
+ *        instead.
+ */
+OGE_API void ogeProfilerEnd();
+
+/**
+ * @brief Starts a profiler scope, use OGE_PROFILE_SCOPE instead.
+ * @param name A name of a scope.
+ * @return Returns the name.
+ */
+OGE_API const char* ogeProfilerBeginScope(const char *name);
+
+/**
+ * @brief Ends a profiler scope, use OGE_PROFILE_SCOPE instead.
+ * @param name A pointer to a variable the scope began with.
+ */
+OGE_API void ogeProfilerEndScope(const char *const *name);
+
+/**
+ * @brief Writes the recorded scopes of every thread as a Chrome
+ *        trace JSON file, viewable with Perfetto or
+ *        chrome://tracing.
+ *
+ * Only the last eventCount scopes of every thread are kept. Should
+ * be called between frames, scopes recorded while the file is
+ * written may be torn.
+ *
+ * @param fileName A name of a file to write.
+ * @return Returns OGE_TRUE if a file was written, otherwise
+ *         returns OGE_FALSE.
+ */
+OGE_API b8 ogeProfilerWriteTrace(const char *fileName);
+
+/**
+ * @brief Fills an array with the aggregate statistics of every
+ *        recorded scope.
+ * @param stats A pointer to an array to fill.
+ * @param maxCount A number of elements in the array.
+ * @return Returns a number of filled elements.
+ */
+OGE_API u32 ogeProfilerGetStats(OgeProfilerScopeStats *stats, u32 maxCount);
+
+/**
+ * @brief Logs the aggregate statistics of every recorded scope.
+ */
+OGE_API void ogeProfilerLogStats();
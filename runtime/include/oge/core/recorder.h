@@ -0,0 +1,139 @@
+/**
+ * @file recorder.h
+ * @brief The header of the flight recorder
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+#include "oge/core/logging.h"
+
+/**
+ * @brief A default number of flight recorder entries per thread.
+ */
+#define OGE_RECORDER_DEFAULT_ENTRY_COUNT 4096
+
+/**
+ * @brief A maximum number of threads flight recorder keeps
+ *        entries of.
+ */
+#define OGE_RECORDER_MAX_THREADS 64
+
+/**
+ * @brief Flight recorder initialization info.
+ *
+ * @var OgeRecorderInitInfo::disabled
+ * If set to OGE_TRUE nothing is recorded.
+ *
+ * @var OgeRecorderInitInfo::fileName
+ * A name of a file to dump records to, 0 means "oge-recorder.txt".
+ *
+ * @var OgeRecorderInitInfo::entryCount
+ * A number of the most recent entries kept per thread, rounded up
+ * to a power of 2. 0 means OGE_RECORDER_DEFAULT_ENTRY_COUNT.
+ */
+typedef struct OgeRecorderInitInfo {
+  b8          disabled;
+  const char *fileName;
+  u32         entryCount;
+} OgeRecorderInitInfo;
+
+/**
+ * @brief Initializes flight recorder.
+ *
+ * The flight recorder keeps the most recent log messages, events,
+ * frame boundaries and markers of every thread in memory and dumps
+ * them to a file on a fatal message or a crash signal (SIGSEGV,
+ * SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP).
+ *
+ * Should be called before any other system initialization so
+ * their messages are recorded too.
+ *
+ * @param initInfo A pointer to OgeRecorderInitInfo struct or 0
+ *                 to use default settings.
+ * @return Returns OGE_TRUE if flight recorder was successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeRecorderInit(const OgeRecorderInitInfo *initInfo);
+
+/**
+ * @brief Terminates flight recorder.
+ *
+ * Restores crash signal handlers and frees every thread entries.
+ */
+void ogeRecorderTerminate();
+
+/**
+ * @brief Installs a crash signal stack of a calling thread.
+ *
+ * An alternate signal stack is per thread, so a stack overflow on
+ * any thread can be dumped. Called by every thread made with
+ * ogeThreadCreate before its function, doesn't need initialized
+ * flight recorder.
+ */
+void ogeRecorderThreadBegin();
+
+/**
+ * @brief Removes a crash signal stack of a calling thread.
+ *
+ * Called by every thread made with ogeThreadCreate after its
+ * function returns.
+ */
+void ogeRecorderThreadEnd();
+
+/**
+ * @brief Records a frame boundary.
+ *
+ * Called by the engine at the start of every frame.
+ */
+void ogeRecorderBeginFrame();
+
+/**
+ * @brief Records a log message.
+ *
+ * Only a format string pointer is kept, so format strings should
+ * be string literals.
+ *
+ * @param category A logging category.
+ * @param level A logging level.
+ * @param format A message format string.
+ */
+void ogeRecorderLog(OgeLogCategory category, OgeLogLevel level,
+                    const char *format);
+
+/**
+ * @brief Records an invoked event.
+ * @param code A code of an event.
+ */
+void ogeRecorderEvent(u16 code);
+
+/**
+ * @brief Records a timing marker.
+ * @param name A name of a marker, should be a string literal.
+ * @param value An arbitrary value to keep with a marker.
+ */
+OGE_API void ogeRecorderMark(const char *name, u64 value);
+
+/**
+ * @brief Dumps recorded entries of every thread to the recorder file.
+ *
+ * Only the first dump is written, the ones that follow (e.g. a trap
+ * signal right after a fatal message) are ignored. Safe to call
+ * from a signal handler.
+ *
+ * @param reason A reason of a dump written to the file header.
+ */
+OGE_API void ogeRecorderDump(const char *reason);
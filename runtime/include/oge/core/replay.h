@@ -0,0 +1,144 @@
+/**
+ * @file replay.h
+ * @brief The header of the replay system
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <opl/opl.h>
+
+#include "oge/defines.h"
+#include "oge/core/events.h"
+
+/**
+ * @brief Replay mode.
+ *
+ * @var OGE_REPLAY_MODE_NONE
+ * Replay system is disabled.
+ *
+ * @var OGE_REPLAY_MODE_RECORD
+ * Every invoked event and per-frame input snapshot is written
+ * to a replay file.
+ *
+ * @var OGE_REPLAY_MODE_PLAYBACK
+ * Input snapshots and events are read from a replay file instead
+ * of the platform layer. The main cycle quits when the replay ends.
+ */
+typedef enum OgeReplayMode {
+  OGE_REPLAY_MODE_NONE,
+  OGE_REPLAY_MODE_RECORD,
+  OGE_REPLAY_MODE_PLAYBACK,
+} OgeReplayMode;
+
+/**
+ * @brief Replay system initialization info.
+ *
+ * @var OgeReplayInitInfo::mode
+ * A replay mode.
+ *
+ * @var OgeReplayInitInfo::fileName
+ * A name of a file to record to or to play back from.
+ */
+typedef struct OgeReplayInitInfo {
+  OgeReplayMode mode;
+  const char   *fileName;
+} OgeReplayInitInfo;
+
+/**
+ * @brief Initializes replay system.
+ *
+ * Should be called after events system initialization and
+ * before input system initialization.
+ *
+ * @param initInfo A pointer to OgeReplayInitInfo struct or 0
+ *                 to leave replay system disabled.
+ * @return Returns OGE_TRUE if replay system was successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeReplayInit(const OgeReplayInitInfo *initInfo);
+
+/**
+ * @brief Terminates replay system.
+ *
+ * Flushes and closes a replay file.
+ */
+void ogeReplayTerminate();
+
+/**
+ * @brief Begins a new replay frame.
+ *
+ * In record mode writes a frame marker with a frame time, events
+ * invoked after it belong to the frame. In playback mode reads the
+ * next frame, replaces a frame time with the recorded one, re-invokes
+ * recorded engine events and updates replayed input state.
+ *
+ * This function should be called before pumping OPL messages,
+ * followed by ogeReplayEndInput after the pump.
+ *
+ * @param frameTime A pointer to the current frame time in
+ *                  nanoseconds, it's overwritten in playback mode
+ *                  so a simulation advances the same way it did
+ *                  while recording.
+ * @return Returns OGE_FALSE if playback reached the end of a replay
+ *         file, otherwise returns OGE_TRUE.
+ */
+b8 ogeReplayBeginFrame(u64 *frameTime);
+
+/**
+ * @brief Ends input of a replay frame.
+ *
+ * In record mode writes an input snapshot if it changed since the
+ * previous frame. Does nothing in other modes.
+ *
+ * This function should be called after pumping OPL messages and
+ * before the application update function.
+ */
+void ogeReplayEndInput();
+
+/**
+ * @brief Writes an event to a replay file.
+ *
+ * Does nothing if replay system isn't recording or the first frame
+ * hasn't begun yet. A write failure stops recording.
+ *
+ * @param code A code of an event.
+ * @param data An event data.
+ */
+void ogeReplayRecordEvent(u16 code, OgeEventData data);
+
+/**
+ * @brief Returns a replayed keyboard state.
+ *
+ * The state is valid only while replay system is playing back.
+ */
+const OplKeyboardState* ogeReplayGetKeyboardState();
+
+/**
+ * @brief Returns a replayed mouse state.
+ *
+ * The state is valid only while replay system is playing back.
+ */
+const OplMouseState* ogeReplayGetMouseState();
+
+/**
+ * @brief Returns current replay mode.
+ */
+OGE_API OgeReplayMode ogeReplayGetMode();
+
+/**
+ * @brief Returns an index of the current replay frame.
+ */
+OGE_API u32 ogeReplayGetFrameIndex();
@@ -0,0 +1,174 @@
+/**
+ * @file startup.h
+ * @brief The header of the startup step graph and the startup report
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A maximum number of steps in a startup graph.
+ */
+#define OGE_STARTUP_MAX_STEPS 64
+
+/**
+ * @brief A maximum number of spans recorded until the first frame,
+ *        later ones are dropped.
+ */
+#define OGE_STARTUP_MAX_SPANS 256
+
+/**
+ * @brief A span index returned once no more spans can be recorded.
+ */
+#define OGE_STARTUP_INVALID_SPAN ((u32)-1)
+
+/**
+ * @brief A name of an environment variable with a name of a startup
+ *        report file.
+ */
+#define OGE_STARTUP_REPORT_ENV "OGE_STARTUP_REPORT"
+
+/**
+ * @brief A name of an environment variable with a name of a startup
+ *        trace file.
+ */
+#define OGE_STARTUP_TRACE_ENV "OGE_STARTUP_TRACE"
+
+/**
+ * @brief Makes a dependency mask bit of a step.
+ * @param index An index of a step.
+ */
+#define OGE_STARTUP_STEP_BIT(index) (1ull << (index))
+
+/**
+ * @brief Startup step function pointer.
+ * @param userData A pointer passed to ogeStartupRun.
+ * @return Should return OGE_FALSE if a step failed.
+ */
+typedef b8 (*OgeStartupStepFunction)(void *userData);
+
+/**
+ * @brief Startup step struct.
+ *
+ * @var OgeStartupStep::name
+ * A name of a step.
+ *
+ * @var OgeStartupStep::function
+ * A function of a step.
+ *
+ * @var OgeStartupStep::dependencies
+ * A mask of OGE_STARTUP_STEP_BIT of steps that should finish before
+ * a step starts. A step can only depend on the steps before it.
+ *
+ * @var OgeStartupStep::anyThread
+ * If set to OGE_TRUE a step may run on a job system worker,
+ * otherwise it runs on the thread calling ogeStartupRun. Steps
+ * touching thread-affine state (windows, surfaces, event
+ * subscriptions) shouldn't set it.
+ */
+typedef struct OgeStartupStep {
+  const char             *name;
+  OgeStartupStepFunction  function;
+  u64                     dependencies;
+  b8                      anyThread;
+} OgeStartupStep;
+
+/**
+ * @brief Startup report info.
+ *
+ * @var OgeStartupInitInfo::reportFileName
+ * A name of a JSON file with time to the first frame and the spans
+ * sorted by duration or 0 not to write it. A previous report in the
+ * file is compared with, so cold and warm starts can be told apart.
+ *
+ * @var OgeStartupInitInfo::traceFileName
+ * A name of a Chrome trace event format file with the spans or 0 not
+ * to write it.
+ */
+typedef struct OgeStartupInitInfo {
+  const char *reportFileName;
+  const char *traceFileName;
+} OgeStartupInitInfo;
+
+/**
+ * @brief Runs a startup graph and logs its timeline.
+ *
+ * A step starts as soon as every step it depends on finishes. Steps
+ * that may run on any thread are submitted to the job system, if
+ * it's initialized, so independent steps run concurrently. Once a
+ * step fails no more steps are started. The graph and every step
+ * are recorded as startup spans, the timeline is logged on info
+ * level.
+ *
+ * @param name A name of a graph used in the timeline and the spans.
+ * @param steps A pointer to an array of steps.
+ * @param stepCount A number of steps in the array, at most
+ *                  OGE_STARTUP_MAX_STEPS.
+ * @param userData A pointer passed to step functions.
+ * @param order A pointer to an array of stepCount elements filled
+ *              with indices of finished steps in order they finished
+ *              or 0. Deinitializing in reverse order respects
+ *              dependencies.
+ * @return Returns OGE_TRUE if every step succeeded, otherwise
+ *         returns OGE_FALSE.
+ */
+b8 ogeStartupRun(const char *name, const OgeStartupStep *steps,
+                 u32 stepCount, void *userData, u32 *order);
+
+/**
+ * @brief Starts a startup span.
+ *
+ * Spans are recorded from the process start to the end of the first
+ * frame, so time to the first frame can be broken down. Spans may
+ * nest and may be recorded on any thread, a span ends on the thread
+ * it began on.
+ *
+ * @param name A name of a span, should outlive the first frame.
+ * @return Returns an index of a span to end or
+ *         OGE_STARTUP_INVALID_SPAN if it isn't recorded.
+ */
+OGE_API u32 ogeStartupSpanBegin(const char *name);
+
+/**
+ * @brief Ends a startup span.
+ * @param span An index returned by ogeStartupSpanBegin.
+ */
+OGE_API void ogeStartupSpanEnd(u32 span);
+
+/**
+ * @brief Starts a driver call, its time is accounted to every span
+ *        open on the calling thread.
+ */
+void ogeStartupDriverBegin();
+
+/**
+ * @brief Ends a driver call started by ogeStartupDriverBegin.
+ */
+void ogeStartupDriverEnd();
+
+/**
+ * @brief Finishes startup recording.
+ *
+ * Called by the engine at the end of the first frame. Logs time to
+ * the first frame and the longest spans, writes the report and the
+ * trace files. The OGE_STARTUP_REPORT_ENV and OGE_STARTUP_TRACE_ENV
+ * environment variables override the info.
+ *
+ * @param initInfo A pointer to OgeStartupInitInfo struct or 0 only
+ *                 to log the report.
+ */
+void ogeStartupFinish(const OgeStartupInitInfo *initInfo);
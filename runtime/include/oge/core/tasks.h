@@ -0,0 +1,145 @@
+/**
+ * @file tasks.h
+ * @brief The header of the frame task graph
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+// forward decl for struct from oge/core/engine.h
+typedef struct OgeFrameInfo OgeFrameInfo;
+
+/**
+ * @brief A maximum number of registered frame tasks.
+ */
+#define OGE_TASKS_MAX_TASKS 64
+
+/**
+ * @brief A maximum number of distinct resources frame tasks
+ *        read or write.
+ */
+#define OGE_TASKS_MAX_RESOURCES 64
+
+/**
+ * @brief A maximum length of task and resource names, longer
+ *        ones are truncated.
+ */
+#define OGE_TASKS_MAX_NAME_LENGTH 32
+
+/**
+ * @brief An id returned if a task wasn't registered.
+ */
+#define OGE_TASKS_INVALID_ID 0xFFFFFFFF
+
+/**
+ * @brief Frame task function pointer.
+ * @param frameInfo A pointer to the current frame info.
+ * @param userData A user defined data.
+ * @return Should return OGE_FALSE to stop the main cycle.
+ */
+typedef b8 (*OgeTaskFunction)(const OgeFrameInfo *frameInfo,
+                              void *userData);
+
+/**
+ * @brief Frame task registration info.
+ *
+ * A task runs after every task registered before it that writes
+ * a resource it reads or writes, or reads a resource it writes.
+ * Tasks that don't share written resources run in parallel.
+ *
+ * @var OgeTaskInfo::name
+ * A name of a task.
+ *
+ * @var OgeTaskInfo::function
+ * A function to run every frame.
+ *
+ * @var OgeTaskInfo::userData
+ * A pointer passed to a function.
+ *
+ * @var OgeTaskInfo::reads
+ * An array of names of resources a task reads.
+ *
+ * @var OgeTaskInfo::readCount
+ * A number of elements in the reads array.
+ *
+ * @var OgeTaskInfo::writes
+ * An array of names of resources a task writes.
+ *
+ * @var OgeTaskInfo::writeCount
+ * A number of elements in the writes array.
+ */
+typedef struct OgeTaskInfo {
+  const char         *name;
+  OgeTaskFunction     function;
+  void               *userData;
+  const char *const  *reads;
+  u32                 readCount;
+  const char *const  *writes;
+  u32                 writeCount;
+} OgeTaskInfo;
+
+/**
+ * @brief Initializes frame task graph.
+ */
+void ogeTasksInit();
+
+/**
+ * @brief Terminates frame task graph, unregisters every task.
+ */
+void ogeTasksTerminate();
+
+/**
+ * @brief Runs every registered task for a frame.
+ *
+ * The graph is rebuilt only after tasks were registered or
+ * unregistered. Ready tasks are started in order of their
+ * critical path length (the longest chain of measured task times
+ * a task starts), so the longest chains start first. Called by the
+ * engine every frame after the application update.
+ *
+ * @param frameInfo A pointer to the current frame info.
+ * @return Returns OGE_FALSE if any of the tasks failed.
+ */
+b8 ogeTasksRun(const OgeFrameInfo *frameInfo);
+
+/**
+ * @brief Registers a frame task.
+ * @param info A pointer to a OgeTaskInfo struct.
+ * @return Returns an id of a registered task or
+ *         OGE_TASKS_INVALID_ID if there's no room for it or for
+ *         one of its resources.
+ */
+OGE_API u32 ogeTasksRegister(const OgeTaskInfo *info);
+
+/**
+ * @brief Unregisters a frame task.
+ * @param id An id of a task.
+ */
+OGE_API void ogeTasksUnregister(u32 id);
+
+/**
+ * @brief Writes the task graph with the last frame timings to
+ *        a Graphviz DOT file.
+ *
+ * Tasks on the critical path and edges between them are
+ * highlighted.
+ *
+ * @param fileName A name of a file to write.
+ * @return Returns OGE_TRUE if a file was written, otherwise
+ *         returns OGE_FALSE.
+ */
+OGE_API b8 ogeTasksDumpGraph(const char *fileName);
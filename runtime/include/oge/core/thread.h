@@ -0,0 +1,147 @@
+/**
+ * @file thread.h
+ * @brief The header of the threading primitives
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include <pthread.h>
+
+#include "oge/defines.h"
+
+/**
+ * @brief Thread function pointer.
+ * @param arg A user defined argument.
+ */
+typedef void (*OgeThreadFunction)(void *arg);
+
+/**
+ * @brief OGE thread struct.
+ *
+ * The struct must outlive the thread it was created for.
+ */
+typedef struct OgeThread {
+  pthread_t         handle;
+  OgeThreadFunction function;
+  void             *arg;
+} OgeThread;
+
+/**
+ * @brief OGE mutex struct.
+ */
+typedef struct OgeMutex {
+  pthread_mutex_t handle;
+} OgeMutex;
+
+/**
+ * @brief OGE condition variable struct.
+ */
+typedef struct OgeCondition {
+  pthread_cond_t handle;
+} OgeCondition;
+
+/**
+ * @brief Creates and starts a thread.
+ * @param thread A pointer to a thread struct.
+ * @param function A thread function.
+ * @param arg An argument to pass to a thread function.
+ * @return Returns OGE_TRUE if a thread was successfully created,
+ *         otherwise returns OGE_FALSE.
+ */
+OGE_API b8 ogeThreadCreate(OgeThread *thread, OgeThreadFunction function,
+                           void *arg);
+
+/**
+ * @brief Waits for a thread to finish.
+ * @param thread A pointer to a thread.
+ */
+OGE_API void ogeThreadJoin(OgeThread *thread);
+
+/**
+ * @brief Suspends the calling thread.
+ * @param nanoseconds A time to sleep in nanoseconds.
+ */
+OGE_API void ogeThreadSleep(u64 nanoseconds);
+
+/**
+ * @brief Yields the rest of the calling thread's time slice.
+ */
+OGE_API void ogeThreadYield();
+
+/**
+ * @brief Returns a number of online logical processors.
+ */
+OGE_API u32 ogeThreadGetProcessorCount();
+
+/**
+ * @brief Creates a mutex.
+ * @param mutex A pointer to a mutex.
+ */
+OGE_API void ogeMutexCreate(OgeMutex *mutex);
+
+/**
+ * @brief Destroys a mutex.
+ * @param mutex A pointer to a mutex.
+ */
+OGE_API void ogeMutexDestroy(OgeMutex *mutex);
+
+/**
+ * @brief Locks a mutex.
+ * @param mutex A pointer to a mutex.
+ */
+OGE_API void ogeMutexLock(OgeMutex *mutex);
+
+/**
+ * @brief Unlocks a mutex.
+ * @param mutex A pointer to a mutex.
+ */
+OGE_API void ogeMutexUnlock(OgeMutex *mutex);
+
+/**
+ * @brief Creates a condition variable.
+ * @param condition A pointer to a condition variable.
+ */
+OGE_API void ogeConditionCreate(OgeCondition *condition);
+
+/**
+ * @brief Destroys a condition variable.
+ * @param condition A pointer to a condition variable.
+ */
+OGE_API void ogeConditionDestroy(OgeCondition *condition);
+
+/**
+ * @brief Waits on a condition variable.
+ *
+ * A mutex must be locked by the calling thread.
+ *
+ * @param condition A pointer to a condition variable.
+ * @param mutex A pointer to a locked mutex.
+ * @param timeout A maximum time to wait in nanoseconds.
+ */
+OGE_API void ogeConditionWait(OgeCondition *condition, OgeMutex *mutex,
+                              u64 timeout);
+
+/**
+ * @brief Wakes one thread waiting on a condition variable.
+ * @param condition A pointer to a condition variable.
+ */
+OGE_API void ogeConditionSignal(OgeCondition *condition);
+
+/**
+ * @brief Wakes all of the threads waiting on a condition variable.
+ * @param condition A pointer to a condition variable.
+ */
+OGE_API void ogeConditionBroadcast(OgeCondition *condition);
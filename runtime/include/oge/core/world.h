@@ -0,0 +1,182 @@
+/**
+ * @file world.h
+ * @brief The header of independent simulation worlds
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+#include "oge/core/input.h"
+#include "oge/core/engine.h"
+#include "oge/core/events.h"
+#include "oge/core/memory.h"
+
+/**
+ * @brief An opaque world handle.
+ *
+ * A world owns everything a simulation mutates: an update loop,
+ * an events context, an input snapshot and memory accounting. Worlds
+ * don't share mutable state, so a process may run many of them, for
+ * example one per server match, and tick them concurrently.
+ */
+typedef struct OgeWorld OgeWorld;
+
+/**
+ * @brief World update function pointer.
+ * @param world A pointer to a world being updated.
+ * @param frameInfo A pointer to a world's frame info.
+ * @return Should return OGE_FALSE if a world failed to update.
+ */
+typedef b8 (*OgeWorldUpdateFunction)(OgeWorld *world,
+                                     const OgeFrameInfo *frameInfo);
+
+/**
+ * @brief World initialization info.
+ *
+ * @var OgeWorldInitInfo::loopInitInfo
+ * Update loop parameters of a world, see OgeLoopInitInfo.
+ *
+ * @var OgeWorldInitInfo::update
+ * A function called once per tick of a world.
+ *
+ * @var OgeWorldInitInfo::userData
+ * A pointer to world specific data.
+ *
+ * @var OgeWorldInitInfo::sharedData
+ * A pointer to data shared between worlds, like loaded assets. It
+ * should be read-only while worlds tick.
+ */
+typedef struct OgeWorldInitInfo {
+  OgeLoopInitInfo         loopInitInfo;
+  OgeWorldUpdateFunction  update;
+  void                   *userData;
+  const void             *sharedData;
+} OgeWorldInitInfo;
+
+/**
+ * @brief Creates a world.
+ * @param initInfo A pointer to OgeWorldInitInfo struct.
+ * @return Returns a pointer to a world or 0 on failure.
+ */
+OGE_API OgeWorld* ogeWorldCreate(const OgeWorldInitInfo *initInfo);
+
+/**
+ * @brief Destroys a world, warns about memory it didn't free.
+ * @param world A pointer to a world.
+ */
+OGE_API void ogeWorldDestroy(OgeWorld *world);
+
+/**
+ * @brief Advances a world by a frame.
+ *
+ * Runs the world's update loop on the calling thread, a world
+ * should be ticked by one thread at a time.
+ *
+ * @param world A pointer to a world.
+ * @param frameTime A time passed since the previous frame in
+ *                  nanoseconds, clamped to the world's max frame time.
+ * @return Returns OGE_FALSE if an update function failed.
+ */
+OGE_API b8 ogeWorldTick(OgeWorld *world, u64 frameTime);
+
+/**
+ * @brief Advances worlds by a frame concurrently.
+ *
+ * Every world is ticked by its own job, so worlds are spread across
+ * job system threads. Returns once every world was ticked.
+ *
+ * @param worlds A pointer to an array of world pointers.
+ * @param count A number of worlds in the array.
+ * @param frameTime A time passed since the previous frame in
+ *                  nanoseconds.
+ * @return Returns OGE_FALSE if any world failed to update.
+ */
+OGE_API b8 ogeWorldsTick(OgeWorld **worlds, u32 count, u64 frameTime);
+
+/**
+ * @brief Returns a frame info of a world.
+ * @param world A pointer to a world.
+ */
+OGE_API const OgeFrameInfo* ogeWorldGetFrameInfo(const OgeWorld *world);
+
+/**
+ * @brief Returns a world specific data pointer.
+ * @param world A pointer to a world.
+ */
+OGE_API void* ogeWorldGetUserData(const OgeWorld *world);
+
+/**
+ * @brief Returns a pointer to data shared between worlds.
+ * @param world A pointer to a world.
+ */
+OGE_API const void* ogeWorldGetSharedData(const OgeWorld *world);
+
+/**
+ * @brief Returns an events context of a world.
+ *
+ * Events invoked in it reach only the world's subscribers and
+ * aren't recorded by the recorder.
+ *
+ * @param world A pointer to a world.
+ */
+OGE_API OgeEventsContext* ogeWorldGetEvents(OgeWorld *world);
+
+/**
+ * @brief Sets an input snapshot of a world, for example the input
+ *        received from a world's client.
+ *
+ * Only the down bits are read, the changed bits are computed
+ * against the previous snapshot.
+ *
+ * @param world A pointer to a world.
+ * @param input A pointer to a new input snapshot.
+ */
+OGE_API void ogeWorldSetInput(OgeWorld *world, const OgeInputBits *input);
+
+/**
+ * @brief Returns an input snapshot of a world.
+ * @param world A pointer to a world.
+ */
+OGE_API const OgeInputBits* ogeWorldGetInput(const OgeWorld *world);
+
+/**
+ * @brief Allocates a block of memory accounted to a world.
+ *
+ * Accounting works in every build configuration and isn't
+ * synchronized, so only a thread ticking a world should allocate.
+ *
+ * @param world A pointer to a world.
+ * @param size A size of block in bytes.
+ * @param memoryTag A memory tag.
+ * @return Returns a pointer to an allocated memory block.
+ */
+OGE_API void* ogeWorldAlloc(OgeWorld *world, u64 size,
+                            OgeMemoryTag memoryTag);
+
+/**
+ * @brief Frees a block of memory allocated by ogeWorldAlloc.
+ * @param world A pointer to a world the block was allocated from.
+ * @param block A pointer to a memory block.
+ */
+OGE_API void ogeWorldFree(OgeWorld *world, void *block);
+
+/**
+ * @brief Fills memory usage stats of a world.
+ * @param world A pointer to a world.
+ * @param stats A pointer to OgeMemoryStats struct to fill.
+ */
+OGE_API void ogeWorldGetMemoryStats(const OgeWorld *world,
+                                    OgeMemoryStats *stats);
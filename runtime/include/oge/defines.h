@@ -108,6 +108,26 @@
  */
 #define OGE_MAX(x, y) ((x) > (y) ? (x) : (y))
 
+/**
+ * @brief Returns a number of trailing zero bits of a non-zero
+ *        64-bit value.
+ */
+#if defined(_MSC_VER)
+  #include <intrin.h>
+  #define OGE_CTZ64(x) ((u32)_tzcnt_u64(x))
+#else // clang or gcc
+  #define OGE_CTZ64(x) ((u32)__builtin_ctzll(x))
+#endif
+
+/**
+ * @brief Returns a number of set bits of a 64-bit value.
+ */
+#if defined(_MSC_VER)
+  #define OGE_POPCOUNT64(x) ((u32)__popcnt64(x))
+#else // clang or gcc
+  #define OGE_POPCOUNT64(x) ((u32)__builtin_popcountll(x))
+#endif
+
 #define OGE_GIBIBYTES(x) ((x) * 1024ULL * 1024ULL * 1024ULL)
 #define OGE_MEBIBYTES(x) ((x) * 1024ULL * 1024ULL)
 #define OGE_KIBIBYTES(x) ((x) * 1024ULL)
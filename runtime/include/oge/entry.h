@@ -17,7 +17,7 @@ extern b8 ogeApplicationCreate(OgeApplication *pApplication);
  * @brief OGE application entry point.
  */
 int main() {
-  OgeApplication ogeApplication;
+  OgeApplication ogeApplication = { 0 };
 
   ogeMemoryInit();
 
@@ -1,15 +1,31 @@
 #pragma once
 
+#include "oge/core/jobs.h"
+#include "oge/core/file.h"
+#include "oge/core/world.h"
 #include "oge/core/input.h"
+#include "oge/core/clock.h"
+#include "oge/core/tasks.h"
 #include "oge/core/events.h"
 #include "oge/core/memory.h"
+#include "oge/core/thread.h"
+#include "oge/core/replay.h"
+#include "oge/core/actions.h"
+#include "oge/core/limiter.h"
 #include "oge/core/logging.h"
+#include "oge/core/startup.h"
+#include "oge/core/recorder.h"
 #include "oge/core/platform.h"
+#include "oge/core/profiler.h"
+#include "oge/core/benchmark.h"
 #include "oge/core/assertion.h"
 #include "oge/core/application.h"
 
 #include "oge/containers/darray.h"
+#include "oge/containers/parallel.h"
 
+#include "oge/renderer/packets.h"
 #include "oge/renderer/renderer.h"
+#include "oge/renderer/pipelines.h"
 
 #include "oge/entry.h"
@@ -0,0 +1,221 @@
+/**
+ * @file packets.h
+ * @brief The header of render packets and the render thread
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+#include "oge/core/engine.h"
+#include "oge/renderer/renderer.h"
+
+/**
+ * @brief A default number of render packets in flight.
+ */
+#define OGE_RENDER_PACKETS_DEFAULT_DEPTH 1
+
+/**
+ * @brief A maximum number of render packets in flight.
+ */
+#define OGE_RENDER_PACKETS_MAX_DEPTH 4
+
+/**
+ * @brief A number of kept render packet completion records.
+ */
+#define OGE_RENDER_PACKETS_COMPLETION_COUNT (2 * OGE_RENDER_PACKETS_MAX_DEPTH)
+
+/**
+ * @brief A default size of a render packet data in bytes.
+ */
+#define OGE_RENDER_PACKETS_DEFAULT_DATA_SIZE OGE_KIBIBYTES(256)
+
+/**
+ * @brief Render packet struct, immutable once published.
+ *
+ * @var OgeRenderPacket::frameInfo
+ * A copy of the frame info of a frame a packet was built in.
+ *
+ * @var OgeRenderPacket::inputTime
+ * A time in nanoseconds the input of a frame was sampled at.
+ *
+ * @var OgeRenderPacket::publishTime
+ * A time in nanoseconds a packet was published at.
+ *
+ * @var OgeRenderPacket::data
+ * A pointer to the data allocated with ogeRenderPacketAlloc.
+ *
+ * @var OgeRenderPacket::dataSize
+ * A size of the allocated data in bytes.
+ */
+typedef struct OgeRenderPacket {
+  OgeFrameInfo  frameInfo;
+  u64           inputTime;
+  u64           publishTime;
+  void         *data;
+  u64           dataSize;
+} OgeRenderPacket;
+
+/**
+ * @brief Render packet submission function pointer.
+ * @param packet A pointer to a packet to submit.
+ * @return Should return OGE_FALSE to stop the main cycle.
+ */
+typedef b8 (*OgeRenderPacketSubmitFunction)(const OgeRenderPacket *packet);
+
+/**
+ * @brief Render packets initialization info.
+ *
+ * @var OgeRenderPacketsInitInfo::renderThread
+ * If set to OGE_TRUE packets are submitted on a dedicated render
+ * thread, otherwise they're submitted right after they're built.
+ *
+ * @var OgeRenderPacketsInitInfo::depth
+ * A number of packets the game thread can build ahead of the one
+ * being submitted, 0 means OGE_RENDER_PACKETS_DEFAULT_DEPTH. Every
+ * packet adds up to a frame of latency. Clamped to
+ * OGE_RENDER_PACKETS_MAX_DEPTH.
+ *
+ * @var OgeRenderPacketsInitInfo::dataSize
+ * A size of every packet data in bytes, 0 means
+ * OGE_RENDER_PACKETS_DEFAULT_DATA_SIZE.
+ */
+typedef struct OgeRenderPacketsInitInfo {
+  b8  renderThread;
+  u32 depth;
+  u64 dataSize;
+} OgeRenderPacketsInitInfo;
+
+/**
+ * @brief Render pipeline latency statistics, all of the times are
+ *        in nanoseconds.
+ *
+ * @var OgeRenderPacketsStats::packetCount
+ * A number of submitted packets.
+ *
+ * @var OgeRenderPacketsStats::meanBlockTime
+ * A mean time the game thread waited for a free packet.
+ *
+ * @var OgeRenderPacketsStats::meanQueueTime
+ * A mean time between a packet publication and its submission
+ * start.
+ *
+ * @var OgeRenderPacketsStats::meanSubmitTime
+ * A mean time a packet submission took.
+ *
+ * @var OgeRenderPacketsStats::meanLatency
+ * A mean time between a frame input sampling and the end of its
+ * packet submission.
+ *
+ * @var OgeRenderPacketsStats::maxLatency
+ * The longest time between a frame input sampling and the end of
+ * its packet submission.
+ */
+typedef struct OgeRenderPacketsStats {
+  u64 packetCount;
+  f64 meanBlockTime;
+  f64 meanQueueTime;
+  f64 meanSubmitTime;
+  f64 meanLatency;
+  u64 maxLatency;
+} OgeRenderPacketsStats;
+
+/**
+ * @brief A completion record of a submitted render packet.
+ *
+ * @var OgeRenderPacketCompletion::frameIndex
+ * An index of a frame the packet was built in.
+ *
+ * @var OgeRenderPacketCompletion::rendererStats
+ * A copy of renderer timings taken right after the packet was
+ * submitted, on the thread that submitted it.
+ */
+typedef struct OgeRenderPacketCompletion {
+  u64                   frameIndex;
+  OgeRendererFrameStats rendererStats;
+} OgeRenderPacketCompletion;
+
+/**
+ * @brief Initializes render packets and starts the render thread
+ *        if it's enabled.
+ * @param initInfo A pointer to OgeRenderPacketsInitInfo struct or 0
+ *                 to submit packets on the game thread.
+ * @param submit A function submitting packets.
+ * @return Returns OGE_TRUE if render packets were successfully
+ *         initialized, otherwise returns OGE_FALSE.
+ */
+b8 ogeRenderPacketsInit(const OgeRenderPacketsInitInfo *initInfo,
+                        OgeRenderPacketSubmitFunction submit);
+
+/**
+ * @brief Stops the render thread and terminates render packets.
+ *
+ * Packets that weren't submitted yet are submitted first.
+ */
+void ogeRenderPacketsTerminate();
+
+/**
+ * @brief Starts building the next render packet.
+ *
+ * Waits for a free packet if the game thread is depth packets
+ * ahead of the render thread.
+ *
+ * @param frameInfo A pointer to the current frame info.
+ * @param inputTime A time the input of a frame was sampled at.
+ * @return Returns OGE_FALSE if a submission failed.
+ */
+b8 ogeRenderPacketsBegin(const OgeFrameInfo *frameInfo, u64 inputTime);
+
+/**
+ * @brief Publishes the render packet being built.
+ *
+ * Without the render thread the packet is submitted right away.
+ *
+ * @return Returns OGE_FALSE if a submission failed.
+ */
+b8 ogeRenderPacketsEnd();
+
+/**
+ * @brief Waits until every published packet is submitted.
+ */
+void ogeRenderPacketsFlush();
+
+/**
+ * @brief Allocates data in the render packet being built.
+ *
+ * The data is 16 bytes aligned and lives until the packet is
+ * submitted. Should be called from the application render
+ * function.
+ *
+ * @param size A size of data in bytes.
+ * @return Returns a pointer to the data or 0 if a packet is full.
+ */
+OGE_API void* ogeRenderPacketAlloc(u64 size);
+
+/**
+ * @brief Takes the oldest completion record that wasn't taken yet.
+ *
+ * Records are kept for the last OGE_RENDER_PACKETS_COMPLETION_COUNT
+ * submitted packets, older ones are lost.
+ *
+ * @param completion A pointer to a record to fill.
+ * @return Returns OGE_FALSE if there are no records to take.
+ */
+b8 ogeRenderPacketsPopCompletion(OgeRenderPacketCompletion *completion);
+
+/**
+ * @brief Returns render pipeline latency statistics.
+ */
+OGE_API const OgeRenderPacketsStats* ogeRenderPacketsGetStats();
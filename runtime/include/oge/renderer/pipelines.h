@@ -0,0 +1,282 @@
+/**
+ * @file pipelines.h
+ * @brief The header of the pipeline state cache
+ *
+ * Copyright (c) 2023-2024 Osfabias
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+#pragma once
+
+#include "oge/defines.h"
+
+/**
+ * @brief A maximum number of distinct pipelines.
+ */
+#define OGE_PIPELINES_MAX_PIPELINES 256
+
+/**
+ * @brief A maximum number of vertex bindings of a pipeline.
+ */
+#define OGE_PIPELINES_MAX_VERTEX_BINDINGS 4
+
+/**
+ * @brief A maximum number of vertex attributes of a pipeline.
+ */
+#define OGE_PIPELINES_MAX_VERTEX_ATTRIBUTES 8
+
+/**
+ * @brief A maximum length of shader file names, longer names can't
+ *        be requested.
+ */
+#define OGE_PIPELINES_MAX_NAME_LENGTH 128
+
+/**
+ * @brief An id returned if a pipeline can't be requested.
+ */
+#define OGE_PIPELINES_INVALID_ID 0xFFFFFFFF
+
+/**
+ * @brief An id of the pipeline made of the renderer init info
+ *        shaders, it's bound at the start of a scene.
+ */
+#define OGE_PIPELINES_DEFAULT_ID 0
+
+/**
+ * @brief Vertex attribute format.
+ */
+typedef enum OgeVertexFormat {
+  OGE_VERTEX_FORMAT_FLOAT,
+  OGE_VERTEX_FORMAT_FLOAT2,
+  OGE_VERTEX_FORMAT_FLOAT3,
+  OGE_VERTEX_FORMAT_FLOAT4,
+  OGE_VERTEX_FORMAT_UBYTE4_NORM,
+
+  OGE_VERTEX_FORMAT_MAX_ENUM
+} OgeVertexFormat;
+
+/**
+ * @brief Primitive topology.
+ */
+typedef enum OgePrimitiveTopology {
+  OGE_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+  OGE_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+  OGE_PRIMITIVE_TOPOLOGY_LINE_LIST,
+  OGE_PRIMITIVE_TOPOLOGY_LINE_STRIP,
+  OGE_PRIMITIVE_TOPOLOGY_POINT_LIST,
+
+  OGE_PRIMITIVE_TOPOLOGY_MAX_ENUM
+} OgePrimitiveTopology;
+
+/**
+ * @brief Polygon rasterization mode.
+ */
+typedef enum OgePolygonMode {
+  OGE_POLYGON_MODE_FILL,
+  OGE_POLYGON_MODE_LINE,
+
+  OGE_POLYGON_MODE_MAX_ENUM
+} OgePolygonMode;
+
+/**
+ * @brief Face culling mode.
+ */
+typedef enum OgeCullMode {
+  OGE_CULL_MODE_NONE,
+  OGE_CULL_MODE_FRONT,
+  OGE_CULL_MODE_BACK,
+
+  OGE_CULL_MODE_MAX_ENUM
+} OgeCullMode;
+
+/**
+ * @brief Color blending of a pipeline, the alpha channel is blended
+ *        the same way.
+ */
+typedef enum OgeBlendMode {
+  OGE_BLEND_MODE_OPAQUE,
+  OGE_BLEND_MODE_ALPHA,
+  OGE_BLEND_MODE_ADDITIVE,
+  OGE_BLEND_MODE_PREMULTIPLIED,
+
+  OGE_BLEND_MODE_MAX_ENUM
+} OgeBlendMode;
+
+/**
+ * @brief Depth comparison operator.
+ */
+typedef enum OgeCompareOp {
+  OGE_COMPARE_OP_NEVER,
+  OGE_COMPARE_OP_LESS,
+  OGE_COMPARE_OP_EQUAL,
+  OGE_COMPARE_OP_LESS_OR_EQUAL,
+  OGE_COMPARE_OP_GREATER,
+  OGE_COMPARE_OP_NOT_EQUAL,
+  OGE_COMPARE_OP_GREATER_OR_EQUAL,
+  OGE_COMPARE_OP_ALWAYS,
+
+  OGE_COMPARE_OP_MAX_ENUM
+} OgeCompareOp;
+
+/**
+ * @brief Vertex buffer binding.
+ *
+ * @var OgeVertexBinding::stride
+ * A distance between consecutive elements in bytes.
+ *
+ * @var OgeVertexBinding::perInstance
+ * If set to OGE_TRUE elements are advanced per instance instead of
+ * per vertex.
+ */
+typedef struct OgeVertexBinding {
+  u32 stride;
+  b8  perInstance;
+} OgeVertexBinding;
+
+/**
+ * @brief Vertex attribute.
+ *
+ * @var OgeVertexAttribute::location
+ * A shader input location.
+ *
+ * @var OgeVertexAttribute::binding
+ * An index of a binding the attribute is read from.
+ *
+ * @var OgeVertexAttribute::format
+ * A format of the attribute.
+ *
+ * @var OgeVertexAttribute::offset
+ * An offset of the attribute in a binding element in bytes.
+ */
+typedef struct OgeVertexAttribute {
+  u32             location;
+  u32             binding;
+  OgeVertexFormat format;
+  u32             offset;
+} OgeVertexAttribute;
+
+/**
+ * @brief Pipeline description, every state a pipeline is compiled
+ *        with.
+ *
+ * Descriptions that are equal share one pipeline. Viewport and
+ * scissor are dynamic, so they aren't a part of it.
+ *
+ * @var OgePipelineDesc::vertexShaderFileName
+ * A name of a SPIR-V vertex shader file.
+ *
+ * @var OgePipelineDesc::fragmentShaderFileName
+ * A name of a SPIR-V fragment shader file.
+ *
+ * @var OgePipelineDesc::bindingCount
+ * A number of vertex bindings.
+ *
+ * @var OgePipelineDesc::bindings
+ * Vertex bindings, the ones past bindingCount are ignored.
+ *
+ * @var OgePipelineDesc::attributeCount
+ * A number of vertex attributes.
+ *
+ * @var OgePipelineDesc::attributes
+ * Vertex attributes, the ones past attributeCount are ignored.
+ *
+ * @var OgePipelineDesc::topology
+ * A primitive topology.
+ *
+ * @var OgePipelineDesc::polygonMode
+ * A polygon rasterization mode.
+ *
+ * @var OgePipelineDesc::cullMode
+ * Faces that are culled.
+ *
+ * @var OgePipelineDesc::frontFaceClockwise
+ * If set to OGE_TRUE clockwise triangles are front facing,
+ * otherwise counter clockwise ones are.
+ *
+ * @var OgePipelineDesc::blendMode
+ * Color blending.
+ *
+ * @var OgePipelineDesc::depthTest
+ * If set to OGE_TRUE fragments are tested against the depth buffer.
+ *
+ * @var OgePipelineDesc::depthWrite
+ * If set to OGE_TRUE fragments write the depth buffer.
+ *
+ * @var OgePipelineDesc::depthCompareOp
+ * A depth test comparison.
+ *
+ * @var OgePipelineDesc::subpass
+ * An index of a subpass of the renderer render pass a pipeline is
+ * used in. Depth state takes effect only in subpasses with a depth
+ * attachment.
+ */
+typedef struct OgePipelineDesc {
+  const char           *vertexShaderFileName;
+  const char           *fragmentShaderFileName;
+  u32                   bindingCount;
+  OgeVertexBinding      bindings[OGE_PIPELINES_MAX_VERTEX_BINDINGS];
+  u32                   attributeCount;
+  OgeVertexAttribute    attributes[OGE_PIPELINES_MAX_VERTEX_ATTRIBUTES];
+  OgePrimitiveTopology  topology;
+  OgePolygonMode        polygonMode;
+  OgeCullMode           cullMode;
+  b8                    frontFaceClockwise;
+  OgeBlendMode          blendMode;
+  b8                    depthTest;
+  b8                    depthWrite;
+  OgeCompareOp          depthCompareOp;
+  u32                   subpass;
+} OgePipelineDesc;
+
+/**
+ * @brief Returns an id of a pipeline matching a description.
+ *
+ * If there's no such pipeline yet it's queued for compilation on
+ * the job system and the id is returned right away, so a frame never
+ * waits for a compiler. Ids are stable, materials should keep them
+ * instead of requesting every frame. Can be called from any thread.
+ *
+ * @param desc A pointer to a pipeline description.
+ * @return Returns an id of a pipeline or OGE_PIPELINES_INVALID_ID
+ *         if the description is invalid, there are already
+ *         OGE_PIPELINES_MAX_PIPELINES pipelines or the engine runs
+ *         without renderer.
+ */
+OGE_API u32 ogePipelinesRequest(const OgePipelineDesc *desc);
+
+/**
+ * @brief Checks if a pipeline finished compiling.
+ * @param id An id returned by ogePipelinesRequest.
+ * @return Returns OGE_TRUE if a pipeline can be bound, otherwise
+ *         returns OGE_FALSE. Pipelines that failed to compile are
+ *         never ready.
+ */
+OGE_API b8 ogePipelinesIsReady(u32 id);
+
+/**
+ * @brief Binds a pipeline for the following draws of a scene.
+ *
+ * Should be called between ogeRendererStartScene and
+ * ogeRendererEndScene.
+ *
+ * @param id An id returned by ogePipelinesRequest.
+ * @return Returns OGE_FALSE if a pipeline isn't ready yet, draws
+ *         using it should be skipped this frame.
+ */
+OGE_API b8 ogePipelinesBind(u32 id);
+
+/**
+ * @brief Waits until every queued pipeline is compiled, e.g. at the
+ *        end of a loading screen.
+ */
+OGE_API void ogePipelinesWait();
@@ -20,6 +20,21 @@
 
 #include "oge/defines.h"
 
+/**
+ * @brief A default width of headless renderer images in pixels.
+ */
+#define OGE_RENDERER_DEFAULT_HEADLESS_WIDTH 1280
+
+/**
+ * @brief A default height of headless renderer images in pixels.
+ */
+#define OGE_RENDERER_DEFAULT_HEADLESS_HEIGHT 720
+
+/**
+ * @brief A default name of a pipeline cache file.
+ */
+#define OGE_RENDERER_DEFAULT_PIPELINE_CACHE_FILE_NAME "pipeline-cache.bin"
+
 typedef struct OgeColor {
   f32 r, g, b, a;
 } OgeColor;
@@ -32,6 +47,25 @@ typedef struct OgeColor {
  *
  * @var OgeRendererInitInfo::applicationVersion
  * An application version made using OGE_MAKE_VERSION.
+ *
+ * @var OgeRendererInitInfo::headless
+ * If set to OGE_TRUE renderer draws into offscreen images instead
+ * of a swapchain, so neither a surface nor presentation support
+ * is required. Forced if the platform layer is headless.
+ *
+ * @var OgeRendererInitInfo::headlessWidth
+ * A width of headless images in pixels, 0 means
+ * OGE_RENDERER_DEFAULT_HEADLESS_WIDTH.
+ *
+ * @var OgeRendererInitInfo::headlessHeight
+ * A height of headless images in pixels, 0 means
+ * OGE_RENDERER_DEFAULT_HEADLESS_HEIGHT.
+ *
+ * @var OgeRendererInitInfo::pipelineCacheFileName
+ * A name of a file the pipeline cache is loaded from at init and
+ * saved to at terminate, so warm starts don't recompile pipelines.
+ * 0 means OGE_RENDERER_DEFAULT_PIPELINE_CACHE_FILE_NAME. Should
+ * outlive renderer.
  */
 typedef struct OgeRendererInitInfo {
   const char *applicationName;
@@ -39,8 +73,62 @@ typedef struct OgeRendererInitInfo {
   const char *vertexShaderFileName;
   const char *fragmentShaderFileName;
   OgeColor clearColor;
+  b8  headless;
+  u16 headlessWidth;
+  u16 headlessHeight;
+  const char *pipelineCacheFileName;
 } OgeRendererInitInfo;
 
+/**
+ * @brief Renderer timings of the latest frame, all of the times are
+ *        in nanoseconds.
+ *
+ * @var OgeRendererFrameStats::fenceWaitTime
+ * A time spent waiting for the frame in flight to finish on GPU.
+ *
+ * @var OgeRendererFrameStats::acquireTime
+ * A time spent acquiring a swapchain image.
+ *
+ * @var OgeRendererFrameStats::gpuTime
+ * A time GPU spent executing a frame, measured with timestamp
+ * queries. It's read once the frame in flight finishes, so it lags
+ * behind by the number of frames in flight.
+ *
+ * @var OgeRendererFrameStats::gpuTimeValid
+ * OGE_FALSE if GPU doesn't support timestamps or no frame finished
+ * yet.
+ */
+typedef struct OgeRendererFrameStats {
+  u64 fenceWaitTime;
+  u64 acquireTime;
+  u64 gpuTime;
+  b8  gpuTimeValid;
+} OgeRendererFrameStats;
+
+/**
+ * @brief Pipeline cache statistics.
+ *
+ * @var OgeRendererPipelineCacheStats::loadedSize
+ * A size of cache data loaded from a file in bytes, 0 if the file
+ * was missing or written by a different device or driver.
+ *
+ * @var OgeRendererPipelineCacheStats::hitCount
+ * A number of pipelines created from the cache without compiling.
+ *
+ * @var OgeRendererPipelineCacheStats::missCount
+ * A number of compiled pipelines. Drivers that don't report
+ * pipeline creation feedback count every pipeline as a miss.
+ *
+ * @var OgeRendererPipelineCacheStats::creationTime
+ * A time spent creating pipelines in nanoseconds.
+ */
+typedef struct OgeRendererPipelineCacheStats {
+  u64 loadedSize;
+  u32 hitCount;
+  u32 missCount;
+  u64 creationTime;
+} OgeRendererPipelineCacheStats;
+
 /**
  * @brief Initializes renderer.
  * @param initInfo A pointer to OgeRendererInitInfo struct.
@@ -56,6 +144,8 @@ void ogeRendererTerminate();
 
 /**
  * @brief Starts scene rendering preparation.
+ *
+ * Scene functions do nothing if the engine runs without renderer.
  */
 OGE_API void ogeRendererStartScene();
 
@@ -68,3 +158,20 @@ OGE_API void ogeRendererEndScene();
  * @brief Waits for the end of rendering.
  */
 void ogeRendererWaitIdle();
+
+/**
+ * @brief Returns renderer timings of the latest frame, zeroed if
+ *        the engine runs without renderer.
+ *
+ * The timings are written by the thread that renders, so with the
+ * render thread they should only be read on it, e.g. from the
+ * application submit function. The engine reports them to benchmark
+ * from render packet completion records.
+ */
+OGE_API const OgeRendererFrameStats* ogeRendererGetFrameStats();
+
+/**
+ * @brief Returns pipeline cache statistics, zeroed if the engine
+ *        runs without renderer.
+ */
+OGE_API const OgeRendererPipelineCacheStats* ogeRendererGetPipelineCacheStats();
@@ -1,3 +1,5 @@
+#define OGE_LOG_CATEGORY CORE
+
 #include "oge/defines.h"
 #include "oge/core/memory.h"
 #include "oge/core/logging.h"
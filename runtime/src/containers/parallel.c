@@ -0,0 +1,404 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include "oge/defines.h"
+#include "oge/core/jobs.h"
+#include "oge/core/memory.h"
+#include "oge/core/assertion.h"
+#include "oge/containers/darray.h"
+#include "oge/containers/parallel.h"
+
+// Chunks per thread with an automatic grain size, a few more than
+// one, so threads that finish early steal the rest
+#define PARALLEL_CHUNKS_PER_THREAD 4
+#define PARALLEL_MAX_CHUNKS        256
+
+#define PARALLEL_RADIX_BITS 8
+#define PARALLEL_RADIX_SIZE (1 << PARALLEL_RADIX_BITS)
+#define PARALLEL_RADIX_MASK (PARALLEL_RADIX_SIZE - 1)
+
+typedef struct OgeParallelRange {
+  u64 begin;
+  u64 end;
+} OgeParallelRange;
+
+// Splits [begin, end) to chunks of at least a grain size elements,
+// returns a number of chunks
+OGE_INLINE u64 splitRange(u64 begin, u64 end, u64 grainSize,
+                          OgeParallelRange *ranges) {
+  const u64 length = end - begin;
+  if (!length) { return 0; }
+
+  if (!grainSize) {
+    const u64 threadCount = OGE_MAX(ogeJobsGetThreadCount(), 1);
+    const u64 target      = threadCount * PARALLEL_CHUNKS_PER_THREAD;
+    grainSize = OGE_MAX((length + target - 1) / target,
+                        OGE_PARALLEL_MIN_GRAIN_SIZE);
+  }
+
+  u64 chunkCount = (length + grainSize - 1) / grainSize;
+  if (chunkCount > PARALLEL_MAX_CHUNKS) {
+    chunkCount = PARALLEL_MAX_CHUNKS;
+    grainSize  = (length + chunkCount - 1) / chunkCount;
+  }
+
+  for (u64 i = 0; i < chunkCount; ++i) {
+    ranges[i].begin = begin + i * grainSize;
+    ranges[i].end   = OGE_MIN(ranges[i].begin + grainSize, end);
+  }
+
+  return chunkCount;
+}
+
+// Runs a job per chunk, the calling thread takes the first one
+OGE_INLINE void runChunks(OgeJobFunction function, void *chunks,
+                          u64 chunkSize, u64 chunkCount) {
+  if (!chunkCount) { return; }
+
+  OgeJob jobs[PARALLEL_MAX_CHUNKS];
+  for (u64 i = 1; i < chunkCount; ++i) {
+    jobs[i - 1].function = function;
+    jobs[i - 1].data     = (u8*)chunks + i * chunkSize;
+  }
+
+  OgeJobCounter counter = { 0 };
+  if (chunkCount > 1) { ogeJobsSubmit(jobs, chunkCount - 1, &counter); }
+
+  function(chunks);
+
+  if (chunkCount > 1) { ogeJobsWait(&counter); }
+}
+
+/************************************************/
+/* for                                          */
+/************************************************/
+typedef struct OgeParallelForChunk {
+  OgeParallelForFunction  function;
+  void                   *darray;
+  void                   *userData;
+  OgeParallelRange        range;
+} OgeParallelForChunk;
+
+static void forChunk(void *data) {
+  const OgeParallelForChunk *chunk = data;
+  chunk->function(chunk->darray, chunk->range.begin, chunk->range.end,
+                  chunk->userData);
+}
+
+void ogeParallelFor(void *darray, u64 begin, u64 end, u64 grainSize,
+                    OgeParallelForFunction function, void *userData) {
+  OGE_ASSERT(begin <= end, "Parallel for range is reversed.");
+
+  OgeParallelRange ranges[PARALLEL_MAX_CHUNKS];
+  const u64 chunkCount = splitRange(begin, end, grainSize, ranges);
+
+  OgeParallelForChunk chunks[PARALLEL_MAX_CHUNKS];
+  for (u64 i = 0; i < chunkCount; ++i) {
+    chunks[i] = (OgeParallelForChunk){
+      .function = function,
+      .darray   = darray,
+      .userData = userData,
+      .range    = ranges[i],
+    };
+  }
+
+  runChunks(forChunk, chunks, sizeof(OgeParallelForChunk), chunkCount);
+}
+
+/************************************************/
+/* reduce                                       */
+/************************************************/
+typedef struct OgeParallelReduceChunk {
+  OgeParallelReduceFunction  function;
+  const void                *darray;
+  void                      *result;
+  void                      *userData;
+  OgeParallelRange           range;
+} OgeParallelReduceChunk;
+
+static void reduceChunk(void *data) {
+  const OgeParallelReduceChunk *chunk = data;
+  chunk->function(chunk->darray, chunk->range.begin, chunk->range.end,
+                  chunk->result, chunk->userData);
+}
+
+void ogeParallelReduce(const void *darray, u64 begin, u64 end,
+                       u64 grainSize, void *result, u64 resultSize,
+                       OgeParallelReduceFunction reduce,
+                       OgeParallelCombineFunction combine,
+                       void *userData) {
+  OGE_ASSERT(begin <= end, "Parallel reduce range is reversed.");
+
+  OgeParallelRange ranges[PARALLEL_MAX_CHUNKS];
+  const u64 chunkCount = splitRange(begin, end, grainSize, ranges);
+
+  // A single chunk reduces right into the result
+  if (chunkCount <= 1) {
+    if (chunkCount) { reduce(darray, begin, end, result, userData); }
+    return;
+  }
+
+  u8 *partials = ogeAlloc(chunkCount * resultSize, OGE_MEMORY_TAG_ARRAY);
+
+  OgeParallelReduceChunk chunks[PARALLEL_MAX_CHUNKS];
+  for (u64 i = 0; i < chunkCount; ++i) {
+    ogeMemCpy(partials + i * resultSize, result, resultSize);
+    chunks[i] = (OgeParallelReduceChunk){
+      .function = reduce,
+      .darray   = darray,
+      .result   = partials + i * resultSize,
+      .userData = userData,
+      .range    = ranges[i],
+    };
+  }
+
+  runChunks(reduceChunk, chunks, sizeof(OgeParallelReduceChunk),
+            chunkCount);
+
+  for (u64 i = 0; i < chunkCount; ++i) {
+    combine(result, partials + i * resultSize, userData);
+  }
+
+  ogeFree(partials);
+}
+
+/************************************************/
+/* prefix sum                                   */
+/************************************************/
+// Three phases: every chunk sums its elements, the chunk sums are
+// scanned serially, then every chunk scans itself from its offset.
+// The offset is overwritten by the sum at the end of a chunk.
+typedef struct OgeParallelScanChunk {
+  void             *darray;
+  u64               offset;
+  b8                wide; // u64 elements instead of u32 ones
+  OgeParallelRange  range;
+} OgeParallelScanChunk;
+
+static void sumChunk(void *data) {
+  OgeParallelScanChunk *chunk = data;
+
+  u64 sum = 0;
+  if (chunk->wide) {
+    const u64 *elements = chunk->darray;
+    for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+      sum += elements[i];
+    }
+  } else {
+    const u32 *elements = chunk->darray;
+    u32 narrowSum = 0;
+    for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+      narrowSum += elements[i];
+    }
+    sum = narrowSum;
+  }
+
+  chunk->offset = sum;
+}
+
+static void scanChunk(void *data) {
+  OgeParallelScanChunk *chunk = data;
+
+  if (chunk->wide) {
+    u64 *elements = chunk->darray;
+    u64 sum = chunk->offset;
+    for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+      const u64 element = elements[i];
+      elements[i] = sum;
+      sum += element;
+    }
+    chunk->offset = sum;
+  } else {
+    u32 *elements = chunk->darray;
+    u32 sum = (u32)chunk->offset;
+    for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+      const u32 element = elements[i];
+      elements[i] = sum;
+      sum += element;
+    }
+    chunk->offset = sum;
+  }
+}
+
+static OGE_INLINE u64 prefixSum(void *darray, u64 begin, u64 end, b8 wide) {
+  OGE_ASSERT(begin <= end, "Parallel prefix sum range is reversed.");
+
+  OgeParallelRange ranges[PARALLEL_MAX_CHUNKS];
+  const u64 chunkCount = splitRange(begin, end, 0, ranges);
+
+  OgeParallelScanChunk chunks[PARALLEL_MAX_CHUNKS];
+  for (u64 i = 0; i < chunkCount; ++i) {
+    chunks[i] = (OgeParallelScanChunk){
+      .darray = darray,
+      .offset = 0,
+      .wide   = wide,
+      .range  = ranges[i],
+    };
+  }
+
+  // A single chunk has nothing to sum up front
+  if (chunkCount > 1) {
+    runChunks(sumChunk, chunks, sizeof(OgeParallelScanChunk), chunkCount);
+  }
+
+  u64 total = 0;
+  for (u64 i = 0; i < chunkCount; ++i) {
+    const u64 sum = chunks[i].offset;
+    chunks[i].offset = total;
+    total += sum;
+  }
+
+  runChunks(scanChunk, chunks, sizeof(OgeParallelScanChunk), chunkCount);
+
+  return chunkCount ? chunks[chunkCount - 1].offset : 0;
+}
+
+u32 ogeParallelPrefixSumU32(u32 *darray, u64 begin, u64 end) {
+  return (u32)prefixSum(darray, begin, end, OGE_FALSE);
+}
+
+u64 ogeParallelPrefixSumU64(u64 *darray, u64 begin, u64 end) {
+  return prefixSum(darray, begin, end, OGE_TRUE);
+}
+
+/************************************************/
+/* sort                                         */
+/************************************************/
+// Every pass sorts by one key byte: chunks count their digits,
+// the counts are scanned digit-major so every chunk knows where
+// its elements of every digit go, then chunks scatter them.
+// Chunks scatter their elements in order, so the sort is stable.
+typedef struct OgeParallelSortChunk {
+  const u8         *src;
+  u8               *dst;
+  u64               stride;
+  u64               keyOffset;
+  u64               keySize;
+  u32               shift;
+  u64              *counts; // PARALLEL_RADIX_SIZE entries
+  OgeParallelRange  range;
+} OgeParallelSortChunk;
+
+OGE_INLINE u32 elementDigit(const OgeParallelSortChunk *chunk, u64 index) {
+  const u8 *key = chunk->src + index * chunk->stride + chunk->keyOffset;
+  const u64 value = chunk->keySize == sizeof(u64)
+                  ? *(const u64*)key
+                  : *(const u32*)key;
+  return (u32)(value >> chunk->shift) & PARALLEL_RADIX_MASK;
+}
+
+static void countChunk(void *data) {
+  OgeParallelSortChunk *chunk = data;
+
+  ogeMemSet(chunk->counts, 0, PARALLEL_RADIX_SIZE * sizeof(u64));
+  for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+    chunk->counts[elementDigit(chunk, i)] += 1;
+  }
+}
+
+static void scatterChunk(void *data) {
+  OgeParallelSortChunk *chunk = data;
+
+  u64 *offsets = chunk->counts;
+  const u64 stride = chunk->stride;
+
+  for (u64 i = chunk->range.begin; i < chunk->range.end; ++i) {
+    const u8 *src = chunk->src + i * stride;
+    u8       *dst = chunk->dst + offsets[elementDigit(chunk, i)]++ * stride;
+
+    // Typed copies for the common strides, sort keys are
+    // usually a key and an index or a pointer
+    switch (stride) {
+      case sizeof(u32):     *(u32*)dst = *(const u32*)src; break;
+      case sizeof(u64):     *(u64*)dst = *(const u64*)src; break;
+      case sizeof(u64) * 2:
+        ((u64*)dst)[0] = ((const u64*)src)[0];
+        ((u64*)dst)[1] = ((const u64*)src)[1];
+        break;
+      default: ogeMemCpy(dst, src, stride); break;
+    }
+  }
+}
+
+static void copyChunk(void *data) {
+  const OgeParallelSortChunk *chunk = data;
+  const u64 offset = chunk->range.begin * chunk->stride;
+  ogeMemCpy(chunk->dst + offset, chunk->src + offset,
+            (chunk->range.end - chunk->range.begin) * chunk->stride);
+}
+
+void ogeParallelSort(void *darray, u64 begin, u64 end,
+                     u64 keyOffset, u64 keySize) {
+  OGE_ASSERT(begin <= end, "Parallel sort range is reversed.");
+  OGE_ASSERT(keySize == sizeof(u32) || keySize == sizeof(u64),
+             "Parallel sort key size must be either 4 or 8 bytes.");
+
+  const u64 stride = ogeDArrayStride(darray);
+  const u64 length = end - begin;
+  if (length < 2) { return; }
+
+  OgeParallelRange ranges[PARALLEL_MAX_CHUNKS];
+  const u64 chunkCount = splitRange(0, length, 0, ranges);
+
+  u8  *elements = (u8*)darray + begin * stride;
+  u8  *buffer   = ogeAlloc(length * stride, OGE_MEMORY_TAG_ARRAY);
+  u64 *counts   = ogeAlloc(chunkCount * PARALLEL_RADIX_SIZE * sizeof(u64),
+                           OGE_MEMORY_TAG_ARRAY);
+
+  OgeParallelSortChunk chunks[PARALLEL_MAX_CHUNKS];
+  for (u64 i = 0; i < chunkCount; ++i) {
+    chunks[i] = (OgeParallelSortChunk){
+      .stride    = stride,
+      .keyOffset = keyOffset,
+      .keySize   = keySize,
+      .counts    = counts + i * PARALLEL_RADIX_SIZE,
+      .range     = ranges[i],
+    };
+  }
+
+  const u8 *src = elements;
+  u8       *dst = buffer;
+
+  for (u32 shift = 0; shift < keySize * 8; shift += PARALLEL_RADIX_BITS) {
+    for (u64 i = 0; i < chunkCount; ++i) {
+      chunks[i].src   = src;
+      chunks[i].dst   = dst;
+      chunks[i].shift = shift;
+    }
+
+    runChunks(countChunk, chunks, sizeof(OgeParallelSortChunk), chunkCount);
+
+    // Turn counts to offsets, digit-major so elements of lower
+    // chunks go first, and skip the pass if every element has
+    // the same digit
+    u64 offset = 0;
+    b8  skip   = OGE_FALSE;
+    for (u32 digit = 0; digit < PARALLEL_RADIX_SIZE && !skip; ++digit) {
+      const u64 digitBegin = offset;
+      for (u64 i = 0; i < chunkCount; ++i) {
+        const u64 count = chunks[i].counts[digit];
+        chunks[i].counts[digit] = offset;
+        offset += count;
+      }
+      skip = offset - digitBegin == length;
+    }
+    if (skip) { continue; }
+
+    runChunks(scatterChunk, chunks, sizeof(OgeParallelSortChunk),
+              chunkCount);
+
+    dst = (u8*)src;
+    src = chunks[0].dst;
+  }
+
+  // An odd number of passes leaves elements in the buffer
+  if (src != elements) {
+    for (u64 i = 0; i < chunkCount; ++i) {
+      chunks[i].src = src;
+      chunks[i].dst = elements;
+    }
+    runChunks(copyChunk, chunks, sizeof(OgeParallelSortChunk), chunkCount);
+  }
+
+  ogeFree(counts);
+  ogeFree(buffer);
+}
@@ -0,0 +1,158 @@
+#define OGE_LOG_CATEGORY INPUT
+
+#include "oge/defines.h"
+#include "oge/core/input.h"
+#include "oge/core/memory.h"
+#include "oge/core/actions.h"
+#include "oge/core/logging.h"
+#include "oge/core/assertion.h"
+#include "oge/containers/darray.h"
+
+// A binding compiled to masks, the chord is down when
+// (bits & mask) == mask for every word
+typedef struct OgeCompiledBinding {
+  u64 keyMask[OGE_KEY_WORD_COUNT];
+  u64 mouseButtonMask;
+  u16 action;
+} OgeCompiledBinding;
+
+static struct {
+  b8 initialized;
+  OgeCompiledBinding *bindings; // darray
+} s_actionsState = { .initialized = OGE_FALSE };
+
+u8 g_ogeActionStates[OGE_MAX_ACTIONS];
+
+void ogeActionsInit() {
+  OGE_ASSERT(
+    !s_actionsState.initialized,
+    "Trying to initialize actions system while it's already initialized."
+  );
+
+  s_actionsState.bindings = ogeDArrayAlloc(16, sizeof(OgeCompiledBinding));
+  ogeMemSet(g_ogeActionStates, 0, sizeof(g_ogeActionStates));
+
+  s_actionsState.initialized = OGE_TRUE;
+
+  OGE_INFO("Actions system initialized.");
+}
+
+void ogeActionsTerminate() {
+  OGE_ASSERT(
+    s_actionsState.initialized,
+    "Trying to terminate actions system while it's already terminated."
+  );
+
+  ogeDArrayFree(s_actionsState.bindings);
+  s_actionsState.initialized = OGE_FALSE;
+
+  OGE_INFO("Actions system terminated.");
+}
+
+void ogeActionsUpdate() {
+  const OgeCompiledBinding *bindings = s_actionsState.bindings;
+  const u64 bindingsCount = ogeDArrayLength(bindings);
+
+  // Previous frame bits are recovered from the changed mask
+  u64 keysDown[OGE_KEY_WORD_COUNT], keysDownPrevious[OGE_KEY_WORD_COUNT];
+  for (u32 word = 0; word < OGE_KEY_WORD_COUNT; ++word) {
+    keysDown[word]         = g_ogeInputBits.keysDown[word];
+    keysDownPrevious[word] = g_ogeInputBits.keysDown[word] ^
+                             g_ogeInputBits.keysChanged[word];
+  }
+
+  const u64 mouseButtonsDown = g_ogeInputBits.mouseButtonsDown;
+  const u64 mouseButtonsDownPrevious =
+    g_ogeInputBits.mouseButtonsDown ^ g_ogeInputBits.mouseButtonsChanged;
+
+  // An action is down if any of its bindings is down, so the
+  // previous frame state is combined over the bindings the same way
+  // before the transitions are derived
+  u8 actionsDownPrevious[OGE_MAX_ACTIONS];
+  ogeMemSet(actionsDownPrevious, 0, sizeof(actionsDownPrevious));
+  ogeMemSet(g_ogeActionStates, 0, sizeof(g_ogeActionStates));
+
+  // Branchless chord tests: any bit of a mask that isn't set
+  // in the input bits makes the mismatch non-zero
+  for (u64 i = 0; i < bindingsCount; ++i) {
+    const OgeCompiledBinding *binding = &bindings[i];
+
+    u64 mismatch =
+      (mouseButtonsDown & binding->mouseButtonMask) ^
+      binding->mouseButtonMask;
+    u64 mismatchPrevious =
+      (mouseButtonsDownPrevious & binding->mouseButtonMask) ^
+      binding->mouseButtonMask;
+
+    for (u32 word = 0; word < OGE_KEY_WORD_COUNT; ++word) {
+      mismatch |=
+        (keysDown[word] & binding->keyMask[word]) ^ binding->keyMask[word];
+      mismatchPrevious |=
+        (keysDownPrevious[word] & binding->keyMask[word]) ^
+        binding->keyMask[word];
+    }
+
+    g_ogeActionStates[binding->action]   |= mismatch == 0;
+    actionsDownPrevious[binding->action] |= mismatchPrevious == 0;
+  }
+
+  for (u32 i = 0; i < OGE_MAX_ACTIONS; ++i) {
+    const u8 down     = g_ogeActionStates[i];
+    const u8 downPrev = actionsDownPrevious[i];
+
+    g_ogeActionStates[i] =
+      (down              ? OGE_ACTION_STATE_DOWN     : 0) |
+      (down && !downPrev ? OGE_ACTION_STATE_PRESSED  : 0) |
+      (!down && downPrev ? OGE_ACTION_STATE_RELEASED : 0);
+  }
+}
+
+void ogeActionBind(u16 action, const OgeActionBinding *binding) {
+  OGE_ASSERT(action < OGE_MAX_ACTIONS,
+             "Action index %d is out of OGE_MAX_ACTIONS range.", action);
+
+  if (binding->keyCount == 0 && binding->mouseButtonCount == 0) {
+    OGE_WARN("Trying to bind an empty chord to %d action.", action);
+    return;
+  }
+
+  OgeCompiledBinding compiled;
+  ogeMemSet(&compiled, 0, sizeof(compiled));
+  compiled.action = action;
+
+  for (u32 i = 0; i < binding->keyCount; ++i) {
+    const OplKey key = binding->keys[i];
+    OGE_ASSERT((u64)key < OGE_KEY_COUNT,
+               "Key %d is out of OGE_KEY_COUNT range.", key);
+    OGE_KEY_WORD(compiled.keyMask, key) |= OGE_KEY_MASK(key);
+  }
+
+  for (u32 i = 0; i < binding->mouseButtonCount; ++i) {
+    OGE_ASSERT((u64)binding->mouseButtons[i] < OGE_MOUSE_BUTTON_COUNT,
+               "Mouse button %d is out of OGE_MOUSE_BUTTON_COUNT range.",
+               binding->mouseButtons[i]);
+    compiled.mouseButtonMask |= 1ULL << binding->mouseButtons[i];
+  }
+
+  s_actionsState.bindings =
+    ogeDArrayAppend(s_actionsState.bindings, &compiled);
+}
+
+void ogeActionUnbind(u16 action) {
+  OGE_ASSERT(action < OGE_MAX_ACTIONS,
+             "Action index %d is out of OGE_MAX_ACTIONS range.", action);
+
+  OgeCompiledBinding *bindings = s_actionsState.bindings;
+  u64 length = ogeDArrayLength(bindings);
+
+  // Swap-remove, bindings order doesn't matter
+  for (u64 i = 0; i < length;) {
+    if (bindings[i].action != action) { ++i; continue; }
+
+    bindings[i] = bindings[length - 1];
+    length -= 1;
+  }
+
+  ogeDArrayLength(bindings) = length;
+  g_ogeActionStates[action] = 0;
+}
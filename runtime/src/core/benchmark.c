@@ -0,0 +1,316 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/limiter.h"
+#include "oge/core/logging.h"
+#include "oge/core/assertion.h"
+#include "oge/core/benchmark.h"
+
+#define BENCHMARK_MAX_FILE_NAME_LENGTH 256
+
+typedef enum OgeBenchmarkMetric {
+  OGE_BENCHMARK_METRIC_FRAME_TIME,
+  OGE_BENCHMARK_METRIC_CPU_TIME,
+  OGE_BENCHMARK_METRIC_GPU_TIME,
+  OGE_BENCHMARK_METRIC_FENCE_WAIT_TIME,
+  OGE_BENCHMARK_METRIC_ACQUIRE_TIME,
+
+  OGE_BENCHMARK_METRIC_MAX_ENUM
+} OgeBenchmarkMetric;
+
+typedef struct OgeBenchmarkStats {
+  u64 minTime;
+  f64 meanTime;
+  u64 p50Time;
+  u64 p95Time;
+  u64 p99Time;
+  u64 maxTime;
+} OgeBenchmarkStats;
+
+const char *s_benchmarkMetricNames[OGE_BENCHMARK_METRIC_MAX_ENUM] = {
+  "frameTime",
+  "cpuTime",
+  "gpuTime",
+  "fenceWaitTime",
+  "acquireTime",
+};
+
+// Samples are stored per metric, frameCount of every one, so each
+// metric sorts in place. GPU time isn't measured every frame, its
+// samples are packed at the start of its range.
+static struct {
+  b8 initialized;
+  b8 enabled;
+  b8 finished;
+
+  u32  warmupFrameCount;
+  u32  frameCount;
+  char fileName[BENCHMARK_MAX_FILE_NAME_LENGTH];
+
+  u64  recordedFrameCount;
+  u64  previousEndTime;
+  u64  startTime;
+  u64 *samples;
+  u32  sampleCounts[OGE_BENCHMARK_METRIC_MAX_ENUM];
+} s_benchmarkState = { .initialized = OGE_FALSE };
+
+// Leaves the value untouched if a variable isn't set
+OGE_INLINE void readEnvironmentCount(const char *name, u32 *value) {
+  const char *string = getenv(name);
+  if (!string || !*string) { return; }
+
+  char *end;
+  const unsigned long count = strtoul(string, &end, 10);
+  if (*end || count > 0xFFFFFFFFul) {
+    OGE_WARN("Ignoring invalid %s value \"%s\".", name, string);
+    return;
+  }
+  *value = (u32)count;
+}
+
+static i32 compareSamples(const void *a, const void *b) {
+  const u64 x = *(const u64*)a;
+  const u64 y = *(const u64*)b;
+  return (x > y) - (x < y);
+}
+
+// Nearest rank, the smallest sample percentile% of the samples
+// don't exceed
+OGE_INLINE u64 getPercentile(const u64 *sorted, u32 count, u32 percentile) {
+  const u64 rank = ((u64)count * percentile + 99) / 100;
+  return sorted[OGE_MAX(rank, 1) - 1];
+}
+
+// Sorts samples of a metric
+static OGE_INLINE b8 computeStats(OgeBenchmarkMetric metric,
+                                  OgeBenchmarkStats *stats) {
+  const u32 count = s_benchmarkState.sampleCounts[metric];
+  if (!count) { return OGE_FALSE; }
+
+  u64 *samples = s_benchmarkState.samples +
+                 (u64)metric * s_benchmarkState.frameCount;
+  qsort(samples, count, sizeof(u64), compareSamples);
+
+  u64 sum = 0;
+  for (u32 i = 0; i < count; ++i) { sum += samples[i]; }
+
+  stats->minTime  = samples[0];
+  stats->meanTime = (f64)sum / (f64)count;
+  stats->p50Time  = getPercentile(samples, count, 50);
+  stats->p95Time  = getPercentile(samples, count, 95);
+  stats->p99Time  = getPercentile(samples, count, 99);
+  stats->maxTime  = samples[count - 1];
+  return OGE_TRUE;
+}
+
+OGE_INLINE void writeStats(FILE *file, const OgeBenchmarkStats *stats) {
+  fprintf(file, "{\"min\": %.6f, \"mean\": %.6f, \"p50\": %.6f, "
+          "\"p95\": %.6f, \"p99\": %.6f, \"max\": %.6f}",
+          OGE_NS_TO_MILLISECONDS(stats->minTime),
+          OGE_NS_TO_MILLISECONDS(stats->meanTime),
+          OGE_NS_TO_MILLISECONDS(stats->p50Time),
+          OGE_NS_TO_MILLISECONDS(stats->p95Time),
+          OGE_NS_TO_MILLISECONDS(stats->p99Time),
+          OGE_NS_TO_MILLISECONDS(stats->maxTime));
+}
+
+// Memory usage is tracked only in debug builds
+OGE_INLINE void writeMemoryStats(FILE *file) {
+  OgeMemoryStats memoryStats;
+  if (!ogeMemoryGetStats(&memoryStats)) {
+    fputs("  \"memory\": null\n", file);
+    return;
+  }
+
+  fprintf(file, "  \"memory\": {\n    \"current\": %llu,\n"
+          "    \"peak\": %llu,\n    \"tags\": {",
+          memoryStats.totalUsage, memoryStats.peakUsage);
+
+  for (u32 i = 0; i < OGE_MEMORY_TAG_MAX_ENUM; ++i) {
+    fprintf(file, "%s\n      \"%s\": {\"current\": %llu, \"peak\": %llu}",
+            i ? "," : "", ogeMemoryTagToString(i),
+            memoryStats.perTagUsage[i], memoryStats.perTagPeakUsage[i]);
+  }
+
+  fputs("\n    }\n  }\n", file);
+}
+
+// Times are written in milliseconds, sizes in bytes
+static OGE_INLINE b8 writeResults(u64 duration) {
+  const char *fileName = s_benchmarkState.fileName;
+
+  FILE *file = fopen(fileName, "w");
+  if (!file) {
+    OGE_ERROR("Failed to open benchmark results file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+#ifdef OGE_DEBUG
+  const char *build = "debug";
+#else
+  const char *build = "release";
+#endif
+
+  fprintf(file, "{\n  \"version\": \"%d.%d.%d\",\n  \"build\": \"%s\",\n"
+          "  \"warmupFrames\": %u,\n  \"frames\": %u,\n"
+          "  \"duration\": %.6f,\n",
+          OGE_VERSION_MAJOR, OGE_VERSION_MINOR, OGE_VERSION_PATCH, build,
+          s_benchmarkState.warmupFrameCount, s_benchmarkState.frameCount,
+          OGE_NS_TO_SECONDS(duration));
+
+  for (u32 i = 0; i < OGE_BENCHMARK_METRIC_MAX_ENUM; ++i) {
+    OgeBenchmarkStats stats;
+    fprintf(file, "  \"%s\": ", s_benchmarkMetricNames[i]);
+
+    if (computeStats(i, &stats)) { writeStats(file, &stats); }
+    else                         { fputs("null", file); }
+    fputs(",\n", file);
+  }
+
+  writeMemoryStats(file);
+  fputs("}\n", file);
+
+  const b8 result = !ferror(file);
+  fclose(file);
+
+  if (!result) {
+    OGE_ERROR("Failed to write benchmark results file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+  OGE_INFO("Benchmark results were written to \"%s\".", fileName);
+  return OGE_TRUE;
+}
+
+// Called after writeResults, so samples are sorted
+static OGE_INLINE void logResults() {
+  const u64 *frameTimes = s_benchmarkState.samples;
+  const u32  count      = s_benchmarkState.frameCount;
+
+  OGE_INFO("Benchmark: %u frames, frame time p50 %.3f ms, p99 %.3f ms, "
+           "max %.3f ms.", count,
+           OGE_NS_TO_MILLISECONDS(getPercentile(frameTimes, count, 50)),
+           OGE_NS_TO_MILLISECONDS(getPercentile(frameTimes, count, 99)),
+           OGE_NS_TO_MILLISECONDS(frameTimes[count - 1]));
+}
+
+b8 ogeBenchmarkInit(const OgeBenchmarkInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_benchmarkState.initialized,
+    "Trying to initialize benchmark while it's already initialized."
+  );
+
+  ogeMemSet(&s_benchmarkState, 0, sizeof(s_benchmarkState));
+
+  const char *fileName = OGE_BENCHMARK_DEFAULT_FILE_NAME;
+  if (initInfo) {
+    s_benchmarkState.warmupFrameCount = initInfo->warmupFrameCount;
+    s_benchmarkState.frameCount       = initInfo->frameCount;
+    if (initInfo->fileName) { fileName = initInfo->fileName; }
+  }
+
+  readEnvironmentCount(OGE_BENCHMARK_FRAMES_ENV,
+                       &s_benchmarkState.frameCount);
+  readEnvironmentCount(OGE_BENCHMARK_WARMUP_FRAMES_ENV,
+                       &s_benchmarkState.warmupFrameCount);
+
+  const char *environmentFileName = getenv(OGE_BENCHMARK_OUTPUT_ENV);
+  if (environmentFileName && *environmentFileName) {
+    fileName = environmentFileName;
+  }
+
+  snprintf(s_benchmarkState.fileName, sizeof(s_benchmarkState.fileName),
+           "%s", fileName);
+
+  s_benchmarkState.initialized = OGE_TRUE;
+  s_benchmarkState.enabled     = s_benchmarkState.frameCount != 0;
+
+  if (s_benchmarkState.enabled) {
+    s_benchmarkState.samples =
+      ogeAlloc(sizeof(u64) * s_benchmarkState.frameCount *
+               OGE_BENCHMARK_METRIC_MAX_ENUM, OGE_MEMORY_TAG_ARRAY);
+
+    // A frame rate cap would hide how fast a build actually is
+    ogeLimiterSetTargetFrameRate(0);
+
+    OGE_INFO("Benchmark: %u warmup and %u measured frames.",
+             s_benchmarkState.warmupFrameCount,
+             s_benchmarkState.frameCount);
+  }
+
+  OGE_INFO("Benchmark initialized.");
+  return OGE_TRUE;
+}
+
+void ogeBenchmarkTerminate() {
+  OGE_ASSERT(
+    s_benchmarkState.initialized,
+    "Trying to terminate benchmark while it's already terminated."
+  );
+
+  if (s_benchmarkState.enabled && !s_benchmarkState.finished) {
+    OGE_WARN("Benchmark stopped after %llu of %u frames, results weren't written.",
+             s_benchmarkState.recordedFrameCount,
+             s_benchmarkState.warmupFrameCount + s_benchmarkState.frameCount);
+  }
+
+  if (s_benchmarkState.samples) { ogeFree(s_benchmarkState.samples); }
+
+  s_benchmarkState.initialized = OGE_FALSE;
+
+  OGE_INFO("Benchmark terminated.");
+}
+
+b8 ogeBenchmarkEndFrame(const OgeBenchmarkFrame *frame) {
+  if (!s_benchmarkState.enabled || s_benchmarkState.finished) {
+    return OGE_TRUE;
+  }
+
+  // The first frame has no previous one to measure from
+  const u64 endTime   = frame->endTime;
+  const u64 frameTime = s_benchmarkState.previousEndTime
+                      ? endTime - s_benchmarkState.previousEndTime
+                      : frame->cpuTime;
+  s_benchmarkState.previousEndTime = endTime;
+
+  const u64 frameIndex = s_benchmarkState.recordedFrameCount++;
+  if (frameIndex < s_benchmarkState.warmupFrameCount) { return OGE_TRUE; }
+
+  if (frameIndex == s_benchmarkState.warmupFrameCount) {
+    s_benchmarkState.startTime = endTime - frameTime;
+  }
+
+  const u64 samples[OGE_BENCHMARK_METRIC_MAX_ENUM] = {
+    [OGE_BENCHMARK_METRIC_FRAME_TIME]      = frameTime,
+    [OGE_BENCHMARK_METRIC_CPU_TIME]        = frame->cpuTime,
+    [OGE_BENCHMARK_METRIC_GPU_TIME]        = frame->gpuTime,
+    [OGE_BENCHMARK_METRIC_FENCE_WAIT_TIME] = frame->fenceWaitTime,
+    [OGE_BENCHMARK_METRIC_ACQUIRE_TIME]    = frame->acquireTime,
+  };
+
+  for (u32 i = 0; i < OGE_BENCHMARK_METRIC_MAX_ENUM; ++i) {
+    if (i == OGE_BENCHMARK_METRIC_GPU_TIME && !frame->gpuTimeValid) {
+      continue;
+    }
+
+    u32 *count = &s_benchmarkState.sampleCounts[i];
+    s_benchmarkState.samples[(u64)i * s_benchmarkState.frameCount + *count] =
+      samples[i];
+    *count += 1;
+  }
+
+  if (s_benchmarkState.sampleCounts[OGE_BENCHMARK_METRIC_FRAME_TIME] <
+      s_benchmarkState.frameCount) {
+    return OGE_TRUE;
+  }
+
+  s_benchmarkState.finished = OGE_TRUE;
+  writeResults(endTime - s_benchmarkState.startTime);
+  logResults();
+  return OGE_FALSE;
+}
@@ -1,53 +1,292 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include "oge/core/jobs.h"
 #include "oge/core/input.h"
+#include "oge/core/clock.h"
+#include "oge/core/tasks.h"
 #include "oge/core/engine.h"
 #include "oge/core/events.h"
+#include "oge/core/memory.h"
+#include "oge/core/replay.h"
+#include "oge/core/actions.h"
+#include "oge/core/limiter.h"
 #include "oge/core/logging.h"
+#include "oge/core/recorder.h"
 #include "oge/core/platform.h"
+#include "oge/core/startup.h"
+#include "oge/core/profiler.h"
+#include "oge/core/benchmark.h"
 #include "oge/core/assertion.h"
 #include "oge/core/application.h"
+#include "oge/renderer/packets.h"
 #include "oge/renderer/renderer.h"
 
+#include "loop.h"
+
+typedef enum OgeSubsystem {
+  OGE_SUBSYSTEM_RECORDER,
+  OGE_SUBSYSTEM_LOGGING,
+  OGE_SUBSYSTEM_PROFILER,
+  OGE_SUBSYSTEM_JOBS,
+  OGE_SUBSYSTEM_PLATFORM,
+  OGE_SUBSYSTEM_EVENTS,
+  OGE_SUBSYSTEM_LIMITER,
+  OGE_SUBSYSTEM_BENCHMARK,
+  OGE_SUBSYSTEM_REPLAY,
+  OGE_SUBSYSTEM_INPUT,
+  OGE_SUBSYSTEM_ACTIONS,
+  OGE_SUBSYSTEM_TASKS,
+  OGE_SUBSYSTEM_RENDERER,
+  OGE_SUBSYSTEM_RENDER_PACKETS,
+
+  OGE_SUBSYSTEM_MAX_ENUM
+} OgeSubsystem;
+
+#define DEPENDS_ON(subsystem) OGE_STARTUP_STEP_BIT(OGE_SUBSYSTEM_##subsystem)
+
+// Frames waiting for renderer timings of their render packets,
+// which the render thread submits up to the packets depth later
+#define PENDING_FRAMES_CAPACITY OGE_RENDER_PACKETS_COMPLETION_COUNT
+
+typedef struct pendingFrame {
+  u64               frameIndex;
+  b8                complete;
+  OgeBenchmarkFrame timings;
+} pendingFrame;
+
 static struct {
   b8 initialized;
   b8 terminateRequested;
   const OgeApplication *application;
+  u32 initOrder[OGE_SUBSYSTEM_MAX_ENUM];
+  updateLoop loop;
+
+  pendingFrame pendingFrames[PENDING_FRAMES_CAPACITY];
+  u64          pendingFramesStart;
+  u64          pendingFramesEnd;
 } s_ogeState = {
   .initialized        = OGE_FALSE,
   .terminateRequested = OGE_FALSE,
 };
 
-OGE_INLINE b8 initSystems() {
-  const OgeInitInfo initInfo = *s_ogeState.application->ogeInitInfo;
+static b8 initRecorder(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeRecorderInit(initInfo->recorderInitInfo)) {
+    OGE_ERROR("Failed to initialize flight recorder.");
+  }
+  return OGE_TRUE;
+}
 
-  if (!ogeLoggingInit(initInfo.loggingInitInfo)) {
+static b8 initLogging(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeLoggingInit(initInfo->loggingInitInfo)) {
     OGE_ERROR("Failed to initizlize logging system.");
   }
+  return OGE_TRUE;
+}
+
+static b8 initProfiler(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeProfilerInit(initInfo->profilerInitInfo)) {
+    OGE_ERROR("Failed to initialize profiler.");
+    return OGE_FALSE;
+  }
+  return OGE_TRUE;
+}
+
+static b8 initJobs(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeJobsInit(initInfo->jobsInitInfo)) {
+    OGE_ERROR("Failed to initialize job system.");
+    return OGE_FALSE;
+  }
+  return OGE_TRUE;
+}
 
-  if (!ogePlatformInit(initInfo.platformInitInfo)) {
+static b8 initPlatform(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogePlatformInit(initInfo->platformInitInfo)) {
     OGE_ERROR("Failed to initialize platform layer.");
     return OGE_FALSE;
   }
   OGE_INFO("OPL initialized.");
+  return OGE_TRUE;
+}
 
+static b8 initEvents(void *userData) {
+  (void)userData;
   ogeEventsInit();
+  return OGE_TRUE;
+}
+
+static b8 initLimiter(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  ogeLimiterInit(initInfo->limiterInitInfo);
+  return OGE_TRUE;
+}
+
+static b8 initBenchmark(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeBenchmarkInit(initInfo->benchmarkInitInfo)) {
+    OGE_ERROR("Failed to initialize benchmark.");
+    return OGE_FALSE;
+  }
+  return OGE_TRUE;
+}
+
+static b8 initReplay(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (!ogeReplayInit(initInfo->replayInitInfo)) {
+    OGE_ERROR("Failed to initialize replay system.");
+    return OGE_FALSE;
+  }
+  return OGE_TRUE;
+}
+
+static b8 initInput(void *userData) {
+  (void)userData;
   ogeInputInit();
+  return OGE_TRUE;
+}
 
-  if (!ogeRendererInit(initInfo.rendererInitInfo)) {
+static b8 initActions(void *userData) {
+  (void)userData;
+  ogeActionsInit();
+  return OGE_TRUE;
+}
+
+static b8 initTasks(void *userData) {
+  (void)userData;
+  ogeTasksInit();
+  return OGE_TRUE;
+}
+
+static b8 initRenderer(void *userData) {
+  const OgeInitInfo *initInfo = userData;
+  if (initInfo->rendererInitInfo &&
+      !ogeRendererInit(initInfo->rendererInitInfo)) {
     OGE_ERROR("Failed to initialize renderer.");
     return OGE_FALSE;
   }
+  return OGE_TRUE;
+}
+
+static b8 initRenderPackets(void *userData) {
+  const OgeInitInfo *initInfo = userData;
 
+  // Only the application submit function may use the render thread
+  const OgeRenderPacketsInitInfo *renderPacketsInitInfo =
+    s_ogeState.application->submit ? initInfo->renderPacketsInitInfo : 0;
+
+  if (!ogeRenderPacketsInit(renderPacketsInitInfo,
+                            s_ogeState.application->submit)) {
+    OGE_ERROR("Failed to initialize render packets.");
+    return OGE_FALSE;
+  }
   return OGE_TRUE;
 }
 
-OGE_INLINE void terminateSystems() {
-  ogeRendererTerminate();
-  ogeInputTerminate();
-  ogeEventsTerminate();
+static void terminateRenderer() {
+  if (s_ogeState.application->ogeInitInfo->rendererInitInfo) {
+    ogeRendererTerminate();
+  }
+}
 
-  ogePlatformTerminate();
+// Subsystems are indexed by OgeSubsystem. Ones subscribing to
+// events or touching the window and the surface stay on the main
+// thread, the event subscriptions aren't synchronized.
+static const struct {
+  OgeStartupStep step;
+  void (*terminate)();
+} s_subsystems[OGE_SUBSYSTEM_MAX_ENUM] = {
+  [OGE_SUBSYSTEM_RECORDER] = {
+    { "recorder", initRecorder, 0, OGE_FALSE },
+    ogeRecorderTerminate,
+  },
+  [OGE_SUBSYSTEM_LOGGING] = {
+    { "logging", initLogging, DEPENDS_ON(RECORDER), OGE_FALSE },
+    ogeLoggingTerminate,
+  },
+  [OGE_SUBSYSTEM_PROFILER] = {
+    { "profiler", initProfiler, DEPENDS_ON(LOGGING), OGE_FALSE },
+    ogeProfilerTerminate,
+  },
+  [OGE_SUBSYSTEM_JOBS] = {
+    { "jobs", initJobs, DEPENDS_ON(PROFILER), OGE_FALSE },
+    ogeJobsTerminate,
+  },
+  [OGE_SUBSYSTEM_PLATFORM] = {
+    { "platform", initPlatform, DEPENDS_ON(LOGGING), OGE_FALSE },
+    ogePlatformTerminate,
+  },
+  [OGE_SUBSYSTEM_EVENTS] = {
+    { "events", initEvents, DEPENDS_ON(LOGGING), OGE_FALSE },
+    ogeEventsTerminate,
+  },
+  [OGE_SUBSYSTEM_LIMITER] = {
+    { "limiter", initLimiter, DEPENDS_ON(EVENTS), OGE_FALSE },
+    ogeLimiterTerminate,
+  },
+  [OGE_SUBSYSTEM_BENCHMARK] = {
+    { "benchmark", initBenchmark, DEPENDS_ON(LIMITER), OGE_TRUE },
+    ogeBenchmarkTerminate,
+  },
+  [OGE_SUBSYSTEM_REPLAY] = {
+    { "replay", initReplay,
+      DEPENDS_ON(EVENTS) | DEPENDS_ON(PLATFORM), OGE_TRUE },
+    ogeReplayTerminate,
+  },
+  [OGE_SUBSYSTEM_INPUT] = {
+    { "input", initInput,
+      DEPENDS_ON(EVENTS) | DEPENDS_ON(PLATFORM), OGE_FALSE },
+    ogeInputTerminate,
+  },
+  [OGE_SUBSYSTEM_ACTIONS] = {
+    { "actions", initActions, DEPENDS_ON(INPUT), OGE_TRUE },
+    ogeActionsTerminate,
+  },
+  [OGE_SUBSYSTEM_TASKS] = {
+    { "tasks", initTasks, DEPENDS_ON(JOBS), OGE_TRUE },
+    ogeTasksTerminate,
+  },
+  [OGE_SUBSYSTEM_RENDERER] = {
+    { "renderer", initRenderer,
+      DEPENDS_ON(PLATFORM) | DEPENDS_ON(JOBS), OGE_FALSE },
+    terminateRenderer,
+  },
+  [OGE_SUBSYSTEM_RENDER_PACKETS] = {
+    { "render packets", initRenderPackets, DEPENDS_ON(RENDERER), OGE_TRUE },
+    ogeRenderPacketsTerminate,
+  },
+};
 
-  ogeLoggingTerminate();
+static OGE_INLINE b8 initSystems() {
+  OgeStartupStep steps[OGE_SUBSYSTEM_MAX_ENUM];
+  for (u32 i = 0; i < OGE_SUBSYSTEM_MAX_ENUM; ++i) {
+    steps[i] = s_subsystems[i].step;
+  }
+
+  // Cast away const, steps only read the init info
+  return ogeStartupRun("Engine", steps, OGE_SUBSYSTEM_MAX_ENUM,
+                       (void*)s_ogeState.application->ogeInitInfo,
+                       s_ogeState.initOrder);
+}
+
+// Reverse initialization order respects dependencies
+static OGE_INLINE void terminateSystems() {
+  for (u32 i = OGE_SUBSYSTEM_MAX_ENUM; i > 0; --i) {
+    s_subsystems[s_ogeState.initOrder[i - 1]].terminate();
+  }
+}
+
+static OGE_INLINE void initLoop(const OgeLoopInitInfo *initInfo) {
+  initUpdateLoop(&s_ogeState.loop, initInfo);
+
+  if (s_ogeState.loop.fixedTimestep) {
+    OGE_INFO("Fixed timestep: %u ticks per second, at most %u per frame.",
+             (u32)(OGE_NANOSECONDS_PER_SECOND / s_ogeState.loop.tickDuration),
+             s_ogeState.loop.maxTicksPerFrame);
+  }
 }
 
 b8 ogeInit(const OgeApplication *application) {
@@ -61,14 +300,20 @@ b8 ogeInit(const OgeApplication *application) {
            OGE_VERSION_MINOR,
            OGE_VERSION_PATCH);
 
-  s_ogeState.application = application;
+  s_ogeState.application        = application;
+  s_ogeState.pendingFramesStart = 0;
+  s_ogeState.pendingFramesEnd   = 0;
 
   if (!initSystems()) { return OGE_FALSE; }
+
+  initLoop(application->ogeInitInfo->loopInitInfo);
   
+  const u32 span = ogeStartupSpanBegin("application");
   if(!s_ogeState.application->init()) {
     OGE_FATAL("Failed to init OGE application.");
     return 1;
   }
+  ogeStartupSpanEnd(span);
   OGE_INFO("OGE application initialized.");
 
   s_ogeState.initialized = OGE_TRUE;
@@ -77,27 +322,184 @@ b8 ogeInit(const OgeApplication *application) {
   return OGE_TRUE;
 }
 
+static b8 updateApplicationTick(void *userData, const OgeFrameInfo *frameInfo) {
+  (void)userData;
+  return s_ogeState.application->update(frameInfo);
+}
+
+static OGE_INLINE b8 updateApplication(u64 frameTime) {
+  OGE_PROFILE_SCOPE("update");
+  return runUpdateLoop(&s_ogeState.loop, frameTime, updateApplicationTick, 0);
+}
+
+// Without a submit function the application renders on its own,
+// otherwise its render function builds a packet to submit
+static OGE_INLINE b8 renderApplication(u64 inputTime) {
+  OGE_PROFILE_SCOPE("render");
+
+  const OgeApplication *application = s_ogeState.application;
+  if (!application->submit) {
+    return application->render(&s_ogeState.loop.frameInfo);
+  }
+
+  if (!ogeRenderPacketsBegin(&s_ogeState.loop.frameInfo, inputTime)) {
+    return OGE_FALSE;
+  }
+
+  const b8 result = application->render(&s_ogeState.loop.frameInfo);
+  return ogeRenderPacketsEnd() && result;
+}
+
+static OGE_INLINE void setRendererTimings(OgeBenchmarkFrame *frame,
+                                          const OgeRendererFrameStats *stats) {
+  frame->gpuTime       = stats->gpuTime;
+  frame->fenceWaitTime = stats->fenceWaitTime;
+  frame->acquireTime   = stats->acquireTime;
+  frame->gpuTimeValid  = stats->gpuTimeValid;
+}
+
+// Matches completed packets with their frames, then reports frames
+// in order up to the first one still waiting for its packet
+static OGE_INLINE b8 reportPendingFrames() {
+  OgeRenderPacketCompletion completion;
+  while (ogeRenderPacketsPopCompletion(&completion)) {
+    for (u64 i = s_ogeState.pendingFramesStart;
+         i < s_ogeState.pendingFramesEnd; ++i) {
+      pendingFrame *frame =
+        &s_ogeState.pendingFrames[i % PENDING_FRAMES_CAPACITY];
+      if (frame->frameIndex == completion.frameIndex) {
+        setRendererTimings(&frame->timings, &completion.rendererStats);
+        frame->complete = OGE_TRUE;
+        break;
+      }
+    }
+  }
+
+  b8 result = OGE_TRUE;
+  while (s_ogeState.pendingFramesStart < s_ogeState.pendingFramesEnd) {
+    const pendingFrame *frame =
+      &s_ogeState.pendingFrames[s_ogeState.pendingFramesStart %
+                                PENDING_FRAMES_CAPACITY];
+    if (!frame->complete) { break; }
+
+    result = ogeBenchmarkEndFrame(&frame->timings) && result;
+    s_ogeState.pendingFramesStart += 1;
+  }
+  return result;
+}
+
+// Renderer timings are zeroed if the engine runs without renderer.
+// With render packets they're taken from the completion record of
+// the frame packet, the render thread may still be rendering it.
+static OGE_INLINE b8 recordBenchmarkFrame(u64 frameStart, b8 rendered) {
+  const u64 endTime = ogeClockNow();
+
+  OgeBenchmarkFrame timings = {
+    .endTime = endTime,
+    .cpuTime = endTime - frameStart,
+  };
+
+  if (!s_ogeState.application->submit) {
+    setRendererTimings(&timings, ogeRendererGetFrameStats());
+    return ogeBenchmarkEndFrame(&timings);
+  }
+
+  // A frame can't wait longer than its packet could, if it does
+  // its packet completion was lost and it's reported without it
+  b8 result = OGE_TRUE;
+  if (s_ogeState.pendingFramesEnd - s_ogeState.pendingFramesStart ==
+      PENDING_FRAMES_CAPACITY) {
+    result = ogeBenchmarkEndFrame(
+      &s_ogeState.pendingFrames[s_ogeState.pendingFramesStart %
+                                PENDING_FRAMES_CAPACITY].timings);
+    s_ogeState.pendingFramesStart += 1;
+  }
+
+  // The frame index was already advanced to the next frame
+  s_ogeState.pendingFrames[s_ogeState.pendingFramesEnd %
+                           PENDING_FRAMES_CAPACITY] = (pendingFrame){
+    .frameIndex = s_ogeState.loop.frameInfo.frameIndex - 1,
+    .complete   = !rendered,
+    .timings    = timings,
+  };
+  s_ogeState.pendingFramesEnd += 1;
+
+  return reportPendingFrames() && result;
+}
+
 void ogeRun() {
   OGE_INFO("Entering main cycle.");
+
+  // Time to the first frame is counted up to its end
+  const u32 firstFrameSpan = ogeStartupSpanBegin("first frame");
+  u64 previousTime = ogeClockNow();
+
   while (!s_ogeState.terminateRequested &&
          !ogePlatformAppShouldClose()) {
-    ogePlatformPumpMessages();
+    OGE_PROFILE_SCOPE("frame");
+    ogeRecorderBeginFrame();
 
-    if (!s_ogeState.application->update()) {
+    const u64 currentTime = ogeClockNow();
+    u64 frameTime = OGE_MIN(currentTime - previousTime,
+                            s_ogeState.loop.maxFrameTime);
+    previousTime = currentTime;
+
+    // The frame marker precedes the pump, so pumped events are
+    // recorded into the frame they're handled in
+    if (!ogeReplayBeginFrame(&frameTime)) { break; }
+
+    // Replay playback feeds input instead of the platform layer
+    if (ogeReplayGetMode() != OGE_REPLAY_MODE_PLAYBACK) {
+      OGE_PROFILE_BEGIN("message pump");
+      ogePlatformPumpMessages();
+      OGE_PROFILE_END();
+    }
+
+    ogeReplayEndInput();
+
+    ogeInputBeginFrame();
+    ogeActionsUpdate();
+
+    if (!updateApplication(frameTime)) {
       OGE_ERROR("Failed on OGE application update function call.");
       break;
     }
 
+    if (!ogeTasksRun(&s_ogeState.loop.frameInfo)) {
+      OGE_ERROR("Failed on OGE frame tasks run.");
+      break;
+    }
 
-    if (!s_ogeState.application->render()) {
+    // There's nothing to present to while minimized
+    const b8 rendered = !ogeLimiterIsHidden();
+    if (rendered && !renderApplication(currentTime)) {
       OGE_ERROR("Failed on OGE application render function call.");
       break;
     }
 
     ogeInputUpdate();
+    ogeLoggingUpdate();
+
+    s_ogeState.loop.frameInfo.frameIndex += 1;
+
+#ifdef OGE_EVENTS_STATS
+    ogeEventsStatsUpdate();
+#endif
+
+    ogeProfilerEndFrame();
+
+    if (s_ogeState.loop.frameInfo.frameIndex == 1) {
+      ogeStartupSpanEnd(firstFrameSpan);
+      ogeStartupFinish(s_ogeState.application->ogeInitInfo->startupInitInfo);
+    }
+
+    if (!recordBenchmarkFrame(currentTime, rendered)) { break; }
+
+    ogeLimiterWait();
   }
   OGE_INFO("Quitting main cycle.");
 
+  ogeRenderPacketsFlush();
   ogeRendererWaitIdle();
 }
 
@@ -118,3 +520,7 @@ void ogeTerminate() {
 void ogeRequestTerminate() {
   s_ogeState.terminateRequested = OGE_TRUE;
 }
+
+const OgeFrameInfo* ogeGetFrameInfo() {
+  return &s_ogeState.loop.frameInfo;
+}
@@ -1,17 +1,58 @@
+#define OGE_LOG_CATEGORY EVENTS
+
 #include "oge/defines.h"
+#include "oge/core/clock.h"
 #include "oge/core/memory.h"
 #include "oge/core/events.h"
+#include "oge/core/replay.h"
 #include "oge/core/logging.h"
+#include "oge/core/recorder.h"
 #include "oge/core/assertion.h"
 #include "oge/containers/darray.h"
 
 #define MAX_EVENT_CODES 1024
 
+#ifdef OGE_EVENTS_STATS
+#ifndef OGE_EVENTS_STATS_LOG_PERIOD
+  #define OGE_EVENTS_STATS_LOG_PERIOD (10 * OGE_NANOSECONDS_PER_SECOND)
+#endif
+#endif
+
+// Callback arrays are allocated on the first subscription, so
+// a context costs little until it's used
+struct OgeEventsContext {
+  OgeEventCallback* callbacks[MAX_EVENT_CODES]; // darrays
+#ifdef OGE_EVENTS_STATS
+  OgeEventStats stats[MAX_EVENT_CODES];
+  OgeEventCallbackStats* callbackStats[MAX_EVENT_CODES]; // darrays,
+                                                         // parallel to
+                                                         // callbacks
+#endif
+};
+
 static struct {
   b8 initialized;
-  OgeEventCallback* callbacks[MAX_EVENT_CODES]; // darrays
+  OgeEventsContext context;
+#ifdef OGE_EVENTS_STATS
+  u64 lastLogTime;
+#endif
 } s_eventsState = { .initialized = OGE_FALSE };
 
+OGE_INLINE void initContext(OgeEventsContext *context) {
+  ogeMemSet(context, 0, sizeof(*context));
+}
+
+OGE_INLINE void terminateContext(OgeEventsContext *context) {
+  for(u16 i = 0; i < MAX_EVENT_CODES; ++i) {
+    if (context->callbacks[i]) { ogeDArrayFree(context->callbacks[i]); }
+#ifdef OGE_EVENTS_STATS
+    if (context->callbackStats[i]) {
+      ogeDArrayFree(context->callbackStats[i]);
+    }
+#endif
+  }
+}
+
 void ogeEventsInit() {
   OGE_ASSERT(
     !s_eventsState.initialized,
@@ -19,11 +60,11 @@ void ogeEventsInit() {
   );
 
   s_eventsState.initialized = OGE_TRUE;
+  initContext(&s_eventsState.context);
 
-  // Allocate DArray for each event code
-  for(u16 i = 0; i < MAX_EVENT_CODES; ++i) {
-    s_eventsState.callbacks[i] = ogeDArrayAlloc(2, sizeof(OgeEventCallback));
-  }
+#ifdef OGE_EVENTS_STATS
+  s_eventsState.lastLogTime = ogeClockNow();
+#endif
 
   OGE_INFO("Events system initialized.");
 }
@@ -35,37 +76,221 @@ void ogeEventsTerminate() {
   );
 
   s_eventsState.initialized = OGE_FALSE;
+  terminateContext(&s_eventsState.context);
 
-  // Deallocate DArray for each event code
-  for(u16 i = 0; i < MAX_EVENT_CODES; ++i) {
-    ogeDArrayFree(s_eventsState.callbacks[i]);
+  OGE_INFO("Events system terminated.");
+}
+
+OgeEventsContext* ogeEventsContextCreate() {
+  OgeEventsContext *context =
+    ogeAlloc(sizeof(OgeEventsContext), OGE_MEMORY_TAG_ARRAY);
+  initContext(context);
+  return context;
+}
+
+void ogeEventsContextDestroy(OgeEventsContext *context) {
+  terminateContext(context);
+  ogeFree(context);
+}
+
+void ogeEventsContextSubscribe(OgeEventsContext *context, u16 code,
+                               OgeEventCallback callback) {
+  if (!context->callbacks[code]) {
+    context->callbacks[code] = ogeDArrayAlloc(2, sizeof(OgeEventCallback));
+#ifdef OGE_EVENTS_STATS
+    context->callbackStats[code] =
+      ogeDArrayAlloc(2, sizeof(OgeEventCallbackStats));
+#endif
   }
 
-  OGE_INFO("Events system terminated.");
+  context->callbacks[code] =
+    ogeDArrayAppend(context->callbacks[code], &callback);
+
+#ifdef OGE_EVENTS_STATS
+  const OgeEventCallbackStats callbackStats = { .callback = callback };
+  context->callbackStats[code] =
+    ogeDArrayAppend(context->callbackStats[code], &callbackStats);
+#endif
+  OGE_TRACE("Subscribed %p callback for %d event.", &callback, code);
+}
+
+void ogeEventsContextUnsubscribe(OgeEventsContext *context, u16 code,
+                                 OgeEventCallback callback) {
+  if (!context->callbacks[code]) { return; }
+
+  u64 index = ogeDArrayFind(context->callbacks[code], &callback);
+
+  if (index == -1) { return; }
+  ogeDArrayRemove(context->callbacks[code], index);
+#ifdef OGE_EVENTS_STATS
+  ogeDArrayRemove(context->callbackStats[code], index);
+#endif
+  OGE_TRACE("Unsubscribed %p callback for %d event.", &callback, code);
+}
+
+// Callback arrays are 0 until an event gets a subscriber
+OGE_INLINE u64 getCallbacksCount(const OgeEventCallback *callbacks) {
+  return callbacks ? ogeDArrayLength(callbacks) : 0;
+}
+
+// Returns an index of an invoked callback or -1 if it unsubscribed.
+// Unsubscription only shifts callbacks down and subscription appends
+// them, so the callback is at its index or below it.
+OGE_INLINE u64 findInvokedCallback(const OgeEventCallback *callbacks,
+                                   u64 index, OgeEventCallback callback) {
+  for (u64 i = OGE_MIN(index + 1, getCallbacksCount(callbacks)); i-- > 0;) {
+    if (callbacks[i] == callback) { return i; }
+  }
+  return -1;
+}
+
+void ogeEventsContextInvoke(OgeEventsContext *context, u16 code,
+                            void *invoker, OgeEventData data) {
+#ifdef OGE_EVENTS_STATS
+  const u64 startTime = ogeClockNow();
+  u64 callbackStartTime = startTime;
+#endif
+
+  // Arrays are re-read on every iteration, callbacks may subscribe
+  // (reallocating them) or unsubscribe (shifting them) while an
+  // event is dispatched
+  u64 i = 0;
+  while (i < getCallbacksCount(context->callbacks[code])) {
+    const OgeEventCallback callback = context->callbacks[code][i];
+    const b8 handled = callback(invoker, data);
+
+    const u64 index = findInvokedCallback(context->callbacks[code], i,
+                                          callback);
+
+#ifdef OGE_EVENTS_STATS
+    // End of the one callback is the start of the next one
+    const u64 callbackEndTime = ogeClockNow();
+    const u64 callbackTime    = callbackEndTime - callbackStartTime;
+    callbackStartTime = callbackEndTime;
+
+    if (index != -1) {
+      OgeEventCallbackStats *callbackStats =
+        &context->callbackStats[code][index];
+      callbackStats->callCount += 1;
+      callbackStats->totalTime += callbackTime;
+      callbackStats->maxTime    =
+        OGE_MAX(callbackStats->maxTime, callbackTime);
+    }
+#endif
+
+    // If event was processed - stop
+    if (handled) { break; }
+
+    // A callback that unsubscribed itself left the next one at its
+    // index
+    if (index != -1) { i = index + 1; }
+  }
+
+#ifdef OGE_EVENTS_STATS
+  const u64 dispatchTime = callbackStartTime - startTime;
+  OgeEventStats *stats = &context->stats[code];
+
+  stats->invokeCount     += 1;
+  stats->subscriberCount  = getCallbacksCount(context->callbacks[code]);
+  stats->totalTime       += dispatchTime;
+  stats->maxTime          = OGE_MAX(stats->maxTime, dispatchTime);
+#endif
 }
 
 void ogeEventsSubscribe(u16 code, OgeEventCallback callback) {
   OGE_ASSERT(s_eventsState.initialized, "Trying to subscribe a callback to an event while events system is offline.");
-  ogeDArrayAppend(s_eventsState.callbacks[code], &callback);
-  OGE_TRACE("Subscribed %p callback for %d event.", &callback, code);
+  ogeEventsContextSubscribe(&s_eventsState.context, code, callback);
 }
 
 void ogeEventsUnsubscribe(u16 code, OgeEventCallback callback) {
   OGE_ASSERT(s_eventsState.initialized, "Trying to unsubscribe a callback from an event while events system is offline.");
-  u64 index = ogeDArrayFind(s_eventsState.callbacks[code], &callback);
-
-  if (index == -1) { return; }
-  ogeDArrayRemove(s_eventsState.callbacks[code], index);
-  OGE_TRACE("Unsubscribed %p callback for %d event.", &callback, code);
+  ogeEventsContextUnsubscribe(&s_eventsState.context, code, callback);
 }
 
+// Only the process events are recorded, they're the ones coming
+// from the platform layer
 void ogeEventsInvoke(u16 code, void *invoker, OgeEventData data) {
-  const u64 callbacksCount =
-    ogeDArrayLength(s_eventsState.callbacks[code]);
-  for (u64 i = 0; i < callbacksCount; ++i) {
-    const OgeEventCallback callback = s_eventsState.callbacks[code][i];
+  ogeRecorderEvent(code);
+  ogeReplayRecordEvent(code, data);
 
-    // If event was processed - stop
-    if(callback(invoker, data)) { return; }
+  ogeEventsContextInvoke(&s_eventsState.context, code, invoker, data);
+}
+
+#ifdef OGE_EVENTS_STATS
+// Callback statistics arrays are 0 until an event gets a subscriber
+OGE_INLINE u64 getCallbackStatsCount(const OgeEventCallbackStats *stats) {
+  return stats ? ogeDArrayLength(stats) : 0;
+}
+
+const OgeEventStats* ogeEventsGetStats(u16 code) {
+  return &s_eventsState.context.stats[code];
+}
+
+const OgeEventCallbackStats* ogeEventsGetCallbackStats(
+  u16 code, u64 *count) {
+  OgeEventCallbackStats *callbackStats =
+    s_eventsState.context.callbackStats[code];
+  *count = getCallbackStatsCount(callbackStats);
+  return callbackStats;
+}
+
+void ogeEventsResetStats() {
+  OgeEventsContext *context = &s_eventsState.context;
+  ogeMemSet(context->stats, 0, sizeof(context->stats));
+
+  for (u16 i = 0; i < MAX_EVENT_CODES; ++i) {
+    OgeEventCallbackStats *callbackStats = context->callbackStats[i];
+    const u64 count = getCallbackStatsCount(callbackStats);
+
+    for (u64 j = 0; j < count; ++j) {
+      callbackStats[j].callCount = 0;
+      callbackStats[j].totalTime = 0;
+      callbackStats[j].maxTime   = 0;
+    }
+  }
+}
+
+void ogeEventsLogStats() {
+  OGE_INFO("Events statistics:");
+
+  for (u16 code = 0; code < MAX_EVENT_CODES; ++code) {
+    const OgeEventStats *stats = &s_eventsState.context.stats[code];
+    if (stats->invokeCount == 0) { continue; }
+
+    // Find the slowest callback by it's cumulative time
+    const OgeEventCallbackStats *callbackStats =
+      s_eventsState.context.callbackStats[code];
+    const u64 callbacksCount = getCallbackStatsCount(callbackStats);
+
+    const OgeEventCallbackStats *slowest = 0;
+    for (u64 i = 0; i < callbacksCount; ++i) {
+      if (!slowest || callbackStats[i].totalTime > slowest->totalTime) {
+        slowest = &callbackStats[i];
+      }
+    }
+
+    OGE_INFO("\t➜ Event %d: %llu invokes, %llu subscribers, total %.3f ms, avg %.3f us, max %.3f us",
+             code, stats->invokeCount, stats->subscriberCount,
+             OGE_NS_TO_MILLISECONDS(stats->totalTime),
+             OGE_NS_TO_MICROSECONDS(stats->totalTime) / stats->invokeCount,
+             OGE_NS_TO_MICROSECONDS(stats->maxTime));
+
+    if (slowest && slowest->callCount > 0) {
+      OGE_INFO("\t  slowest callback %p: %llu calls, total %.3f ms, max %.3f us",
+               (void*)slowest->callback, slowest->callCount,
+               OGE_NS_TO_MILLISECONDS(slowest->totalTime),
+               OGE_NS_TO_MICROSECONDS(slowest->maxTime));
+    }
   }
 }
+
+void ogeEventsStatsUpdate() {
+  const u64 time = ogeClockNow();
+  if (time - s_eventsState.lastLogTime < OGE_EVENTS_STATS_LOG_PERIOD) {
+    return;
+  }
+
+  s_eventsState.lastLogTime = time;
+  ogeEventsLogStats();
+}
+#endif
@@ -0,0 +1,40 @@
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "oge/defines.h"
+#include "oge/core/file.h"
+
+b8 ogeFileMap(const char *fileName, OgeFileMapping *mapping) {
+  mapping->data = 0;
+  mapping->size = 0;
+
+  const int fd = open(fileName, O_RDONLY);
+  if (fd < 0) { return OGE_FALSE; }
+
+  struct stat status;
+  if (fstat(fd, &status) != 0 || status.st_size <= 0) {
+    close(fd);
+    return OGE_FALSE;
+  }
+
+  // The mapping keeps the file referenced, so the descriptor isn't
+  // needed after it's made
+  void *data = mmap(0, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+
+  if (data == MAP_FAILED) { return OGE_FALSE; }
+
+  mapping->data = data;
+  mapping->size = status.st_size;
+  return OGE_TRUE;
+}
+
+void ogeFileUnmap(OgeFileMapping *mapping) {
+  if (!mapping->data) { return; }
+
+  munmap((void*)mapping->data, mapping->size);
+  mapping->data = 0;
+  mapping->size = 0;
+}
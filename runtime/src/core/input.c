@@ -1,19 +1,47 @@
+#define OGE_LOG_CATEGORY INPUT
+
+#include <string.h>
+
 #include <opl/opl.h>
 
 #include "oge/defines.h"
 #include "oge/core/input.h"
 #include "oge/core/memory.h"
+#include "oge/core/replay.h"
 #include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/platform.h"
 #include "oge/core/assertion.h"
 
 static struct {
   b8                      initialized;
   const OplKeyboardState *keyboardStateCurrent;
-  OplKeyboardState        keyboardStatePrevious;
   const OplMouseState    *mouseStateCurrent;
   OplMouseState           mouseStatePrevious;
 } s_inputState = { .initialized = OGE_FALSE };
 
+OgeInputBits g_ogeInputBits;
+
+// Packs an array of 0/1 bytes into bits, 8 bytes at a time.
+// Multiplying by the magic gathers the lowest bit of every byte
+// into the highest byte (little endian only).
+OGE_INLINE void packBits(const void *bytes, u64 count, u64 *bits) {
+  const u8 *values = bytes;
+  ogeMemSet(bits, 0, ((count + 63) / 64) * sizeof(u64));
+
+  u64 i = 0;
+  for (; i + 8 <= count; i += 8) {
+    u64 chunk;
+    memcpy(&chunk, values + i, sizeof(chunk));
+    const u64 packed = (chunk * 0x0102040810204080ULL) >> 56;
+    bits[i / 64] |= packed << (i % 64);
+  }
+
+  for (; i < count; ++i) {
+    if (values[i]) { bits[i / 64] |= 1ULL << (i % 64); }
+  }
+}
+
 void ogeInputInit() {
   OGE_ASSERT(
     !s_inputState.initialized,
@@ -21,9 +49,16 @@ void ogeInputInit() {
   );
 
   ogeMemSet(&s_inputState, 0, sizeof(s_inputState));
+  ogeMemSet(&g_ogeInputBits, 0, sizeof(g_ogeInputBits));
   s_inputState.initialized = OGE_TRUE;
-  s_inputState.keyboardStateCurrent = oplKeyboardGetState();
-  s_inputState.mouseStateCurrent = oplMouseGetState();
+
+  if (ogeReplayGetMode() == OGE_REPLAY_MODE_PLAYBACK) {
+    s_inputState.keyboardStateCurrent = ogeReplayGetKeyboardState();
+    s_inputState.mouseStateCurrent    = ogeReplayGetMouseState();
+  } else {
+    s_inputState.keyboardStateCurrent = ogePlatformGetKeyboardState();
+    s_inputState.mouseStateCurrent    = ogePlatformGetMouseState();
+  }
 
   OGE_INFO("Input system initialized.");
 }
@@ -39,51 +74,32 @@ void ogeInputTerminate() {
   OGE_INFO("Input system terminated.");
 }
 
-void ogeInputUpdate() {
-  // copy current states to previous
-  ogeMemCpy(&s_inputState.keyboardStatePrevious,
-            s_inputState.keyboardStateCurrent,
-            sizeof(OplKeyboardState));
-
-  ogeMemCpy(&s_inputState.mouseStatePrevious,
-            s_inputState.mouseStateCurrent,
-            sizeof(s_inputState.mouseStatePrevious));
-}
+void ogeInputBeginFrame() {
+  u64 keysDown[OGE_KEY_WORD_COUNT];
+  packBits(s_inputState.keyboardStateCurrent->keys, OGE_KEY_COUNT, keysDown);
 
-OGE_API b8 ogeKeyIsPressed(OplKey key) {
-  return s_inputState.keyboardStateCurrent->keys[key] &&
-         !s_inputState.keyboardStatePrevious.keys[key];
-}
+  u64 mouseButtonsDown;
+  packBits(s_inputState.mouseStateCurrent->buttons, OGE_MOUSE_BUTTON_COUNT,
+           &mouseButtonsDown);
 
-OGE_API b8 ogeKeyIsDown(OplKey key) {
-  return s_inputState.keyboardStateCurrent->keys[key];
-}
+  // Update frame bits, previous frame bits are the current ones
+  for (u32 word = 0; word < OGE_KEY_WORD_COUNT; ++word) {
+    g_ogeInputBits.keysChanged[word] =
+      g_ogeInputBits.keysDown[word] ^ keysDown[word];
+    g_ogeInputBits.keysDown[word] = keysDown[word];
+  }
 
-OGE_API b8 ogeKeyIsReleased(OplKey key) {
-  return !s_inputState.keyboardStateCurrent->keys[key] &&
-         s_inputState.keyboardStatePrevious.keys[key];
+  g_ogeInputBits.mouseButtonsChanged =
+    g_ogeInputBits.mouseButtonsDown ^ mouseButtonsDown;
+  g_ogeInputBits.mouseButtonsDown = mouseButtonsDown;
 }
 
-OGE_API b8 ogeKeyIsUp(OplKey key) {
-  return !s_inputState.keyboardStateCurrent->keys[key];
-}
-
-OGE_API b8 ogeMouseButtonIsPressed(OplMouseButton mouseButton) {
-  return s_inputState.mouseStateCurrent->buttons[mouseButton] &&
-         !s_inputState.mouseStatePrevious.buttons[mouseButton];
-}
-
-OGE_API b8 ogeMouseButtonIsDown(OplMouseButton mouseButton) {
-  return s_inputState.mouseStateCurrent->buttons[mouseButton];
-}
-
-OGE_API b8 ogeMouseButtonIsReleased(OplMouseButton mouseButton) {
-  return !s_inputState.mouseStateCurrent->buttons[mouseButton] &&
-         s_inputState.mouseStatePrevious.buttons[mouseButton];
-}
+void ogeInputUpdate() {
+  OGE_PROFILE_SCOPE("input update");
 
-OGE_API b8 ogeMouseButtonIsUp(OplMouseButton mouseButton) {
-  return !s_inputState.mouseStateCurrent->buttons[mouseButton];
+  // Keys and buttons are tracked by the input bits, only cursor
+  // position is needed for the delta
+  s_inputState.mouseStatePrevious = *s_inputState.mouseStateCurrent;
 }
 
 OGE_API i8 ogeMouseGetWheel() {
@@ -0,0 +1,393 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdatomic.h>
+
+#include "oge/core/jobs.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/thread.h"
+#include "oge/core/logging.h"
+#include "oge/core/assertion.h"
+
+// Idle workers spin, then yield and only then go to sleep, so
+// jobs submitted a moment later don't pay for a wake up
+#define JOBS_SPIN_ROUNDS  64
+#define JOBS_YIELD_ROUNDS 16
+
+// How long a sleeping worker waits if nobody wakes it up
+#define JOBS_SLEEP_TIMEOUT (10 * OGE_NANOSECONDS_PER_MILLISECOND)
+
+#define JOBS_CACHE_LINE_SIZE 64
+
+// An index of threads the job system didn't start, it's never a
+// valid index since the deques array has a spare slot at the end
+#define JOBS_EXTERNAL_THREAD (OGE_JOBS_MAX_WORKERS + 1)
+
+typedef struct OgeJobEntry {
+  OgeJob         job;
+  OgeJobCounter *counter;
+} OgeJobEntry;
+
+// Chase-Lev work-stealing deque (Lê et al., "Correct and Efficient
+// Work-Stealing for Weak Memory Models"). The owner pushes and takes
+// at the bottom, thieves steal at the top. Top and bottom live on
+// separate cache lines, so the owner doesn't bounce with thieves.
+typedef struct OgeJobDeque {
+  _Alignas(JOBS_CACHE_LINE_SIZE) atomic_llong top;
+  _Alignas(JOBS_CACHE_LINE_SIZE) atomic_llong bottom;
+  OgeJobEntry *entries;
+  i64          mask;
+} OgeJobDeque;
+
+static struct {
+  b8  initialized;
+  u32 workerCount;
+  u32 threadCount; // Workers and the main thread
+
+  // A deque per thread and a shared one at threadCount for
+  // threads the job system didn't start
+  OgeJobDeque deques[OGE_JOBS_MAX_WORKERS + 2];
+  OgeMutex    sharedMutex;
+
+  OgeThread   workers[OGE_JOBS_MAX_WORKERS];
+  atomic_bool running;
+
+  atomic_uint  sleepingCount;
+  OgeMutex     sleepMutex;
+  OgeCondition sleepCondition;
+} s_jobsState = { .initialized = OGE_FALSE };
+
+static _Thread_local u32 t_threadIndex = JOBS_EXTERNAL_THREAD;
+static _Thread_local u32 t_randomState;
+
+OGE_INLINE void spinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ volatile("yield");
+#endif
+}
+
+static OGE_INLINE u32 nextRandom() {
+  // xorshift32, victims only need to differ between thieves
+  u32 x = t_randomState ? t_randomState : (u32)(u64)&t_randomState | 1;
+  x ^= x << 13;
+  x ^= x >> 17;
+  x ^= x << 5;
+  t_randomState = x;
+  return x;
+}
+
+static OGE_INLINE u32 dequeIndex() {
+  return t_threadIndex < s_jobsState.threadCount
+       ? t_threadIndex
+       : s_jobsState.threadCount;
+}
+
+/************************************************/
+/* work-stealing deque                          */
+/************************************************/
+OGE_INLINE b8 dequePush(OgeJobDeque *deque, const OgeJobEntry *entry) {
+  const i64 bottom = atomic_load_explicit(&deque->bottom,
+                                          memory_order_relaxed);
+  const i64 top    = atomic_load_explicit(&deque->top,
+                                          memory_order_acquire);
+  if (bottom - top > deque->mask) { return OGE_FALSE; }
+
+  deque->entries[bottom & deque->mask] = *entry;
+  atomic_thread_fence(memory_order_release);
+  atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+  return OGE_TRUE;
+}
+
+OGE_INLINE b8 dequeTake(OgeJobDeque *deque, OgeJobEntry *entry) {
+  const i64 bottom = atomic_load_explicit(&deque->bottom,
+                                          memory_order_relaxed) - 1;
+  atomic_store_explicit(&deque->bottom, bottom, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  i64 top = atomic_load_explicit(&deque->top, memory_order_relaxed);
+
+  if (top > bottom) {
+    atomic_store_explicit(&deque->bottom, bottom + 1,
+                          memory_order_relaxed);
+    return OGE_FALSE;
+  }
+
+  *entry = deque->entries[bottom & deque->mask];
+  if (top != bottom) { return OGE_TRUE; }
+
+  // The last entry, race thieves for it
+  const b8 won = atomic_compare_exchange_strong_explicit(
+    &deque->top, &top, top + 1,
+    memory_order_seq_cst, memory_order_relaxed);
+  atomic_store_explicit(&deque->bottom, bottom + 1, memory_order_relaxed);
+  return won;
+}
+
+OGE_INLINE b8 dequeSteal(OgeJobDeque *deque, OgeJobEntry *entry) {
+  i64 top = atomic_load_explicit(&deque->top, memory_order_acquire);
+  atomic_thread_fence(memory_order_seq_cst);
+  const i64 bottom = atomic_load_explicit(&deque->bottom,
+                                          memory_order_acquire);
+  if (top >= bottom) { return OGE_FALSE; }
+
+  *entry = deque->entries[top & deque->mask];
+  return atomic_compare_exchange_strong_explicit(
+    &deque->top, &top, top + 1,
+    memory_order_seq_cst, memory_order_relaxed);
+}
+
+OGE_INLINE b8 dequeEmpty(OgeJobDeque *deque) {
+  return atomic_load(&deque->top) >= atomic_load(&deque->bottom);
+}
+
+/************************************************/
+/* running jobs                                 */
+/************************************************/
+OGE_INLINE void runEntry(const OgeJobEntry *entry) {
+  entry->job.function(entry->job.data);
+
+  if (entry->counter) {
+    __atomic_sub_fetch(&entry->counter->value, 1, __ATOMIC_RELEASE);
+  }
+}
+
+// Takes a job from the calling thread deque or steals one from
+// a random victim and runs it
+static b8 runJob() {
+  const u32 index      = dequeIndex();
+  const u32 dequeCount = s_jobsState.threadCount + 1;
+  OgeJobEntry entry;
+
+  // Only the job system threads own their deques, the shared one
+  // is only pushed to under a lock and stolen from
+  if (index < s_jobsState.threadCount &&
+      dequeTake(&s_jobsState.deques[index], &entry)) {
+    runEntry(&entry);
+    return OGE_TRUE;
+  }
+
+  const u32 start = nextRandom() % dequeCount;
+  for (u32 i = 0; i < dequeCount; ++i) {
+    const u32 victim = (start + i) % dequeCount;
+    if (victim == index && index < s_jobsState.threadCount) { continue; }
+
+    if (dequeSteal(&s_jobsState.deques[victim], &entry)) {
+      runEntry(&entry);
+      return OGE_TRUE;
+    }
+  }
+
+  return OGE_FALSE;
+}
+
+static OGE_INLINE b8 anyJobs() {
+  for (u32 i = 0; i <= s_jobsState.threadCount; ++i) {
+    if (!dequeEmpty(&s_jobsState.deques[i])) { return OGE_TRUE; }
+  }
+  return OGE_FALSE;
+}
+
+static OGE_INLINE void wakeWorkers(u32 jobCount) {
+  // Pairs with the fence in sleepWorker, either a worker sees the
+  // pushed jobs or the sleeping count is seen here
+  atomic_thread_fence(memory_order_seq_cst);
+  if (!atomic_load_explicit(&s_jobsState.sleepingCount,
+                            memory_order_relaxed)) {
+    return;
+  }
+
+  ogeMutexLock(&s_jobsState.sleepMutex);
+  if (jobCount > 1) {
+    ogeConditionBroadcast(&s_jobsState.sleepCondition);
+  } else {
+    ogeConditionSignal(&s_jobsState.sleepCondition);
+  }
+  ogeMutexUnlock(&s_jobsState.sleepMutex);
+}
+
+static OGE_INLINE void sleepWorker() {
+  ogeMutexLock(&s_jobsState.sleepMutex);
+
+  atomic_fetch_add(&s_jobsState.sleepingCount, 1);
+  atomic_thread_fence(memory_order_seq_cst);
+
+  if (!anyJobs() && atomic_load(&s_jobsState.running)) {
+    ogeConditionWait(&s_jobsState.sleepCondition, &s_jobsState.sleepMutex,
+                     JOBS_SLEEP_TIMEOUT);
+  }
+
+  atomic_fetch_sub(&s_jobsState.sleepingCount, 1);
+  ogeMutexUnlock(&s_jobsState.sleepMutex);
+}
+
+static void workerThread(void *arg) {
+  t_threadIndex = (u32)(u64)arg;
+  t_randomState = 0x9E3779B9u * (t_threadIndex + 1);
+
+  u32 idleRounds = 0;
+  while (atomic_load_explicit(&s_jobsState.running, memory_order_relaxed)) {
+    if (runJob()) {
+      idleRounds = 0;
+    } else if (idleRounds < JOBS_SPIN_ROUNDS) {
+      ++idleRounds;
+      spinPause();
+    } else if (idleRounds < JOBS_SPIN_ROUNDS + JOBS_YIELD_ROUNDS) {
+      ++idleRounds;
+      ogeThreadYield();
+    } else {
+      sleepWorker();
+      idleRounds = 0;
+    }
+  }
+}
+
+/************************************************/
+/* job system                                   */
+/************************************************/
+b8 ogeJobsInit(const OgeJobsInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_jobsState.initialized,
+    "Trying to initialize job system while it's already initialized."
+  );
+
+  const OgeJobsInitInfo defaultInitInfo = { .workerCount = 0 };
+  if (!initInfo) { initInfo = &defaultInitInfo; }
+
+  u32 workerCount = initInfo->workerCount
+                  ? initInfo->workerCount
+                  : ogeThreadGetProcessorCount() - 1;
+  workerCount = OGE_MIN(workerCount, OGE_JOBS_MAX_WORKERS);
+
+  u64 capacity = 1;
+  while (capacity < (initInfo->queueCapacity
+                     ? initInfo->queueCapacity
+                     : OGE_JOBS_DEFAULT_QUEUE_CAPACITY)) {
+    capacity <<= 1;
+  }
+
+  s_jobsState.threadCount = workerCount + 1;
+
+  for (u32 i = 0; i <= s_jobsState.threadCount; ++i) {
+    OgeJobDeque *deque = &s_jobsState.deques[i];
+    atomic_init(&deque->top, 0);
+    atomic_init(&deque->bottom, 0);
+    deque->entries = ogeAlloc(capacity * sizeof(OgeJobEntry),
+                              OGE_MEMORY_TAG_ARRAY);
+    deque->mask    = (i64)capacity - 1;
+  }
+
+  ogeMutexCreate(&s_jobsState.sharedMutex);
+  ogeMutexCreate(&s_jobsState.sleepMutex);
+  ogeConditionCreate(&s_jobsState.sleepCondition);
+  atomic_init(&s_jobsState.sleepingCount, 0);
+  atomic_init(&s_jobsState.running, OGE_TRUE);
+
+  t_threadIndex = 0;
+  t_randomState = 0x9E3779B9u;
+
+  s_jobsState.workerCount = 0;
+  for (u32 i = 0; i < workerCount; ++i) {
+    if (!ogeThreadCreate(&s_jobsState.workers[i], workerThread,
+                         (void*)(u64)(i + 1))) {
+      OGE_WARN("Failed to create job worker thread, running with %u.", i);
+      break;
+    }
+    s_jobsState.workerCount += 1;
+  }
+
+  s_jobsState.initialized = OGE_TRUE;
+
+  OGE_INFO("Job system initialized with %u worker threads.",
+           s_jobsState.workerCount);
+  return OGE_TRUE;
+}
+
+void ogeJobsTerminate() {
+  OGE_ASSERT(
+    s_jobsState.initialized,
+    "Trying to terminate job system while it's already terminated."
+  );
+
+  atomic_store(&s_jobsState.running, OGE_FALSE);
+
+  ogeMutexLock(&s_jobsState.sleepMutex);
+  ogeConditionBroadcast(&s_jobsState.sleepCondition);
+  ogeMutexUnlock(&s_jobsState.sleepMutex);
+
+  for (u32 i = 0; i < s_jobsState.workerCount; ++i) {
+    ogeThreadJoin(&s_jobsState.workers[i]);
+  }
+
+  for (u32 i = 0; i <= s_jobsState.threadCount; ++i) {
+    ogeFree(s_jobsState.deques[i].entries);
+  }
+
+  ogeConditionDestroy(&s_jobsState.sleepCondition);
+  ogeMutexDestroy(&s_jobsState.sleepMutex);
+  ogeMutexDestroy(&s_jobsState.sharedMutex);
+
+  t_threadIndex = JOBS_EXTERNAL_THREAD;
+  s_jobsState.initialized = OGE_FALSE;
+
+  OGE_INFO("Job system terminated.");
+}
+
+/************************************************/
+/* jobs                                         */
+/************************************************/
+void ogeJobsSubmit(const OgeJob *jobs, u32 count, OgeJobCounter *counter) {
+  OGE_ASSERT(s_jobsState.initialized, "Job system isn't initialized.");
+
+  if (counter) {
+    __atomic_add_fetch(&counter->value, count, __ATOMIC_RELAXED);
+  }
+
+  const u32 index  = dequeIndex();
+  const b8  shared = index == s_jobsState.threadCount;
+  OgeJobDeque *deque = &s_jobsState.deques[index];
+
+  if (shared) { ogeMutexLock(&s_jobsState.sharedMutex); }
+
+  u32 pushed = 0;
+  if (s_jobsState.workerCount) {
+    for (; pushed < count; ++pushed) {
+      const OgeJobEntry entry = { .job = jobs[pushed], .counter = counter };
+      if (!dequePush(deque, &entry)) { break; }
+    }
+  }
+
+  if (shared) { ogeMutexUnlock(&s_jobsState.sharedMutex); }
+
+  if (pushed) { wakeWorkers(pushed); }
+
+  // Nobody to hand the rest to or no room for it
+  for (u32 i = pushed; i < count; ++i) {
+    const OgeJobEntry entry = { .job = jobs[i], .counter = counter };
+    runEntry(&entry);
+  }
+}
+
+void ogeJobsWait(OgeJobCounter *counter) {
+  OGE_ASSERT(s_jobsState.initialized, "Job system isn't initialized.");
+
+  u32 idleRounds = 0;
+  while (__atomic_load_n(&counter->value, __ATOMIC_ACQUIRE)) {
+    if (runJob()) {
+      idleRounds = 0;
+    } else if (++idleRounds < JOBS_SPIN_ROUNDS) {
+      spinPause();
+    } else {
+      // The rest of the jobs are running on other threads
+      ogeThreadYield();
+    }
+  }
+}
+
+u32 ogeJobsGetThreadCount() {
+  return s_jobsState.threadCount;
+}
+
+u32 ogeJobsGetThreadIndex() {
+  return dequeIndex();
+}
@@ -0,0 +1,272 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <math.h>
+
+#include "oge/core/clock.h"
+#include "oge/core/events.h"
+#include "oge/core/memory.h"
+#include "oge/core/thread.h"
+#include "oge/core/limiter.h"
+#include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/assertion.h"
+
+// Bounds of the time spent spinning before a deadline, the
+// window starts at the maximum and follows sleep overshoots
+#define LIMITER_MIN_SPIN_WINDOW  (50 * OGE_NANOSECONDS_PER_MICROSECOND)
+#define LIMITER_MAX_SPIN_WINDOW  (2 * OGE_NANOSECONDS_PER_MILLISECOND)
+#define LIMITER_SPIN_MARGIN      (100 * OGE_NANOSECONDS_PER_MICROSECOND)
+
+// Every wait the overshoot peak decays by 1/LIMITER_PEAK_DECAY,
+// so a single scheduler hiccup doesn't keep the window wide
+#define LIMITER_PEAK_DECAY 64
+
+// Frames starting later than that after their deadline are missed
+#define LIMITER_LATENESS_TOLERANCE (50 * OGE_NANOSECONDS_PER_MICROSECOND)
+
+static struct {
+  b8 initialized;
+  b8 hidden;
+  b8 focused;
+
+  // All of the times are in nanoseconds, 0 frame time is unlimited
+  u64 targetFrameTime;
+  u64 backgroundFrameTime;
+  u64 hiddenFrameTime;
+
+  u64 deadline;
+  u64 previousFrameStart;
+  u64 spinWindow;
+  u64 overshootPeak;
+
+  OgeLimiterStats stats;
+  f64 frameTimeM2; // Welford's sum of squared differences
+} s_limiterState = { .initialized = OGE_FALSE };
+
+OGE_INLINE u64 frameRateToTime(u32 frameRate) {
+  return frameRate ? OGE_NANOSECONDS_PER_SECOND / frameRate : 0;
+}
+
+OGE_INLINE void spinPause() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  __asm__ volatile("yield");
+#endif
+}
+
+// Throttled frame times never run faster than the target one
+static OGE_INLINE u64 currentFrameTime() {
+  if (s_limiterState.hidden) {
+    return OGE_MAX(s_limiterState.hiddenFrameTime,
+                   s_limiterState.targetFrameTime);
+  }
+  if (!s_limiterState.focused) {
+    return OGE_MAX(s_limiterState.backgroundFrameTime,
+                   s_limiterState.targetFrameTime);
+  }
+  return s_limiterState.targetFrameTime;
+}
+
+// Drops the schedule, the next wait starts a new one from its
+// own time instead of sleeping off or rushing through a backlog
+static OGE_INLINE void resetDeadline() {
+  s_limiterState.deadline = 0;
+}
+
+static b8 onMinimize(void *invoker, OgeEventData data) {
+  s_limiterState.hidden = OGE_TRUE;
+  resetDeadline();
+  OGE_TRACE("Application hidden, throttling to %u FPS.",
+            (u32)(OGE_NANOSECONDS_PER_SECOND / currentFrameTime()));
+  return OGE_FALSE;
+}
+
+static b8 onRestore(void *invoker, OgeEventData data) {
+  s_limiterState.hidden = OGE_FALSE;
+  resetDeadline();
+  return OGE_FALSE;
+}
+
+static b8 onFocus(void *invoker, OgeEventData data) {
+  s_limiterState.focused = data.u8[0] != OGE_FALSE;
+  resetDeadline();
+  return OGE_FALSE;
+}
+
+void ogeLimiterInit(const OgeLimiterInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_limiterState.initialized,
+    "Trying to initialize frame limiter while it's already initialized."
+  );
+
+  const OgeLimiterInitInfo defaultInitInfo = { .targetFrameRate = 0 };
+  if (!initInfo) { initInfo = &defaultInitInfo; }
+
+  ogeMemSet(&s_limiterState, 0, sizeof(s_limiterState));
+
+  s_limiterState.focused             = OGE_TRUE;
+  s_limiterState.targetFrameTime     =
+    frameRateToTime(initInfo->targetFrameRate);
+  s_limiterState.backgroundFrameTime = frameRateToTime(
+    initInfo->backgroundFrameRate
+      ? initInfo->backgroundFrameRate
+      : OGE_LIMITER_DEFAULT_BACKGROUND_FRAME_RATE);
+  s_limiterState.hiddenFrameTime     = frameRateToTime(
+    initInfo->hiddenFrameRate
+      ? initInfo->hiddenFrameRate
+      : OGE_LIMITER_DEFAULT_HIDDEN_FRAME_RATE);
+  s_limiterState.spinWindow          = LIMITER_MAX_SPIN_WINDOW;
+
+  ogeEventsSubscribe(OGE_EVENT_APPLICATION_MINIMIZE, onMinimize);
+  ogeEventsSubscribe(OGE_EVENT_APPLICATION_MAXIMIZE, onRestore);
+  ogeEventsSubscribe(OGE_EVENT_APPLICATION_RESTORE,  onRestore);
+  ogeEventsSubscribe(OGE_EVENT_APPLICATION_FOCUS,    onFocus);
+
+  s_limiterState.initialized = OGE_TRUE;
+  ogeLimiterResetStats();
+
+  if (initInfo->targetFrameRate) {
+    OGE_INFO("Frame rate limited to %u FPS.", initInfo->targetFrameRate);
+  }
+  OGE_INFO("Frame limiter initialized.");
+}
+
+void ogeLimiterTerminate() {
+  OGE_ASSERT(
+    s_limiterState.initialized,
+    "Trying to terminate frame limiter while it's already terminated."
+  );
+
+  if (s_limiterState.targetFrameTime) { ogeLimiterLogStats(); }
+
+  ogeEventsUnsubscribe(OGE_EVENT_APPLICATION_MINIMIZE, onMinimize);
+  ogeEventsUnsubscribe(OGE_EVENT_APPLICATION_MAXIMIZE, onRestore);
+  ogeEventsUnsubscribe(OGE_EVENT_APPLICATION_RESTORE,  onRestore);
+  ogeEventsUnsubscribe(OGE_EVENT_APPLICATION_FOCUS,    onFocus);
+
+  s_limiterState.initialized = OGE_FALSE;
+
+  OGE_INFO("Frame limiter terminated.");
+}
+
+// Sleeps until the spin window before a deadline and widens
+// or narrows the window after the observed sleep overshoot
+static OGE_INLINE void sleepUntil(u64 deadline, u64 now) {
+  if (deadline - now <= s_limiterState.spinWindow) { return; }
+
+  const u64 sleepTime = deadline - now - s_limiterState.spinWindow;
+  ogeThreadSleep(sleepTime);
+
+  const u64 slept     = ogeClockNow() - now;
+  const u64 overshoot = slept > sleepTime ? slept - sleepTime : 0;
+
+  u64 peak = s_limiterState.overshootPeak;
+  peak -= peak / LIMITER_PEAK_DECAY;
+  peak  = OGE_MAX(peak, overshoot);
+  s_limiterState.overshootPeak = peak;
+
+  s_limiterState.spinWindow = OGE_MIN(
+    OGE_MAX(peak + LIMITER_SPIN_MARGIN, LIMITER_MIN_SPIN_WINDOW),
+    LIMITER_MAX_SPIN_WINDOW);
+}
+
+static OGE_INLINE void updateStats(u64 frameStart) {
+  OgeLimiterStats *stats = &s_limiterState.stats;
+
+  if (s_limiterState.previousFrameStart) {
+    const u64 frameTime = frameStart - s_limiterState.previousFrameStart;
+
+    stats->frameCount += 1;
+    stats->minFrameTime = OGE_MIN(stats->minFrameTime, frameTime);
+    stats->maxFrameTime = OGE_MAX(stats->maxFrameTime, frameTime);
+
+    const f64 delta = (f64)frameTime - stats->meanFrameTime;
+    stats->meanFrameTime += delta / (f64)stats->frameCount;
+    s_limiterState.frameTimeM2 +=
+      delta * ((f64)frameTime - stats->meanFrameTime);
+  }
+
+  s_limiterState.previousFrameStart = frameStart;
+}
+
+void ogeLimiterWait() {
+  OGE_PROFILE_SCOPE("limiter wait");
+
+  const u64 frameTime = currentFrameTime();
+  u64 now = ogeClockNow();
+
+  s_limiterState.stats.targetFrameTime = frameTime;
+
+  if (!frameTime) {
+    updateStats(now);
+    return;
+  }
+
+  if (!s_limiterState.deadline) { s_limiterState.deadline = now; }
+
+  // Deadlines are absolute, so an early or a late frame doesn't
+  // shift every frame after it
+  u64 deadline = s_limiterState.deadline + frameTime;
+
+  if (now < deadline) {
+    sleepUntil(deadline, now);
+    while ((now = ogeClockNow()) < deadline) { spinPause(); }
+  }
+
+  // Either the frame itself or the sleep took too long
+  const u64 lateness = now - deadline;
+  if (lateness > LIMITER_LATENESS_TOLERANCE) {
+    s_limiterState.stats.missedDeadlines += 1;
+    s_limiterState.stats.maxLateness =
+      OGE_MAX(s_limiterState.stats.maxLateness, lateness);
+
+    // Too late to catch up without a burst of unpaced frames
+    if (lateness > frameTime) { deadline = now; }
+  }
+
+  s_limiterState.deadline = deadline;
+  updateStats(now);
+}
+
+b8 ogeLimiterIsHidden() {
+  return s_limiterState.hidden;
+}
+
+void ogeLimiterSetTargetFrameRate(u32 frameRate) {
+  s_limiterState.targetFrameTime = frameRateToTime(frameRate);
+  resetDeadline();
+}
+
+const OgeLimiterStats* ogeLimiterGetStats() {
+  OgeLimiterStats *stats = &s_limiterState.stats;
+  stats->jitter = stats->frameCount > 1
+                ? sqrt(s_limiterState.frameTimeM2 /
+                       (f64)(stats->frameCount - 1))
+                : 0.0;
+  return stats;
+}
+
+void ogeLimiterResetStats() {
+  ogeMemSet(&s_limiterState.stats, 0, sizeof(s_limiterState.stats));
+  s_limiterState.stats.minFrameTime = (u64)-1;
+  s_limiterState.previousFrameStart = 0;
+  s_limiterState.frameTimeM2        = 0.0;
+}
+
+void ogeLimiterLogStats() {
+  const OgeLimiterStats *stats = ogeLimiterGetStats();
+  if (!stats->frameCount) { return; }
+
+  OGE_INFO("Frame pacing: %llu frames, target %.3f ms, mean %.3f ms, "
+           "min %.3f ms, max %.3f ms, jitter %.3f ms, "
+           "%llu missed deadlines (at most %.3f ms late).",
+           stats->frameCount,
+           OGE_NS_TO_MILLISECONDS(stats->targetFrameTime),
+           OGE_NS_TO_MILLISECONDS(stats->meanFrameTime),
+           OGE_NS_TO_MILLISECONDS(stats->minFrameTime),
+           OGE_NS_TO_MILLISECONDS(stats->maxFrameTime),
+           OGE_NS_TO_MILLISECONDS(stats->jitter),
+           stats->missedDeadlines,
+           OGE_NS_TO_MILLISECONDS(stats->maxLateness));
+}
@@ -1,50 +1,129 @@
+#define OGE_LOG_CATEGORY CORE
+
 #include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
 #include <stdarg.h>
+#include <stdatomic.h>
 
 #include <opl/opl.h>
 
+#include "oge/core/clock.h"
 #include "oge/core/memory.h"
+#include "oge/core/thread.h"
 #include "oge/core/logging.h"
+#include "oge/core/recorder.h"
 #include "oge/core/assertion.h"
+#include "oge/containers/darray.h"
 
-static struct {
-  b8 initialized;
-  OgeLogLevel logLevel;
-} s_loggingState = { .initialized = OGE_FALSE };
+// A size of a single queued log record, including it's header.
+// Longer messages are truncated.
+#define LOG_RECORD_SIZE 1024
 
-b8 ogeLoggingInit(const OgeLoggingInitInfo *pInitInfo) {
-  OGE_ASSERT(
-    !s_loggingState.initialized,
-    "Trying to initialize logging system while it's already initialized."
-  );
+// A number of records in the logging queue, must be a power of 2
+#define LOG_QUEUE_CAPACITY 1024
 
-  // TODO: create log file
+// How long the logging thread sleeps without a log file to flush,
+// producers wake it up as soon as they publish a record
+#define LOG_THREAD_IDLE_TIMEOUT OGE_NANOSECONDS_PER_SECOND
 
-  s_loggingState.initialized = OGE_TRUE;
-  s_loggingState.logLevel    = pInitInfo->logLevel;
+// How long the logging thread waits for a claimed record to be
+// published before it skips the record and reports it as lost,
+// e.g. when its producer was killed between the claim and publish
+#define LOG_RECORD_PUBLISH_TIMEOUT (250 * OGE_NANOSECONDS_PER_MILLISECOND)
 
-  OGE_INFO("Logging system initialized.");
+// A sequence of a skipped record, it's neither free nor filled, so
+// the record stays its producer's until the producer frees it
+#define LOG_RECORD_SKIPPED(position) ((position) + 2)
 
-  return OGE_TRUE;
-} 
+// Log file buffer size, the file is written in batches of this size
+// unless a flush interval elapses or an error is logged first
+#define LOG_FILE_BUFFER_SIZE OGE_KIBIBYTES(256)
 
-void ogeLoggingTerminate() {
-  OGE_ASSERT(
-    s_loggingState.initialized,
-    "Trying to terminate logging system while it's already terminated."
-  );
+// Maximum length of a log file name, including rotated file suffix
+#define LOG_FILE_NAME_MAX 256
 
-  s_loggingState.initialized = OGE_FALSE;
+// Size of a buffer deferred records are formatted into
+#define LOG_DEFERRED_MESSAGE_SIZE 4096
 
-  // TODO: write all queued entries and close file
+typedef struct OgeLogRecord {
+  // Vyukov's bounded queue cell sequence: equals to a cell position
+  // when the cell is free and to position + 1 when it's filled, or
+  // to LOG_RECORD_SKIPPED(position) when the logging thread skipped
+  // the cell before it was filled
+  atomic_ullong sequence;
+  u8            category;
+  u8            level;
+  // If set, message holds a format string pointer followed by
+  // captured arguments instead of a formatted message
+  b8            deferred;
+  char          message[LOG_RECORD_SIZE - sizeof(atomic_ullong) - 3];
+} OgeLogRecord;
 
-  OGE_INFO("Logging system terminated.");
-}
+// A registered rate limited call site
+typedef struct OgeLogSiteEntry {
+  OgeLogSite     *site;
+  const char     *format;
+  OgeLogCategory  category;
+  OgeLogLevel     level;
+} OgeLogSiteEntry;
 
-void ogeLog(OgeLogLevel level, const char *msg, ...) {
-  // TODO: These string operations are all pretty slow. This needs to be
-  // moved to another thread eventually, along with the file writes, to
-  // avoid slowing things down while the engine is trying to run.
+_OGE_STATIC_ASSERT(sizeof(OgeLogRecord) == LOG_RECORD_SIZE,
+                   "Expected log record to be LOG_RECORD_SIZE bytes.");
+_OGE_STATIC_ASSERT((LOG_QUEUE_CAPACITY & (LOG_QUEUE_CAPACITY - 1)) == 0,
+                   "Expected log queue capacity to be a power of 2.");
+_OGE_STATIC_ASSERT(LOG_RECORD_SKIPPED(0) < LOG_QUEUE_CAPACITY,
+                   "Expected skipped records to be told from free ones.");
+
+static struct {
+  b8 initialized;
+  OgeLogOverflowPolicy overflowPolicy;
+  b8 deferredFormatting;
+
+  // Multiple producers, single consumer (logging thread)
+  OgeLogRecord *records;
+  atomic_ullong enqueuePosition;
+  atomic_ullong dequeuePosition;
+  atomic_ullong droppedCount;
+  // Dequeue position + 1 of a record the logging thread waits to be
+  // published and when it started waiting, only it touches them
+  u64           stallPosition;
+  u64           stallTime;
+
+  OgeThread     thread;
+  atomic_bool   threadRunning;
+  atomic_bool   threadSleeping;
+  OgeMutex      mutex;
+  OgeCondition  condition;
+
+  // Guards the file, it's written by the logging thread and by
+  // synchronous (fatal) messages
+  OgeMutex         fileMutex;
+  FILE            *file;
+  char            *fileBuffer;
+  char             fileName[LOG_FILE_NAME_MAX];
+  OgeLogFileFormat fileFormat;
+  u64              fileSize;
+  u64              fileMaxSize;
+  u32              fileBackupCount;
+  u64              fileFlushInterval;
+  u64              fileFlushTime;
+  u64              startTime;
+
+  // Rate limited call sites, guarded by the sites mutex
+  OgeMutex         sitesMutex;
+  OgeLogSiteEntry *sites;
+  u64              repeatPeriod;
+  u64              repeatReportTime;
+} s_loggingState = { .initialized = OGE_FALSE };
+
+u8 g_ogeLogCategoryLevels[OGE_LOG_CATEGORY_MAX_ENUM];
+
+/************************************************
+ *                   output                     *
+ ************************************************/
+static void writeConsole(OgeLogLevel level, const char *message) {
   static const char* levelPrefixes[5] = {
     " >", " ℹ", " WARNING ", "  ERROR  ", "  FATAL  ",
   };
@@ -65,31 +144,12 @@ void ogeLog(OgeLogLevel level, const char *msg, ...) {
     OPL_BG_COLOR_RED,
   };
 
-  if (level < s_loggingState.logLevel) { return; }
-
-  // Technically imposes a 4k character limit on a single
-  // log entry, but... DON'T DO THAT!
-  char outMessage[4096];
-  char formattedMessage[4096];
-  ogeMemSet(outMessage, 0, sizeof(outMessage));
-  ogeMemSet(formattedMessage, 0, sizeof(formattedMessage));
-
-  // Format original message.
-  // NOTE: Oddly enough, MS's headers override the GCC/Clang va_list type
-  // with a "typedef char* va_list" in some cases, and as a result throws
-  // a strange error here. The workaround for now is to just use
-  // __builtin_va_list, which is the type GCC/Clang's va_start expects.
-  __builtin_va_list valist;
-  va_start(valist, msg);
-  vsnprintf(formattedMessage, 4096, msg, valist);
-  va_end(valist);
-
   if (level > OGE_LOG_LEVEL_INFO) {
     oplConsoleWrite("\n");
     oplConsoleSetColor(fgColors[level], bgColors[level]);
     oplConsoleWrite("%s", levelPrefixes[level]);
     oplConsoleSetTextStyle(OPL_TEXT_STYLE_NORMAL);
-    oplConsoleWrite(" %s\n\n", formattedMessage);
+    oplConsoleWrite(" %s\n\n", message);
   } else {
     oplConsoleSetColor(fgColors[level], bgColors[level]);
     oplConsoleWrite(levelPrefixes[level]);
@@ -100,6 +160,959 @@ void ogeLog(OgeLogLevel level, const char *msg, ...) {
     else {
       oplConsoleSetTextStyle(OPL_TEXT_STYLE_NORMAL);
     }
-    oplConsoleWrite(" %s\n", formattedMessage);
+    oplConsoleWrite(" %s\n", message);
+  }
+}
+
+/************************************************
+ *                  log file                    *
+ ************************************************/
+static OGE_INLINE b8 openFile() {
+  s_loggingState.file = fopen(s_loggingState.fileName, "w");
+  if (!s_loggingState.file) { return OGE_FALSE; }
+
+  setvbuf(s_loggingState.file, s_loggingState.fileBuffer,
+          _IOFBF, LOG_FILE_BUFFER_SIZE);
+  s_loggingState.fileSize = 0;
+  return OGE_TRUE;
+}
+
+// Shifts "<name>.1" ... "<name>.N-1" one number up and
+// renames the current file to "<name>.1"
+static OGE_INLINE void shiftFileBackups() {
+  char from[LOG_FILE_NAME_MAX + 16];
+  char to[LOG_FILE_NAME_MAX + 16];
+
+  for (u32 i = s_loggingState.fileBackupCount - 1; i > 0; --i) {
+    snprintf(from, sizeof(from), "%s.%u", s_loggingState.fileName, i);
+    snprintf(to,   sizeof(to),   "%s.%u", s_loggingState.fileName, i + 1);
+    rename(from, to);
+  }
+
+  snprintf(to, sizeof(to), "%s.1", s_loggingState.fileName);
+  rename(s_loggingState.fileName, to);
+}
+
+static OGE_INLINE void rotateFile() {
+  fclose(s_loggingState.file);
+  shiftFileBackups();
+
+  if (!openFile()) {
+    writeConsole(OGE_LOG_LEVEL_ERROR,
+                 "Failed to reopen log file after rotation, file logging is disabled.");
+  }
+}
+
+static OGE_INLINE void flushFile(u64 now) {
+  fflush(s_loggingState.file);
+  s_loggingState.fileFlushTime = now;
+}
+
+static void writeFile(OgeLogCategory category, OgeLogLevel level,
+                      const char *message) {
+  static const char* levelNames[5] = {
+    "TRACE", "INFO ", "WARN ", "ERROR", "FATAL",
+  };
+
+  static const char* categoryNames[OGE_LOG_CATEGORY_MAX_ENUM] = {
+    "", "[core] ", "[platform] ", "[events] ", "[input] ", "[renderer] ",
+  };
+
+  static const char* ansiColors[5] = {
+    "\x1b[90m", "\x1b[92m", "\x1b[30;103m", "\x1b[97;41m", "\x1b[97;41m",
+  };
+
+  if (!s_loggingState.file) { return; }
+
+  ogeMutexLock(&s_loggingState.fileMutex);
+
+  // Rotation may have failed and closed the file
+  if (!s_loggingState.file) {
+    ogeMutexUnlock(&s_loggingState.fileMutex);
+    return;
+  }
+
+  const u64 now = ogeClockNow();
+  const f64 time = OGE_NS_TO_SECONDS(now - s_loggingState.startTime);
+
+  const i32 written =
+    s_loggingState.fileFormat == OGE_LOG_FILE_FORMAT_ANSI
+    ? fprintf(s_loggingState.file, "[%10.3f] %s%s\x1b[0m %s%s\n",
+              time, ansiColors[level], levelNames[level],
+              categoryNames[category], message)
+    : fprintf(s_loggingState.file, "[%10.3f] %s %s%s\n",
+              time, levelNames[level], categoryNames[category], message);
+
+  if (written > 0) { s_loggingState.fileSize += written; }
+
+  // Errors precede crashes more often than not,
+  // so they shouldn't wait in the buffer
+  if (level >= OGE_LOG_LEVEL_ERROR ||
+      now - s_loggingState.fileFlushTime >= s_loggingState.fileFlushInterval) {
+    flushFile(now);
+  }
+
+  if (s_loggingState.fileMaxSize &&
+      s_loggingState.fileSize >= s_loggingState.fileMaxSize) {
+    rotateFile();
+  }
+
+  ogeMutexUnlock(&s_loggingState.fileMutex);
+}
+
+static OGE_INLINE void flushFileIfDue(b8 force) {
+  if (!s_loggingState.file) { return; }
+
+  ogeMutexLock(&s_loggingState.fileMutex);
+
+  const u64 now = ogeClockNow();
+  if (s_loggingState.file &&
+      (force || now - s_loggingState.fileFlushTime >=
+                s_loggingState.fileFlushInterval)) {
+    flushFile(now);
+  }
+
+  ogeMutexUnlock(&s_loggingState.fileMutex);
+}
+
+static OGE_INLINE b8 initFile(const OgeLoggingInitInfo *pInitInfo) {
+  if (strlen(pInitInfo->fileName) + 1 > LOG_FILE_NAME_MAX) {
+    OGE_ERROR("Log file name \"%s\" is too long.", pInitInfo->fileName);
+    return OGE_FALSE;
+  }
+
+  strcpy(s_loggingState.fileName, pInitInfo->fileName);
+  s_loggingState.fileFormat        = pInitInfo->fileFormat;
+  s_loggingState.fileMaxSize       = pInitInfo->fileMaxSize;
+  s_loggingState.fileBackupCount   = OGE_MAX(pInitInfo->fileBackupCount, 1);
+  s_loggingState.fileFlushInterval = pInitInfo->fileFlushInterval
+                                   ? pInitInfo->fileFlushInterval
+                                   : OGE_LOG_FILE_DEFAULT_FLUSH_INTERVAL;
+  s_loggingState.fileFlushTime     = s_loggingState.startTime;
+
+  // Keep the previous run's log around if rotation is enabled
+  if (s_loggingState.fileMaxSize) { shiftFileBackups(); }
+
+  s_loggingState.fileBuffer = ogeAlloc(LOG_FILE_BUFFER_SIZE,
+                                       OGE_MEMORY_TAG_ARRAY);
+  if (!openFile()) {
+    ogeFree(s_loggingState.fileBuffer);
+    s_loggingState.fileBuffer = 0;
+    OGE_ERROR("Failed to open log file \"%s\".", s_loggingState.fileName);
+    return OGE_FALSE;
+  }
+
+  ogeMutexCreate(&s_loggingState.fileMutex);
+  return OGE_TRUE;
+}
+
+static OGE_INLINE void terminateFile() {
+  if (!s_loggingState.fileBuffer) { return; }
+
+  if (s_loggingState.file) {
+    fclose(s_loggingState.file);
+    s_loggingState.file = 0;
+  }
+
+  ogeMutexDestroy(&s_loggingState.fileMutex);
+  ogeFree(s_loggingState.fileBuffer);
+  s_loggingState.fileBuffer = 0;
+}
+
+static OGE_INLINE void writeMessage(OgeLogCategory category, OgeLogLevel level,
+                                    const char *message) {
+  writeConsole(level, message);
+  writeFile(category, level, message);
+}
+
+/************************************************
+ *             deferred formatting              *
+ ************************************************/
+// A parsed conversion specification, e.g. "%-*.3lld"
+typedef struct OgeLogSpec {
+  const char *start;          // right after '%'
+  const char *precisionStart; // '.' or lengthStart if there's no precision
+  const char *lengthStart;    // length modifier or conversion
+  i32         precision;      // -1 if not specified or given by '*'
+  char        length;         // 'H' for hh, 'q' for ll, 0 if not specified
+  char        conversion;
+  b8          starWidth;
+  b8          starPrecision;
+} OgeLogSpec;
+
+OGE_INLINE b8 isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Parses a conversion specification, p points right after '%'
+OGE_INLINE const char* parseSpec(const char *p, OgeLogSpec *spec) {
+  spec->start         = p;
+  spec->precision     = -1;
+  spec->length        = 0;
+  spec->starWidth     = OGE_FALSE;
+  spec->starPrecision = OGE_FALSE;
+
+  while (*p == '-' || *p == '+' || *p == ' ' || *p == '#' || *p == '0') {
+    ++p;
+  }
+
+  if (*p == '*') { spec->starWidth = OGE_TRUE; ++p; }
+  else { while (isDigit(*p)) { ++p; } }
+
+  spec->precisionStart = p;
+  if (*p == '.') {
+    ++p;
+    if (*p == '*') { spec->starPrecision = OGE_TRUE; ++p; }
+    else {
+      spec->precision = 0;
+      while (isDigit(*p)) { spec->precision = spec->precision * 10 + (*p++ - '0'); }
+    }
+  }
+
+  spec->lengthStart = p;
+  switch (*p) {
+    case 'h': spec->length = p[1] == 'h' ? 'H' : 'h'; break;
+    case 'l': spec->length = p[1] == 'l' ? 'q' : 'l'; break;
+    case 'j': case 'z': case 't': case 'L': spec->length = *p; break;
+    default: { }
+  }
+  if (spec->length) { p += (spec->length == 'H' || spec->length == 'q') ? 2 : 1; }
+
+  spec->conversion = *p;
+  return *p ? p + 1 : p;
+}
+
+#define PUSH_ARGUMENT(value)                                    \
+  do {                                                          \
+    if ((u64)(end - cursor) < sizeof(value)) { return OGE_FALSE; } \
+    memcpy(cursor, &(value), sizeof(value));                    \
+    cursor += sizeof(value);                                    \
+  } while (0)
+
+#define POP_ARGUMENT(value)                    \
+  do {                                         \
+    memcpy(&(value), cursor, sizeof(value));   \
+    cursor += sizeof(value);                   \
+  } while (0)
+
+// Copies a format string pointer and raw arguments into a buffer.
+// Integers are widened to 64 bits, strings are copied by value.
+// Returns OGE_FALSE if the buffer is too small or the format string
+// has a conversion that can't be deferred.
+OGE_INLINE b8 captureArguments(char *buffer, u64 size, const char *format,
+                               __builtin_va_list valist) {
+  char *cursor = buffer;
+  const char *end = buffer + size;
+
+  PUSH_ARGUMENT(format);
+
+  for (const char *p = format; *p; ) {
+    if (*p++ != '%') { continue; }
+    if (*p == '%') { ++p; continue; }
+
+    OgeLogSpec spec;
+    p = parseSpec(p, &spec);
+
+    i32 precision = spec.precision;
+    if (spec.starWidth) {
+      const i32 width = va_arg(valist, i32);
+      PUSH_ARGUMENT(width);
+    }
+    if (spec.starPrecision) {
+      precision = va_arg(valist, i32);
+      PUSH_ARGUMENT(precision);
+    }
+
+    switch (spec.conversion) {
+      case 'd': case 'i': {
+        i64 value;
+        switch (spec.length) {
+          case 'H': value = (signed char)va_arg(valist, i32); break;
+          case 'h': value = (short)va_arg(valist, i32);       break;
+          case 'l': value = va_arg(valist, long);             break;
+          case 'q': value = va_arg(valist, long long);        break;
+          case 'j': value = va_arg(valist, intmax_t);         break;
+          case 'z': value = va_arg(valist, ptrdiff_t);        break;
+          case 't': value = va_arg(valist, ptrdiff_t);        break;
+          default:  value = va_arg(valist, i32);
+        }
+        PUSH_ARGUMENT(value);
+      } break;
+
+      case 'u': case 'o': case 'x': case 'X': {
+        u64 value;
+        switch (spec.length) {
+          case 'H': value = (unsigned char)va_arg(valist, u32);  break;
+          case 'h': value = (unsigned short)va_arg(valist, u32); break;
+          case 'l': value = va_arg(valist, unsigned long);       break;
+          case 'q': value = va_arg(valist, unsigned long long);  break;
+          case 'j': value = va_arg(valist, uintmax_t);           break;
+          case 'z': value = va_arg(valist, size_t);              break;
+          case 't': value = va_arg(valist, size_t);              break;
+          default:  value = va_arg(valist, u32);
+        }
+        PUSH_ARGUMENT(value);
+      } break;
+
+      case 'c': {
+        const i32 value = va_arg(valist, i32);
+        PUSH_ARGUMENT(value);
+      } break;
+
+      case 'f': case 'F': case 'e': case 'E':
+      case 'g': case 'G': case 'a': case 'A':
+        if (spec.length == 'L') {
+          const long double value = va_arg(valist, long double);
+          PUSH_ARGUMENT(value);
+        } else {
+          const f64 value = va_arg(valist, f64);
+          PUSH_ARGUMENT(value);
+        }
+        break;
+
+      case 'p': {
+        const void *value = va_arg(valist, void*);
+        PUSH_ARGUMENT(value);
+      } break;
+
+      case 's': {
+        if (spec.length) { return OGE_FALSE; } // wide strings
+
+        const char *string = va_arg(valist, const char*);
+        if (!string) { string = "(null)"; }
+
+        const u64 room = (u64)(end - cursor);
+        const u64 maxLength = precision >= 0 ? OGE_MIN((u64)precision, room)
+                                             : room;
+        const u32 length = strnlen(string, maxLength);
+        PUSH_ARGUMENT(length);
+        if ((u64)(end - cursor) < length) { return OGE_FALSE; }
+        memcpy(cursor, string, length);
+        cursor += length;
+      } break;
+
+      default: // %n and malformed specifications
+        return OGE_FALSE;
+    }
+  }
+
+  return OGE_TRUE;
+}
+
+// Rebuilds a conversion specification with '*' replaced by captured
+// values, up to (not including) a length modifier
+OGE_INLINE u32 buildSpec(const OgeLogSpec *spec, const char *specEnd,
+                         i32 width, i32 precision, char *out) {
+  u32 length = 0;
+  out[length++] = '%';
+
+  for (const char *c = spec->start; c < specEnd; ++c) {
+    if (*c == '.' && spec->starPrecision && precision < 0) {
+      break; // negative precision is taken as if it was omitted
+    }
+
+    if (*c == '*') {
+      length += sprintf(out + length, "%d",
+                        c < spec->precisionStart ? width : precision);
+    } else {
+      out[length++] = *c;
+    }
+  }
+
+  out[length] = '\0';
+  return length;
+}
+
+// Formats a record captured by captureArguments into a message
+static void formatDeferred(const char *payload, char *message, u64 size) {
+  const char *cursor = payload;
+  const char *format;
+  POP_ARGUMENT(format);
+
+  u64 position = 0;
+  for (const char *p = format; *p && position + 1 < size; ) {
+    if (*p != '%') { message[position++] = *p++; continue; }
+    if (p[1] == '%') { message[position++] = '%'; p += 2; continue; }
+
+    OgeLogSpec spec;
+    p = parseSpec(p + 1, &spec);
+
+    i32 width = 0, precision = -1;
+    if (spec.starWidth)     { POP_ARGUMENT(width); }
+    if (spec.starPrecision) { POP_ARGUMENT(precision); }
+
+    char specString[64];
+    char *out = message + position;
+    const u64 room = size - position;
+    i32 written = 0;
+
+    switch (spec.conversion) {
+      case 'd': case 'i': {
+        i64 value;
+        POP_ARGUMENT(value);
+        const u32 l = buildSpec(&spec, spec.lengthStart, width, precision, specString);
+        sprintf(specString + l, "ll%c", spec.conversion);
+        written = snprintf(out, room, specString, (long long)value);
+      } break;
+
+      case 'u': case 'o': case 'x': case 'X': {
+        u64 value;
+        POP_ARGUMENT(value);
+        const u32 l = buildSpec(&spec, spec.lengthStart, width, precision, specString);
+        sprintf(specString + l, "ll%c", spec.conversion);
+        written = snprintf(out, room, specString, (unsigned long long)value);
+      } break;
+
+      case 'c': {
+        i32 value;
+        POP_ARGUMENT(value);
+        const u32 l = buildSpec(&spec, spec.lengthStart, width, precision, specString);
+        sprintf(specString + l, "c");
+        written = snprintf(out, room, specString, value);
+      } break;
+
+      case 'f': case 'F': case 'e': case 'E':
+      case 'g': case 'G': case 'a': case 'A': {
+        const u32 l = buildSpec(&spec, spec.lengthStart, width, precision, specString);
+        if (spec.length == 'L') {
+          long double value;
+          POP_ARGUMENT(value);
+          sprintf(specString + l, "L%c", spec.conversion);
+          written = snprintf(out, room, specString, value);
+        } else {
+          f64 value;
+          POP_ARGUMENT(value);
+          sprintf(specString + l, "%c", spec.conversion);
+          written = snprintf(out, room, specString, value);
+        }
+      } break;
+
+      case 'p': {
+        const void *value;
+        POP_ARGUMENT(value);
+        const u32 l = buildSpec(&spec, spec.lengthStart, width, precision, specString);
+        sprintf(specString + l, "p");
+        written = snprintf(out, room, specString, value);
+      } break;
+
+      case 's': {
+        // Precision was already applied when the string was captured
+        u32 length;
+        POP_ARGUMENT(length);
+        const u32 l = buildSpec(&spec, spec.precisionStart, width, precision, specString);
+        sprintf(specString + l, ".*s");
+        written = snprintf(out, room, specString, (i32)length, cursor);
+        cursor += length;
+      } break;
+
+      default: { }
+    }
+
+    if (written < 0) { break; }
+    position += OGE_MIN((u64)written, room - 1);
+  }
+
+  message[position] = '\0';
+}
+
+#undef PUSH_ARGUMENT
+#undef POP_ARGUMENT
+
+/************************************************
+ *                logging queue                 *
+ ************************************************/
+static OGE_INLINE void wakeThread() {
+  // Only the first producer that finds the thread sleeping signals it,
+  // the rest of them don't touch the mutex
+  if (!atomic_load_explicit(&s_loggingState.threadSleeping,
+                            memory_order_relaxed) ||
+      !atomic_exchange(&s_loggingState.threadSleeping, OGE_FALSE)) {
+    return;
+  }
+
+  ogeMutexLock(&s_loggingState.mutex);
+  ogeConditionSignal(&s_loggingState.condition);
+  ogeMutexUnlock(&s_loggingState.mutex);
+}
+
+// Claims a free queue record or returns 0 if the queue is full
+static OGE_INLINE OgeLogRecord* tryClaimRecord(u64 *position) {
+  u64 pos = atomic_load_explicit(&s_loggingState.enqueuePosition,
+                                 memory_order_relaxed);
+  for (;;) {
+    OgeLogRecord *record = &s_loggingState.records[pos & (LOG_QUEUE_CAPACITY - 1)];
+    const u64 sequence = atomic_load_explicit(&record->sequence,
+                                              memory_order_acquire);
+    const i64 diff = (i64)sequence - (i64)pos;
+
+    if (diff == 0) {
+      if (atomic_compare_exchange_weak_explicit(
+            &s_loggingState.enqueuePosition, &pos, pos + 1,
+            memory_order_relaxed, memory_order_relaxed)) {
+        *position = pos;
+        return record;
+      }
+    } else if (diff < 0) {
+      return 0; // full
+    } else {
+      pos = atomic_load_explicit(&s_loggingState.enqueuePosition,
+                                 memory_order_relaxed);
+    }
+  }
+}
+
+static OGE_INLINE void publishRecord(OgeLogRecord *record, u64 position) {
+  // Fails only if the logging thread gave up waiting for this record
+  // and skipped it, the message is lost then. No other producer could
+  // claim the record meanwhile, it's freed for the next lap only now
+  // that it's written
+  u64 expected = position;
+  if (!atomic_compare_exchange_strong_explicit(
+        &record->sequence, &expected, position + 1,
+        memory_order_release, memory_order_relaxed)) {
+    atomic_store_explicit(&record->sequence,
+                          position + LOG_QUEUE_CAPACITY,
+                          memory_order_release);
+    return;
+  }
+
+  // Pairs with the logging thread announcing its sleep before it
+  // rechecks the queue, so either it sees the record or we see it
+  // sleeping
+  atomic_thread_fence(memory_order_seq_cst);
+  wakeThread();
+}
+
+static OGE_INLINE OgeLogRecord* claimRecord(u64 *position) {
+  OgeLogRecord *record = tryClaimRecord(position);
+  if (record) { return record; }
+
+  switch (s_loggingState.overflowPolicy) {
+    case OGE_LOG_OVERFLOW_POLICY_BLOCK:
+      while (!(record = tryClaimRecord(position))) {
+        wakeThread();
+        ogeThreadYield();
+      }
+      return record;
+
+    case OGE_LOG_OVERFLOW_POLICY_DROP:
+    case OGE_LOG_OVERFLOW_POLICY_COUNT:
+    default:
+      atomic_fetch_add_explicit(&s_loggingState.droppedCount, 1,
+                                memory_order_relaxed);
+      return 0;
+  }
+}
+
+// Returns OGE_FALSE if there was nothing to write
+static OGE_INLINE b8 writeQueuedRecord() {
+  const u64 pos = atomic_load_explicit(&s_loggingState.dequeuePosition,
+                                       memory_order_relaxed);
+  OgeLogRecord *record = &s_loggingState.records[pos & (LOG_QUEUE_CAPACITY - 1)];
+
+  const u64 sequence = atomic_load_explicit(&record->sequence,
+                                            memory_order_acquire);
+  if (sequence != pos + 1) { return OGE_FALSE; }
+
+  if (record->deferred) {
+    char message[LOG_DEFERRED_MESSAGE_SIZE];
+    formatDeferred(record->message, message, sizeof(message));
+    writeMessage(record->category, record->level, message);
+  } else {
+    writeMessage(record->category, record->level, record->message);
+  }
+
+  atomic_store_explicit(&record->sequence, pos + LOG_QUEUE_CAPACITY,
+                        memory_order_release);
+  atomic_store_explicit(&s_loggingState.dequeuePosition, pos + 1,
+                        memory_order_release);
+  return OGE_TRUE;
+}
+
+// Returns OGE_TRUE if a record at the dequeue position is claimed but
+// not published yet
+static OGE_INLINE b8 isQueueStalled() {
+  const u64 pos = atomic_load_explicit(&s_loggingState.dequeuePosition,
+                                       memory_order_relaxed);
+  return atomic_load(&s_loggingState.enqueuePosition) > pos;
+}
+
+// Skips a stalled record once it has waited for the publish timeout.
+// Returns OGE_FALSE if the caller should keep waiting.
+static OGE_INLINE b8 skipStalledRecord() {
+  const u64 pos = atomic_load_explicit(&s_loggingState.dequeuePosition,
+                                       memory_order_relaxed);
+  const u64 now = ogeClockNow();
+  if (s_loggingState.stallPosition != pos + 1) {
+    s_loggingState.stallPosition = pos + 1;
+    s_loggingState.stallTime     = now;
+    return OGE_FALSE;
+  }
+  if (now - s_loggingState.stallTime < LOG_RECORD_PUBLISH_TIMEOUT) {
+    return OGE_FALSE;
+  }
+
+  // Marks the record skipped, so a late publish fails and frees it.
+  // Until then producers of the next lap find the queue full there
+  OgeLogRecord *record = &s_loggingState.records[pos & (LOG_QUEUE_CAPACITY - 1)];
+  u64 expected = pos;
+  if (!atomic_compare_exchange_strong_explicit(
+        &record->sequence, &expected, LOG_RECORD_SKIPPED(pos),
+        memory_order_relaxed, memory_order_relaxed)) {
+    return OGE_TRUE; // published meanwhile
+  }
+  atomic_store_explicit(&s_loggingState.dequeuePosition, pos + 1,
+                        memory_order_release);
+
+  char message[128];
+  snprintf(message, sizeof(message),
+           "A log message was lost, it wasn't published in %.0f ms.",
+           OGE_NS_TO_MILLISECONDS(LOG_RECORD_PUBLISH_TIMEOUT));
+  writeMessage(OGE_LOG_CATEGORY_CORE, OGE_LOG_LEVEL_WARN, message);
+  return OGE_TRUE;
+}
+
+// Writes queued records until the queue is empty, yields while a
+// producer finishes a claimed record
+static OGE_INLINE void writeQueuedRecords() {
+  for (;;) {
+    if (writeQueuedRecord()) { continue; }
+    if (!isQueueStalled()) { return; }
+    if (!skipStalledRecord()) { ogeThreadYield(); }
+  }
+}
+
+static OGE_INLINE void reportDroppedRecords() {
+  if (s_loggingState.overflowPolicy != OGE_LOG_OVERFLOW_POLICY_COUNT) {
+    return;
+  }
+
+  const u64 droppedCount =
+    atomic_exchange_explicit(&s_loggingState.droppedCount, 0,
+                             memory_order_relaxed);
+  if (droppedCount == 0) { return; }
+
+  char message[128];
+  snprintf(message, sizeof(message),
+           "Logging queue overflowed, %llu messages were dropped.",
+           droppedCount);
+  writeMessage(OGE_LOG_CATEGORY_CORE, OGE_LOG_LEVEL_WARN, message);
+}
+
+static void loggingThread(void *arg) {
+  const u64 idleTimeout = s_loggingState.file
+                        ? s_loggingState.fileFlushInterval
+                        : LOG_THREAD_IDLE_TIMEOUT;
+
+  while (atomic_load(&s_loggingState.threadRunning)) {
+    writeQueuedRecords();
+    reportDroppedRecords();
+    flushFileIfDue(OGE_FALSE);
+
+    ogeMutexLock(&s_loggingState.mutex);
+    atomic_store(&s_loggingState.threadSleeping, OGE_TRUE);
+
+    // Recheck after announcing the sleep so a producer that
+    // published before it can't be missed
+    const u64 pos = atomic_load(&s_loggingState.dequeuePosition);
+    const OgeLogRecord *record =
+      &s_loggingState.records[pos & (LOG_QUEUE_CAPACITY - 1)];
+    if (atomic_load(&record->sequence) != pos + 1 &&
+        atomic_load(&s_loggingState.threadRunning)) {
+      ogeConditionWait(&s_loggingState.condition, &s_loggingState.mutex,
+                       idleTimeout);
+    }
+
+    atomic_store(&s_loggingState.threadSleeping, OGE_FALSE);
+    ogeMutexUnlock(&s_loggingState.mutex);
+  }
+
+  // Drain everything that was queued before termination
+  writeQueuedRecords();
+  reportDroppedRecords();
+}
+
+static OGE_INLINE void drainQueue() {
+  if (!s_loggingState.initialized || !s_loggingState.records) { return; }
+
+  const u64 target = atomic_load(&s_loggingState.enqueuePosition);
+  while (atomic_load(&s_loggingState.dequeuePosition) < target) {
+    wakeThread();
+    ogeThreadYield();
+  }
+}
+
+// Only formats with a static storage duration are deferrable, the
+// logging thread and the recorder read them after the call returns
+static void logMessage(OgeLogCategory category, OgeLogLevel level,
+                       b8 deferrable, const char *msg,
+                       __builtin_va_list valist) {
+  ogeRecorderLog(category, level,
+                 deferrable ? msg : "(message with a non-literal format)");
+
+  // Fatal messages precede a crash or a trap, so they are written
+  // right away after everything that was queued before them
+  const b8 async = s_loggingState.initialized && s_loggingState.records &&
+                   level != OGE_LOG_LEVEL_FATAL;
+
+  if (!async) {
+    drainQueue();
+
+    // Technically imposes a 4k character limit on a single
+    // log entry, but... DON'T DO THAT!
+    char formattedMessage[4096];
+    vsnprintf(formattedMessage, sizeof(formattedMessage), msg, valist);
+
+    writeMessage(category, level, formattedMessage);
+
+    if (level == OGE_LOG_LEVEL_FATAL) {
+      ogeRecorderDump("fatal message");
+    }
+    return;
+  }
+
+  u64 position;
+  OgeLogRecord *record = claimRecord(&position);
+  if (!record) { return; }
+
+  // Format straight into the queue record, the logging thread
+  // does colors and console writes. In deferred mode only raw
+  // arguments are copied and the logging thread formats them too.
+  record->category = category;
+  record->level    = level;
+  record->deferred = OGE_FALSE;
+
+  if (deferrable && s_loggingState.deferredFormatting &&
+      level < OGE_LOG_LEVEL_ERROR) {
+    __builtin_va_list captureList;
+    va_copy(captureList, valist);
+    record->deferred = captureArguments(record->message,
+                                        sizeof(record->message),
+                                        msg, captureList);
+    va_end(captureList);
+  }
+
+  if (!record->deferred) {
+    vsnprintf(record->message, sizeof(record->message), msg, valist);
+  }
+
+  publishRecord(record, position);
+}
+
+/************************************************
+ *              rate limited sites              *
+ ************************************************/
+static void logFormat(OgeLogCategory category, OgeLogLevel level,
+                      const char *msg, ...) {
+  __builtin_va_list valist;
+  va_start(valist, msg);
+  logMessage(category, level, OGE_FALSE, msg, valist);
+  va_end(valist);
+}
+
+static void reportRepeats(b8 force) {
+  if (!s_loggingState.initialized) { return; }
+
+  const u64 now = ogeClockNow();
+  if (!force &&
+      now - s_loggingState.repeatReportTime < s_loggingState.repeatPeriod) {
+    return;
+  }
+
+  const f64 period = OGE_NS_TO_SECONDS(now - s_loggingState.repeatReportTime);
+  s_loggingState.repeatReportTime = now;
+
+  ogeMutexLock(&s_loggingState.sitesMutex);
+  for (u64 i = 0; i < ogeDArrayLength(s_loggingState.sites); ++i) {
+    const OgeLogSiteEntry *entry = &s_loggingState.sites[i];
+
+    // Resetting the count lets the next call log the message again
+    const u32 count = __atomic_exchange_n(&entry->site->count, 0,
+                                          __ATOMIC_RELAXED);
+    if (count > 1) {
+      logFormat(entry->category, entry->level,
+                "\"%s\" repeated %u times in %.1f s.",
+                entry->format, count - 1, period);
+    }
   }
+  ogeMutexUnlock(&s_loggingState.sitesMutex);
+}
+
+/************************************************
+ *               logging system                 *
+ ************************************************/
+b8 ogeLoggingInit(const OgeLoggingInitInfo *pInitInfo) {
+  OGE_ASSERT(
+    !s_loggingState.initialized,
+    "Trying to initialize logging system while it's already initialized."
+  );
+
+  for (u32 i = 0; i < OGE_LOG_CATEGORY_MAX_ENUM; ++i) {
+    g_ogeLogCategoryLevels[i] = pInitInfo->logLevel;
+  }
+
+  s_loggingState.overflowPolicy = pInitInfo->overflowPolicy;
+  s_loggingState.deferredFormatting = pInitInfo->deferredFormatting;
+  s_loggingState.startTime      = ogeClockNow();
+
+  s_loggingState.repeatPeriod     = pInitInfo->repeatPeriod
+                                  ? pInitInfo->repeatPeriod
+                                  : OGE_LOG_DEFAULT_REPEAT_PERIOD;
+  s_loggingState.repeatReportTime = s_loggingState.startTime;
+  s_loggingState.sites = ogeDArrayAlloc(0, sizeof(OgeLogSiteEntry));
+  ogeMutexCreate(&s_loggingState.sitesMutex);
+
+  if (pInitInfo->fileName) { initFile(pInitInfo); }
+
+  if (!pInitInfo->synchronous) {
+    s_loggingState.records =
+      ogeAlloc(sizeof(OgeLogRecord) * LOG_QUEUE_CAPACITY,
+               OGE_MEMORY_TAG_ARRAY);
+
+    for (u64 i = 0; i < LOG_QUEUE_CAPACITY; ++i) {
+      atomic_init(&s_loggingState.records[i].sequence, i);
+    }
+
+    atomic_init(&s_loggingState.enqueuePosition, 0);
+    atomic_init(&s_loggingState.dequeuePosition, 0);
+    atomic_init(&s_loggingState.droppedCount, 0);
+    s_loggingState.stallPosition = 0;
+    atomic_init(&s_loggingState.threadRunning, OGE_TRUE);
+    atomic_init(&s_loggingState.threadSleeping, OGE_FALSE);
+
+    ogeMutexCreate(&s_loggingState.mutex);
+    ogeConditionCreate(&s_loggingState.condition);
+
+    if (!ogeThreadCreate(&s_loggingState.thread, loggingThread, 0)) {
+      OGE_ERROR("Failed to create logging thread, falling back to synchronous logging.");
+      ogeConditionDestroy(&s_loggingState.condition);
+      ogeMutexDestroy(&s_loggingState.mutex);
+      ogeFree(s_loggingState.records);
+      s_loggingState.records = 0;
+    }
+  }
+
+  s_loggingState.initialized = OGE_TRUE;
+
+  OGE_INFO("Logging system initialized.");
+
+  return OGE_TRUE;
+}
+
+void ogeLoggingTerminate() {
+  OGE_ASSERT(
+    s_loggingState.initialized,
+    "Trying to terminate logging system while it's already terminated."
+  );
+
+  reportRepeats(OGE_TRUE);
+
+  if (s_loggingState.records) {
+    atomic_store(&s_loggingState.threadRunning, OGE_FALSE);
+
+    ogeMutexLock(&s_loggingState.mutex);
+    ogeConditionSignal(&s_loggingState.condition);
+    ogeMutexUnlock(&s_loggingState.mutex);
+
+    ogeThreadJoin(&s_loggingState.thread);
+
+    ogeConditionDestroy(&s_loggingState.condition);
+    ogeMutexDestroy(&s_loggingState.mutex);
+    ogeFree(s_loggingState.records);
+    s_loggingState.records = 0;
+  }
+
+  terminateFile();
+
+  // Sites are static variables, reset them for the next initialization
+  for (u64 i = 0; i < ogeDArrayLength(s_loggingState.sites); ++i) {
+    s_loggingState.sites[i].site->registered = OGE_FALSE;
+    __atomic_store_n(&s_loggingState.sites[i].site->count, 0,
+                     __ATOMIC_RELAXED);
+  }
+  ogeDArrayFree(s_loggingState.sites);
+  s_loggingState.sites = 0;
+  ogeMutexDestroy(&s_loggingState.sitesMutex);
+
+  s_loggingState.initialized = OGE_FALSE;
+
+  OGE_INFO("Logging system terminated.");
+}
+
+void ogeLoggingFlush() {
+  if (!s_loggingState.initialized) { return; }
+
+  drainQueue();
+  flushFileIfDue(OGE_TRUE);
+}
+
+void ogeLoggingUpdate() {
+  reportRepeats(OGE_FALSE);
+}
+
+void ogeLogSetCategoryLevel(OgeLogCategory category, OgeLogLevel level) {
+  OGE_ASSERT(category < OGE_LOG_CATEGORY_MAX_ENUM,
+             "Log category is out of range.");
+  g_ogeLogCategoryLevels[category] = level;
+}
+
+/************************************************
+ *                   logging                    *
+ ************************************************/
+// NOTE: Oddly enough, MS's headers override the GCC/Clang va_list type
+// with a "typedef char* va_list" in some cases, and as a result throws
+// a strange error here. The workaround for now is to just use
+// __builtin_va_list, which is the type GCC/Clang's va_start expects.
+
+void ogeLog(OgeLogLevel level, const char *msg, ...) {
+  if (level < g_ogeLogCategoryLevels[OGE_LOG_CATEGORY_GENERAL]) { return; }
+
+  __builtin_va_list valist;
+  va_start(valist, msg);
+  logMessage(OGE_LOG_CATEGORY_GENERAL, level, OGE_FALSE, msg, valist);
+  va_end(valist);
+}
+
+void ogeLogCategory(OgeLogCategory category, OgeLogLevel level,
+                    const char *msg, ...) {
+  if (level < g_ogeLogCategoryLevels[category]) { return; }
+
+  __builtin_va_list valist;
+  va_start(valist, msg);
+  logMessage(category, level, OGE_FALSE, msg, valist);
+  va_end(valist);
+}
+
+void ogeLogCategoryLiteral(OgeLogCategory category, OgeLogLevel level,
+                           const char *msg, ...) {
+  if (level < g_ogeLogCategoryLevels[category]) { return; }
+
+  __builtin_va_list valist;
+  va_start(valist, msg);
+  logMessage(category, level, OGE_TRUE, msg, valist);
+  va_end(valist);
+}
+
+void ogeLogSite(OgeLogSite *site, OgeLogCategory category,
+                OgeLogLevel level, const char *msg, ...) {
+  if (!s_loggingState.initialized) {
+    // Nobody would report and reset the site, so it isn't limited
+    __atomic_store_n(&site->count, 0, __ATOMIC_RELAXED);
+  } else if (!__atomic_load_n(&site->registered, __ATOMIC_ACQUIRE)) {
+    ogeMutexLock(&s_loggingState.sitesMutex);
+    if (!site->registered) {
+      const OgeLogSiteEntry entry = {
+        .site     = site,
+        .format   = msg,
+        .category = category,
+        .level    = level,
+      };
+      s_loggingState.sites = ogeDArrayAppend(s_loggingState.sites, &entry);
+      __atomic_store_n(&site->registered, OGE_TRUE, __ATOMIC_RELEASE);
+    }
+    ogeMutexUnlock(&s_loggingState.sitesMutex);
+  }
+
+  __builtin_va_list valist;
+  va_start(valist, msg);
+  logMessage(category, level, OGE_TRUE, msg, valist);
+  va_end(valist);
 }
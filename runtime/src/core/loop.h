@@ -0,0 +1,84 @@
+#pragma once
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/engine.h"
+
+// Update loop timing shared by the engine main cycle and worlds,
+// all of the times are in nanoseconds
+typedef struct updateLoop {
+  b8           fixedTimestep;
+  u64          tickDuration;
+  u32          maxTicksPerFrame;
+  u64          maxFrameTime;
+  u64          accumulator;
+  OgeFrameInfo frameInfo;
+} updateLoop;
+
+typedef b8 (*updateLoopFunction)(void *userData, const OgeFrameInfo *frameInfo);
+
+OGE_INLINE void initUpdateLoop(updateLoop *loop,
+                               const OgeLoopInitInfo *initInfo) {
+  const OgeLoopInitInfo defaultInitInfo = { .fixedTimestep = OGE_FALSE };
+  if (!initInfo) { initInfo = &defaultInitInfo; }
+
+  const u32 tickRate = initInfo->tickRate
+                     ? initInfo->tickRate
+                     : OGE_DEFAULT_TICK_RATE;
+  const f64 maxFrameTime = initInfo->maxFrameTime > 0.0
+                         ? initInfo->maxFrameTime
+                         : OGE_DEFAULT_MAX_FRAME_TIME;
+
+  loop->fixedTimestep    = initInfo->fixedTimestep;
+  loop->tickDuration     = OGE_NANOSECONDS_PER_SECOND / tickRate;
+  loop->maxTicksPerFrame = initInfo->maxTicksPerFrame
+                         ? initInfo->maxTicksPerFrame
+                         : OGE_DEFAULT_MAX_TICKS_PER_FRAME;
+  loop->maxFrameTime     = maxFrameTime * OGE_NANOSECONDS_PER_SECOND;
+  loop->accumulator      = 0;
+  ogeMemSet(&loop->frameInfo, 0, sizeof(loop->frameInfo));
+}
+
+// Calls an update function once with the whole frame time or, in
+// fixed timestep mode, once per elapsed tick
+OGE_INLINE b8 runUpdateLoop(updateLoop *loop, u64 frameTime,
+                            updateLoopFunction update, void *userData) {
+  OgeFrameInfo *frameInfo = &loop->frameInfo;
+
+  if (!loop->fixedTimestep) {
+    frameInfo->deltaTime = OGE_NS_TO_SECONDS(frameTime);
+    frameInfo->alpha     = 1.0;
+
+    if (!update(userData, frameInfo)) { return OGE_FALSE; }
+
+    frameInfo->time += frameInfo->deltaTime;
+    frameInfo->tickIndex += 1;
+    return OGE_TRUE;
+  }
+
+  const u64 tickDuration = loop->tickDuration;
+  frameInfo->deltaTime = OGE_NS_TO_SECONDS(tickDuration);
+
+  loop->accumulator += frameTime;
+
+  u32 tickCount = 0;
+  while (loop->accumulator >= tickDuration &&
+         tickCount < loop->maxTicksPerFrame) {
+    if (!update(userData, frameInfo)) { return OGE_FALSE; }
+
+    loop->accumulator -= tickDuration;
+    frameInfo->time += frameInfo->deltaTime;
+    frameInfo->tickIndex += 1;
+    ++tickCount;
+  }
+
+  // Drop the time the simulation couldn't catch up with,
+  // otherwise every next frame would be even longer
+  if (loop->accumulator >= tickDuration) {
+    loop->accumulator %= tickDuration;
+  }
+
+  frameInfo->alpha = (f64)loop->accumulator / (f64)tickDuration;
+  return OGE_TRUE;
+}
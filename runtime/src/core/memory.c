@@ -1,10 +1,14 @@
+#define OGE_LOG_CATEGORY CORE
+
 #include <stdio.h>
 #include <string.h>
+#include <stdatomic.h>
 
 #include <opl/opl.h>
 
 #include "oge/core/memory.h"
 #include "oge/core/logging.h"
+#include "oge/core/startup.h"
 #include "oge/core/assertion.h"
 
 #ifdef OGE_DEBUG
@@ -44,22 +48,52 @@ char* s_memoryTagNames[OGE_MEMORY_TAG_MAX_ENUM] = {
 static struct {
   b8 initialized;
 #ifdef OGE_DEBUG
-  u64 totalUsage; 
-  u64 perTagUsage[OGE_MEMORY_TAG_MAX_ENUM];
+  // Memory is allocated on any thread, e.g. by parallel startup
+  atomic_ullong totalUsage; 
+  atomic_ullong perTagUsage[OGE_MEMORY_TAG_MAX_ENUM];
+  atomic_ullong peakUsage;
+  atomic_ullong perTagPeakUsage[OGE_MEMORY_TAG_MAX_ENUM];
 #endif
 } s_memoryState = { .initialized = OGE_FALSE };
 
+#ifdef OGE_DEBUG
+OGE_INLINE void updatePeakUsage(atomic_ullong *peakUsage, u64 usage) {
+  u64 peak = atomic_load_explicit(peakUsage, memory_order_relaxed);
+  while (usage > peak &&
+         !atomic_compare_exchange_weak(peakUsage, &peak, usage)) {}
+}
+
+static OGE_INLINE void addUsage(u16 memoryTag, u64 size) {
+  const u64 totalUsage =
+    atomic_fetch_add(&s_memoryState.totalUsage, size) + size;
+  const u64 tagUsage =
+    atomic_fetch_add(&s_memoryState.perTagUsage[memoryTag], size) + size;
+
+  updatePeakUsage(&s_memoryState.peakUsage, totalUsage);
+  updatePeakUsage(&s_memoryState.perTagPeakUsage[memoryTag], tagUsage);
+}
+
+static OGE_INLINE void subUsage(u16 memoryTag, u64 size) {
+  atomic_fetch_sub(&s_memoryState.totalUsage, size);
+  atomic_fetch_sub(&s_memoryState.perTagUsage[memoryTag], size);
+}
+#endif
+
 void ogeMemoryInit() {
   OGE_ASSERT(
     !s_memoryState.initialized,
     "Trying to initialize memory system while it's already initialized."
   );
 
+  // The first startup span, time to the first frame counts from it
+  const u32 span = ogeStartupSpanBegin("memory");
+
 #ifdef OGE_DEBUG
   oplMemSet(&s_memoryState, 0, sizeof(s_memoryState));
   s_memoryState.initialized = OGE_TRUE;
 #endif
 
+  ogeStartupSpanEnd(span);
   OGE_INFO("Memory system initialized.");
 }
 
@@ -87,9 +121,8 @@ void* ogeAlloc(u64 size, OgeMemoryTag memoryTag) {
   blockHeader->size = size;
   blockHeader->tag  = memoryTag;
 
-  s_memoryState.totalUsage += size;
-  s_memoryState.perTagUsage[memoryTag] += size;
-  
+  addUsage(memoryTag, size);
+
   return MEMORY_HTOS(blockHeader);
 #endif
   return oplAlloc(size);
@@ -99,8 +132,11 @@ void* ogeRealloc(void *block, u64 size) {
 #ifdef OGE_DEBUG
   OgeMemoryDebugHeader *blockHeader = MEMORY_STOH(block);
 
-  s_memoryState.totalUsage -= blockHeader->size - size;
-  s_memoryState.perTagUsage[blockHeader->tag] -= blockHeader->size - size;
+  if (size > blockHeader->size) {
+    addUsage(blockHeader->tag, size - blockHeader->size);
+  } else {
+    subUsage(blockHeader->tag, blockHeader->size - size);
+  }
 
   blockHeader = oplRealloc(blockHeader,
                             sizeof(OgeMemoryDebugHeader) + size);
@@ -115,8 +151,7 @@ void ogeFree(void *block) {
 #ifdef OGE_DEBUG
   const OgeMemoryDebugHeader *blockHeader = MEMORY_STOH(block);
 
-  s_memoryState.totalUsage -= blockHeader->size;
-  s_memoryState.perTagUsage[blockHeader->tag] -= blockHeader->size;
+  subUsage(blockHeader->tag, blockHeader->size);
 
   oplFree(MEMORY_STOH(block));
 #else
@@ -155,7 +190,7 @@ const char* ogeMemoryGetDebugInfo() {
                "Memory debug info string is exceed the limit."); 
 
     char unit[4] = "Xib";
-    f64 amount = s_memoryState.perTagUsage[i];
+    f64 amount = atomic_load(&s_memoryState.perTagUsage[i]);
     if (amount >= gib) {
       unit[0] = 'G';
       amount /= gib;
@@ -186,6 +221,22 @@ const char* ogeMemoryGetDebugInfo() {
   #endif
 }
 
+b8 ogeMemoryGetStats(OgeMemoryStats *stats) {
+#ifdef OGE_DEBUG
+  stats->totalUsage = atomic_load(&s_memoryState.totalUsage);
+  stats->peakUsage  = atomic_load(&s_memoryState.peakUsage);
+  for (u32 i = 0; i < OGE_MEMORY_TAG_MAX_ENUM; ++i) {
+    stats->perTagUsage[i]     = atomic_load(&s_memoryState.perTagUsage[i]);
+    stats->perTagPeakUsage[i] =
+      atomic_load(&s_memoryState.perTagPeakUsage[i]);
+  }
+  return OGE_TRUE;
+#else
+  ogeMemSet(stats, 0, sizeof(*stats));
+  return OGE_FALSE;
+#endif
+}
+
 const char* ogeMemoryTagToString(OgeMemoryTag memoryTag) {
   #ifdef OGE_DEBUG
   return s_memoryTagNames[memoryTag];
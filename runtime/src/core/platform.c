@@ -1,3 +1,5 @@
+#define OGE_LOG_CATEGORY PLATFORM
+
 #include <opl/opl.h>
 
 #include "oge/core/platform.h"
@@ -6,12 +8,26 @@
 
 static struct {
   b8 initialized;
+  b8 headless;
   OplWindow *mainWindow;
+
+  // Stay released in headless mode
+  OplKeyboardState keyboardState;
+  OplMouseState    mouseState;
 } s_platformState = { .initialized = OGE_FALSE };
 
 b8 ogePlatformInit(const OgePlatformInitInfo *initInfo) {
   OGE_ASSERT(!s_platformState.initialized, "Trying to initialize platform layer while it's alredy initialized.");
 
+  s_platformState.headless = initInfo->headless;
+  if (s_platformState.headless) {
+    s_platformState.mainWindow = 0;
+    s_platformState.initialized = OGE_TRUE;
+
+    OGE_INFO("Platform layer initialized in headless mode.");
+    return OGE_TRUE;
+  }
+
   if (!oplInit()) {
     OGE_ERROR("Failed to initialize OPL.");
     return OGE_FALSE;
@@ -58,21 +74,55 @@ b8 ogePlatformInit(const OgePlatformInitInfo *initInfo) {
 void ogePlatformTerminate() {
   OGE_ASSERT(s_platformState.initialized, "Trying to terminate platform layer while it's already terminated."); 
 
-  oplWindowDestroy(s_platformState.mainWindow);
-  oplTerminate();
+  if (!s_platformState.headless) {
+    oplWindowDestroy(s_platformState.mainWindow);
+    oplTerminate();
+  }
 
   s_platformState.initialized = OGE_FALSE;
 }
 
+b8 ogePlatformIsHeadless() {
+  return s_platformState.headless;
+}
+
+void ogePlatformPumpMessages() {
+  if (s_platformState.headless) { return; }
+  oplPumpMessages();
+}
+
 b8 ogePlatformAppShouldClose() {
+  if (s_platformState.headless) { return OGE_FALSE; }
   return oplWindowShouldClose(s_platformState.mainWindow);
 }
 
+const OplKeyboardState* ogePlatformGetKeyboardState() {
+  if (s_platformState.headless) { return &s_platformState.keyboardState; }
+  return oplKeyboardGetState();
+}
+
+const OplMouseState* ogePlatformGetMouseState() {
+  if (s_platformState.headless) { return &s_platformState.mouseState; }
+  return oplMouseGetState();
+}
+
 VkResult ogePlatformCreateSurface(
   VkInstance instance,
   const VkAllocationCallbacks *allocator,
   VkSurfaceKHR *surface) {
+  OGE_ASSERT(!s_platformState.headless,
+             "Trying to create Vulkan surface in headless mode.");
 
   return oplCreateSurface(s_platformState.mainWindow, instance,
                           allocator, surface);
 }
+
+void ogePlatformGetDeviceExtensions(u32 *extensionsCount,
+                                    const char **extensionNames) {
+  if (s_platformState.headless) {
+    *extensionsCount = 0;
+    return;
+  }
+
+  oplGetDeviceExtensions(extensionsCount, extensionNames);
+}
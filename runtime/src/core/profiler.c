@@ -0,0 +1,458 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/thread.h"
+#include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/assertion.h"
+
+// Scope name pointer to aggregate index table, twice as large as
+// the number of scopes so probing stays short
+#define PROFILER_SLOT_COUNT (OGE_PROFILER_MAX_SCOPES * 2)
+
+// The sequence is an event index + 1 once the event is written and
+// 0 while it's being written, a reader drops a copy it changed over
+typedef struct OgeProfilerEvent {
+  atomic_ullong sequence;
+  const char   *name;
+  u64           start;
+  u64           duration;
+  u32           depth;
+} OgeProfilerEvent;
+
+typedef struct OgeProfilerOpenScope {
+  const char *name;
+  u64         start;
+} OgeProfilerOpenScope;
+
+// Written only by its thread, the head is published with a release
+// store so the aggregator and the trace writer see whole events
+typedef struct OgeProfilerBuffer {
+  atomic_ullong        head;
+  u64                  consumed; // aggregated events, aggregator only
+  u32                  threadIndex;
+  u32                  depth;
+  OgeProfilerOpenScope stack[OGE_PROFILER_MAX_DEPTH];
+  OgeProfilerEvent     events[];
+} OgeProfilerBuffer;
+
+typedef struct OgeProfilerScope {
+  const char *name;
+  u64         count;
+  u64         window[OGE_PROFILER_WINDOW_SIZE];
+} OgeProfilerScope;
+
+static struct {
+  b8 initialized;
+  char traceFileName[256];
+  u32 eventMask;
+  u64 startTime;
+
+  // Buffers are never freed while profiler is initialized
+  OgeProfilerBuffer *buffers[OGE_PROFILER_MAX_THREADS];
+  atomic_uint        bufferCount;
+  u32                generation;
+
+  // Aggregate, allocated on the first aggregated event
+  OgeMutex          mutex;
+  OgeProfilerScope *scopes;
+  u32               scopeCount;
+  u16               slots[PROFILER_SLOT_COUNT]; // scope index + 1
+  u64               droppedCount;
+} s_profilerState = { .initialized = OGE_FALSE };
+
+// Same as the flight recorder thread rings, the generation tells
+// a thread that its buffer belongs to a previous initialization.
+// The default TLS model, OGE is a shared library
+static _Thread_local OgeProfilerBuffer *t_buffer;
+static _Thread_local u32                t_bufferGeneration;
+
+static OGE_INLINE OgeProfilerBuffer* findBuffer() {
+  return t_buffer && t_bufferGeneration == s_profilerState.generation
+       ? t_buffer : 0;
+}
+
+static OGE_INLINE OgeProfilerBuffer* getBuffer() {
+  if (!s_profilerState.initialized) { return 0; }
+
+  OgeProfilerBuffer *buffer = findBuffer();
+  if (buffer) { return buffer; }
+
+  const u32 index = atomic_fetch_add(&s_profilerState.bufferCount, 1);
+  if (index >= OGE_PROFILER_MAX_THREADS) {
+    atomic_fetch_sub(&s_profilerState.bufferCount, 1);
+    return 0;
+  }
+
+  const u64 size = sizeof(OgeProfilerBuffer) +
+    sizeof(OgeProfilerEvent) * (s_profilerState.eventMask + 1);
+  buffer = ogeAlloc(size, OGE_MEMORY_TAG_ARRAY);
+  ogeMemSet(buffer, 0, size);
+  buffer->threadIndex = index;
+
+  s_profilerState.buffers[index] = buffer;
+  t_buffer           = buffer;
+  t_bufferGeneration = s_profilerState.generation;
+  return buffer;
+}
+
+// Copies an event of a buffer another thread may be writing, fails
+// if the event was overwritten before or during the copy
+static OGE_INLINE b8 copyEvent(const OgeProfilerBuffer *buffer, u64 index,
+                               OgeProfilerEvent *copy) {
+  OgeProfilerEvent *event = (OgeProfilerEvent*)
+    &buffer->events[index & s_profilerState.eventMask];
+
+  if (atomic_load_explicit(&event->sequence, memory_order_acquire) !=
+      index + 1) {
+    return OGE_FALSE;
+  }
+
+  copy->name     = event->name;
+  copy->start    = event->start;
+  copy->duration = event->duration;
+  copy->depth    = event->depth;
+
+  atomic_thread_fence(memory_order_acquire);
+  return atomic_load_explicit(&event->sequence, memory_order_relaxed) ==
+         index + 1;
+}
+
+/************************************************
+ *                 aggregate                    *
+ ************************************************/
+OGE_INLINE u32 hashName(const char *name) {
+  return (u32)(((u64)name * 0x9E3779B97F4A7C15ULL) >> 32) %
+         PROFILER_SLOT_COUNT;
+}
+
+// Scopes are told apart by name pointers, identical string
+// literals are merged by the linker within a module
+static OGE_INLINE OgeProfilerScope* findScope(const char *name) {
+  for (u32 slot = hashName(name);; slot = (slot + 1) % PROFILER_SLOT_COUNT) {
+    const u16 index = s_profilerState.slots[slot];
+
+    if (index) {
+      OgeProfilerScope *scope = &s_profilerState.scopes[index - 1];
+      if (scope->name == name) { return scope; }
+      continue;
+    }
+
+    if (s_profilerState.scopeCount == OGE_PROFILER_MAX_SCOPES) { return 0; }
+
+    OgeProfilerScope *scope =
+      &s_profilerState.scopes[s_profilerState.scopeCount++];
+    scope->name  = name;
+    scope->count = 0;
+    s_profilerState.slots[slot] = (u16)s_profilerState.scopeCount;
+    return scope;
+  }
+}
+
+static OGE_INLINE void aggregateEvent(const OgeProfilerEvent *event) {
+  OgeProfilerScope *scope = findScope(event->name);
+  if (!scope) { return; }
+
+  scope->window[scope->count % OGE_PROFILER_WINDOW_SIZE] = event->duration;
+  scope->count += 1;
+}
+
+// Called with the mutex locked
+static void aggregate() {
+  const u32 bufferCount = OGE_MIN(atomic_load(&s_profilerState.bufferCount),
+                                  OGE_PROFILER_MAX_THREADS);
+
+  for (u32 i = 0; i < bufferCount; ++i) {
+    OgeProfilerBuffer *buffer = s_profilerState.buffers[i];
+    if (!buffer) { continue; }
+
+    const u64 head = atomic_load_explicit(&buffer->head,
+                                          memory_order_acquire);
+    if (head == buffer->consumed) { continue; }
+
+    if (!s_profilerState.scopes) {
+      s_profilerState.scopes = ogeAlloc(
+        sizeof(OgeProfilerScope) * OGE_PROFILER_MAX_SCOPES,
+        OGE_MEMORY_TAG_ARRAY);
+    }
+
+    // Events a thread overwrote before they were aggregated, only
+    // the last capacity events before the published head are kept
+    const u64 capacity = (u64)s_profilerState.eventMask + 1;
+    if (head - buffer->consumed > capacity) {
+      s_profilerState.droppedCount += head - buffer->consumed - capacity;
+      buffer->consumed = head - capacity;
+    }
+
+    // The thread keeps writing, so the oldest of them may be
+    // overwritten during the copy too
+    for (u64 j = buffer->consumed; j < head; ++j) {
+      OgeProfilerEvent event;
+      if (copyEvent(buffer, j, &event)) {
+        aggregateEvent(&event);
+      } else {
+        s_profilerState.droppedCount += 1;
+      }
+    }
+    buffer->consumed = head;
+  }
+}
+
+static i32 compareDurations(const void *a, const void *b) {
+  const u64 x = *(const u64*)a;
+  const u64 y = *(const u64*)b;
+  return (x > y) - (x < y);
+}
+
+static OGE_INLINE void computeStats(const OgeProfilerScope *scope,
+                                    OgeProfilerScopeStats *stats) {
+  u64 window[OGE_PROFILER_WINDOW_SIZE];
+  const u32 count = (u32)OGE_MIN(scope->count, OGE_PROFILER_WINDOW_SIZE);
+  ogeMemCpy(window, scope->window, sizeof(u64) * count);
+  qsort(window, count, sizeof(u64), compareDurations);
+
+  u64 sum = 0;
+  for (u32 i = 0; i < count; ++i) { sum += window[i]; }
+
+  // Nearest rank, the smallest duration 99% of the window
+  // doesn't exceed
+  const u32 rank = (count * 99 + 99) / 100;
+
+  stats->name     = scope->name;
+  stats->count    = scope->count;
+  stats->meanTime = (f64)sum / (f64)count;
+  stats->maxTime  = window[count - 1];
+  stats->p99Time  = window[rank - 1];
+}
+
+/************************************************
+ *                   trace                      *
+ ************************************************/
+OGE_INLINE void writeJsonString(FILE *file, const char *string) {
+  fputc('"', file);
+  for (; *string; ++string) {
+    const char c = *string;
+    if (c == '"' || c == '\\')   { fputc('\\', file); fputc(c, file); }
+    else if ((u8)c < 0x20)       { fprintf(file, "\\u%04x", c); }
+    else                         { fputc(c, file); }
+  }
+  fputc('"', file);
+}
+
+b8 ogeProfilerWriteTrace(const char *fileName) {
+  if (!s_profilerState.initialized) { return OGE_FALSE; }
+
+  FILE *file = fopen(fileName, "w");
+  if (!file) {
+    OGE_ERROR("Failed to open profiler trace file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+
+  b8 first = OGE_TRUE;
+  const u32 bufferCount = OGE_MIN(atomic_load(&s_profilerState.bufferCount),
+                                  OGE_PROFILER_MAX_THREADS);
+
+  for (u32 i = 0; i < bufferCount; ++i) {
+    const OgeProfilerBuffer *buffer = s_profilerState.buffers[i];
+    if (!buffer) { continue; }
+
+    fprintf(file, "%s\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+            "\"tid\":%u,\"args\":{\"name\":\"thread %u\"}}",
+            first ? "" : ",", buffer->threadIndex, buffer->threadIndex);
+    first = OGE_FALSE;
+
+    const u64 head  = atomic_load_explicit(&buffer->head,
+                                           memory_order_acquire);
+    const u64 count = OGE_MIN(head, (u64)s_profilerState.eventMask + 1);
+
+    // Complete events, the viewer nests them by their times
+    for (u64 j = head - count; j < head; ++j) {
+      OgeProfilerEvent event;
+      if (!copyEvent(buffer, j, &event)) { continue; }
+
+      fputs(",\n{\"name\":", file);
+      writeJsonString(file, event.name);
+      fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+              "\"ts\":%.3f,\"dur\":%.3f}",
+              buffer->threadIndex,
+              (f64)(event.start - s_profilerState.startTime) /
+                (f64)OGE_NANOSECONDS_PER_MICROSECOND,
+              (f64)event.duration / (f64)OGE_NANOSECONDS_PER_MICROSECOND);
+    }
+  }
+
+  fputs("\n]}\n", file);
+  const b8 result = !ferror(file);
+  fclose(file);
+
+  if (!result) {
+    OGE_ERROR("Failed to write profiler trace file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+  OGE_INFO("Profiler trace was written to \"%s\".", fileName);
+  return OGE_TRUE;
+}
+
+/************************************************
+ *                  profiler                    *
+ ************************************************/
+b8 ogeProfilerInit(const OgeProfilerInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_profilerState.initialized,
+    "Trying to initialize profiler while it's already initialized."
+  );
+
+  s_profilerState.traceFileName[0] = '\0';
+  if (initInfo && initInfo->traceFileName) {
+    snprintf(s_profilerState.traceFileName,
+             sizeof(s_profilerState.traceFileName),
+             "%s", initInfo->traceFileName);
+  }
+
+  const u32 eventCount = initInfo && initInfo->eventCount
+                       ? initInfo->eventCount
+                       : OGE_PROFILER_DEFAULT_EVENT_COUNT;
+  u32 powerOf2 = 1;
+  while (powerOf2 < eventCount) { powerOf2 <<= 1; }
+  s_profilerState.eventMask = powerOf2 - 1;
+
+  s_profilerState.startTime    = ogeClockNow();
+  s_profilerState.generation  += 1;
+  s_profilerState.scopes       = 0;
+  s_profilerState.scopeCount   = 0;
+  s_profilerState.droppedCount = 0;
+  ogeMemSet(s_profilerState.slots, 0, sizeof(s_profilerState.slots));
+  atomic_store(&s_profilerState.bufferCount, 0);
+  ogeMutexCreate(&s_profilerState.mutex);
+
+  s_profilerState.initialized = OGE_TRUE;
+
+  OGE_INFO("Profiler initialized.");
+  return OGE_TRUE;
+}
+
+void ogeProfilerTerminate() {
+  OGE_ASSERT(
+    s_profilerState.initialized,
+    "Trying to terminate profiler while it's already terminated."
+  );
+
+  ogeProfilerEndFrame();
+
+  if (s_profilerState.traceFileName[0]) {
+    ogeProfilerWriteTrace(s_profilerState.traceFileName);
+  }
+
+  ogeProfilerLogStats();
+  if (s_profilerState.droppedCount) {
+    OGE_WARN("Profiler dropped %llu scopes before they were aggregated.",
+             s_profilerState.droppedCount);
+  }
+
+  s_profilerState.initialized = OGE_FALSE;
+
+  const u32 bufferCount = OGE_MIN(atomic_load(&s_profilerState.bufferCount),
+                                  OGE_PROFILER_MAX_THREADS);
+  for (u32 i = 0; i < bufferCount; ++i) {
+    ogeFree(s_profilerState.buffers[i]);
+    s_profilerState.buffers[i] = 0;
+  }
+  atomic_store(&s_profilerState.bufferCount, 0);
+
+  if (s_profilerState.scopes) { ogeFree(s_profilerState.scopes); }
+  s_profilerState.scopes = 0;
+  ogeMutexDestroy(&s_profilerState.mutex);
+
+  OGE_INFO("Profiler terminated.");
+}
+
+void ogeProfilerEndFrame() {
+  if (!atomic_load(&s_profilerState.bufferCount)) { return; }
+
+  ogeMutexLock(&s_profilerState.mutex);
+  aggregate();
+  ogeMutexUnlock(&s_profilerState.mutex);
+}
+
+void ogeProfilerBegin(const char *name) {
+  OgeProfilerBuffer *buffer = getBuffer();
+  if (!buffer) { return; }
+
+  const u32 depth = buffer->depth++;
+  if (depth >= OGE_PROFILER_MAX_DEPTH) { return; }
+
+  buffer->stack[depth].name  = name;
+  buffer->stack[depth].start = ogeClockNow();
+}
+
+void ogeProfilerEnd() {
+  const u64 end = ogeClockNow();
+
+  OgeProfilerBuffer *buffer = s_profilerState.initialized ? findBuffer() : 0;
+  if (!buffer || !buffer->depth) { return; }
+
+  const u32 depth = --buffer->depth;
+  if (depth >= OGE_PROFILER_MAX_DEPTH) { return; }
+
+  const u64 head = atomic_load_explicit(&buffer->head, memory_order_relaxed);
+  OgeProfilerEvent *event = &buffer->events[head & s_profilerState.eventMask];
+
+  // Readers see 0 before any of the fields change
+  atomic_store_explicit(&event->sequence, 0, memory_order_relaxed);
+  atomic_thread_fence(memory_order_release);
+
+  event->name     = buffer->stack[depth].name;
+  event->start    = buffer->stack[depth].start;
+  event->duration = end - event->start;
+  event->depth    = depth;
+
+  atomic_store_explicit(&event->sequence, head + 1, memory_order_release);
+  atomic_store_explicit(&buffer->head, head + 1, memory_order_release);
+}
+
+const char* ogeProfilerBeginScope(const char *name) {
+  ogeProfilerBegin(name);
+  return name;
+}
+
+void ogeProfilerEndScope(const char *const *name) {
+  (void)name;
+  ogeProfilerEnd();
+}
+
+u32 ogeProfilerGetStats(OgeProfilerScopeStats *stats, u32 maxCount) {
+  if (!s_profilerState.initialized) { return 0; }
+
+  ogeMutexLock(&s_profilerState.mutex);
+
+  const u32 count = OGE_MIN(s_profilerState.scopeCount, maxCount);
+  for (u32 i = 0; i < count; ++i) {
+    computeStats(&s_profilerState.scopes[i], &stats[i]);
+  }
+
+  ogeMutexUnlock(&s_profilerState.mutex);
+  return count;
+}
+
+void ogeProfilerLogStats() {
+  OgeProfilerScopeStats stats[OGE_PROFILER_MAX_SCOPES];
+  const u32 count = ogeProfilerGetStats(stats, OGE_PROFILER_MAX_SCOPES);
+
+  for (u32 i = 0; i < count; ++i) {
+    OGE_INFO("Profiler scope \"%s\": %llu times, mean %.1f us, "
+             "max %.1f us, p99 %.1f us.",
+             stats[i].name, stats[i].count,
+             OGE_NS_TO_MICROSECONDS(stats[i].meanTime),
+             OGE_NS_TO_MICROSECONDS(stats[i].maxTime),
+             OGE_NS_TO_MICROSECONDS(stats[i].p99Time));
+  }
+}
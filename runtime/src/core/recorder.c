@@ -0,0 +1,450 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <stdatomic.h>
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/logging.h"
+#include "oge/core/recorder.h"
+#include "oge/core/assertion.h"
+
+#define RECORDER_DEFAULT_FILE_NAME "oge-recorder.txt"
+
+// Stack crash signal handlers run on, so a stack overflow
+// can be dumped too
+#define RECORDER_SIGNAL_STACK_SIZE OGE_KIBIBYTES(64)
+
+typedef enum OgeRecorderEntryType {
+  OGE_RECORDER_ENTRY_FRAME,
+  OGE_RECORDER_ENTRY_LOG,
+  OGE_RECORDER_ENTRY_EVENT,
+  OGE_RECORDER_ENTRY_MARK,
+} OgeRecorderEntryType;
+
+typedef struct OgeRecorderEntry {
+  u64         ticks;
+  const char *string; // log format or mark name
+  u64         value;  // frame index, event code or mark value
+  u8          type;
+  u8          level;
+  u8          category;
+} OgeRecorderEntry;
+
+// Written only by its thread, so recording doesn't need atomics.
+// A dump from another thread may see a torn entry or two, which
+// is fine for a crash report.
+typedef struct OgeRecorderRing {
+  u64               head;
+  u32               threadIndex;
+  OgeRecorderEntry  entries[];
+} OgeRecorderRing;
+
+static const i32 s_crashSignals[] = {
+  SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT, SIGTRAP,
+};
+
+static struct {
+  b8 initialized;
+  char fileName[256];
+  u32 entryMask;
+  u64 frameIndex;
+
+  // Rings are never freed while the recorder is initialized, so a
+  // dump can read every thread ring including exited ones
+  OgeRecorderRing *rings[OGE_RECORDER_MAX_THREADS];
+  atomic_uint      ringCount;
+  u32              generation;
+
+  // Ticks to nanoseconds calibration point
+  u64 startTicks;
+  u64 startTime;
+
+  atomic_bool      dumped;
+  void            *signalStack;
+  struct sigaction previousActions[sizeof(s_crashSignals) / sizeof(i32)];
+} s_recorderState = { .initialized = OGE_FALSE };
+
+// The generation tells a thread that its ring belongs to a previous
+// initialization. The default TLS model, OGE is a shared library
+// that may be loaded with dlopen.
+static _Thread_local OgeRecorderRing *t_ring;
+static _Thread_local u32              t_ringGeneration;
+
+// Signal stack of a thread made with ogeThreadCreate
+static _Thread_local void *t_signalStack;
+
+OGE_INLINE u64 readTicks() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __builtin_ia32_rdtsc();
+#elif defined(__aarch64__)
+  u64 ticks;
+  __asm__ volatile("mrs %0, cntvct_el0" : "=r"(ticks));
+  return ticks;
+#else
+  return ogeClockNow();
+#endif
+}
+
+static OGE_INLINE OgeRecorderRing* getRing() {
+  if (t_ring && t_ringGeneration == s_recorderState.generation) {
+    return t_ring;
+  }
+
+  const u32 index = atomic_fetch_add(&s_recorderState.ringCount, 1);
+  if (index >= OGE_RECORDER_MAX_THREADS) {
+    atomic_fetch_sub(&s_recorderState.ringCount, 1);
+    return 0;
+  }
+
+  const u64 size = sizeof(OgeRecorderRing) +
+    sizeof(OgeRecorderEntry) * (s_recorderState.entryMask + 1);
+  OgeRecorderRing *ring = ogeAlloc(size, OGE_MEMORY_TAG_ARRAY);
+  ogeMemSet(ring, 0, size);
+  ring->threadIndex = index;
+
+  s_recorderState.rings[index] = ring;
+  t_ring           = ring;
+  t_ringGeneration = s_recorderState.generation;
+  return ring;
+}
+
+static OGE_INLINE void record(OgeRecorderEntryType type, const char *string,
+                              u64 value, u8 level, u8 category) {
+  if (!s_recorderState.initialized) { return; }
+
+  OgeRecorderRing *ring = getRing();
+  if (!ring) { return; }
+
+  OgeRecorderEntry *entry =
+    &ring->entries[ring->head & s_recorderState.entryMask];
+  entry->ticks    = readTicks();
+  entry->string   = string;
+  entry->value    = value;
+  entry->type     = type;
+  entry->level    = level;
+  entry->category = category;
+
+  // Publish the entry after it's written for a dump from a signal
+  // handler on another thread
+  atomic_signal_fence(memory_order_release);
+  ++ring->head;
+}
+
+/************************************************
+ *                    dump                      *
+ ************************************************/
+OGE_INLINE void writeString(i32 fd, const char *string, i32 length) {
+  if (length <= 0) { return; }
+  while (length > 0) {
+    const ssize_t written = write(fd, string, length);
+    if (written <= 0) { return; }
+    string += written;
+    length -= written;
+  }
+}
+
+// Lines are built by hand, snprintf isn't async-signal-safe. Every
+// append stops at the end of a line, so a long string is cut.
+typedef struct OgeRecorderLine {
+  char data[512];
+  u32  length;
+} OgeRecorderLine;
+
+OGE_INLINE void appendString(OgeRecorderLine *line, const char *string) {
+  while (*string && line->length < sizeof(line->data)) {
+    line->data[line->length++] = *string++;
+  }
+}
+
+OGE_INLINE void appendUnsigned(OgeRecorderLine *line, u64 value,
+                               u32 minDigits) {
+  char digits[20];
+  u32 count = 0;
+  do {
+    digits[count++] = (char)('0' + value % 10);
+    value /= 10;
+  } while (value > 0);
+  while (count < OGE_MIN(minDigits, sizeof(digits))) { digits[count++] = '0'; }
+
+  while (count > 0 && line->length < sizeof(line->data)) {
+    line->data[line->length++] = digits[--count];
+  }
+}
+
+// Writes "-seconds.microseconds s" right aligned to 12 characters
+OGE_INLINE void appendTime(OgeRecorderLine *line, u64 nanosecondsAgo) {
+  const u64 microseconds = nanosecondsAgo / 1000;
+
+  OgeRecorderLine time = { .length = 0 };
+  appendString(&time, "-");
+  appendUnsigned(&time, microseconds / 1000000, 1);
+  appendString(&time, ".");
+  appendUnsigned(&time, microseconds % 1000000, 6);
+
+  for (u32 i = time.length; i < 12; ++i) { appendString(line, " "); }
+  time.data[time.length] = '\0';
+  appendString(line, time.data);
+  appendString(line, " s");
+}
+
+OGE_INLINE void writeLine(i32 fd, const OgeRecorderLine *line) {
+  writeString(fd, line->data, line->length);
+}
+
+static void dumpRing(i32 fd, const OgeRecorderRing *ring,
+                     u64 endTicks, f64 nanosecondsPerTick) {
+  static const char* levelNames[5] = {
+    "TRACE", "INFO ", "WARN ", "ERROR", "FATAL",
+  };
+
+  static const char* categoryNames[OGE_LOG_CATEGORY_MAX_ENUM] = {
+    "", "[core] ", "[platform] ", "[events] ", "[input] ", "[renderer] ",
+  };
+
+  const u64 head  = ring->head;
+  const u64 count = OGE_MIN(head, (u64)s_recorderState.entryMask + 1);
+
+  OgeRecorderLine line = { .length = 0 };
+  appendString(&line, "\nThread ");
+  appendUnsigned(&line, ring->threadIndex, 1);
+  appendString(&line, ", ");
+  appendUnsigned(&line, count, 1);
+  appendString(&line, " of ");
+  appendUnsigned(&line, head, 1);
+  appendString(&line, " entries:\n");
+  writeLine(fd, &line);
+
+  for (u64 i = head - count; i < head; ++i) {
+    const OgeRecorderEntry *entry =
+      &ring->entries[i & s_recorderState.entryMask];
+
+    // Time relative to the dump, the last entries are the interesting ones
+    const u64 ticksAgo = endTicks > entry->ticks ? endTicks - entry->ticks : 0;
+
+    line.length = 0;
+    appendString(&line, "  ");
+    appendTime(&line, (u64)((f64)ticksAgo * nanosecondsPerTick));
+
+    switch (entry->type) {
+      case OGE_RECORDER_ENTRY_FRAME:
+        appendString(&line, "  FRAME ");
+        appendUnsigned(&line, entry->value, 1);
+        break;
+
+      case OGE_RECORDER_ENTRY_LOG:
+        appendString(&line, "  LOG   ");
+        appendString(&line, levelNames[entry->level % 5]);
+        appendString(&line, " ");
+        appendString(&line, categoryNames[entry->category %
+                                          OGE_LOG_CATEGORY_MAX_ENUM]);
+        appendString(&line, entry->string ? entry->string : "");
+        break;
+
+      case OGE_RECORDER_ENTRY_EVENT:
+        appendString(&line, "  EVENT ");
+        appendUnsigned(&line, entry->value, 1);
+        break;
+
+      case OGE_RECORDER_ENTRY_MARK:
+        appendString(&line, "  MARK  ");
+        appendString(&line, entry->string ? entry->string : "");
+        appendString(&line, " ");
+        appendUnsigned(&line, entry->value, 1);
+        break;
+
+      default: { }
+    }
+
+    // A cut line still ends with a new line
+    line.length = OGE_MIN(line.length, sizeof(line.data) - 1);
+    line.data[line.length++] = '\n';
+    writeLine(fd, &line);
+  }
+}
+
+void ogeRecorderDump(const char *reason) {
+  if (!s_recorderState.initialized ||
+      atomic_exchange(&s_recorderState.dumped, OGE_TRUE)) {
+    return;
+  }
+
+  // Only raw file descriptor writes here, this function is called
+  // from crash signal handlers
+  const i32 fd = open(s_recorderState.fileName,
+                      O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) { return; }
+
+  const u64 endTicks = readTicks();
+  const u64 endTime  = ogeClockNow();
+  const f64 nanosecondsPerTick = endTicks > s_recorderState.startTicks
+    ? (f64)(endTime - s_recorderState.startTime) /
+      (f64)(endTicks - s_recorderState.startTicks)
+    : 1.0;
+
+  OgeRecorderLine line = { .length = 0 };
+  appendString(&line, "OGE flight recorder dump: ");
+  appendString(&line, reason ? reason : "unknown");
+  appendString(&line, "\nFrame: ");
+  appendUnsigned(&line, s_recorderState.frameIndex, 1);
+  appendString(&line, "\n");
+  writeLine(fd, &line);
+
+  const u32 ringCount = OGE_MIN(atomic_load(&s_recorderState.ringCount),
+                                OGE_RECORDER_MAX_THREADS);
+  for (u32 i = 0; i < ringCount; ++i) {
+    if (s_recorderState.rings[i]) {
+      dumpRing(fd, s_recorderState.rings[i], endTicks, nanosecondsPerTick);
+    }
+  }
+
+  close(fd);
+
+  static const char message[] = "Flight recorder was dumped.\n";
+  writeString(STDERR_FILENO, message, sizeof(message) - 1);
+}
+
+/************************************************
+ *               crash signals                  *
+ ************************************************/
+static void crashSignalHandler(i32 signal) {
+  OgeRecorderLine reason = { .length = 0 };
+  appendString(&reason, "signal ");
+  appendUnsigned(&reason, (u64)signal, 1);
+  reason.data[reason.length] = '\0';
+  ogeRecorderDump(reason.data);
+
+  // The handler was reset to the default one, so this crashes
+  // the way it would without the recorder
+  raise(signal);
+}
+
+// An alternate stack is per thread, every one needs its own
+static void* installSignalStack() {
+  void *signalStack = ogeAlloc(RECORDER_SIGNAL_STACK_SIZE,
+                               OGE_MEMORY_TAG_ARRAY);
+  const stack_t stack = {
+    .ss_sp    = signalStack,
+    .ss_size  = RECORDER_SIGNAL_STACK_SIZE,
+    .ss_flags = 0,
+  };
+  sigaltstack(&stack, 0);
+  return signalStack;
+}
+
+static void removeSignalStack(void *signalStack) {
+  const stack_t stack = { .ss_flags = SS_DISABLE };
+  sigaltstack(&stack, 0);
+  ogeFree(signalStack);
+}
+
+static OGE_INLINE void installSignalHandlers() {
+  s_recorderState.signalStack = installSignalStack();
+
+  struct sigaction action = { 0 };
+  action.sa_handler = crashSignalHandler;
+  action.sa_flags   = SA_ONSTACK | SA_RESETHAND | SA_NODEFER;
+  sigemptyset(&action.sa_mask);
+
+  for (u32 i = 0; i < sizeof(s_crashSignals) / sizeof(i32); ++i) {
+    sigaction(s_crashSignals[i], &action,
+              &s_recorderState.previousActions[i]);
+  }
+}
+
+static OGE_INLINE void restoreSignalHandlers() {
+  for (u32 i = 0; i < sizeof(s_crashSignals) / sizeof(i32); ++i) {
+    sigaction(s_crashSignals[i], &s_recorderState.previousActions[i], 0);
+  }
+
+  removeSignalStack(s_recorderState.signalStack);
+  s_recorderState.signalStack = 0;
+}
+
+/************************************************
+ *              flight recorder                 *
+ ************************************************/
+b8 ogeRecorderInit(const OgeRecorderInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_recorderState.initialized,
+    "Trying to initialize flight recorder while it's already initialized."
+  );
+
+  if (initInfo && initInfo->disabled) { return OGE_TRUE; }
+
+  const char *fileName = initInfo && initInfo->fileName
+                       ? initInfo->fileName
+                       : RECORDER_DEFAULT_FILE_NAME;
+  snprintf(s_recorderState.fileName, sizeof(s_recorderState.fileName),
+           "%s", fileName);
+
+  u32 entryCount = initInfo && initInfo->entryCount
+                 ? initInfo->entryCount
+                 : OGE_RECORDER_DEFAULT_ENTRY_COUNT;
+  u32 powerOf2 = 1;
+  while (powerOf2 < entryCount) { powerOf2 <<= 1; }
+  s_recorderState.entryMask = powerOf2 - 1;
+
+  s_recorderState.frameIndex = 0;
+  s_recorderState.generation += 1;
+  s_recorderState.startTicks = readTicks();
+  s_recorderState.startTime  = ogeClockNow();
+  atomic_store(&s_recorderState.ringCount, 0);
+  atomic_store(&s_recorderState.dumped, OGE_FALSE);
+
+  installSignalHandlers();
+
+  s_recorderState.initialized = OGE_TRUE;
+
+  OGE_INFO("Flight recorder initialized.");
+  return OGE_TRUE;
+}
+
+void ogeRecorderTerminate() {
+  if (!s_recorderState.initialized) { return; }
+
+  s_recorderState.initialized = OGE_FALSE;
+
+  restoreSignalHandlers();
+
+  const u32 ringCount = OGE_MIN(atomic_load(&s_recorderState.ringCount),
+                                OGE_RECORDER_MAX_THREADS);
+  for (u32 i = 0; i < ringCount; ++i) {
+    ogeFree(s_recorderState.rings[i]);
+    s_recorderState.rings[i] = 0;
+  }
+  atomic_store(&s_recorderState.ringCount, 0);
+
+  OGE_INFO("Flight recorder terminated.");
+}
+
+void ogeRecorderThreadBegin() {
+  if (!t_signalStack) { t_signalStack = installSignalStack(); }
+}
+
+void ogeRecorderThreadEnd() {
+  if (!t_signalStack) { return; }
+  removeSignalStack(t_signalStack);
+  t_signalStack = 0;
+}
+
+void ogeRecorderBeginFrame() {
+  record(OGE_RECORDER_ENTRY_FRAME, 0, s_recorderState.frameIndex++, 0, 0);
+}
+
+void ogeRecorderLog(OgeLogCategory category, OgeLogLevel level,
+                    const char *format) {
+  record(OGE_RECORDER_ENTRY_LOG, format, 0, level, category);
+}
+
+void ogeRecorderEvent(u16 code) {
+  record(OGE_RECORDER_ENTRY_EVENT, 0, code, 0, 0);
+}
+
+void ogeRecorderMark(const char *name, u64 value) {
+  record(OGE_RECORDER_ENTRY_MARK, name, value, 0, 0);
+}
@@ -0,0 +1,352 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+
+#include <opl/opl.h>
+
+#include "oge/defines.h"
+#include "oge/core/memory.h"
+#include "oge/core/events.h"
+#include "oge/core/replay.h"
+#include "oge/core/logging.h"
+#include "oge/core/platform.h"
+#include "oge/core/assertion.h"
+
+#define REPLAY_MAGIC   "OGER"
+#define REPLAY_VERSION 3
+
+// Replay file buffer size, records are small so a big buffer
+// keeps writes out of the frame time.
+#define REPLAY_FILE_BUFFER_SIZE OGE_KIBIBYTES(64)
+
+/*
+ * Replay file layout (native endianness):
+ *
+ * header | record | record | ...
+ *
+ * Every record starts with a one byte record type:
+ * - FRAME:    u32 frame index, u64 frame time in nanoseconds,
+ *             starts a new frame;
+ * - EVENT:    u16 event code, OgeEventData;
+ * - KEYBOARD: OplKeyboardState, written only if it changed;
+ * - MOUSE:    OplMouseState, written only if it changed.
+ *
+ * A frame marker is written before messages are pumped, so events
+ * follow the marker of a frame they were invoked in and precede
+ * the input snapshots taken after the pump.
+ */
+typedef struct OgeReplayHeader {
+  char magic[4];
+  u16  version;
+  u16  keyboardStateSize;
+  u16  mouseStateSize;
+  u16  eventDataSize;
+} OgeReplayHeader;
+
+typedef enum OgeReplayRecordType {
+  OGE_REPLAY_RECORD_FRAME,
+  OGE_REPLAY_RECORD_KEYBOARD,
+  OGE_REPLAY_RECORD_MOUSE,
+  OGE_REPLAY_RECORD_EVENT,
+} OgeReplayRecordType;
+
+static struct {
+  b8               initialized;
+  OgeReplayMode    mode;
+  FILE            *file;
+  char            *fileBuffer;
+  u32              frameIndex;
+  b8               frameStarted;
+  OplKeyboardState keyboardState;
+  OplMouseState    mouseState;
+} s_replayState = {
+  .initialized = OGE_FALSE,
+  .mode        = OGE_REPLAY_MODE_NONE,
+};
+
+OGE_INLINE void fillHeader(OgeReplayHeader *header) {
+  ogeMemCpy(header->magic, REPLAY_MAGIC, sizeof(header->magic));
+  header->version           = REPLAY_VERSION;
+  header->keyboardStateSize = sizeof(OplKeyboardState);
+  header->mouseStateSize    = sizeof(OplMouseState);
+  header->eventDataSize     = sizeof(OgeEventData);
+}
+
+static OGE_INLINE b8 openFile(const char *fileName, const char *fileMode) {
+  s_replayState.file = fopen(fileName, fileMode);
+  if (!s_replayState.file) {
+    OGE_ERROR("Failed to open replay file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+  s_replayState.fileBuffer =
+    ogeAlloc(REPLAY_FILE_BUFFER_SIZE, OGE_MEMORY_TAG_ARRAY);
+  setvbuf(s_replayState.file, s_replayState.fileBuffer,
+          _IOFBF, REPLAY_FILE_BUFFER_SIZE);
+
+  return OGE_TRUE;
+}
+
+static OGE_INLINE b8 startRecording(const char *fileName) {
+  if (!openFile(fileName, "wb")) { return OGE_FALSE; }
+
+  OgeReplayHeader header;
+  fillHeader(&header);
+  if (fwrite(&header, sizeof(header), 1, s_replayState.file) != 1) {
+    OGE_ERROR("Failed to write replay file \"%s\".", fileName);
+    return OGE_FALSE;
+  }
+
+  OGE_INFO("Recording replay to \"%s\".", fileName);
+  return OGE_TRUE;
+}
+
+static OGE_INLINE b8 startPlayback(const char *fileName) {
+  if (!openFile(fileName, "rb")) { return OGE_FALSE; }
+
+  OgeReplayHeader expected, header;
+  fillHeader(&expected);
+
+  if (fread(&header, sizeof(header), 1, s_replayState.file) != 1 ||
+      ogeMemCmp(&header, &expected, sizeof(header)) != 0) {
+    OGE_ERROR("Replay file \"%s\" is invalid or was recorded by an incompatible build.",
+              fileName);
+    return OGE_FALSE;
+  }
+
+  OGE_INFO("Playing replay back from \"%s\".", fileName);
+  return OGE_TRUE;
+}
+
+// Returns OGE_FALSE if buffered records failed to reach the file
+static OGE_INLINE b8 closeFile() {
+  b8 result = OGE_TRUE;
+  if (s_replayState.file) {
+    result = fclose(s_replayState.file) == 0;
+    s_replayState.file = 0;
+  }
+
+  if (s_replayState.fileBuffer) {
+    ogeFree(s_replayState.fileBuffer);
+    s_replayState.fileBuffer = 0;
+  }
+  return result;
+}
+
+b8 ogeReplayInit(const OgeReplayInitInfo *initInfo) {
+  OGE_ASSERT(
+    !s_replayState.initialized,
+    "Trying to initialize replay system while it's already initialized."
+  );
+
+  ogeMemSet(&s_replayState, 0, sizeof(s_replayState));
+  s_replayState.initialized = OGE_TRUE;
+  s_replayState.mode        = OGE_REPLAY_MODE_NONE;
+
+  if (!initInfo || initInfo->mode == OGE_REPLAY_MODE_NONE) {
+    return OGE_TRUE;
+  }
+
+  b8 result = OGE_FALSE;
+  switch (initInfo->mode) {
+    case OGE_REPLAY_MODE_RECORD:
+      result = startRecording(initInfo->fileName);
+      break;
+    case OGE_REPLAY_MODE_PLAYBACK:
+      result = startPlayback(initInfo->fileName);
+      break;
+    default: { }
+  }
+
+  if (!result) {
+    closeFile();
+    return OGE_FALSE;
+  }
+
+  s_replayState.mode = initInfo->mode;
+
+  OGE_INFO("Replay system initialized.");
+  return OGE_TRUE;
+}
+
+void ogeReplayTerminate() {
+  OGE_ASSERT(
+    s_replayState.initialized,
+    "Trying to terminate replay system while it's already terminated."
+  );
+
+  const b8 recording = s_replayState.mode == OGE_REPLAY_MODE_RECORD;
+  if (!closeFile() && recording) {
+    OGE_ERROR("Failed to flush replay file, the replay is truncated.");
+  } else if (recording) {
+    OGE_INFO("Replay recorded: %u frames.", s_replayState.frameIndex);
+  }
+
+  s_replayState.mode        = OGE_REPLAY_MODE_NONE;
+  s_replayState.initialized = OGE_FALSE;
+}
+
+// A failed write stops recording, a replay that misses records
+// would silently diverge from the recorded run
+static OGE_INLINE void writeRecord(const void *data, u64 size) {
+  if (s_replayState.mode != OGE_REPLAY_MODE_RECORD) { return; }
+
+  if (fwrite(data, size, 1, s_replayState.file) != 1) {
+    OGE_ERROR("Failed to write replay file, recording stopped at frame %u.",
+              s_replayState.frameIndex);
+    closeFile();
+    s_replayState.mode = OGE_REPLAY_MODE_NONE;
+  }
+}
+
+static OGE_INLINE void writeRecordType(OgeReplayRecordType type) {
+  const u8 byte = type;
+  writeRecord(&byte, sizeof(byte));
+}
+
+static OGE_INLINE void recordFrame(u64 frameTime) {
+  writeRecordType(OGE_REPLAY_RECORD_FRAME);
+  writeRecord(&s_replayState.frameIndex, sizeof(u32));
+  writeRecord(&frameTime, sizeof(u64));
+  s_replayState.frameStarted = OGE_TRUE;
+}
+
+static OGE_INLINE void recordInput() {
+  // Input snapshots are written only when they change, most
+  // frames don't touch the input at all
+  const OplKeyboardState *keyboardState = ogePlatformGetKeyboardState();
+  if (s_replayState.frameIndex == 0 ||
+      ogeMemCmp(&s_replayState.keyboardState, keyboardState,
+                sizeof(OplKeyboardState)) != 0) {
+    ogeMemCpy(&s_replayState.keyboardState, keyboardState,
+              sizeof(OplKeyboardState));
+    writeRecordType(OGE_REPLAY_RECORD_KEYBOARD);
+    writeRecord(keyboardState, sizeof(OplKeyboardState));
+  }
+
+  const OplMouseState *mouseState = ogePlatformGetMouseState();
+  if (s_replayState.frameIndex == 0 ||
+      ogeMemCmp(&s_replayState.mouseState, mouseState,
+                sizeof(OplMouseState)) != 0) {
+    ogeMemCpy(&s_replayState.mouseState, mouseState,
+              sizeof(OplMouseState));
+    writeRecordType(OGE_REPLAY_RECORD_MOUSE);
+    writeRecord(mouseState, sizeof(OplMouseState));
+  }
+}
+
+static OGE_INLINE b8 playbackFrame(u64 *frameTime) {
+  FILE *file = s_replayState.file;
+
+  i32 type = fgetc(file);
+  if (type == EOF) { return OGE_FALSE; }
+
+  if (type != OGE_REPLAY_RECORD_FRAME ||
+      fread(&s_replayState.frameIndex, sizeof(u32), 1, file) != 1 ||
+      fread(frameTime, sizeof(u64), 1, file) != 1) {
+    OGE_ERROR("Replay file is corrupted: expected a frame record.");
+    return OGE_FALSE;
+  }
+
+  // Read records up to the next frame marker
+  while ((type = fgetc(file)) != EOF) {
+    if (type == OGE_REPLAY_RECORD_FRAME) {
+      ungetc(type, file);
+      break;
+    }
+
+    b8 ok = OGE_TRUE;
+    switch (type) {
+      case OGE_REPLAY_RECORD_KEYBOARD:
+        ok = fread(&s_replayState.keyboardState,
+                   sizeof(OplKeyboardState), 1, file) == 1;
+        break;
+
+      case OGE_REPLAY_RECORD_MOUSE:
+        ok = fread(&s_replayState.mouseState,
+                   sizeof(OplMouseState), 1, file) == 1;
+        break;
+
+      case OGE_REPLAY_RECORD_EVENT: {
+        u16 code;
+        OgeEventData data;
+        ok = fread(&code, sizeof(code), 1, file) == 1 &&
+             fread(&data, sizeof(data), 1, file) == 1;
+
+        // Application defined events are produced by the application
+        // code itself while it replays, so only engine events that
+        // come from outside of the application are re-invoked.
+        if (ok && code < OGE_EVENT_MAX_ENUM) {
+          ogeEventsInvoke(code, 0, data);
+        }
+      } break;
+
+      default:
+        ok = OGE_FALSE;
+    }
+
+    if (!ok) {
+      OGE_ERROR("Replay file is corrupted: unexpected record %d in frame %u.",
+                type, s_replayState.frameIndex);
+      return OGE_FALSE;
+    }
+  }
+
+  return OGE_TRUE;
+}
+
+b8 ogeReplayBeginFrame(u64 *frameTime) {
+  switch (s_replayState.mode) {
+    case OGE_REPLAY_MODE_RECORD:
+      recordFrame(*frameTime);
+      return OGE_TRUE;
+
+    case OGE_REPLAY_MODE_PLAYBACK:
+      if (!playbackFrame(frameTime)) {
+        OGE_INFO("Replay playback finished: %u frames.",
+                 s_replayState.frameIndex + 1);
+        return OGE_FALSE;
+      }
+      return OGE_TRUE;
+
+    default:
+      return OGE_TRUE;
+  }
+}
+
+void ogeReplayEndInput() {
+  if (s_replayState.mode != OGE_REPLAY_MODE_RECORD) { return; }
+
+  recordInput();
+  ++s_replayState.frameIndex;
+}
+
+void ogeReplayRecordEvent(u16 code, OgeEventData data) {
+  // Events invoked before the first frame marker (e.g. from
+  // application init function) are reproduced by the application
+  // itself
+  if (s_replayState.mode != OGE_REPLAY_MODE_RECORD ||
+      !s_replayState.frameStarted) {
+    return;
+  }
+
+  writeRecordType(OGE_REPLAY_RECORD_EVENT);
+  writeRecord(&code, sizeof(code));
+  writeRecord(&data, sizeof(data));
+}
+
+const OplKeyboardState* ogeReplayGetKeyboardState() {
+  return &s_replayState.keyboardState;
+}
+
+const OplMouseState* ogeReplayGetMouseState() {
+  return &s_replayState.mouseState;
+}
+
+OgeReplayMode ogeReplayGetMode() {
+  return s_replayState.mode;
+}
+
+u32 ogeReplayGetFrameIndex() {
+  return s_replayState.frameIndex;
+}
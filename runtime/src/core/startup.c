@@ -0,0 +1,466 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+
+#include "oge/defines.h"
+#include "oge/core/jobs.h"
+#include "oge/core/clock.h"
+#include "oge/core/thread.h"
+#include "oge/core/logging.h"
+#include "oge/core/startup.h"
+#include "oge/core/assertion.h"
+
+// How long the calling thread waits for a step before it rechecks
+// the graph
+#define STARTUP_WAIT_TIMEOUT (10 * OGE_NANOSECONDS_PER_MILLISECOND)
+
+// A number of the longest spans logged, the report file has them all
+#define STARTUP_LOGGED_SPAN_COUNT 16
+
+/************************************************
+ *                    spans                     *
+ ************************************************/
+typedef struct OgeStartupSpan {
+  const char *graph;
+  const char *name;
+  u64         start;
+  u64         end;
+
+  // Driver time of a thread when a span began, driver time of
+  // a span once it ends
+  u64         driverTime;
+  u32         threadIndex;
+} OgeStartupSpan;
+
+static struct {
+  atomic_uint    spanCount;
+  atomic_bool    finished;
+  atomic_ullong  driverTime;
+  OgeStartupSpan spans[OGE_STARTUP_MAX_SPANS];
+} s_startupState;
+
+// Driver time accumulated by a thread, spans take differences of it
+static _Thread_local u64 t_driverTime;
+static _Thread_local u64 t_driverCallStart;
+
+static OGE_INLINE u32 beginSpan(const char *graph, const char *name) {
+  if (atomic_load_explicit(&s_startupState.finished,
+                           memory_order_relaxed)) {
+    return OGE_STARTUP_INVALID_SPAN;
+  }
+
+  const u32 index = atomic_fetch_add(&s_startupState.spanCount, 1);
+  if (index >= OGE_STARTUP_MAX_SPANS) { return OGE_STARTUP_INVALID_SPAN; }
+
+  OgeStartupSpan *span = &s_startupState.spans[index];
+  span->graph       = graph;
+  span->name        = name;
+  span->driverTime  = t_driverTime;
+  span->threadIndex = ogeJobsGetThreadIndex();
+  span->end         = 0;
+  span->start       = ogeClockNow();
+  return index;
+}
+
+u32 ogeStartupSpanBegin(const char *name) {
+  return beginSpan(0, name);
+}
+
+void ogeStartupSpanEnd(u32 span) {
+  if (span >= OGE_STARTUP_MAX_SPANS) { return; }
+
+  OgeStartupSpan *ended = &s_startupState.spans[span];
+  ended->end        = ogeClockNow();
+  ended->driverTime = t_driverTime - ended->driverTime;
+}
+
+void ogeStartupDriverBegin() {
+  t_driverCallStart = ogeClockNow();
+}
+
+void ogeStartupDriverEnd() {
+  const u64 duration = ogeClockNow() - t_driverCallStart;
+  t_driverTime += duration;
+  atomic_fetch_add_explicit(&s_startupState.driverTime, duration,
+                            memory_order_relaxed);
+}
+
+/************************************************
+ *                    graph                     *
+ ************************************************/
+
+typedef struct OgeStartupRunState OgeStartupRunState;
+
+typedef struct OgeStartupJob {
+  OgeStartupRunState *run;
+  u32                 index;
+} OgeStartupJob;
+
+typedef struct OgeStartupTiming {
+  u64 start;
+  u64 end;
+  u32 threadIndex;
+} OgeStartupTiming;
+
+// Lives on the stack of ogeStartupRun, which doesn't return until
+// every started step finishes
+struct OgeStartupRunState {
+  const char           *name;
+  const OgeStartupStep *steps;
+  u32                   stepCount;
+  void                 *userData;
+  u32                  *order;
+
+  OgeMutex     mutex;
+  OgeCondition stepFinished;
+  u64          started;
+  u64          finished;
+  u32          runningCount;
+  u32          finishedCount;
+  b8           failed;
+
+  OgeStartupJob    jobs[OGE_STARTUP_MAX_STEPS];
+  OgeStartupTiming timings[OGE_STARTUP_MAX_STEPS];
+};
+
+static OGE_INLINE void runStep(OgeStartupRunState *run, u32 index) {
+  OgeStartupTiming *timing = &run->timings[index];
+  const u32 span = beginSpan(run->name, run->steps[index].name);
+  timing->threadIndex = ogeJobsGetThreadIndex();
+  timing->start       = ogeClockNow();
+
+  const b8 result = run->steps[index].function(run->userData);
+
+  timing->end = ogeClockNow();
+  ogeStartupSpanEnd(span);
+
+  ogeMutexLock(&run->mutex);
+  if (result) {
+    run->finished |= OGE_STARTUP_STEP_BIT(index);
+    if (run->order) { run->order[run->finishedCount] = index; }
+    run->finishedCount += 1;
+  } else {
+    OGE_ERROR("Startup step \"%s\" failed.", run->steps[index].name);
+    run->failed = OGE_TRUE;
+  }
+  run->runningCount -= 1;
+  ogeConditionBroadcast(&run->stepFinished);
+  ogeMutexUnlock(&run->mutex);
+}
+
+static void startupJob(void *data) {
+  const OgeStartupJob *job = data;
+  runStep(job->run, job->index);
+}
+
+// Called with the mutex locked. Takes every ready step that may
+// run on a worker and the first ready one of the calling thread,
+// the calling thread rechecks the graph after each of its steps.
+// Returns a mask of the taken steps.
+OGE_INLINE u64 takeReadySteps(OgeStartupRunState *run, b8 jobsAvailable,
+                              u64 *local) {
+  u64 taken = 0;
+  *local = 0;
+
+  for (u32 i = 0; i < run->stepCount; ++i) {
+    const u64 bit = OGE_STARTUP_STEP_BIT(i);
+    if (run->started & bit) { continue; }
+
+    const u64 dependencies = run->steps[i].dependencies;
+    if ((run->finished & dependencies) != dependencies) { continue; }
+
+    if (jobsAvailable && run->steps[i].anyThread) {
+      taken |= bit;
+    } else if (!*local) {
+      *local = bit;
+      taken |= bit;
+    }
+  }
+
+  run->started      |= taken;
+  run->runningCount += OGE_POPCOUNT64(taken);
+  return taken;
+}
+
+OGE_INLINE void logTimeline(const char *name, const OgeStartupRunState *run,
+                            u64 startTime, u64 endTime) {
+  OGE_INFO("%s startup took %.3f ms:", name,
+           OGE_NS_TO_MILLISECONDS(endTime - startTime));
+
+  // Steps are listed in order they started
+  u64 listed = 0;
+  for (u32 i = 0; i < run->stepCount; ++i) {
+    u32 first = run->stepCount;
+    for (u32 j = 0; j < run->stepCount; ++j) {
+      if (!(run->started & ~listed & OGE_STARTUP_STEP_BIT(j))) { continue; }
+      if (first == run->stepCount ||
+          run->timings[j].start < run->timings[first].start) {
+        first = j;
+      }
+    }
+    if (first == run->stepCount) { break; }
+    listed |= OGE_STARTUP_STEP_BIT(first);
+
+    const OgeStartupTiming *timing = &run->timings[first];
+    OGE_INFO("\t➜ %-24s %9.3f → %9.3f ms (%.3f ms), thread %u",
+             run->steps[first].name,
+             OGE_NS_TO_MILLISECONDS(timing->start - startTime),
+             OGE_NS_TO_MILLISECONDS(timing->end - startTime),
+             OGE_NS_TO_MILLISECONDS(timing->end - timing->start),
+             timing->threadIndex);
+  }
+}
+
+b8 ogeStartupRun(const char *name, const OgeStartupStep *steps,
+                 u32 stepCount, void *userData, u32 *order) {
+  OGE_ASSERT(stepCount <= OGE_STARTUP_MAX_STEPS,
+             "Startup graph has too many steps.");
+
+  for (u32 i = 0; i < stepCount; ++i) {
+    OGE_ASSERT(steps[i].dependencies < OGE_STARTUP_STEP_BIT(i),
+               "Startup step can only depend on the steps before it.");
+  }
+
+  OgeStartupRunState run = {
+    .name      = name,
+    .steps     = steps,
+    .stepCount = stepCount,
+    .userData  = userData,
+    .order     = order,
+  };
+  ogeMutexCreate(&run.mutex);
+  ogeConditionCreate(&run.stepFinished);
+
+  const u64 all       = stepCount == OGE_STARTUP_MAX_STEPS
+                      ? ~0ull
+                      : OGE_STARTUP_STEP_BIT(stepCount) - 1;
+  const u32 span      = ogeStartupSpanBegin(name);
+  const u64 startTime = ogeClockNow();
+
+  ogeMutexLock(&run.mutex);
+  while (!run.failed && run.finished != all) {
+    // The job system may not be initialized yet, e.g. while it's
+    // a step itself
+    const b8 jobsAvailable = ogeJobsGetThreadCount() > 1;
+
+    u64 local;
+    const u64 taken = takeReadySteps(&run, jobsAvailable, &local);
+    if (!taken) {
+      ogeConditionWait(&run.stepFinished, &run.mutex, STARTUP_WAIT_TIMEOUT);
+      continue;
+    }
+    ogeMutexUnlock(&run.mutex);
+
+    // Workers start on their steps before the calling thread runs
+    // its own one
+    for (u64 mask = taken & ~local; mask; mask &= mask - 1) {
+      const u32 index = OGE_CTZ64(mask);
+      run.jobs[index] = (OgeStartupJob){ .run = &run, .index = index };
+
+      const OgeJob job = { .function = startupJob, .data = &run.jobs[index] };
+      ogeJobsSubmit(&job, 1, 0);
+    }
+
+    if (local) { runStep(&run, OGE_CTZ64(local)); }
+
+    ogeMutexLock(&run.mutex);
+  }
+
+  // Started steps keep pointers into this frame
+  while (run.runningCount) {
+    ogeConditionWait(&run.stepFinished, &run.mutex, STARTUP_WAIT_TIMEOUT);
+  }
+  const b8 result = !run.failed;
+  ogeMutexUnlock(&run.mutex);
+
+  ogeStartupSpanEnd(span);
+  logTimeline(name, &run, startTime, ogeClockNow());
+
+  ogeConditionDestroy(&run.stepFinished);
+  ogeMutexDestroy(&run.mutex);
+  return result;
+}
+
+/************************************************
+ *                    report                    *
+ ************************************************/
+static i32 compareSpans(const void *a, const void *b) {
+  const OgeStartupSpan *x = *(const OgeStartupSpan* const*)a;
+  const OgeStartupSpan *y = *(const OgeStartupSpan* const*)b;
+  const u64 xDuration = x->end - x->start;
+  const u64 yDuration = y->end - y->start;
+  return (xDuration < yDuration) - (xDuration > yDuration);
+}
+
+OGE_INLINE void writeJsonSpanName(FILE *file, const OgeStartupSpan *span) {
+  fputc('"', file);
+  for (u32 i = 0; i < 2; ++i) {
+    const char *string = i ? span->name : span->graph;
+    if (!string) { continue; }
+
+    for (; *string; ++string) {
+      const char c = *string;
+      if (c == '"' || c == '\\')   { fputc('\\', file); fputc(c, file); }
+      else if ((u8)c < 0x20)       { fprintf(file, "\\u%04x", c); }
+      else                         { fputc(c, file); }
+    }
+    if (!i) { fputc('/', file); }
+  }
+  fputc('"', file);
+}
+
+// The report starts with time to the first frame, so the previous
+// one is read back without a JSON parser
+OGE_INLINE b8 readPreviousReport(const char *fileName, f64 *timeToFirstFrame) {
+  FILE *file = fopen(fileName, "r");
+  if (!file) { return OGE_FALSE; }
+
+  const b8 result =
+    fscanf(file, " { \"timeToFirstFrame\" : %lf", timeToFirstFrame) == 1;
+  fclose(file);
+  return result;
+}
+
+// Times are written in milliseconds relative to the first span
+static OGE_INLINE void writeReport(const char *fileName,
+                                   OgeStartupSpan **sorted, u32 count,
+                                   u64 startTime, u64 endTime) {
+  FILE *file = fopen(fileName, "w");
+  if (!file) {
+    OGE_ERROR("Failed to open startup report file \"%s\".", fileName);
+    return;
+  }
+
+#ifdef OGE_DEBUG
+  const char *build = "debug";
+#else
+  const char *build = "release";
+#endif
+
+  fprintf(file, "{\n  \"timeToFirstFrame\": %.6f,\n"
+          "  \"driverTime\": %.6f,\n  \"version\": \"%d.%d.%d\",\n"
+          "  \"build\": \"%s\",\n  \"spans\": [",
+          OGE_NS_TO_MILLISECONDS(endTime - startTime),
+          OGE_NS_TO_MILLISECONDS(atomic_load(&s_startupState.driverTime)),
+          OGE_VERSION_MAJOR, OGE_VERSION_MINOR, OGE_VERSION_PATCH, build);
+
+  for (u32 i = 0; i < count; ++i) {
+    const OgeStartupSpan *span = sorted[i];
+    fputs(i ? ",\n    {\"name\": " : "\n    {\"name\": ", file);
+    writeJsonSpanName(file, span);
+    fprintf(file, ", \"start\": %.6f, \"duration\": %.6f, "
+            "\"driverTime\": %.6f, \"thread\": %u}",
+            OGE_NS_TO_MILLISECONDS(span->start - startTime),
+            OGE_NS_TO_MILLISECONDS(span->end - span->start),
+            OGE_NS_TO_MILLISECONDS(span->driverTime), span->threadIndex);
+  }
+  fputs("\n  ]\n}\n", file);
+
+  const b8 result = !ferror(file);
+  fclose(file);
+
+  if (!result) {
+    OGE_ERROR("Failed to write startup report file \"%s\".", fileName);
+    return;
+  }
+  OGE_INFO("Startup report was written to \"%s\".", fileName);
+}
+
+OGE_INLINE void writeTrace(const char *fileName, OgeStartupSpan **sorted,
+                           u32 count, u64 startTime) {
+  FILE *file = fopen(fileName, "w");
+  if (!file) {
+    OGE_ERROR("Failed to open startup trace file \"%s\".", fileName);
+    return;
+  }
+
+  fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[", file);
+  for (u32 i = 0; i < count; ++i) {
+    const OgeStartupSpan *span = sorted[i];
+    fputs(i ? ",\n{\"name\":" : "\n{\"name\":", file);
+    writeJsonSpanName(file, span);
+    fprintf(file, ",\"ph\":\"X\",\"pid\":1,\"tid\":%u,"
+            "\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"driver ms\":%.3f}}",
+            span->threadIndex,
+            (f64)(span->start - startTime) /
+              (f64)OGE_NANOSECONDS_PER_MICROSECOND,
+            (f64)(span->end - span->start) /
+              (f64)OGE_NANOSECONDS_PER_MICROSECOND,
+            OGE_NS_TO_MILLISECONDS(span->driverTime));
+  }
+  fputs("\n]}\n", file);
+
+  const b8 result = !ferror(file);
+  fclose(file);
+
+  if (!result) {
+    OGE_ERROR("Failed to write startup trace file \"%s\".", fileName);
+    return;
+  }
+  OGE_INFO("Startup trace was written to \"%s\".", fileName);
+}
+
+void ogeStartupFinish(const OgeStartupInitInfo *initInfo) {
+  if (atomic_exchange(&s_startupState.finished, OGE_TRUE)) { return; }
+
+  const u64 endTime = ogeClockNow();
+  const u32 count   = OGE_MIN(atomic_load(&s_startupState.spanCount),
+                              OGE_STARTUP_MAX_SPANS);
+
+  // Spans still open, e.g. ones of a failed graph, aren't reported
+  OgeStartupSpan *sorted[OGE_STARTUP_MAX_SPANS];
+  u32 sortedCount = 0;
+  u64 startTime   = endTime;
+  for (u32 i = 0; i < count; ++i) {
+    OgeStartupSpan *span = &s_startupState.spans[i];
+    if (!span->end) { continue; }
+
+    sorted[sortedCount++] = span;
+    startTime = OGE_MIN(startTime, span->start);
+  }
+  qsort(sorted, sortedCount, sizeof(OgeStartupSpan*), compareSpans);
+
+  const char *reportFileName = getenv(OGE_STARTUP_REPORT_ENV);
+  const char *traceFileName  = getenv(OGE_STARTUP_TRACE_ENV);
+  if (!reportFileName && initInfo) { reportFileName = initInfo->reportFileName; }
+  if (!traceFileName && initInfo)  { traceFileName  = initInfo->traceFileName; }
+
+  const f64 timeToFirstFrame = OGE_NS_TO_MILLISECONDS(endTime - startTime);
+  const f64 driverTime =
+    OGE_NS_TO_MILLISECONDS(atomic_load(&s_startupState.driverTime));
+
+  f64 previousTimeToFirstFrame;
+  if (reportFileName &&
+      readPreviousReport(reportFileName, &previousTimeToFirstFrame)) {
+    OGE_INFO("Startup took %.3f ms to the first frame, %.3f ms in driver calls, the previous one took %.3f ms:",
+             timeToFirstFrame, driverTime, previousTimeToFirstFrame);
+  } else {
+    OGE_INFO("Startup took %.3f ms to the first frame, %.3f ms in driver calls:",
+             timeToFirstFrame, driverTime);
+  }
+
+  const u32 loggedCount = OGE_MIN(sortedCount, STARTUP_LOGGED_SPAN_COUNT);
+  for (u32 i = 0; i < loggedCount; ++i) {
+    const OgeStartupSpan *span = sorted[i];
+
+    char name[64];
+    if (span->graph) {
+      snprintf(name, sizeof(name), "%s/%s", span->graph, span->name);
+    } else {
+      snprintf(name, sizeof(name), "%s", span->name);
+    }
+
+    OGE_INFO("\t➜ %-40s %9.3f ms, driver %9.3f ms, thread %u", name,
+             OGE_NS_TO_MILLISECONDS(span->end - span->start),
+             OGE_NS_TO_MILLISECONDS(span->driverTime), span->threadIndex);
+  }
+
+  if (reportFileName) {
+    writeReport(reportFileName, sorted, sortedCount, startTime, endTime);
+  }
+  if (traceFileName) {
+    writeTrace(traceFileName, sorted, sortedCount, startTime);
+  }
+}
@@ -0,0 +1,484 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+
+#include "oge/core/jobs.h"
+#include "oge/core/clock.h"
+#include "oge/core/tasks.h"
+#include "oge/core/memory.h"
+#include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/assertion.h"
+
+// Weight of the last frame in a task average duration
+#define TASKS_AVERAGE_WEIGHT (1.0 / 8.0)
+
+typedef struct OgeTask {
+  b8              registered;
+  char            name[OGE_TASKS_MAX_NAME_LENGTH];
+  OgeTaskFunction function;
+  void           *userData;
+  u64             readMask;  // resource bits
+  u64             writeMask;
+  u64             sequence;  // registration order
+
+  // Timings of the last frame in nanoseconds, start is relative
+  // to the start of the frame tasks
+  u64 lastStart;
+  u64 lastDuration;
+  f64 averageDuration;
+  u32 lastThread;
+} OgeTask;
+
+static struct {
+  b8 initialized;
+
+  OgeTask tasks[OGE_TASKS_MAX_TASKS];
+  u64     nextSequence;
+
+  char resources[OGE_TASKS_MAX_RESOURCES][OGE_TASKS_MAX_NAME_LENGTH];
+  u32  resourceCount;
+
+  // The graph in task indices, rebuilt only if dirty
+  b8  dirty;
+  u32 taskCount;
+  u32 sequenceOrder[OGE_TASKS_MAX_TASKS]; // topological
+  u64 predecessors[OGE_TASKS_MAX_TASKS];
+  u64 successors[OGE_TASKS_MAX_TASKS];
+
+  // The schedule, rebuilt every frame from the measured times.
+  // Tasks are ranked by their critical path length, so the highest
+  // priority ready task is the lowest set bit of the ready mask.
+  u64 priorities[OGE_TASKS_MAX_TASKS]; // in task indices
+  u32 order[OGE_TASKS_MAX_TASKS];      // rank to task index
+  u64 rankSuccessors[OGE_TASKS_MAX_TASKS];
+
+  // Execution state of the current frame
+  atomic_ullong       readyMask;
+  atomic_uint         pendingCounts[OGE_TASKS_MAX_TASKS];
+  atomic_bool         failed;
+  const OgeFrameInfo *frameInfo;
+  u64                 frameStart;
+  u64                 lastFrameDuration;
+} s_tasksState = { .initialized = OGE_FALSE };
+
+void ogeTasksInit() {
+  OGE_ASSERT(
+    !s_tasksState.initialized,
+    "Trying to initialize frame task graph while it's already initialized."
+  );
+
+  ogeMemSet(&s_tasksState, 0, sizeof(s_tasksState));
+  s_tasksState.initialized = OGE_TRUE;
+
+  OGE_INFO("Frame task graph initialized.");
+}
+
+void ogeTasksTerminate() {
+  OGE_ASSERT(
+    s_tasksState.initialized,
+    "Trying to terminate frame task graph while it's already terminated."
+  );
+
+  s_tasksState.initialized = OGE_FALSE;
+
+  OGE_INFO("Frame task graph terminated.");
+}
+
+/************************************************/
+/* registration                                 */
+/************************************************/
+OGE_INLINE void copyName(char *dst, const char *src) {
+  strncpy(dst, src, OGE_TASKS_MAX_NAME_LENGTH - 1);
+  dst[OGE_TASKS_MAX_NAME_LENGTH - 1] = '\0';
+}
+
+// Returns a bit of a resource, adds it if it's new. Returns 0 if
+// the resource table is full.
+static u64 resourceBit(const char *name) {
+  for (u32 i = 0; i < s_tasksState.resourceCount; ++i) {
+    if (strncmp(s_tasksState.resources[i], name,
+                OGE_TASKS_MAX_NAME_LENGTH - 1) == 0) {
+      return 1ULL << i;
+    }
+  }
+
+  if (s_tasksState.resourceCount == OGE_TASKS_MAX_RESOURCES) { return 0; }
+
+  copyName(s_tasksState.resources[s_tasksState.resourceCount], name);
+  return 1ULL << s_tasksState.resourceCount++;
+}
+
+// A task without one of its resources would lose dependency edges
+// and could run concurrently with a writer, so it isn't registered
+static OGE_INLINE b8 resourceMask(const char *taskName,
+                                  const char *const *names, u32 count,
+                                  u64 *mask) {
+  for (u32 i = 0; i < count; ++i) {
+    const u64 bit = resourceBit(names[i]);
+    if (!bit) {
+      OGE_ERROR("Too many frame task resources, \"%s\" isn't registered "
+                "because of \"%s\".", taskName, names[i]);
+      return OGE_FALSE;
+    }
+    *mask |= bit;
+  }
+  return OGE_TRUE;
+}
+
+u32 ogeTasksRegister(const OgeTaskInfo *info) {
+  OGE_ASSERT(s_tasksState.initialized,
+             "Frame task graph isn't initialized.");
+
+  u32 id = 0;
+  while (id < OGE_TASKS_MAX_TASKS && s_tasksState.tasks[id].registered) {
+    ++id;
+  }
+
+  if (id == OGE_TASKS_MAX_TASKS) {
+    OGE_ERROR("Too many frame tasks, \"%s\" isn't registered.", info->name);
+    return OGE_TASKS_INVALID_ID;
+  }
+
+  // Resources added for a task that failed are dropped again
+  const u32 resourceCount = s_tasksState.resourceCount;
+  u64 readMask = 0, writeMask = 0;
+  if (!resourceMask(info->name, info->reads, info->readCount, &readMask) ||
+      !resourceMask(info->name, info->writes, info->writeCount,
+                    &writeMask)) {
+    s_tasksState.resourceCount = resourceCount;
+    return OGE_TASKS_INVALID_ID;
+  }
+
+  OgeTask *task = &s_tasksState.tasks[id];
+  ogeMemSet(task, 0, sizeof(OgeTask));
+
+  task->registered = OGE_TRUE;
+  task->function   = info->function;
+  task->userData   = info->userData;
+  task->readMask   = readMask;
+  task->writeMask  = writeMask;
+  task->sequence   = s_tasksState.nextSequence++;
+  copyName(task->name, info->name);
+
+  s_tasksState.dirty = OGE_TRUE;
+  return id;
+}
+
+void ogeTasksUnregister(u32 id) {
+  OGE_ASSERT(id < OGE_TASKS_MAX_TASKS &&
+             s_tasksState.tasks[id].registered,
+             "Trying to unregister a frame task that isn't registered.");
+
+  s_tasksState.tasks[id].registered = OGE_FALSE;
+  s_tasksState.dirty = OGE_TRUE;
+}
+
+/************************************************/
+/* graph                                        */
+/************************************************/
+OGE_INLINE u64 conflictMask(const OgeTask *first, const OgeTask *second) {
+  return (first->writeMask & (second->readMask | second->writeMask)) |
+         (first->readMask  & second->writeMask);
+}
+
+static void buildGraph() {
+  u32 count = 0;
+  for (u32 i = 0; i < OGE_TASKS_MAX_TASKS; ++i) {
+    if (!s_tasksState.tasks[i].registered) { continue; }
+
+    // Insertion by registration order
+    u32 j = count++;
+    while (j > 0 && s_tasksState.tasks[s_tasksState.sequenceOrder[j - 1]]
+                      .sequence > s_tasksState.tasks[i].sequence) {
+      s_tasksState.sequenceOrder[j] = s_tasksState.sequenceOrder[j - 1];
+      --j;
+    }
+    s_tasksState.sequenceOrder[j] = i;
+  }
+  s_tasksState.taskCount = count;
+
+  ogeMemSet(s_tasksState.predecessors, 0, sizeof(s_tasksState.predecessors));
+  ogeMemSet(s_tasksState.successors, 0, sizeof(s_tasksState.successors));
+
+  for (u32 j = 0; j < count; ++j) {
+    const u32 second = s_tasksState.sequenceOrder[j];
+    for (u32 i = 0; i < j; ++i) {
+      const u32 first = s_tasksState.sequenceOrder[i];
+      if (!conflictMask(&s_tasksState.tasks[first],
+                        &s_tasksState.tasks[second])) {
+        continue;
+      }
+      s_tasksState.predecessors[second] |= 1ULL << first;
+      s_tasksState.successors[first]    |= 1ULL << second;
+    }
+  }
+
+  s_tasksState.dirty = OGE_FALSE;
+}
+
+// Ranks tasks by the longest chain of average durations they
+// start, predecessors always rank before their successors
+static void buildSchedule() {
+  const u32 count = s_tasksState.taskCount;
+
+  for (u32 j = count; j-- > 0;) {
+    const u32 index = s_tasksState.sequenceOrder[j];
+
+    u64 longest    = 0;
+    u64 successors = s_tasksState.successors[index];
+    while (successors) {
+      const u32 successor = OGE_CTZ64(successors);
+      successors &= successors - 1;
+      longest = OGE_MAX(longest, s_tasksState.priorities[successor]);
+    }
+
+    // At least 1 ns, so a predecessor outranks its successors
+    const u64 cost = OGE_MAX((u64)s_tasksState.tasks[index].averageDuration,
+                             1);
+    s_tasksState.priorities[index] = cost + longest;
+  }
+
+  u32 rankOf[OGE_TASKS_MAX_TASKS];
+  for (u32 j = 0; j < count; ++j) {
+    const u32 index = s_tasksState.sequenceOrder[j];
+
+    u32 rank = j;
+    while (rank > 0 && s_tasksState.priorities[s_tasksState.order[rank - 1]]
+                         < s_tasksState.priorities[index]) {
+      s_tasksState.order[rank] = s_tasksState.order[rank - 1];
+      --rank;
+    }
+    s_tasksState.order[rank] = index;
+  }
+  for (u32 rank = 0; rank < count; ++rank) {
+    rankOf[s_tasksState.order[rank]] = rank;
+  }
+
+  u64 readyMask = 0;
+  for (u32 rank = 0; rank < count; ++rank) {
+    const u32 index = s_tasksState.order[rank];
+
+    u64 rankSuccessors = 0;
+    u64 successors     = s_tasksState.successors[index];
+    while (successors) {
+      rankSuccessors |= 1ULL << rankOf[OGE_CTZ64(successors)];
+      successors &= successors - 1;
+    }
+    s_tasksState.rankSuccessors[rank] = rankSuccessors;
+
+    const u32 pending = OGE_POPCOUNT64(s_tasksState.predecessors[index]);
+    atomic_store_explicit(&s_tasksState.pendingCounts[rank], pending,
+                          memory_order_relaxed);
+    if (!pending) { readyMask |= 1ULL << rank; }
+  }
+
+  atomic_store(&s_tasksState.readyMask, readyMask);
+}
+
+/************************************************/
+/* execution                                    */
+/************************************************/
+// Pops the highest priority ready task, returns OGE_FALSE if
+// none of the tasks is ready
+static OGE_INLINE b8 popReadyTask(u32 *rank) {
+  u64 ready = atomic_load_explicit(&s_tasksState.readyMask,
+                                   memory_order_acquire);
+  while (ready) {
+    const u32 lowest = OGE_CTZ64(ready);
+    if (atomic_compare_exchange_weak(&s_tasksState.readyMask, &ready,
+                                     ready & ~(1ULL << lowest))) {
+      *rank = lowest;
+      return OGE_TRUE;
+    }
+  }
+  return OGE_FALSE;
+}
+
+static OGE_INLINE void runTask(u32 rank) {
+  OgeTask *task = &s_tasksState.tasks[s_tasksState.order[rank]];
+
+  // Tasks after a failed one are skipped, but still complete so
+  // the frame finishes
+  if (atomic_load_explicit(&s_tasksState.failed, memory_order_relaxed)) {
+    task->lastDuration = 0;
+    return;
+  }
+
+  OGE_PROFILE_BEGIN(task->name);
+  const u64 start = ogeClockNow();
+  const b8  ok    = task->function(s_tasksState.frameInfo, task->userData);
+  const u64 end   = ogeClockNow();
+  OGE_PROFILE_END();
+
+  if (!ok) {
+    OGE_ERROR("Frame task \"%s\" failed.", task->name);
+    atomic_store(&s_tasksState.failed, OGE_TRUE);
+  }
+
+  task->lastStart    = start - s_tasksState.frameStart;
+  task->lastDuration = end - start;
+  task->lastThread   = ogeJobsGetThreadIndex();
+  task->averageDuration = task->averageDuration > 0.0
+    ? task->averageDuration +
+      ((f64)task->lastDuration - task->averageDuration) *
+      TASKS_AVERAGE_WEIGHT
+    : (f64)task->lastDuration;
+}
+
+// A runner runs ready tasks until none is left, tasks that become
+// ready after one finishes get runners of their own, so runners
+// never wait and tasks can wait on jobs themselves
+static void runnerJob(void *data) {
+  OgeJobCounter *counter = data;
+
+  u32 rank;
+  while (popReadyTask(&rank)) {
+    runTask(rank);
+
+    u32 readyCount = 0;
+    u64 successors = s_tasksState.rankSuccessors[rank];
+    while (successors) {
+      const u32 successor = OGE_CTZ64(successors);
+      successors &= successors - 1;
+
+      if (atomic_fetch_sub(&s_tasksState.pendingCounts[successor], 1) == 1) {
+        atomic_fetch_or(&s_tasksState.readyMask, 1ULL << successor);
+        ++readyCount;
+      }
+    }
+
+    // This runner takes one of them
+    if (readyCount > 1) {
+      OgeJob jobs[OGE_TASKS_MAX_TASKS];
+      for (u32 i = 0; i < readyCount - 1; ++i) {
+        jobs[i] = (OgeJob){ .function = runnerJob, .data = counter };
+      }
+      ogeJobsSubmit(jobs, readyCount - 1, counter);
+    }
+  }
+}
+
+b8 ogeTasksRun(const OgeFrameInfo *frameInfo) {
+  if (s_tasksState.dirty) { buildGraph(); }
+  if (!s_tasksState.taskCount) { return OGE_TRUE; }
+
+  OGE_PROFILE_SCOPE("tasks");
+
+  buildSchedule();
+
+  s_tasksState.frameInfo  = frameInfo;
+  s_tasksState.frameStart = ogeClockNow();
+  atomic_store(&s_tasksState.failed, OGE_FALSE);
+
+  const u32 readyCount = OGE_POPCOUNT64(atomic_load(&s_tasksState.readyMask));
+
+  OgeJobCounter counter = { 0 };
+  OgeJob jobs[OGE_TASKS_MAX_TASKS];
+  for (u32 i = 0; i + 1 < readyCount; ++i) {
+    jobs[i] = (OgeJob){ .function = runnerJob, .data = &counter };
+  }
+  if (readyCount > 1) { ogeJobsSubmit(jobs, readyCount - 1, &counter); }
+
+  runnerJob(&counter);
+  ogeJobsWait(&counter);
+
+  s_tasksState.lastFrameDuration = ogeClockNow() - s_tasksState.frameStart;
+
+  return !atomic_load(&s_tasksState.failed);
+}
+
+/************************************************/
+/* graph dump                                   */
+/************************************************/
+b8 ogeTasksDumpGraph(const char *fileName) {
+  if (s_tasksState.dirty) { buildGraph(); }
+
+  FILE *file = fopen(fileName, "w");
+  if (!file) {
+    OGE_ERROR("Failed to open \"%s\" to dump frame task graph.", fileName);
+    return OGE_FALSE;
+  }
+
+  // Follows the highest priority successors from the highest
+  // priority root task
+  u32 criticalNext[OGE_TASKS_MAX_TASKS];
+  ogeMemSet(criticalNext, 0xFF, sizeof(criticalNext));
+
+  u64 criticalMask = 0;
+  u32 current      = OGE_TASKS_INVALID_ID;
+  for (u32 j = 0; j < s_tasksState.taskCount; ++j) {
+    const u32 index = s_tasksState.sequenceOrder[j];
+    if (s_tasksState.predecessors[index]) { continue; }
+    if (current == OGE_TASKS_INVALID_ID ||
+        s_tasksState.priorities[index] > s_tasksState.priorities[current]) {
+      current = index;
+    }
+  }
+  while (current != OGE_TASKS_INVALID_ID) {
+    criticalMask |= 1ULL << current;
+
+    u32 next = OGE_TASKS_INVALID_ID;
+    u64 successors = s_tasksState.successors[current];
+    while (successors) {
+      const u32 successor = OGE_CTZ64(successors);
+      successors &= successors - 1;
+      if (next == OGE_TASKS_INVALID_ID ||
+          s_tasksState.priorities[successor] > s_tasksState.priorities[next]) {
+        next = successor;
+      }
+    }
+    criticalNext[current] = next;
+    current = next;
+  }
+
+  fprintf(file, "digraph tasks {\n");
+  fprintf(file, "  label=\"frame tasks: %.3f ms\";\n",
+          OGE_NS_TO_MILLISECONDS(s_tasksState.lastFrameDuration));
+  fprintf(file, "  rankdir=LR;\n");
+  fprintf(file, "  node [shape=box, fontname=\"monospace\"];\n");
+
+  for (u32 j = 0; j < s_tasksState.taskCount; ++j) {
+    const u32 index = s_tasksState.sequenceOrder[j];
+    const OgeTask *task = &s_tasksState.tasks[index];
+
+    fprintf(file,
+            "  t%u [label=\"%s\\n%.3f ms (avg %.3f ms)\\n"
+            "start +%.3f ms, thread %u\"%s];\n",
+            index, task->name,
+            OGE_NS_TO_MILLISECONDS(task->lastDuration),
+            OGE_NS_TO_MILLISECONDS(task->averageDuration),
+            OGE_NS_TO_MILLISECONDS(task->lastStart),
+            task->lastThread,
+            criticalMask & (1ULL << index) ? ", color=red, penwidth=2" : "");
+  }
+
+  for (u32 j = 0; j < s_tasksState.taskCount; ++j) {
+    const u32 index = s_tasksState.sequenceOrder[j];
+
+    u64 successors = s_tasksState.successors[index];
+    while (successors) {
+      const u32 successor = OGE_CTZ64(successors);
+      successors &= successors - 1;
+
+      // Labeled with the first resource the tasks conflict on
+      const u64 conflict = conflictMask(&s_tasksState.tasks[index],
+                                        &s_tasksState.tasks[successor]);
+
+      fprintf(file, "  t%u -> t%u [label=\"%s\"%s];\n",
+              index, successor,
+              s_tasksState.resources[OGE_CTZ64(conflict)],
+              criticalNext[index] == successor
+                ? ", color=red, penwidth=2"
+                : "");
+    }
+  }
+
+  fprintf(file, "}\n");
+  fclose(file);
+
+  OGE_INFO("Frame task graph dumped to \"%s\".", fileName);
+  return OGE_TRUE;
+}
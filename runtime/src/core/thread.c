@@ -0,0 +1,94 @@
+#include <time.h>
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/thread.h"
+#include "oge/core/recorder.h"
+
+static void* threadEntry(void *arg) {
+  OgeThread *thread = arg;
+
+  ogeRecorderThreadBegin();
+  thread->function(thread->arg);
+  ogeRecorderThreadEnd();
+  return 0;
+}
+
+b8 ogeThreadCreate(OgeThread *thread, OgeThreadFunction function,
+                   void *arg) {
+  thread->function = function;
+  thread->arg      = arg;
+  return pthread_create(&thread->handle, 0, threadEntry, thread) == 0;
+}
+
+void ogeThreadJoin(OgeThread *thread) {
+  pthread_join(thread->handle, 0);
+}
+
+void ogeThreadSleep(u64 nanoseconds) {
+  struct timespec time = {
+    .tv_sec  = nanoseconds / OGE_NANOSECONDS_PER_SECOND,
+    .tv_nsec = nanoseconds % OGE_NANOSECONDS_PER_SECOND,
+  };
+  nanosleep(&time, 0);
+}
+
+void ogeThreadYield() {
+  sched_yield();
+}
+
+u32 ogeThreadGetProcessorCount() {
+  const long count = sysconf(_SC_NPROCESSORS_ONLN);
+  return count > 0 ? (u32)count : 1;
+}
+
+void ogeMutexCreate(OgeMutex *mutex) {
+  pthread_mutex_init(&mutex->handle, 0);
+}
+
+void ogeMutexDestroy(OgeMutex *mutex) {
+  pthread_mutex_destroy(&mutex->handle);
+}
+
+void ogeMutexLock(OgeMutex *mutex) {
+  pthread_mutex_lock(&mutex->handle);
+}
+
+void ogeMutexUnlock(OgeMutex *mutex) {
+  pthread_mutex_unlock(&mutex->handle);
+}
+
+void ogeConditionCreate(OgeCondition *condition) {
+  pthread_cond_init(&condition->handle, 0);
+}
+
+void ogeConditionDestroy(OgeCondition *condition) {
+  pthread_cond_destroy(&condition->handle);
+}
+
+void ogeConditionWait(OgeCondition *condition, OgeMutex *mutex,
+                      u64 timeout) {
+  // pthread_cond_timedwait takes an absolute realtime deadline
+  struct timespec now;
+  clock_gettime(CLOCK_REALTIME, &now);
+
+  const u64 deadline =
+    (u64)now.tv_sec * OGE_NANOSECONDS_PER_SECOND + now.tv_nsec + timeout;
+  const struct timespec time = {
+    .tv_sec  = deadline / OGE_NANOSECONDS_PER_SECOND,
+    .tv_nsec = deadline % OGE_NANOSECONDS_PER_SECOND,
+  };
+
+  pthread_cond_timedwait(&condition->handle, &mutex->handle, &time);
+}
+
+void ogeConditionSignal(OgeCondition *condition) {
+  pthread_cond_signal(&condition->handle);
+}
+
+void ogeConditionBroadcast(OgeCondition *condition) {
+  pthread_cond_broadcast(&condition->handle);
+}
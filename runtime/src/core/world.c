@@ -0,0 +1,190 @@
+#define OGE_LOG_CATEGORY CORE
+
+#include "oge/core/jobs.h"
+#include "oge/core/world.h"
+#include "oge/core/events.h"
+#include "oge/core/memory.h"
+#include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/assertion.h"
+
+#include "loop.h"
+
+// Keeps blocks allocated by a world aligned as well as ogeAlloc does
+typedef struct OgeWorldBlockHeader {
+  u64          size;
+  OgeMemoryTag tag;
+  u32          padding;
+} OgeWorldBlockHeader;
+
+_OGE_STATIC_ASSERT(sizeof(OgeWorldBlockHeader) == 16,
+                   "Expected world block header to keep alignment.");
+
+#define WORLD_HTOB(header) ((void*)((OgeWorldBlockHeader*)(header) + 1))
+#define WORLD_BTOH(block)  ((OgeWorldBlockHeader*)(block) - 1)
+
+// Jobs are submitted in batches, so the job array stays on the stack
+#define WORLD_JOB_BATCH_SIZE 64
+
+struct OgeWorld {
+  updateLoop              loop;
+  OgeWorldUpdateFunction  update;
+  void                   *userData;
+  const void             *sharedData;
+  OgeEventsContext       *events;
+  OgeInputBits            input;
+  OgeMemoryStats          memoryStats;
+  u64                     frameTime;
+  b8                      result;
+};
+
+OgeWorld* ogeWorldCreate(const OgeWorldInitInfo *initInfo) {
+  OGE_ASSERT(initInfo, "World init info must not be null.");
+  OGE_ASSERT(initInfo->update, "World update function must not be null.");
+
+  OgeWorld *world = ogeAlloc(sizeof(OgeWorld), OGE_MEMORY_TAG_GAME);
+  ogeMemSet(world, 0, sizeof(OgeWorld));
+
+  world->events = ogeEventsContextCreate();
+  if (!world->events) {
+    OGE_ERROR("Failed to create world events context.");
+    ogeFree(world);
+    return 0;
+  }
+
+  initUpdateLoop(&world->loop, &initInfo->loopInitInfo);
+  world->update     = initInfo->update;
+  world->userData   = initInfo->userData;
+  world->sharedData = initInfo->sharedData;
+
+  return world;
+}
+
+void ogeWorldDestroy(OgeWorld *world) {
+  if (!world) { return; }
+
+  if (world->memoryStats.totalUsage > 0) {
+    OGE_WARN("World destroyed with %llu bytes of memory not freed.",
+             world->memoryStats.totalUsage);
+  }
+
+  ogeEventsContextDestroy(world->events);
+  ogeFree(world);
+}
+
+static b8 updateWorldTick(void *userData, const OgeFrameInfo *frameInfo) {
+  OgeWorld *world = userData;
+  return world->update(world, frameInfo);
+}
+
+b8 ogeWorldTick(OgeWorld *world, u64 frameTime) {
+  OGE_PROFILE_SCOPE("world");
+
+  if (frameTime > world->loop.maxFrameTime) {
+    frameTime = world->loop.maxFrameTime;
+  }
+
+  const b8 result = runUpdateLoop(&world->loop, frameTime,
+                                  updateWorldTick, world);
+  world->loop.frameInfo.frameIndex += 1;
+  return result;
+}
+
+static void tickWorldJob(void *data) {
+  OgeWorld *world = data;
+  world->result = ogeWorldTick(world, world->frameTime);
+}
+
+b8 ogeWorldsTick(OgeWorld **worlds, u32 count, u64 frameTime) {
+  OGE_PROFILE_SCOPE("worlds");
+
+  OgeJobCounter counter = { 0 };
+  OgeJob        jobs[WORLD_JOB_BATCH_SIZE];
+
+  for (u32 i = 0; i < count; i += WORLD_JOB_BATCH_SIZE) {
+    const u32 batchSize = OGE_MIN(count - i, WORLD_JOB_BATCH_SIZE);
+
+    for (u32 j = 0; j < batchSize; ++j) {
+      OgeWorld *world = worlds[i + j];
+      world->frameTime = frameTime;
+      jobs[j].function = tickWorldJob;
+      jobs[j].data     = world;
+    }
+
+    ogeJobsSubmit(jobs, batchSize, &counter);
+  }
+
+  ogeJobsWait(&counter);
+
+  b8 result = OGE_TRUE;
+  for (u32 i = 0; i < count; ++i) {
+    result &= worlds[i]->result;
+  }
+  return result;
+}
+
+const OgeFrameInfo* ogeWorldGetFrameInfo(const OgeWorld *world) {
+  return &world->loop.frameInfo;
+}
+
+void* ogeWorldGetUserData(const OgeWorld *world) {
+  return world->userData;
+}
+
+const void* ogeWorldGetSharedData(const OgeWorld *world) {
+  return world->sharedData;
+}
+
+OgeEventsContext* ogeWorldGetEvents(OgeWorld *world) {
+  return world->events;
+}
+
+void ogeWorldSetInput(OgeWorld *world, const OgeInputBits *input) {
+  OgeInputBits *bits = &world->input;
+
+  for (u32 i = 0; i < OGE_KEY_WORD_COUNT; ++i) {
+    bits->keysChanged[i] = bits->keysDown[i] ^ input->keysDown[i];
+    bits->keysDown[i]    = input->keysDown[i];
+  }
+
+  bits->mouseButtonsChanged = bits->mouseButtonsDown ^
+                              input->mouseButtonsDown;
+  bits->mouseButtonsDown    = input->mouseButtonsDown;
+}
+
+const OgeInputBits* ogeWorldGetInput(const OgeWorld *world) {
+  return &world->input;
+}
+
+void* ogeWorldAlloc(OgeWorld *world, u64 size, OgeMemoryTag memoryTag) {
+  OgeWorldBlockHeader *header =
+    ogeAlloc(sizeof(OgeWorldBlockHeader) + size, memoryTag);
+  header->size = size;
+  header->tag  = memoryTag;
+
+  OgeMemoryStats *stats = &world->memoryStats;
+  stats->totalUsage             += size;
+  stats->perTagUsage[memoryTag] += size;
+  stats->peakUsage = OGE_MAX(stats->peakUsage, stats->totalUsage);
+  stats->perTagPeakUsage[memoryTag] =
+    OGE_MAX(stats->perTagPeakUsage[memoryTag],
+            stats->perTagUsage[memoryTag]);
+
+  return WORLD_HTOB(header);
+}
+
+void ogeWorldFree(OgeWorld *world, void *block) {
+  if (!block) { return; }
+
+  OgeWorldBlockHeader *header = WORLD_BTOH(block);
+
+  OgeMemoryStats *stats = &world->memoryStats;
+  stats->totalUsage               -= header->size;
+  stats->perTagUsage[header->tag] -= header->size;
+
+  ogeFree(header);
+}
+
+void ogeWorldGetMemoryStats(const OgeWorld *world, OgeMemoryStats *stats) {
+  *stats = world->memoryStats;
+}
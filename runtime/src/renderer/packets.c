@@ -0,0 +1,342 @@
+#define OGE_LOG_CATEGORY RENDERER
+
+#include "oge/defines.h"
+#include "oge/core/clock.h"
+#include "oge/core/memory.h"
+#include "oge/core/thread.h"
+#include "oge/core/logging.h"
+#include "oge/core/profiler.h"
+#include "oge/core/assertion.h"
+#include "oge/renderer/packets.h"
+#include "oge/renderer/renderer.h"
+
+#define RENDER_PACKET_DATA_ALIGNMENT 16
+
+// How long the threads wait on a condition before they recheck it
+#define RENDER_PACKETS_WAIT_TIMEOUT (10 * OGE_NANOSECONDS_PER_MILLISECOND)
+
+// Packets cycle through the ring in order: the game thread builds
+// the one at head, publishes it by advancing head, the render
+// thread submits the one at tail and frees it by advancing tail.
+// Indices only grow, a slot is index % depth.
+static struct {
+  b8 initialized;
+  b8 renderThread;
+  OgeRenderPacketSubmitFunction submit;
+
+  OgeRenderPacket packets[OGE_RENDER_PACKETS_MAX_DEPTH];
+  u8             *data;
+  u64             dataSize;
+  u32             depth;
+
+  OgeMutex     mutex;
+  OgeCondition packetFreed;
+  OgeCondition packetPublished;
+  u64          head;
+  u64          tail;
+  b8           running;
+  b8           failed;
+  b8           building;
+
+  OgeThread thread;
+
+  OgeRenderPacketCompletion completions[OGE_RENDER_PACKETS_COMPLETION_COUNT];
+  u64                       completionsWritten;
+  u64                       completionsRead;
+
+  OgeRenderPacketsStats stats;
+  f64 blockTimeSum;
+  f64 queueTimeSum;
+  f64 submitTimeSum;
+  f64 latencySum;
+} s_packetsState = { .initialized = OGE_FALSE };
+
+// Called with the mutex locked
+static OGE_INLINE void updateStats(const OgeRenderPacket *packet,
+                                   u64 submitStart, u64 submitEnd) {
+  OgeRenderPacketsStats *stats = &s_packetsState.stats;
+  const u64 latency = submitEnd - packet->inputTime;
+
+  stats->packetCount += 1;
+  stats->maxLatency   = OGE_MAX(stats->maxLatency, latency);
+
+  s_packetsState.queueTimeSum  += submitStart - packet->publishTime;
+  s_packetsState.submitTimeSum += submitEnd - submitStart;
+  s_packetsState.latencySum    += latency;
+}
+
+// Called with the mutex locked. Renderer timings are written by the
+// thread that submits, so they're copied here and not read by the
+// game thread while the render thread renders the next packet.
+static OGE_INLINE void writeCompletion(const OgeRenderPacket *packet,
+                                       const OgeRendererFrameStats *stats) {
+  OgeRenderPacketCompletion *completion =
+    &s_packetsState.completions[s_packetsState.completionsWritten %
+                                OGE_RENDER_PACKETS_COMPLETION_COUNT];
+  completion->frameIndex    = packet->frameInfo.frameIndex;
+  completion->rendererStats = *stats;
+  s_packetsState.completionsWritten += 1;
+}
+
+static OGE_INLINE b8 submitPacket(const OgeRenderPacket *packet) {
+  OGE_PROFILE_SCOPE("render packet submit");
+
+  const u64 submitStart = ogeClockNow();
+  const b8  result      = s_packetsState.submit(packet);
+  const u64 submitEnd   = ogeClockNow();
+
+  const OgeRendererFrameStats rendererStats = *ogeRendererGetFrameStats();
+
+  ogeMutexLock(&s_packetsState.mutex);
+  updateStats(packet, submitStart, submitEnd);
+  writeCompletion(packet, &rendererStats);
+  ogeMutexUnlock(&s_packetsState.mutex);
+
+  if (!result) { OGE_ERROR("Failed to submit render packet."); }
+  return result;
+}
+
+static void renderThread(void *arg) {
+  ogeMutexLock(&s_packetsState.mutex);
+
+  while (OGE_TRUE) {
+    while (s_packetsState.tail == s_packetsState.head &&
+           s_packetsState.running) {
+      ogeConditionWait(&s_packetsState.packetPublished,
+                       &s_packetsState.mutex, RENDER_PACKETS_WAIT_TIMEOUT);
+    }
+
+    // Published packets are submitted even if the thread is asked
+    // to stop, so the last frames aren't lost
+    if (s_packetsState.tail == s_packetsState.head) { break; }
+
+    const OgeRenderPacket *packet =
+      &s_packetsState.packets[s_packetsState.tail % s_packetsState.depth];
+
+    ogeMutexUnlock(&s_packetsState.mutex);
+    const b8 result = s_packetsState.failed ? OGE_FALSE
+                                            : submitPacket(packet);
+    ogeMutexLock(&s_packetsState.mutex);
+
+    if (!result) { s_packetsState.failed = OGE_TRUE; }
+    s_packetsState.tail += 1;
+    ogeConditionSignal(&s_packetsState.packetFreed);
+  }
+
+  ogeMutexUnlock(&s_packetsState.mutex);
+}
+
+b8 ogeRenderPacketsInit(const OgeRenderPacketsInitInfo *initInfo,
+                        OgeRenderPacketSubmitFunction submit) {
+  OGE_ASSERT(
+    !s_packetsState.initialized,
+    "Trying to initialize render packets while they're already initialized."
+  );
+
+  const OgeRenderPacketsInitInfo defaultInitInfo = { .renderThread = 0 };
+  if (!initInfo) { initInfo = &defaultInitInfo; }
+
+  ogeMemSet(&s_packetsState, 0, sizeof(s_packetsState));
+
+  s_packetsState.submit   = submit;
+  s_packetsState.depth    = initInfo->depth
+                          ? OGE_MIN(initInfo->depth,
+                                    OGE_RENDER_PACKETS_MAX_DEPTH)
+                          : OGE_RENDER_PACKETS_DEFAULT_DEPTH;
+  s_packetsState.dataSize = initInfo->dataSize
+                          ? initInfo->dataSize
+                          : OGE_RENDER_PACKETS_DEFAULT_DATA_SIZE;
+
+  // Without the render thread a packet is submitted before the
+  // next one is built, one is enough
+  if (!initInfo->renderThread) { s_packetsState.depth = 1; }
+
+  s_packetsState.data = ogeAlloc(s_packetsState.dataSize *
+                                 s_packetsState.depth,
+                                 OGE_MEMORY_TAG_RENDERER);
+  for (u32 i = 0; i < s_packetsState.depth; ++i) {
+    s_packetsState.packets[i].data =
+      s_packetsState.data + i * s_packetsState.dataSize;
+  }
+
+  ogeMutexCreate(&s_packetsState.mutex);
+  ogeConditionCreate(&s_packetsState.packetFreed);
+  ogeConditionCreate(&s_packetsState.packetPublished);
+  s_packetsState.running = OGE_TRUE;
+
+  if (initInfo->renderThread) {
+    s_packetsState.renderThread =
+      ogeThreadCreate(&s_packetsState.thread, renderThread, 0);
+
+    if (!s_packetsState.renderThread) {
+      OGE_ERROR("Failed to create render thread, submitting packets on the game thread.");
+      s_packetsState.depth = 1;
+    }
+  }
+
+  s_packetsState.initialized = OGE_TRUE;
+
+  if (s_packetsState.renderThread) {
+    OGE_INFO("Render thread started, %u packets in flight.",
+             s_packetsState.depth);
+  }
+  OGE_INFO("Render packets initialized.");
+  return OGE_TRUE;
+}
+
+void ogeRenderPacketsTerminate() {
+  OGE_ASSERT(
+    s_packetsState.initialized,
+    "Trying to terminate render packets while they're already terminated."
+  );
+
+  if (s_packetsState.renderThread) {
+    ogeMutexLock(&s_packetsState.mutex);
+    s_packetsState.running = OGE_FALSE;
+    ogeConditionSignal(&s_packetsState.packetPublished);
+    ogeMutexUnlock(&s_packetsState.mutex);
+
+    ogeThreadJoin(&s_packetsState.thread);
+  }
+
+  const OgeRenderPacketsStats *stats = ogeRenderPacketsGetStats();
+  if (stats->packetCount) {
+    OGE_INFO("Render packets: %llu submitted, blocked %.3f ms, queued "
+             "%.3f ms, submit %.3f ms, input to submit %.3f ms "
+             "(at most %.3f ms) on average.",
+             stats->packetCount,
+             OGE_NS_TO_MILLISECONDS(stats->meanBlockTime),
+             OGE_NS_TO_MILLISECONDS(stats->meanQueueTime),
+             OGE_NS_TO_MILLISECONDS(stats->meanSubmitTime),
+             OGE_NS_TO_MILLISECONDS(stats->meanLatency),
+             OGE_NS_TO_MILLISECONDS(stats->maxLatency));
+  }
+
+  ogeConditionDestroy(&s_packetsState.packetPublished);
+  ogeConditionDestroy(&s_packetsState.packetFreed);
+  ogeMutexDestroy(&s_packetsState.mutex);
+  ogeFree(s_packetsState.data);
+
+  s_packetsState.initialized = OGE_FALSE;
+
+  OGE_INFO("Render packets terminated.");
+}
+
+b8 ogeRenderPacketsBegin(const OgeFrameInfo *frameInfo, u64 inputTime) {
+  OGE_ASSERT(!s_packetsState.building,
+             "Trying to begin a render packet while building one.");
+
+  const u64 blockStart = ogeClockNow();
+
+  ogeMutexLock(&s_packetsState.mutex);
+  while (s_packetsState.head - s_packetsState.tail == s_packetsState.depth &&
+         !s_packetsState.failed) {
+    ogeConditionWait(&s_packetsState.packetFreed, &s_packetsState.mutex,
+                     RENDER_PACKETS_WAIT_TIMEOUT);
+  }
+  const b8 failed = s_packetsState.failed;
+  s_packetsState.blockTimeSum += ogeClockNow() - blockStart;
+  ogeMutexUnlock(&s_packetsState.mutex);
+
+  if (failed) { return OGE_FALSE; }
+
+  OgeRenderPacket *packet =
+    &s_packetsState.packets[s_packetsState.head % s_packetsState.depth];
+  packet->frameInfo = *frameInfo;
+  packet->inputTime = inputTime;
+  packet->dataSize  = 0;
+
+  s_packetsState.building = OGE_TRUE;
+  return OGE_TRUE;
+}
+
+b8 ogeRenderPacketsEnd() {
+  OGE_ASSERT(s_packetsState.building,
+             "Trying to end a render packet without beginning one.");
+
+  OgeRenderPacket *packet =
+    &s_packetsState.packets[s_packetsState.head % s_packetsState.depth];
+  packet->publishTime = ogeClockNow();
+  s_packetsState.building = OGE_FALSE;
+
+  if (!s_packetsState.renderThread) {
+    s_packetsState.head += 1;
+    s_packetsState.tail += 1;
+    return submitPacket(packet);
+  }
+
+  ogeMutexLock(&s_packetsState.mutex);
+  s_packetsState.head += 1;
+  ogeConditionSignal(&s_packetsState.packetPublished);
+  const b8 failed = s_packetsState.failed;
+  ogeMutexUnlock(&s_packetsState.mutex);
+
+  return !failed;
+}
+
+void ogeRenderPacketsFlush() {
+  if (!s_packetsState.renderThread) { return; }
+
+  ogeMutexLock(&s_packetsState.mutex);
+  while (s_packetsState.tail != s_packetsState.head) {
+    ogeConditionWait(&s_packetsState.packetFreed, &s_packetsState.mutex,
+                     RENDER_PACKETS_WAIT_TIMEOUT);
+  }
+  ogeMutexUnlock(&s_packetsState.mutex);
+}
+
+void* ogeRenderPacketAlloc(u64 size) {
+  OGE_ASSERT(s_packetsState.building,
+             "Render packet data can only be allocated while building one.");
+
+  OgeRenderPacket *packet =
+    &s_packetsState.packets[s_packetsState.head % s_packetsState.depth];
+
+  const u64 offset = (packet->dataSize + RENDER_PACKET_DATA_ALIGNMENT - 1) &
+                     ~(u64)(RENDER_PACKET_DATA_ALIGNMENT - 1);
+  if (offset + size > s_packetsState.dataSize) {
+    OGE_ERROR_LIMITED("Render packet is full, increase its data size.");
+    return 0;
+  }
+
+  packet->dataSize = offset + size;
+  return (u8*)packet->data + offset;
+}
+
+b8 ogeRenderPacketsPopCompletion(OgeRenderPacketCompletion *completion) {
+  ogeMutexLock(&s_packetsState.mutex);
+
+  const u64 written = s_packetsState.completionsWritten;
+  if (written - s_packetsState.completionsRead >
+      OGE_RENDER_PACKETS_COMPLETION_COUNT) {
+    s_packetsState.completionsRead =
+      written - OGE_RENDER_PACKETS_COMPLETION_COUNT;
+  }
+
+  const b8 result = s_packetsState.completionsRead < written;
+  if (result) {
+    *completion =
+      s_packetsState.completions[s_packetsState.completionsRead %
+                                 OGE_RENDER_PACKETS_COMPLETION_COUNT];
+    s_packetsState.completionsRead += 1;
+  }
+
+  ogeMutexUnlock(&s_packetsState.mutex);
+  return result;
+}
+
+const OgeRenderPacketsStats* ogeRenderPacketsGetStats() {
+  ogeMutexLock(&s_packetsState.mutex);
+
+  OgeRenderPacketsStats *stats = &s_packetsState.stats;
+  if (stats->packetCount) {
+    const f64 count = (f64)stats->packetCount;
+    stats->meanBlockTime  = s_packetsState.blockTimeSum  / count;
+    stats->meanQueueTime  = s_packetsState.queueTimeSum  / count;
+    stats->meanSubmitTime = s_packetsState.submitTimeSum / count;
+    stats->meanLatency    = s_packetsState.latencySum    / count;
+  }
+
+  ogeMutexUnlock(&s_packetsState.mutex);
+  return stats;
+}
@@ -13,10 +13,10 @@ OGE_INLINE void querryQueueFamilyIndicies(
   VkSurfaceKHR surface,
   queueFamilyIndicies *pQueueFamilyIndicies) {
 
-  pQueueFamilyIndicies->graphics = -1;
-  pQueueFamilyIndicies->transfer = -1;
-  pQueueFamilyIndicies->compute  = -1;
-  pQueueFamilyIndicies->present  = -1;
+  pQueueFamilyIndicies->graphics = QUEUE_FAMILY_NONE;
+  pQueueFamilyIndicies->transfer = QUEUE_FAMILY_NONE;
+  pQueueFamilyIndicies->compute  = QUEUE_FAMILY_NONE;
+  pQueueFamilyIndicies->present  = QUEUE_FAMILY_NONE;
 
   u32 queueFamilyCount;
   vkGetPhysicalDeviceQueueFamilyProperties(
@@ -25,31 +25,33 @@ OGE_INLINE void querryQueueFamilyIndicies(
   vkGetPhysicalDeviceQueueFamilyProperties(
     device, &queueFamilyCount, familyProperties);
 
-  u8 minScore = 255;
   for (u32 i = 0; i < queueFamilyCount; ++i) {
     // Graphics queue
-    if (pQueueFamilyIndicies->graphics == -1 &&
+    if (pQueueFamilyIndicies->graphics == QUEUE_FAMILY_NONE &&
        (familyProperties[i].queueFlags & VK_QUEUE_GRAPHICS_BIT)) {
       pQueueFamilyIndicies->graphics = i;
       continue;
     }
 
     // Transfer queue
-    if (pQueueFamilyIndicies->transfer == -1 &&
+    if (pQueueFamilyIndicies->transfer == QUEUE_FAMILY_NONE &&
        (familyProperties[i].queueFlags & VK_QUEUE_TRANSFER_BIT)) {
         pQueueFamilyIndicies->transfer = i;
       continue;
     }
 
     // Compute queue
-    if (pQueueFamilyIndicies->compute == -1 &&
+    if (pQueueFamilyIndicies->compute == QUEUE_FAMILY_NONE &&
        (familyProperties[i].queueFlags & VK_QUEUE_COMPUTE_BIT)) {
       pQueueFamilyIndicies->compute = i;
       continue;
     }
 
     // Present queue
-    if (pQueueFamilyIndicies->present != -1) { continue; }
+    if (pQueueFamilyIndicies->present != QUEUE_FAMILY_NONE ||
+        surface == VK_NULL_HANDLE) {
+      continue;
+    }
 
     VkBool32 isPresentSupported = VK_FALSE;
     vkGetPhysicalDeviceSurfaceSupportKHR(device, i, surface,
@@ -58,6 +60,35 @@ OGE_INLINE void querryQueueFamilyIndicies(
       pQueueFamilyIndicies->present = i;
     }
   }
+
+  if (pQueueFamilyIndicies->graphics == QUEUE_FAMILY_NONE) { return; }
+
+  // Devices with fewer queue families (e.g. lavapipe has a single
+  // one) share the graphics family, it supports transfer and
+  // compute too
+  if (pQueueFamilyIndicies->transfer == QUEUE_FAMILY_NONE) {
+    pQueueFamilyIndicies->transfer = pQueueFamilyIndicies->graphics;
+  }
+
+  if (pQueueFamilyIndicies->compute == QUEUE_FAMILY_NONE) {
+    pQueueFamilyIndicies->compute = pQueueFamilyIndicies->graphics;
+  }
+
+  // Nothing is presented without a surface
+  if (surface == VK_NULL_HANDLE) {
+    pQueueFamilyIndicies->present = pQueueFamilyIndicies->graphics;
+    return;
+  }
+
+  if (pQueueFamilyIndicies->present == QUEUE_FAMILY_NONE) {
+    VkBool32 isPresentSupported = VK_FALSE;
+    vkGetPhysicalDeviceSurfaceSupportKHR(
+      device, pQueueFamilyIndicies->graphics, surface, &isPresentSupported);
+
+    if (isPresentSupported) {
+      pQueueFamilyIndicies->present = pQueueFamilyIndicies->graphics;
+    }
+  }
 }
 
 void querrySwapchainSupport(
@@ -66,7 +97,7 @@ void querrySwapchainSupport(
   swapchainSupport *pSwapchainSupport) {
 
   // Surface capabilities
-  VkSurfaceCapabilitiesKHR surfaceCapabilities; vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
+  vkGetPhysicalDeviceSurfaceCapabilitiesKHR(
     device, surface, &pSwapchainSupport->surfaceCapabilities);
 
   // Surface formats
@@ -1,16 +1,26 @@
+#define OGE_LOG_CATEGORY RENDERER
+
 #include <stdio.h>
+#include <stddef.h>
 #include <string.h>
 
 #include <vulkan/vulkan.h>
 #include <vulkan/vulkan_core.h>
 
 #include "oge/defines.h"
+#include "oge/core/jobs.h"
+#include "oge/core/file.h"
+#include "oge/core/clock.h"
 #include "oge/core/memory.h"
+#include "oge/core/thread.h"
 #include "oge/core/logging.h"
 #include "oge/core/platform.h"
+#include "oge/core/startup.h"
+#include "oge/core/profiler.h"
 #include "oge/core/assertion.h"
 #include "oge/containers/darray.h"
 #include "oge/renderer/renderer.h"
+#include "oge/renderer/pipelines.h"
 
 #include "types.h"
 #include "querries.h"
@@ -21,12 +31,19 @@
 
 #define MAX_FRAMES_IN_FLIGHT 2
 
+// Accounts a Vulkan call to startup driver time. The call is an
+// argument of endDriverCall, so it's evaluated after the begin one.
+#define DRIVER_CALL(call) (ogeStartupDriverBegin(), endDriverCall(call))
+
 // TODO: write custom allocators for vulkan
 static struct {
   b8 initialized;
+  b8 headless;
 
   VkInstance instance;
 
+  // Headless renderer has no surface and swapchain, its swapchain
+  // images are offscreen ones backed by its own memory
   VkSurfaceKHR surface;
   VkSwapchainKHR swapchain;
   swapchainSupport swapchainSupport;
@@ -36,6 +53,7 @@ static struct {
   VkImage *swapchainImages;
   VkImageView *swapchainImageViews;
   VkFramebuffer *framebuffers;
+  VkDeviceMemory *headlessImageMemory;
 
   VkPhysicalDevice physicalDevice;
   VkPhysicalDeviceFeatures physicalDeviceFeatures;
@@ -43,6 +61,7 @@ static struct {
   VkPhysicalDeviceMemoryProperties physicalDeviceMemoryProperties;
   queueFamilyIndicies queueFamilyIndicies;
 
+  u32 deviceExtensionCount;
   VkDevice logicalDevice;
   struct {
     VkQueue graphics;
@@ -53,9 +72,28 @@ static struct {
 
   VkRenderPass renderPass;
 
-  VkPipeline graphicsPipeline;
   VkPipelineLayout graphicsPipelineLayout;
 
+  // Pipelines are looked up by a hash of their description. Ids
+  // index the fixed array, so they stay valid while it fills up.
+  pipelineEntry *pipelines;
+  u64 pipelineHashes[OGE_PIPELINES_MAX_PIPELINES];
+  u32 pipelineCount;
+  OgeMutex pipelinesMutex;
+  OgeJobCounter pipelineCompileCounter;
+
+  // Seeded from a file at init and saved back at terminate, so warm
+  // starts don't compile pipelines again
+  VkPipelineCache pipelineCache;
+  const char *pipelineCacheFileName;
+  OgeRendererPipelineCacheStats pipelineCacheStats;
+
+  // Modules are keyed by a hash of SPIR-V code, so identical stages
+  // of different pipelines share one. Init steps create them
+  // concurrently, hence the mutex.
+  OgeMutex shaderModulesMutex;
+  shaderModule *shaderModules;
+
   struct {
     VkCommandPool graphics;
     VkCommandPool transfer;
@@ -74,6 +112,12 @@ static struct {
   VkSemaphore *renderFinishedSemaphores;
   VkFence *inFlightFences;
 
+  // Every frame in flight writes a pair of timestamps, the first
+  // at the top and the second at the bottom of the pipe
+  VkQueryPool timestampQueryPool;
+  b8 timestampsWritten[MAX_FRAMES_IN_FLIGHT];
+  OgeRendererFrameStats frameStats;
+
   u32 currentFrameIndex;
   u32 currentImageIndex;
   VkClearValue frameClearColor;
@@ -89,12 +133,14 @@ static struct {
   .pAllocator = 0, // temporary, while custom allocator isn't written
 };
 
+// The swapchain extension goes last, headless renderer doesn't
+// enable it
 const char *s_ppRequiredDeviceExtensions[] = {
 #if defined(OGE_PLATFORM_APPLE)
   #define REQUIRED_DEVICE_EXTENSIONS_COUNT 2
 
-  VK_KHR_SWAPCHAIN_EXTENSION_NAME,
   "VK_KHR_portability_subset",
+  VK_KHR_SWAPCHAIN_EXTENSION_NAME,
 #elif defined(OGE_PLATFORM_LINUX)
   #define REQUIRED_DEVICE_EXTENSIONS_COUNT 1
 
@@ -104,6 +150,11 @@ const char *s_ppRequiredDeviceExtensions[] = {
 #endif
 };
 
+OGE_INLINE VkResult endDriverCall(VkResult result) {
+  ogeStartupDriverEnd();
+  return result;
+}
+
 #ifdef OGE_DEBUG
 void createDebugMessenger() {
   OGE_TRACE("Creating Vulkan debug messenger.");
@@ -123,9 +174,9 @@ void createDebugMessenger() {
     .pUserData = 0,
   };
 
-  const VkResult result = vkCreateDebugUtilsMessengerEXT(
+  const VkResult result = DRIVER_CALL(vkCreateDebugUtilsMessengerEXT(
     s_rendererState.instance, &createInfo,
-    s_rendererState.pAllocator, &s_rendererState.debugMessenger);
+    s_rendererState.pAllocator, &s_rendererState.debugMessenger));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan debug messenger.");
     return;
@@ -139,7 +190,7 @@ OGE_INLINE b8 isValidationLayerSupported(const char *pLayerName) {
   OGE_TRACE("Checking Vulkan validation layer support.");
 
   u32 layerCount;
-  const VkResult result = vkEnumerateInstanceLayerProperties(&layerCount, NULL);
+  vkEnumerateInstanceLayerProperties(&layerCount, NULL);
   VkLayerProperties pLayerProperties[layerCount];
   vkEnumerateInstanceLayerProperties(&layerCount, pLayerProperties);
 
@@ -157,7 +208,7 @@ OGE_INLINE b8 isValidationLayerSupported(const char *pLayerName) {
 /************************************************
  *              creation functions              *
  ************************************************/
-OGE_INLINE b8 createInstance(const OgeRendererInitInfo *pInitInfo) {
+static OGE_INLINE b8 createInstance(const OgeRendererInitInfo *pInitInfo) {
   VkApplicationInfo applicationInfo = {
     .sType              = VK_STRUCTURE_TYPE_APPLICATION_INFO,
     .apiVersion         = VK_API_VERSION_1_3,
@@ -179,15 +230,14 @@ OGE_INLINE b8 createInstance(const OgeRendererInitInfo *pInitInfo) {
     .ppEnabledLayerNames = 0,
   };
 
+  // Headless platform has no extensions, so they're written straight
+  // into the darray instead of a zero length array
   u32 extensionsCount;
   ogePlatformGetDeviceExtensions(&extensionsCount, 0);
-  const char* extensionNames[extensionsCount];
-  ogePlatformGetDeviceExtensions(&extensionsCount, extensionNames);
-
   const char* *extensions =
     ogeDArrayAlloc(extensionsCount, sizeof(char*));
-  extensions =
-    ogeDArrayExtend(extensions, extensionNames, extensionsCount);
+  ogePlatformGetDeviceExtensions(&extensionsCount, extensions);
+  ogeDArrayLength(extensions) = extensionsCount;
 
   #ifdef OGE_PLATFORM_APPLE
   const char *pPortabilityExtensionName = 
@@ -214,8 +264,8 @@ OGE_INLINE b8 createInstance(const OgeRendererInitInfo *pInitInfo) {
   info.ppEnabledExtensionNames = extensions;
 
   const VkResult result = 
-    vkCreateInstance(&info, s_rendererState.pAllocator,
-                     &s_rendererState.instance);
+    DRIVER_CALL(vkCreateInstance(&info, s_rendererState.pAllocator,
+                                 &s_rendererState.instance));
 
   ogeDArrayFree(extensions);
 
@@ -228,12 +278,17 @@ OGE_INLINE b8 createInstance(const OgeRendererInitInfo *pInitInfo) {
   return OGE_TRUE;
 }
 
-OGE_INLINE b8 createSurface() {
+static OGE_INLINE b8 createSurface() {
+  if (s_rendererState.headless) {
+    s_rendererState.surface = VK_NULL_HANDLE;
+    return OGE_TRUE;
+  }
+
   OGE_TRACE("Creating Vulkan surface.");
 
   const VkResult result =
-    ogePlatformCreateSurface(s_rendererState.instance,
-      s_rendererState.pAllocator, &s_rendererState.surface);
+    DRIVER_CALL(ogePlatformCreateSurface(s_rendererState.instance,
+      s_rendererState.pAllocator, &s_rendererState.surface));
 
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan instance: %d.", result);
@@ -244,27 +299,29 @@ OGE_INLINE b8 createSurface() {
   return OGE_TRUE;
 }
 
-OGE_INLINE b8 isGPUSuitable(VkPhysicalDevice device) {
+static OGE_INLINE b8 isGPUSuitable(VkPhysicalDevice device) {
   // Queue family indicies
   queueFamilyIndicies queueFamilyIndicies;
   querryQueueFamilyIndicies(
     device, s_rendererState.surface, &queueFamilyIndicies);
 
-  if (queueFamilyIndicies.graphics == -1 ||
-      queueFamilyIndicies.transfer == -1 ||
-      queueFamilyIndicies.compute  == -1 ||
-      queueFamilyIndicies.present  == -1) {
+  if (queueFamilyIndicies.graphics == QUEUE_FAMILY_NONE ||
+      queueFamilyIndicies.transfer == QUEUE_FAMILY_NONE ||
+      queueFamilyIndicies.compute  == QUEUE_FAMILY_NONE ||
+      queueFamilyIndicies.present  == QUEUE_FAMILY_NONE) {
     return OGE_FALSE;
   }
 
   // Swapchain support
-  swapchainSupport swapchainSupport;
-  querrySwapchainSupport(
-    device, s_rendererState.surface, &swapchainSupport);
+  if (!s_rendererState.headless) {
+    swapchainSupport swapchainSupport;
+    querrySwapchainSupport(
+      device, s_rendererState.surface, &swapchainSupport);
 
-  if (swapchainSupport.formatCount      == 0 ||
-      swapchainSupport.presentModeCount == 0) {
-    return OGE_FALSE;
+    if (swapchainSupport.formatCount      == 0 ||
+        swapchainSupport.presentModeCount == 0) {
+      return OGE_FALSE;
+    }
   }
 
   // Device extensions
@@ -279,7 +336,7 @@ OGE_INLINE b8 isGPUSuitable(VkPhysicalDevice device) {
     device, 0, &availableExtensionCount, pDeviceExtensions);
 
   b8 extensionFound;
-  for (u32 i = 0; i < REQUIRED_DEVICE_EXTENSIONS_COUNT; ++i) {
+  for (u32 i = 0; i < s_rendererState.deviceExtensionCount; ++i) {
     extensionFound = OGE_FALSE;
 
     for (u32 j = 0; j < availableExtensionCount; ++j) {
@@ -309,11 +366,12 @@ OGE_INLINE b8 isGPUSuitable(VkPhysicalDevice device) {
 //
 // but do wee really need these requirements if we are already
 // know which things are really necessery for engine to fire up?
-OGE_INLINE b8 selectGPU(/* requirements ? */) {
+static OGE_INLINE b8 selectGPU(/* requirements ? */) {
   OGE_TRACE("Selecting GPU.");
 
   u32 deviceCount = 0;
-  vkEnumeratePhysicalDevices(s_rendererState.instance, &deviceCount, 0);
+  DRIVER_CALL(vkEnumeratePhysicalDevices(s_rendererState.instance,
+                                         &deviceCount, 0));
 
   if (deviceCount == 0) {
     OGE_ERROR("Failed to find GPUs with Vulkan support.");
@@ -321,7 +379,8 @@ OGE_INLINE b8 selectGPU(/* requirements ? */) {
   }
 
   VkPhysicalDevice devices[deviceCount];
-  vkEnumeratePhysicalDevices(s_rendererState.instance, &deviceCount, devices);
+  DRIVER_CALL(vkEnumeratePhysicalDevices(s_rendererState.instance,
+                                         &deviceCount, devices));
 
   for (u32 i = 0; i < deviceCount; ++i) {
     if (!isGPUSuitable(devices[i])) { continue; }
@@ -346,9 +405,11 @@ OGE_INLINE b8 selectGPU(/* requirements ? */) {
       devices[i], s_rendererState.surface,
       &s_rendererState.queueFamilyIndicies);
 
-    querrySwapchainSupport(
-      devices[i], s_rendererState.surface,
-      &s_rendererState.swapchainSupport);
+    if (!s_rendererState.headless) {
+      querrySwapchainSupport(
+        devices[i], s_rendererState.surface,
+        &s_rendererState.swapchainSupport);
+    }
 
     OGE_INFO(
       "Selected GPU:\n\n\t➜ Name:               %s\n\t➜ Driver version:     %d.%d.%d\n\t➜ Vulkan API version: %d.%d.%d\n", 
@@ -369,8 +430,9 @@ OGE_INLINE b8 selectGPU(/* requirements ? */) {
   return OGE_FALSE;
 }
 
-OGE_INLINE b8 createLogicalDevice() {
-  // Queues
+// Queues may share a family, but every family should be listed
+// only once on device and swapchain creation
+static OGE_INLINE u32 getUniqueQueueFamilies(u32 *families) {
   const u32 queueFamilyIndicies[] = {
     s_rendererState.queueFamilyIndicies.graphics,
     s_rendererState.queueFamilyIndicies.transfer,
@@ -378,10 +440,28 @@ OGE_INLINE b8 createLogicalDevice() {
     s_rendererState.queueFamilyIndicies.present,
   };
 
+  u32 count = 0;
+  for (u32 i = 0; i < 4; ++i) {
+    b8 found = OGE_FALSE;
+    for (u32 j = 0; j < count; ++j) {
+      if (families[j] == queueFamilyIndicies[i]) { found = OGE_TRUE; }
+    }
+
+    if (!found) { families[count++] = queueFamilyIndicies[i]; }
+  }
+
+  return count;
+}
+
+static OGE_INLINE b8 createLogicalDevice() {
+  // Queues
+  u32 queueFamilyIndicies[4];
+  const u32 queueFamilyCount = getUniqueQueueFamilies(queueFamilyIndicies);
+
   VkDeviceQueueCreateInfo queueCreateInfos[4];
 
   const f32 queuePriopity = 1.0f;
-  for (u32 i = 0; i < 4; ++i) {
+  for (u32 i = 0; i < queueFamilyCount; ++i) {
     VkDeviceQueueCreateInfo *ptr  = queueCreateInfos + i;
 
     ptr->sType            = VK_STRUCTURE_TYPE_DEVICE_QUEUE_CREATE_INFO;
@@ -406,21 +486,21 @@ OGE_INLINE b8 createLogicalDevice() {
     .enabledLayerCount = 0,
     .ppEnabledLayerNames = 0,
 
-    .enabledExtensionCount = REQUIRED_DEVICE_EXTENSIONS_COUNT,
+    .enabledExtensionCount = s_rendererState.deviceExtensionCount,
     .ppEnabledExtensionNames = s_ppRequiredDeviceExtensions,
 
     .pEnabledFeatures = &deviceFeatures,
 
-    .queueCreateInfoCount = 4,
+    .queueCreateInfoCount = queueFamilyCount,
     .pQueueCreateInfos = queueCreateInfos,
 
     .pNext = 0,
   };
 
   const VkResult result =
-    vkCreateDevice(s_rendererState.physicalDevice, &info,
-                   s_rendererState.pAllocator,
-                   &s_rendererState.logicalDevice);
+    DRIVER_CALL(vkCreateDevice(s_rendererState.physicalDevice, &info,
+                               s_rendererState.pAllocator,
+                               &s_rendererState.logicalDevice));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan logical device: %d.", result);
     return OGE_FALSE;
@@ -485,7 +565,7 @@ OGE_INLINE VkExtent2D chooseExtent(VkSurfaceCapabilitiesKHR surfaceCapabilities)
   return surfaceCapabilities.currentExtent;
 }
 
-OGE_INLINE b8 createSwapchain() {
+static OGE_INLINE b8 createSwapchain() {
   swapchainSupport swapchainSupport;
   querrySwapchainSupport(s_rendererState.physicalDevice,
                          s_rendererState.surface, &swapchainSupport);
@@ -501,15 +581,14 @@ OGE_INLINE b8 createSwapchain() {
   s_rendererState.swapchainExtent
     = chooseExtent(swapchainSupport.surfaceCapabilities);
 
-  s_rendererState.swapchainFormat = surfaceFormat.format;
+  // The format was selected along with the device, the render pass
+  // may be reading it right now
+  OGE_ASSERT(surfaceFormat.format == s_rendererState.swapchainFormat,
+             "Swapchain format differs from the selected one.");
 
   // Creation
-  const u32 queueFamilyIndicies[] = {
-    s_rendererState.queueFamilyIndicies.graphics,
-    s_rendererState.queueFamilyIndicies.transfer,
-    s_rendererState.queueFamilyIndicies.compute,
-    s_rendererState.queueFamilyIndicies.present
-  };
+  u32 queueFamilyIndicies[4];
+  const u32 queueFamilyCount = getUniqueQueueFamilies(queueFamilyIndicies);
 
   const VkSwapchainCreateInfoKHR info = {
     .sType                 = VK_STRUCTURE_TYPE_SWAPCHAIN_CREATE_INFO_KHR,
@@ -520,12 +599,14 @@ OGE_INLINE b8 createSwapchain() {
     .imageColorSpace       = surfaceFormat.colorSpace,
     .imageExtent           = s_rendererState.swapchainExtent,
     .imageArrayLayers      = 1,
-    .imageSharingMode      = VK_SHARING_MODE_CONCURRENT,
+    .imageSharingMode      = queueFamilyCount > 1
+                           ? VK_SHARING_MODE_CONCURRENT
+                           : VK_SHARING_MODE_EXCLUSIVE,
     .imageUsage            = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT,
     .preTransform          =
       swapchainSupport.surfaceCapabilities.currentTransform,
     .compositeAlpha        = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR,
-    .queueFamilyIndexCount = 4,
+    .queueFamilyIndexCount = queueFamilyCount > 1 ? queueFamilyCount : 0,
     .pQueueFamilyIndices   = queueFamilyIndicies,
     .presentMode           = presentMode,
     .clipped               = VK_TRUE,
@@ -533,9 +614,9 @@ OGE_INLINE b8 createSwapchain() {
     .pNext                 = 0,
   };
 
-  const VkResult result = vkCreateSwapchainKHR(
+  const VkResult result = DRIVER_CALL(vkCreateSwapchainKHR(
     s_rendererState.logicalDevice, &info, s_rendererState.pAllocator,
-    &s_rendererState.swapchain);
+    &s_rendererState.swapchain));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan swapchain.");
     return OGE_FALSE;
@@ -545,21 +626,121 @@ OGE_INLINE b8 createSwapchain() {
 }
 
 void getSwapchainImages() {
-  vkGetSwapchainImagesKHR(
+  DRIVER_CALL(vkGetSwapchainImagesKHR(
     s_rendererState.logicalDevice, s_rendererState.swapchain,
-    &s_rendererState.swapchainImageCount, 0);
+    &s_rendererState.swapchainImageCount, 0));
 
   s_rendererState.swapchainImages =
     ogeAlloc(sizeof(VkImage) * s_rendererState.swapchainImageCount,
              OGE_MEMORY_TAG_ARRAY);
 
-  vkGetSwapchainImagesKHR(
+  DRIVER_CALL(vkGetSwapchainImagesKHR(
     s_rendererState.logicalDevice, s_rendererState.swapchain,
-    &s_rendererState.swapchainImageCount, s_rendererState.swapchainImages);
+    &s_rendererState.swapchainImageCount, s_rendererState.swapchainImages));
 
   OGE_TRACE("Vulkan swapchain images obtained.");
 }
 
+static OGE_INLINE i32 findMemoryType(u32 typeBits,
+                                      VkMemoryPropertyFlags flags) {
+  const VkPhysicalDeviceMemoryProperties *properties =
+    &s_rendererState.physicalDeviceMemoryProperties;
+
+  for (u32 i = 0; i < properties->memoryTypeCount; ++i) {
+    if ((typeBits & (1u << i)) &&
+        (properties->memoryTypes[i].propertyFlags & flags) == flags) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+// Stand in for swapchain images, an image per frame in flight
+b8 createHeadlessImages(const OgeRendererInitInfo *initInfo) {
+  s_rendererState.swapchainExtent.width = initInfo->headlessWidth
+                                        ? initInfo->headlessWidth
+                                        : OGE_RENDERER_DEFAULT_HEADLESS_WIDTH;
+  s_rendererState.swapchainExtent.height = initInfo->headlessHeight
+                                         ? initInfo->headlessHeight
+                                         : OGE_RENDERER_DEFAULT_HEADLESS_HEIGHT;
+  s_rendererState.swapchainImageCount = MAX_FRAMES_IN_FLIGHT;
+
+  s_rendererState.swapchainImages =
+    ogeAlloc(sizeof(VkImage) * MAX_FRAMES_IN_FLIGHT, OGE_MEMORY_TAG_ARRAY);
+  s_rendererState.headlessImageMemory =
+    ogeAlloc(sizeof(VkDeviceMemory) * MAX_FRAMES_IN_FLIGHT,
+             OGE_MEMORY_TAG_RENDERER);
+
+  for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i) {
+    const VkImageCreateInfo imageInfo = {
+      .sType                 = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
+      .pNext                 = 0,
+      .flags                 = 0,
+      .imageType             = VK_IMAGE_TYPE_2D,
+      .format                = s_rendererState.swapchainFormat,
+      .extent.width          = s_rendererState.swapchainExtent.width,
+      .extent.height         = s_rendererState.swapchainExtent.height,
+      .extent.depth          = 1,
+      .mipLevels             = 1,
+      .arrayLayers           = 1,
+      .samples               = VK_SAMPLE_COUNT_1_BIT,
+      .tiling                = VK_IMAGE_TILING_OPTIMAL,
+      .usage                 = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT |
+                               VK_IMAGE_USAGE_TRANSFER_SRC_BIT,
+      .sharingMode           = VK_SHARING_MODE_EXCLUSIVE,
+      .queueFamilyIndexCount = 0,
+      .pQueueFamilyIndices   = 0,
+      .initialLayout         = VK_IMAGE_LAYOUT_UNDEFINED,
+    };
+
+    VkResult result =
+      DRIVER_CALL(vkCreateImage(s_rendererState.logicalDevice, &imageInfo,
+                                s_rendererState.pAllocator,
+                                &s_rendererState.swapchainImages[i]));
+    if (result != VK_SUCCESS) {
+      OGE_ERROR("Failed to create Vulkan headless image: %d.", result);
+      return OGE_FALSE;
+    }
+
+    VkMemoryRequirements requirements;
+    vkGetImageMemoryRequirements(s_rendererState.logicalDevice,
+                                 s_rendererState.swapchainImages[i],
+                                 &requirements);
+
+    // Software implementations may have no device local memory
+    i32 memoryType = findMemoryType(requirements.memoryTypeBits,
+                                    VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+    if (memoryType == -1) {
+      memoryType = findMemoryType(requirements.memoryTypeBits, 0);
+    }
+
+    const VkMemoryAllocateInfo allocateInfo = {
+      .sType           = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO,
+      .pNext           = 0,
+      .allocationSize  = requirements.size,
+      .memoryTypeIndex = memoryType,
+    };
+
+    result = DRIVER_CALL(
+      vkAllocateMemory(s_rendererState.logicalDevice, &allocateInfo,
+                       s_rendererState.pAllocator,
+                       &s_rendererState.headlessImageMemory[i]));
+    if (result != VK_SUCCESS) {
+      OGE_ERROR("Failed to allocate Vulkan headless image memory: %d.",
+                result);
+      return OGE_FALSE;
+    }
+
+    vkBindImageMemory(s_rendererState.logicalDevice,
+                      s_rendererState.swapchainImages[i],
+                      s_rendererState.headlessImageMemory[i], 0);
+  }
+
+  OGE_TRACE("Vulkan headless images created.");
+  return OGE_TRUE;
+}
+
 b8 createSwapchainImageViews() {
   s_rendererState.swapchainImageViews =
     ogeAlloc(sizeof(VkImageView) * s_rendererState.swapchainImageCount,
@@ -583,9 +764,9 @@ b8 createSwapchainImageViews() {
       .subresourceRange.layerCount     = 1,
     };
     VkResult result =
-      vkCreateImageView(s_rendererState.logicalDevice, &info,
-                        s_rendererState.pAllocator,
-                        &s_rendererState.swapchainImageViews[i]);
+      DRIVER_CALL(vkCreateImageView(s_rendererState.logicalDevice, &info,
+                                    s_rendererState.pAllocator,
+                                    &s_rendererState.swapchainImageViews[i]));
     if (result != VK_SUCCESS) {
       OGE_TRACE("Failed to create image views.");
       return OGE_FALSE;
@@ -606,7 +787,9 @@ b8 createRenderPass() {
     .stencilLoadOp  = VK_ATTACHMENT_LOAD_OP_DONT_CARE,
     .stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE,
     .initialLayout  = VK_IMAGE_LAYOUT_UNDEFINED,
-    .finalLayout    = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+    .finalLayout    = s_rendererState.headless
+                    ? VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL
+                    : VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
   };
 
   VkAttachmentReference colorAttachmentRef = {
@@ -648,8 +831,8 @@ b8 createRenderPass() {
   };
 
   VkResult result =
-    vkCreateRenderPass(s_rendererState.logicalDevice, &info,
-                       0, &s_rendererState.renderPass);
+    DRIVER_CALL(vkCreateRenderPass(s_rendererState.logicalDevice, &info,
+                                   0, &s_rendererState.renderPass));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan render pass.");
     return OGE_FALSE;
@@ -671,10 +854,11 @@ b8 createGraphicsPipelineLayout() {
   };
 
   VkResult result =
-    vkCreatePipelineLayout(s_rendererState.logicalDevice,
-                           &pipelineLayoutInfo,
-                           s_rendererState.pAllocator,
-                           &s_rendererState.graphicsPipelineLayout);
+    DRIVER_CALL(
+      vkCreatePipelineLayout(s_rendererState.logicalDevice,
+                             &pipelineLayoutInfo,
+                             s_rendererState.pAllocator,
+                             &s_rendererState.graphicsPipelineLayout));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan graphics pipeline layout.");
     return OGE_FALSE;
@@ -683,107 +867,459 @@ b8 createGraphicsPipelineLayout() {
   return OGE_TRUE;
 }
 
-b8 createShaderModule(const char *fileName, VkShaderModule *module) {
-  OGE_WARN("createShaderModule() uses standart C file I/O functions, replace them with OGE file I/O system calls.");
+/************************************************
+ *                pipeline cache                *
+ ************************************************/
+#define PIPELINE_CACHE_MAGIC   0x4350474Fu // "OGPC"
+#define PIPELINE_CACHE_VERSION 2
+
+// Driver caches are a few megabytes, a bigger data size comes from
+// a corrupted header
+#define PIPELINE_CACHE_MAX_DATA_SIZE OGE_MEBIBYTES(256)
+
+// Vulkan checks only a vendor, a device and a UUID of its cache
+// data, a file header also keys it by a driver version and guards
+// the data against truncated or corrupted files
+typedef struct pipelineCacheFileHeader {
+  u32 magic;
+  u32 version;
+  u32 vendorID;
+  u32 deviceID;
+  u32 driverVersion;
+  u8  pipelineCacheUUID[VK_UUID_SIZE];
+  u32 reserved;
+  u64 dataSize;
+  u64 dataHash;
+} pipelineCacheFileHeader;
+
+// FNV-1a over 64-bit words, a byte at a time it would take longer
+// to hash shader code than to map it. The tail is mixed in by bytes.
+OGE_INLINE u64 hashData(const void *data, u64 size) {
+  const u8 *bytes = data;
+  const u64 wordsSize = size & ~7ull;
+
+  u64 hash = 0xCBF29CE484222325ull ^ size;
+  for (u64 i = 0; i < wordsSize; i += sizeof(u64)) {
+    u64 word;
+    memcpy(&word, bytes + i, sizeof(u64));
+    hash  = (hash ^ word) * 0x100000001B3ull;
+    hash ^= hash >> 29;
+  }
+  for (u64 i = wordsSize; i < size; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static OGE_INLINE void initPipelineCacheFileHeader(
+  pipelineCacheFileHeader *header) {
+  const VkPhysicalDeviceProperties *properties =
+    &s_rendererState.physicalDeviceProperties;
+
+  ogeMemSet(header, 0, sizeof(pipelineCacheFileHeader));
+  header->magic         = PIPELINE_CACHE_MAGIC;
+  header->version       = PIPELINE_CACHE_VERSION;
+  header->vendorID      = properties->vendorID;
+  header->deviceID      = properties->deviceID;
+  header->driverVersion = properties->driverVersion;
+  ogeMemCpy(header->pipelineCacheUUID, properties->pipelineCacheUUID,
+            VK_UUID_SIZE);
+}
+
+static OGE_INLINE b8 isPipelineCacheDataValid(const u8 *data, u64 size) {
+  const VkPhysicalDeviceProperties *properties =
+    &s_rendererState.physicalDeviceProperties;
+
+  VkPipelineCacheHeaderVersionOne header;
+  if (size < sizeof(header)) { return OGE_FALSE; }
+  ogeMemCpy(&header, data, sizeof(header));
+
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties->vendorID &&
+         header.deviceID == properties->deviceID &&
+         ogeMemCmp(header.pipelineCacheUUID, properties->pipelineCacheUUID,
+                   VK_UUID_SIZE) == 0;
+}
+
+// Returns 0 if there's no cache data for the current device and
+// driver, a pipeline cache starts empty then
+static void* readPipelineCacheFile(const char *fileName, u64 *size) {
+  FILE *file = fopen(fileName, "rb");
+  if (!file) {
+    OGE_INFO("No pipeline cache file \"%s\", pipelines are compiled.",
+             fileName);
+    return 0;
+  }
+
+  pipelineCacheFileHeader expected, header;
+  initPipelineCacheFileHeader(&expected);
+
+  if (fread(&header, sizeof(header), 1, file) != 1) {
+    OGE_WARN("Pipeline cache file \"%s\" is truncated, ignoring it.",
+             fileName);
+    fclose(file);
+    return 0;
+  }
+
+  // Everything but the data size and hash identifies the device
+  if (ogeMemCmp(&header, &expected,
+                offsetof(pipelineCacheFileHeader, dataSize)) != 0) {
+    OGE_INFO("Pipeline cache file \"%s\" belongs to another device or "
+             "driver, ignoring it.", fileName);
+    fclose(file);
+    return 0;
+  }
+
+  // The data size is checked against the file before it's trusted
+  // with an allocation
+  const long fileSize = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+  if (fileSize < 0 || header.dataSize > PIPELINE_CACHE_MAX_DATA_SIZE ||
+      header.dataSize != (u64)fileSize - sizeof(header) ||
+      fseek(file, sizeof(header), SEEK_SET) != 0) {
+    OGE_WARN("Pipeline cache file \"%s\" is corrupted, ignoring it.",
+             fileName);
+    fclose(file);
+    return 0;
+  }
+
+  u8 *data = ogeAlloc(header.dataSize, OGE_MEMORY_TAG_RENDERER);
+  const u64 readSize = fread(data, 1, header.dataSize, file);
+  fclose(file);
+
+  if (readSize != header.dataSize ||
+      hashData(data, header.dataSize) != header.dataHash ||
+      !isPipelineCacheDataValid(data, header.dataSize)) {
+    OGE_WARN("Pipeline cache file \"%s\" is corrupted, ignoring it.",
+             fileName);
+    ogeFree(data);
+    return 0;
+  }
+
+  *size = header.dataSize;
+  return data;
+}
+
+b8 createPipelineCache() {
+  u64 size = 0;
+  void *data = readPipelineCacheFile(s_rendererState.pipelineCacheFileName,
+                                     &size);
+
+  VkPipelineCacheCreateInfo info = {
+    .sType           = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO,
+    .pNext           = 0,
+    .flags           = 0,
+    .initialDataSize = size,
+    .pInitialData    = data,
+  };
+
+  VkResult result =
+    DRIVER_CALL(vkCreatePipelineCache(s_rendererState.logicalDevice, &info,
+                                      s_rendererState.pAllocator,
+                                      &s_rendererState.pipelineCache));
+
+  // A driver may still reject data that passed validation
+  if (result != VK_SUCCESS && data) {
+    OGE_WARN("Vulkan rejected pipeline cache data, starting empty.");
+    info.initialDataSize = size = 0;
+    info.pInitialData    = 0;
+    result =
+      DRIVER_CALL(vkCreatePipelineCache(s_rendererState.logicalDevice, &info,
+                                        s_rendererState.pAllocator,
+                                        &s_rendererState.pipelineCache));
+  }
+
+  if (data) { ogeFree(data); }
+
+  if (result != VK_SUCCESS) {
+    OGE_ERROR("Failed to create Vulkan pipeline cache.");
+    return OGE_FALSE;
+  }
+
+  s_rendererState.pipelineCacheStats.loadedSize = size;
+  OGE_TRACE("Vulkan pipeline cache created with %llu bytes of data.", size);
+  return OGE_TRUE;
+}
+
+// Writes a temporary file and renames it over the old one, so a crash
+// while saving can't leave a truncated cache behind
+static void savePipelineCache() {
+  const char *fileName = s_rendererState.pipelineCacheFileName;
+
+  // A truncated name could be renamed over or removed in place of
+  // an unrelated file
+  char tempFileName[256];
+  const int length = snprintf(tempFileName, sizeof(tempFileName), "%s.tmp",
+                              fileName);
+  if (length < 0 || (size_t)length >= sizeof(tempFileName)) {
+    OGE_WARN("Pipeline cache file name \"%s\" is too long, the cache "
+             "isn't saved.", fileName);
+    return;
+  }
+
+  size_t size = 0;
+  VkResult result = vkGetPipelineCacheData(s_rendererState.logicalDevice,
+                                           s_rendererState.pipelineCache,
+                                           &size, 0);
+  if (result != VK_SUCCESS || size == 0) { return; }
+
+  u8 *data = ogeAlloc(size, OGE_MEMORY_TAG_RENDERER);
+  result = vkGetPipelineCacheData(s_rendererState.logicalDevice,
+                                  s_rendererState.pipelineCache, &size, data);
+  if (result != VK_SUCCESS) {
+    OGE_WARN("Failed to get Vulkan pipeline cache data.");
+    ogeFree(data);
+    return;
+  }
 
-  FILE *shaderCodeFile = fopen(fileName, "rb");
+  pipelineCacheFileHeader header;
+  initPipelineCacheFileHeader(&header);
+  header.dataSize = size;
+  header.dataHash = hashData(data, size);
+
+  FILE *file = fopen(tempFileName, "wb");
+  b8 written = file &&
+               fwrite(&header, sizeof(header), 1, file) == 1 &&
+               fwrite(data, 1, size, file) == size;
+  if (file) { written &= fclose(file) == 0; }
+  ogeFree(data);
+
+  if (!written || rename(tempFileName, fileName) != 0) {
+    OGE_WARN("Failed to save pipeline cache to \"%s\".", fileName);
+    remove(tempFileName);
+    return;
+  }
+  OGE_TRACE("Pipeline cache saved to \"%s\", %llu bytes.",
+            fileName, (u64)size);
+}
 
-  if (!shaderCodeFile) {
-    OGE_ERROR("createShaderModule(): failed to open \"%s\" file.",
-              fileName);
+/************************************************
+ *                shader modules                *
+ ************************************************/
+#define SPIRV_MAGIC 0x07230203u
+
+// SPIR-V words mapped from a file, Vulkan reads them right from
+// the mapping
+typedef struct shaderCode {
+  const char     *fileName;
+  OgeFileMapping  mapping;
+} shaderCode;
+
+// Doesn't need the device, so it runs while one is created
+static b8 loadShaderCode(shaderCode *shader) {
+  if (!ogeFileMap(shader->fileName, &shader->mapping)) {
+    OGE_ERROR("loadShaderCode(): failed to map \"%s\" file.",
+              shader->fileName);
     return OGE_FALSE;
   }
 
-  fseek(shaderCodeFile, 0, SEEK_END);
-  const u64 shaderCodeSize = ftell(shaderCodeFile);
-  rewind(shaderCodeFile);
+  const u32 *words = shader->mapping.data;
+  if (shader->mapping.size % sizeof(u32) != 0 || words[0] != SPIRV_MAGIC) {
+    OGE_ERROR("loadShaderCode(): \"%s\" isn't a SPIR-V file.",
+              shader->fileName);
+    return OGE_FALSE;
+  }
+  return OGE_TRUE;
+}
 
-  const char *shaderCode[shaderCodeSize];
-  fread(shaderCode, sizeof(shaderCode), 1, shaderCodeFile);
+static OGE_INLINE b8 findShaderModule(u64 hash, const void *code, u64 size,
+                                      VkShaderModule *module) {
+  const u64 count = ogeDArrayLength(s_rendererState.shaderModules);
+  for (u64 i = 0; i < count; ++i) {
+    const shaderModule *entry = &s_rendererState.shaderModules[i];
+    if (entry->hash == hash && entry->mapping.size == size &&
+        ogeMemCmp(entry->mapping.data, code, size) == 0) {
+      *module = entry->module;
+      return OGE_TRUE;
+    }
+  }
+  return OGE_FALSE;
+}
 
-  fclose(shaderCodeFile);
+// Returns a cached module if the same code was already seen. The
+// driver call is made outside of the lock, if another thread
+// created the same module meanwhile, the new one is dropped. A new
+// module takes over the mapping of its code, the shader's mapping
+// is zeroed then.
+b8 createShaderModule(shaderCode *shader, VkShaderModule *module) {
+  const void *code = shader->mapping.data;
+  const u64   size = shader->mapping.size;
+  const u64   hash = hashData(code, size);
+
+  ogeMutexLock(&s_rendererState.shaderModulesMutex);
+  const b8 found = findShaderModule(hash, code, size, module);
+  ogeMutexUnlock(&s_rendererState.shaderModulesMutex);
+
+  if (found) {
+    OGE_TRACE("Shader module reused: %s.", shader->fileName);
+    return OGE_TRUE;
+  }
 
   const VkShaderModuleCreateInfo info = {
     .sType    = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO,
     .pNext    = 0,
     .flags    = 0,
-    .codeSize = shaderCodeSize,
-    .pCode    = (u32*)shaderCode,
+    .codeSize = size,
+    .pCode    = code,
   };
 
+  VkShaderModule newModule;
   const VkResult result =
-    vkCreateShaderModule(s_rendererState.logicalDevice, &info,
-                         s_rendererState.pAllocator, module);
+    DRIVER_CALL(vkCreateShaderModule(s_rendererState.logicalDevice, &info,
+                                     s_rendererState.pAllocator,
+                                     &newModule));
   if (result != VK_SUCCESS) {
-    OGE_ERROR("Failed to create shader module: \"%s\".", fileName);
+    OGE_ERROR("Failed to create shader module: \"%s\".", shader->fileName);
     return OGE_FALSE;
   }
-  OGE_TRACE("Shader module created: %s.", fileName);
+
+  ogeMutexLock(&s_rendererState.shaderModulesMutex);
+  if (findShaderModule(hash, code, size, module)) {
+    vkDestroyShaderModule(s_rendererState.logicalDevice, newModule,
+                          s_rendererState.pAllocator);
+  } else {
+    const shaderModule entry = {
+      .hash    = hash,
+      .mapping = shader->mapping,
+      .module  = newModule,
+    };
+    s_rendererState.shaderModules =
+      ogeDArrayAppend(s_rendererState.shaderModules, &entry);
+    shader->mapping = (OgeFileMapping){ 0 };
+    *module = newModule;
+  }
+  ogeMutexUnlock(&s_rendererState.shaderModulesMutex);
+
+  OGE_TRACE("Shader module created: %s.", shader->fileName);
   return OGE_TRUE;
 }
 
-b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
-  VkShaderModule vertShaderModule, fragShaderModule;
-
-  if (!createShaderModule(initInfo->vertexShaderFileName,
-                          &vertShaderModule)) {
-    return OGE_FALSE;
+void destroyShaderModules() {
+  const u64 count = ogeDArrayLength(s_rendererState.shaderModules);
+  for (u64 i = 0; i < count; ++i) {
+    vkDestroyShaderModule(s_rendererState.logicalDevice,
+                          s_rendererState.shaderModules[i].module,
+                          s_rendererState.pAllocator);
+    ogeFileUnmap(&s_rendererState.shaderModules[i].mapping);
   }
+  ogeDArrayFree(s_rendererState.shaderModules);
+  ogeMutexDestroy(&s_rendererState.shaderModulesMutex);
+}
 
-  if (!createShaderModule(initInfo->fragmentShaderFileName,
-                          &fragShaderModule)) {
-    return OGE_FALSE;
-  }
+/************************************************
+ *                  pipelines                   *
+ ************************************************/
+static const VkFormat s_vertexFormats[] = {
+  [OGE_VERTEX_FORMAT_FLOAT]       = VK_FORMAT_R32_SFLOAT,
+  [OGE_VERTEX_FORMAT_FLOAT2]      = VK_FORMAT_R32G32_SFLOAT,
+  [OGE_VERTEX_FORMAT_FLOAT3]      = VK_FORMAT_R32G32B32_SFLOAT,
+  [OGE_VERTEX_FORMAT_FLOAT4]      = VK_FORMAT_R32G32B32A32_SFLOAT,
+  [OGE_VERTEX_FORMAT_UBYTE4_NORM] = VK_FORMAT_R8G8B8A8_UNORM,
+};
 
-  const VkPipelineShaderStageCreateInfo vertShaderStageInfo = {
-    .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-    .pNext               = 0,
-    .flags               = 0,
-    .stage               = VK_SHADER_STAGE_VERTEX_BIT,
-    .module              = vertShaderModule,
-    .pName               = "main",
-    .pSpecializationInfo = 0,
-  };
+static const VkPrimitiveTopology s_topologies[] = {
+  [OGE_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST]  =
+    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+  [OGE_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP] =
+    VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP,
+  [OGE_PRIMITIVE_TOPOLOGY_LINE_LIST]      = VK_PRIMITIVE_TOPOLOGY_LINE_LIST,
+  [OGE_PRIMITIVE_TOPOLOGY_LINE_STRIP]     = VK_PRIMITIVE_TOPOLOGY_LINE_STRIP,
+  [OGE_PRIMITIVE_TOPOLOGY_POINT_LIST]     = VK_PRIMITIVE_TOPOLOGY_POINT_LIST,
+};
 
-  const VkPipelineShaderStageCreateInfo fragShaderStageInfo = {
-    .sType               = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
-    .pNext               = 0,
-    .flags               = 0,
-    .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
-    .module              = fragShaderModule,
-    .pName               = "main",
-    .pSpecializationInfo = 0,
-  };
+static const VkPolygonMode s_polygonModes[] = {
+  [OGE_POLYGON_MODE_FILL] = VK_POLYGON_MODE_FILL,
+  [OGE_POLYGON_MODE_LINE] = VK_POLYGON_MODE_LINE,
+};
+
+static const VkCullModeFlags s_cullModes[] = {
+  [OGE_CULL_MODE_NONE]  = VK_CULL_MODE_NONE,
+  [OGE_CULL_MODE_FRONT] = VK_CULL_MODE_FRONT_BIT,
+  [OGE_CULL_MODE_BACK]  = VK_CULL_MODE_BACK_BIT,
+};
+
+// Source and destination factors of every blend mode
+static const VkBlendFactor s_blendFactors[][2] = {
+  [OGE_BLEND_MODE_OPAQUE]        = {
+    VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO,
+  },
+  [OGE_BLEND_MODE_ALPHA]         = {
+    VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+  },
+  [OGE_BLEND_MODE_ADDITIVE]      = {
+    VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ONE,
+  },
+  [OGE_BLEND_MODE_PREMULTIPLIED] = {
+    VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA,
+  },
+};
 
+// The enum follows VkCompareOp order
+_OGE_STATIC_ASSERT(OGE_COMPARE_OP_ALWAYS == (OgeCompareOp)VK_COMPARE_OP_ALWAYS,
+                   "Expected compare ops to match Vulkan ones.");
+
+// Shader modules are created by the caller and are owned by the
+// shader module cache. Can be called from any thread, the pipeline
+// cache is synchronized by Vulkan.
+b8 createGraphicsPipeline(const OgePipelineDesc *desc,
+                          VkShaderModule vertShaderModule,
+                          VkShaderModule fragShaderModule,
+                          VkPipeline *pipeline) {
   const VkPipelineShaderStageCreateInfo shaderStages[] = {
-    vertShaderStageInfo,
-    fragShaderStageInfo,
+    {
+      .sType               =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext               = 0,
+      .flags               = 0,
+      .stage               = VK_SHADER_STAGE_VERTEX_BIT,
+      .module              = vertShaderModule,
+      .pName               = "main",
+      .pSpecializationInfo = 0,
+    },
+    {
+      .sType               =
+        VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO,
+      .pNext               = 0,
+      .flags               = 0,
+      .stage               = VK_SHADER_STAGE_FRAGMENT_BIT,
+      .module              = fragShaderModule,
+      .pName               = "main",
+      .pSpecializationInfo = 0,
+    },
   };
 
-  // TODO: move configurable
-  OGE_WARN("Currently vertex binding and attribute descriptions are hardcoded in createGraphicsPipeline(), make this configurable.");
-  const VkVertexInputBindingDescription vertexBindingDescription = {
-    .binding   = 0,
-    .stride    = sizeof(f32) * 3,
-    .inputRate = VK_VERTEX_INPUT_RATE_VERTEX,
-  };
+  VkVertexInputBindingDescription
+    bindings[OGE_PIPELINES_MAX_VERTEX_BINDINGS];
+  for (u32 i = 0; i < desc->bindingCount; ++i) {
+    bindings[i] = (VkVertexInputBindingDescription){
+      .binding   = i,
+      .stride    = desc->bindings[i].stride,
+      .inputRate = desc->bindings[i].perInstance
+                 ? VK_VERTEX_INPUT_RATE_INSTANCE
+                 : VK_VERTEX_INPUT_RATE_VERTEX,
+    };
+  }
 
-  const VkVertexInputAttributeDescription vertexAttributeDescription = {
-    .location = 0,
-    .binding  = 0,
-    .format   = VK_FORMAT_R32G32B32_SFLOAT,
-    .offset   = 0,
-  };
+  VkVertexInputAttributeDescription
+    attributes[OGE_PIPELINES_MAX_VERTEX_ATTRIBUTES];
+  for (u32 i = 0; i < desc->attributeCount; ++i) {
+    attributes[i] = (VkVertexInputAttributeDescription){
+      .location = desc->attributes[i].location,
+      .binding  = desc->attributes[i].binding,
+      .format   = s_vertexFormats[desc->attributes[i].format],
+      .offset   = desc->attributes[i].offset,
+    };
+  }
 
   const VkPipelineVertexInputStateCreateInfo vertexInputStateInfo = {
     .sType                           =
       VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO,
     .pNext                           = 0,
     .flags                           = 0,
-    .vertexBindingDescriptionCount   = 1,
-    .pVertexBindingDescriptions      = &vertexBindingDescription,
-    .vertexAttributeDescriptionCount = 1,
-    .pVertexAttributeDescriptions    = &vertexAttributeDescription,
+    .vertexBindingDescriptionCount   = desc->bindingCount,
+    .pVertexBindingDescriptions      = bindings,
+    .vertexAttributeDescriptionCount = desc->attributeCount,
+    .pVertexAttributeDescriptions    = attributes,
   };
 
   const VkPipelineInputAssemblyStateCreateInfo inputAssemblyStateInfo = {
@@ -791,7 +1327,7 @@ b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
       VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO,
     .pNext                  = 0,
     .flags                  = 0,
-    .topology               = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST,
+    .topology               = s_topologies[desc->topology],
     .primitiveRestartEnable = VK_FALSE,
   };
 
@@ -814,10 +1350,12 @@ b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
     .flags                   = 0,
     .depthClampEnable        = VK_FALSE,
     .rasterizerDiscardEnable = VK_FALSE,
-    .polygonMode             = VK_POLYGON_MODE_FILL,
+    .polygonMode             = s_polygonModes[desc->polygonMode],
     .lineWidth               = 1.0f,
-    .cullMode                = VK_CULL_MODE_BACK_BIT,
-    .frontFace               = VK_FRONT_FACE_COUNTER_CLOCKWISE,
+    .cullMode                = s_cullModes[desc->cullMode],
+    .frontFace               = desc->frontFaceClockwise
+                             ? VK_FRONT_FACE_CLOCKWISE
+                             : VK_FRONT_FACE_COUNTER_CLOCKWISE,
     .depthBiasEnable         = VK_FALSE,
   };
 
@@ -834,13 +1372,29 @@ b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
     .alphaToOneEnable      = VK_FALSE,
   };
 
+  // Ignored by subpasses without a depth attachment
+  const VkPipelineDepthStencilStateCreateInfo depthStencilStateInfo = {
+    .sType                 =
+      VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO,
+    .pNext                 = 0,
+    .flags                 = 0,
+    .depthTestEnable       = desc->depthTest,
+    .depthWriteEnable      = desc->depthWrite,
+    .depthCompareOp        = (VkCompareOp)desc->depthCompareOp,
+    .depthBoundsTestEnable = VK_FALSE,
+    .stencilTestEnable     = VK_FALSE,
+    .minDepthBounds        = 0.0f,
+    .maxDepthBounds        = 1.0f,
+  };
+
+  const VkBlendFactor *blendFactors = s_blendFactors[desc->blendMode];
   const VkPipelineColorBlendAttachmentState colorBlendAttachmentState = {
-    .blendEnable         = VK_FALSE,
-    .srcColorBlendFactor = VK_BLEND_FACTOR_ONE,
-    .dstColorBlendFactor = VK_BLEND_FACTOR_ONE,
+    .blendEnable         = desc->blendMode != OGE_BLEND_MODE_OPAQUE,
+    .srcColorBlendFactor = blendFactors[0],
+    .dstColorBlendFactor = blendFactors[1],
     .colorBlendOp        = VK_BLEND_OP_ADD,
-    .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
-    .dstAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+    .srcAlphaBlendFactor = blendFactors[0],
+    .dstAlphaBlendFactor = blendFactors[1],
     .alphaBlendOp        = VK_BLEND_OP_ADD,
     .colorWriteMask      = VK_COLOR_COMPONENT_R_BIT |
                            VK_COLOR_COMPONENT_G_BIT |
@@ -876,10 +1430,24 @@ b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
     .pDynamicStates    = dynamicStates,
   };
 
+  // Creation feedback tells if the cache had a pipeline, it's core
+  // since Vulkan 1.3
+  VkPipelineCreationFeedback feedback = { 0 };
+  VkPipelineCreationFeedbackCreateInfo feedbackInfo = {
+    .sType                              =
+      VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO,
+    .pNext                              = 0,
+    .pPipelineCreationFeedback          = &feedback,
+    .pipelineStageCreationFeedbackCount = 0,
+    .pPipelineStageCreationFeedbacks    = 0,
+  };
+  const b8 feedbackSupported =
+    s_rendererState.physicalDeviceProperties.apiVersion >= VK_API_VERSION_1_3;
+
   VkGraphicsPipelineCreateInfo pipelineInfo = {
     .sType               =
       VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO,
-    .pNext               = 0,
+    .pNext               = feedbackSupported ? &feedbackInfo : 0,
     .flags               = 0,
     .stageCount          = 2,
     .pStages             = shaderStages,
@@ -888,37 +1456,232 @@ b8 createGraphicsPipeline(const OgeRendererInitInfo *initInfo) {
     .pViewportState      = &viewportStateInfo,
     .pRasterizationState = &rasterizationStateInfo,
     .pMultisampleState   = &multisampleStateInfo,
+    .pDepthStencilState  = &depthStencilStateInfo,
     .pColorBlendState    = &colorBlendStateInfo,
     .pDynamicState       = &dynamicStateInfo,
     .layout              = s_rendererState.graphicsPipelineLayout,
     .renderPass          = s_rendererState.renderPass,
-    .subpass             = 0,
+    .subpass             = desc->subpass,
     .basePipelineHandle  = VK_NULL_HANDLE,
   };
 
+  const u64 start = ogeClockNow();
   const VkResult result =
-    vkCreateGraphicsPipelines(s_rendererState.logicalDevice,
-                              VK_NULL_HANDLE, 1,
-                              &pipelineInfo,
-                              s_rendererState.pAllocator,
-                              &s_rendererState.graphicsPipeline);
-
-  vkDestroyShaderModule(s_rendererState.logicalDevice,
-                        fragShaderModule,
-                        s_rendererState.pAllocator);
-
-  vkDestroyShaderModule(s_rendererState.logicalDevice,
-                        vertShaderModule,
-                        s_rendererState.pAllocator);
-
+    DRIVER_CALL(vkCreateGraphicsPipelines(s_rendererState.logicalDevice,
+                                          s_rendererState.pipelineCache, 1,
+                                          &pipelineInfo,
+                                          s_rendererState.pAllocator,
+                                          pipeline));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan graphics pipeline.");
     return OGE_FALSE;
   }
+
+  // Pipelines are compiled concurrently by the compile queue
+  OgeRendererPipelineCacheStats *stats = &s_rendererState.pipelineCacheStats;
+  __atomic_add_fetch(&stats->creationTime, ogeClockNow() - start,
+                     __ATOMIC_RELAXED);
+
+  const VkPipelineCreationFeedbackFlags hitFlags =
+    VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT |
+    VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT;
+  if ((feedback.flags & hitFlags) == hitFlags) {
+    __atomic_add_fetch(&stats->hitCount, 1, __ATOMIC_RELAXED);
+  } else {
+    __atomic_add_fetch(&stats->missCount, 1, __ATOMIC_RELAXED);
+  }
+
   OGE_TRACE("Vulkan graphics pipeline created.");
   return OGE_TRUE;
 }
 
+// The state the renderer drew with before pipelines became
+// configurable: three floats per vertex, back faces culled
+OGE_INLINE void initDefaultPipelineDesc(OgePipelineDesc *desc,
+                                        const OgeRendererInitInfo *initInfo) {
+  ogeMemSet(desc, 0, sizeof(OgePipelineDesc));
+  desc->vertexShaderFileName   = initInfo->vertexShaderFileName;
+  desc->fragmentShaderFileName = initInfo->fragmentShaderFileName;
+  desc->bindingCount           = 1;
+  desc->bindings[0].stride     = sizeof(f32) * 3;
+  desc->attributeCount         = 1;
+  desc->attributes[0].format   = OGE_VERTEX_FORMAT_FLOAT3;
+  desc->topology               = OGE_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+  desc->polygonMode            = OGE_POLYGON_MODE_FILL;
+  desc->cullMode               = OGE_CULL_MODE_BACK;
+  desc->blendMode              = OGE_BLEND_MODE_OPAQUE;
+  desc->depthCompareOp         = OGE_COMPARE_OP_LESS;
+}
+
+OGE_INLINE b8 isPipelineDescValid(const OgePipelineDesc *desc) {
+  if (!desc->vertexShaderFileName || !desc->fragmentShaderFileName ||
+      strlen(desc->vertexShaderFileName) >= OGE_PIPELINES_MAX_NAME_LENGTH ||
+      strlen(desc->fragmentShaderFileName) >= OGE_PIPELINES_MAX_NAME_LENGTH ||
+      desc->bindingCount > OGE_PIPELINES_MAX_VERTEX_BINDINGS ||
+      desc->attributeCount > OGE_PIPELINES_MAX_VERTEX_ATTRIBUTES ||
+      desc->topology >= OGE_PRIMITIVE_TOPOLOGY_MAX_ENUM ||
+      desc->polygonMode >= OGE_POLYGON_MODE_MAX_ENUM ||
+      desc->cullMode >= OGE_CULL_MODE_MAX_ENUM ||
+      desc->blendMode >= OGE_BLEND_MODE_MAX_ENUM ||
+      desc->depthCompareOp >= OGE_COMPARE_OP_MAX_ENUM) {
+    return OGE_FALSE;
+  }
+
+  for (u32 i = 0; i < desc->attributeCount; ++i) {
+    if (desc->attributes[i].format >= OGE_VERTEX_FORMAT_MAX_ENUM ||
+        desc->attributes[i].binding >= desc->bindingCount) {
+      return OGE_FALSE;
+    }
+  }
+  return OGE_TRUE;
+}
+
+// A description with its pointers replaced by the strings. Fields
+// are copied one by one into a zeroed key, so neither padding nor the
+// unused vertex layout makes equal states differ.
+OGE_INLINE void initPipelineKey(pipelineKey *key,
+                                const OgePipelineDesc *desc) {
+  ogeMemSet(key, 0, sizeof(pipelineKey));
+  strcpy(key->vertexShaderFileName, desc->vertexShaderFileName);
+  strcpy(key->fragmentShaderFileName, desc->fragmentShaderFileName);
+
+  OgePipelineDesc *keyDesc = &key->desc;
+  keyDesc->bindingCount = desc->bindingCount;
+  for (u32 i = 0; i < desc->bindingCount; ++i) {
+    keyDesc->bindings[i].stride      = desc->bindings[i].stride;
+    keyDesc->bindings[i].perInstance = desc->bindings[i].perInstance;
+  }
+
+  keyDesc->attributeCount = desc->attributeCount;
+  for (u32 i = 0; i < desc->attributeCount; ++i) {
+    keyDesc->attributes[i].location = desc->attributes[i].location;
+    keyDesc->attributes[i].binding  = desc->attributes[i].binding;
+    keyDesc->attributes[i].format   = desc->attributes[i].format;
+    keyDesc->attributes[i].offset   = desc->attributes[i].offset;
+  }
+
+  keyDesc->topology           = desc->topology;
+  keyDesc->polygonMode        = desc->polygonMode;
+  keyDesc->cullMode           = desc->cullMode;
+  keyDesc->frontFaceClockwise = desc->frontFaceClockwise;
+  keyDesc->blendMode          = desc->blendMode;
+  keyDesc->depthTest          = desc->depthTest;
+  keyDesc->depthWrite         = desc->depthWrite;
+  keyDesc->depthCompareOp     = desc->depthCompareOp;
+  keyDesc->subpass            = desc->subpass;
+}
+
+OGE_INLINE void getPipelineDesc(const pipelineEntry *entry,
+                                OgePipelineDesc *desc) {
+  *desc = entry->key.desc;
+  desc->vertexShaderFileName   = entry->key.vertexShaderFileName;
+  desc->fragmentShaderFileName = entry->key.fragmentShaderFileName;
+}
+
+// Runs on a job system thread, maps the shaders, takes modules from
+// the shader module cache and compiles a pipeline
+static void compilePipelineJob(void *data) {
+  pipelineEntry *entry = data;
+
+  OgePipelineDesc desc;
+  getPipelineDesc(entry, &desc);
+
+  shaderCode vertexShader   = { .fileName = desc.vertexShaderFileName };
+  shaderCode fragmentShader = { .fileName = desc.fragmentShaderFileName };
+  VkShaderModule vertexShaderModule, fragmentShaderModule;
+
+  const b8 result =
+    loadShaderCode(&vertexShader) &&
+    loadShaderCode(&fragmentShader) &&
+    createShaderModule(&vertexShader, &vertexShaderModule) &&
+    createShaderModule(&fragmentShader, &fragmentShaderModule) &&
+    createGraphicsPipeline(&desc, vertexShaderModule, fragmentShaderModule,
+                           &entry->pipeline);
+
+  ogeFileUnmap(&vertexShader.mapping);
+  ogeFileUnmap(&fragmentShader.mapping);
+
+  if (!result) {
+    OGE_ERROR("Failed to compile pipeline of \"%s\" and \"%s\" shaders.",
+              desc.vertexShaderFileName, desc.fragmentShaderFileName);
+  }
+
+  __atomic_store_n(&entry->state,
+                   result ? PIPELINE_STATE_READY : PIPELINE_STATE_FAILED,
+                   __ATOMIC_RELEASE);
+}
+
+// Returns an index of a pipeline with a key, or the pipeline count
+// if there's none. Should be called with the pipelines mutex locked.
+static OGE_INLINE u32 findPipeline(u64 hash, const pipelineKey *key) {
+  const u32 count = s_rendererState.pipelineCount;
+  for (u32 i = 0; i < count; ++i) {
+    if (s_rendererState.pipelineHashes[i] == hash &&
+        ogeMemCmp(&s_rendererState.pipelines[i].key, key,
+                  sizeof(pipelineKey)) == 0) {
+      return i;
+    }
+  }
+  return count;
+}
+
+// Adds a queued pipeline entry. Should be called with the pipelines
+// mutex locked, the count is published last, so ids below it can be
+// read without the lock.
+static OGE_INLINE pipelineEntry* addPipeline(u64 hash, const pipelineKey *key) {
+  const u32 index = s_rendererState.pipelineCount;
+  pipelineEntry *entry = &s_rendererState.pipelines[index];
+
+  entry->key      = *key;
+  entry->pipeline = VK_NULL_HANDLE;
+  entry->state    = PIPELINE_STATE_QUEUED;
+  s_rendererState.pipelineHashes[index] = hash;
+
+  __atomic_store_n(&s_rendererState.pipelineCount, index + 1,
+                   __ATOMIC_RELEASE);
+  return entry;
+}
+
+b8 createPipelines(const OgeRendererInitInfo *initInfo) {
+  s_rendererState.pipelines =
+    ogeAlloc(sizeof(pipelineEntry) * OGE_PIPELINES_MAX_PIPELINES,
+             OGE_MEMORY_TAG_RENDERER);
+  s_rendererState.pipelineCount = 0;
+  ogeMutexCreate(&s_rendererState.pipelinesMutex);
+  ogeMemSet(&s_rendererState.pipelineCompileCounter, 0,
+            sizeof(s_rendererState.pipelineCompileCounter));
+
+  OgePipelineDesc desc;
+  initDefaultPipelineDesc(&desc, initInfo);
+  if (!isPipelineDescValid(&desc)) {
+    OGE_ERROR("Renderer init info shaders can't make a pipeline.");
+    return OGE_FALSE;
+  }
+
+  pipelineKey key;
+  initPipelineKey(&key, &desc);
+  addPipeline(hashData(&key, sizeof(key)), &key);
+  return OGE_TRUE;
+}
+
+void destroyPipelines() {
+  ogePipelinesWait();
+
+  for (u32 i = 0; i < s_rendererState.pipelineCount; ++i) {
+    if (s_rendererState.pipelines[i].state != PIPELINE_STATE_READY) {
+      continue;
+    }
+    vkDestroyPipeline(s_rendererState.logicalDevice,
+                      s_rendererState.pipelines[i].pipeline,
+                      s_rendererState.pAllocator);
+  }
+
+  ogeFree(s_rendererState.pipelines);
+  s_rendererState.pipelines     = 0;
+  s_rendererState.pipelineCount = 0;
+  ogeMutexDestroy(&s_rendererState.pipelinesMutex);
+}
+
 b8 createFramebuffers() {
   s_rendererState.framebuffers =
     ogeAlloc(sizeof(VkFramebuffer) * s_rendererState.swapchainImageCount,
@@ -938,9 +1701,9 @@ b8 createFramebuffers() {
     };
 
     const VkResult result =
-      vkCreateFramebuffer(s_rendererState.logicalDevice, &info,
-                          s_rendererState.pAllocator,
-                          &s_rendererState.framebuffers[i]);
+      DRIVER_CALL(vkCreateFramebuffer(s_rendererState.logicalDevice, &info,
+                                      s_rendererState.pAllocator,
+                                      &s_rendererState.framebuffers[i]));
     if (result != VK_SUCCESS) {
       OGE_ERROR("Failed to create framebuffer: %d.", result);
       return OGE_FALSE;
@@ -959,9 +1722,10 @@ b8 createCommandPools() {
   };
 
   VkResult result = 
-    vkCreateCommandPool(s_rendererState.logicalDevice, &graphicsPoolInfo,
-                        s_rendererState.pAllocator,
-                        &s_rendererState.commandPools.graphics);
+    DRIVER_CALL(
+      vkCreateCommandPool(s_rendererState.logicalDevice, &graphicsPoolInfo,
+                          s_rendererState.pAllocator,
+                          &s_rendererState.commandPools.graphics));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create graphics command pool.");
     return OGE_FALSE;
@@ -974,9 +1738,10 @@ b8 createCommandPools() {
     .queueFamilyIndex = s_rendererState.queueFamilyIndicies.transfer,
   };
 
-  result = vkCreateCommandPool(s_rendererState.logicalDevice, &transferPoolInfo,
-                               s_rendererState.pAllocator,
-                               &s_rendererState.commandPools.transfer);
+  result = DRIVER_CALL(
+    vkCreateCommandPool(s_rendererState.logicalDevice, &transferPoolInfo,
+                        s_rendererState.pAllocator,
+                        &s_rendererState.commandPools.transfer));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create transfer command pool.");
     return OGE_FALSE;
@@ -989,9 +1754,10 @@ b8 createCommandPools() {
     .queueFamilyIndex = s_rendererState.queueFamilyIndicies.compute,
   };
 
-  result = vkCreateCommandPool(s_rendererState.logicalDevice, &computePoolInfo,
-                               s_rendererState.pAllocator,
-                               &s_rendererState.commandPools.compute);
+  result = DRIVER_CALL(
+    vkCreateCommandPool(s_rendererState.logicalDevice, &computePoolInfo,
+                        s_rendererState.pAllocator,
+                        &s_rendererState.commandPools.compute));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create compute command pool.");
     return OGE_FALSE;
@@ -1004,9 +1770,10 @@ b8 createCommandPools() {
     .queueFamilyIndex = s_rendererState.queueFamilyIndicies.present,
   };
 
-  result = vkCreateCommandPool(s_rendererState.logicalDevice, &presentPoolInfo,
-                               s_rendererState.pAllocator,
-                               &s_rendererState.commandPools.present);
+  result = DRIVER_CALL(
+    vkCreateCommandPool(s_rendererState.logicalDevice, &presentPoolInfo,
+                        s_rendererState.pAllocator,
+                        &s_rendererState.commandPools.present));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create present command pool.");
     return OGE_FALSE;
@@ -1031,9 +1798,10 @@ b8 createCommandBuffers() {
              OGE_MEMORY_TAG_RENDERER);
 
   VkResult result =
-    vkAllocateCommandBuffers(s_rendererState.logicalDevice,
-                             &graphicsBufferInfo,
-                             s_rendererState.commandBuffers.graphics);
+    DRIVER_CALL(
+      vkAllocateCommandBuffers(s_rendererState.logicalDevice,
+                               &graphicsBufferInfo,
+                               s_rendererState.commandBuffers.graphics));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan graphics command buffers.");
     return OGE_FALSE;
@@ -1052,9 +1820,10 @@ b8 createCommandBuffers() {
     ogeAlloc(sizeof(VkCommandBuffer) * MAX_FRAMES_IN_FLIGHT,
              OGE_MEMORY_TAG_RENDERER);
 
-  result = vkAllocateCommandBuffers(s_rendererState.logicalDevice,
-                                    &transferBufferInfo,
-                                    s_rendererState.commandBuffers.transfer);
+  result = DRIVER_CALL(
+    vkAllocateCommandBuffers(s_rendererState.logicalDevice,
+                             &transferBufferInfo,
+                             s_rendererState.commandBuffers.transfer));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan transfer command buffers.");
     return OGE_FALSE;
@@ -1073,9 +1842,10 @@ b8 createCommandBuffers() {
     ogeAlloc(sizeof(VkCommandBuffer) * MAX_FRAMES_IN_FLIGHT,
              OGE_MEMORY_TAG_RENDERER);
 
-  result = vkAllocateCommandBuffers(s_rendererState.logicalDevice,
-                                    &computeBufferInfo,
-                                    s_rendererState.commandBuffers.compute);
+  result = DRIVER_CALL(
+    vkAllocateCommandBuffers(s_rendererState.logicalDevice,
+                             &computeBufferInfo,
+                             s_rendererState.commandBuffers.compute));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan compute command buffers.");
     return OGE_FALSE;
@@ -1094,9 +1864,10 @@ b8 createCommandBuffers() {
     ogeAlloc(sizeof(VkCommandBuffer) * MAX_FRAMES_IN_FLIGHT,
              OGE_MEMORY_TAG_RENDERER);
 
-  result = vkAllocateCommandBuffers(s_rendererState.logicalDevice,
-                                    &presentBufferInfo,
-                                    s_rendererState.commandBuffers.present);
+  result = DRIVER_CALL(
+    vkAllocateCommandBuffers(s_rendererState.logicalDevice,
+                             &presentBufferInfo,
+                             s_rendererState.commandBuffers.present));
   if (result != VK_SUCCESS) {
     OGE_ERROR("Failed to create Vulkan present command buffers.");
     return OGE_FALSE;
@@ -1134,22 +1905,24 @@ b8 createSyncObjects() {
   for (u32 i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
   {
     VkResult result1 =
-      vkCreateSemaphore(s_rendererState.logicalDevice,
-                        &semaphoreInfo,
-                        s_rendererState.pAllocator,
-                        &s_rendererState.imageAvailableSemaphores[i]);
+      DRIVER_CALL(
+        vkCreateSemaphore(s_rendererState.logicalDevice,
+                          &semaphoreInfo,
+                          s_rendererState.pAllocator,
+                          &s_rendererState.imageAvailableSemaphores[i]));
 
     VkResult result2 =
-      vkCreateSemaphore(s_rendererState.logicalDevice,
-                        &semaphoreInfo,
-                        s_rendererState.pAllocator,
-                        &s_rendererState.renderFinishedSemaphores[i]);
+      DRIVER_CALL(
+        vkCreateSemaphore(s_rendererState.logicalDevice,
+                          &semaphoreInfo,
+                          s_rendererState.pAllocator,
+                          &s_rendererState.renderFinishedSemaphores[i]));
 
     VkResult result3 =
-      vkCreateFence(s_rendererState.logicalDevice,
-                    &fenceInfo,
-                    s_rendererState.pAllocator,
-                    &s_rendererState.inFlightFences[i]);
+      DRIVER_CALL(vkCreateFence(s_rendererState.logicalDevice,
+                                &fenceInfo,
+                                s_rendererState.pAllocator,
+                                &s_rendererState.inFlightFences[i]));
 
     if (result1 != VK_SUCCESS ||
         result2 != VK_SUCCESS ||
@@ -1163,6 +1936,292 @@ b8 createSyncObjects() {
   return OGE_TRUE;
 }
 
+// Timestamps are optional, without them GPU time isn't measured
+void createTimestampQueryPool() {
+  s_rendererState.timestampQueryPool = VK_NULL_HANDLE;
+
+  if (!s_rendererState.physicalDeviceProperties.limits.
+        timestampComputeAndGraphics) {
+    OGE_WARN("GPU doesn't support timestamps, GPU time isn't measured.");
+    return;
+  }
+
+  const VkQueryPoolCreateInfo queryPoolInfo = {
+    .sType              = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO,
+    .pNext              = 0,
+    .flags              = 0,
+    .queryType          = VK_QUERY_TYPE_TIMESTAMP,
+    .queryCount         = MAX_FRAMES_IN_FLIGHT * 2,
+    .pipelineStatistics = 0,
+  };
+
+  const VkResult result =
+    DRIVER_CALL(vkCreateQueryPool(s_rendererState.logicalDevice, &queryPoolInfo,
+                                  s_rendererState.pAllocator,
+                                  &s_rendererState.timestampQueryPool));
+  if (result != VK_SUCCESS) {
+    OGE_WARN("Failed to create Vulkan timestamp query pool, GPU time isn't measured.");
+    s_rendererState.timestampQueryPool = VK_NULL_HANDLE;
+    return;
+  }
+
+  OGE_TRACE("Vulkan timestamp query pool created.");
+}
+
+/************************************************
+ *                 init steps                   *
+ ************************************************/
+typedef enum rendererInitStep {
+  RENDERER_INIT_STEP_LOAD_VERTEX_SHADER,
+  RENDERER_INIT_STEP_LOAD_FRAGMENT_SHADER,
+  RENDERER_INIT_STEP_INSTANCE,
+  RENDERER_INIT_STEP_SURFACE,
+  RENDERER_INIT_STEP_GPU,
+  RENDERER_INIT_STEP_DEVICE,
+  RENDERER_INIT_STEP_SWAPCHAIN,
+  RENDERER_INIT_STEP_IMAGE_VIEWS,
+  RENDERER_INIT_STEP_RENDER_PASS,
+  RENDERER_INIT_STEP_PIPELINE_LAYOUT,
+  RENDERER_INIT_STEP_PIPELINE_CACHE,
+  RENDERER_INIT_STEP_VERTEX_SHADER_MODULE,
+  RENDERER_INIT_STEP_FRAGMENT_SHADER_MODULE,
+  RENDERER_INIT_STEP_PIPELINE,
+  RENDERER_INIT_STEP_FRAMEBUFFERS,
+  RENDERER_INIT_STEP_COMMAND_POOLS,
+  RENDERER_INIT_STEP_COMMAND_BUFFERS,
+  RENDERER_INIT_STEP_SYNC_OBJECTS,
+  RENDERER_INIT_STEP_TIMESTAMP_QUERY_POOL,
+
+  RENDERER_INIT_STEP_MAX_ENUM
+} rendererInitStep;
+
+#define AFTER(step) OGE_STARTUP_STEP_BIT(RENDERER_INIT_STEP_##step)
+
+typedef struct rendererInitData {
+  const OgeRendererInitInfo *initInfo;
+  shaderCode                 vertexShader;
+  shaderCode                 fragmentShader;
+  VkShaderModule             vertexShaderModule;
+  VkShaderModule             fragmentShaderModule;
+} rendererInitData;
+
+// The render pass only needs the format, so it doesn't wait for
+// the swapchain
+static OGE_INLINE void selectSwapchainFormat() {
+  if (s_rendererState.headless) {
+    s_rendererState.swapchainFormat = VK_FORMAT_R8G8B8A8_UNORM;
+    return;
+  }
+
+  s_rendererState.swapchainFormat =
+    chooseSurfaceFormat(s_rendererState.swapchainSupport.pFormats,
+                        s_rendererState.swapchainSupport.formatCount).format;
+}
+
+b8 loadVertexShaderStep(void *userData) {
+  rendererInitData *data = userData;
+  return loadShaderCode(&data->vertexShader);
+}
+
+b8 loadFragmentShaderStep(void *userData) {
+  rendererInitData *data = userData;
+  return loadShaderCode(&data->fragmentShader);
+}
+
+b8 createInstanceStep(void *userData) {
+  const rendererInitData *data = userData;
+  if (!createInstance(data->initInfo)) { return OGE_FALSE; }
+
+  #ifdef OGE_DEBUG
+  createDebugMessenger();
+  #endif
+  return OGE_TRUE;
+}
+
+b8 createSurfaceStep(void *userData) {
+  (void)userData;
+  return createSurface();
+}
+
+b8 selectGPUStep(void *userData) {
+  (void)userData;
+  return selectGPU();
+}
+
+b8 createLogicalDeviceStep(void *userData) {
+  (void)userData;
+  if (!createLogicalDevice()) { return OGE_FALSE; }
+
+  getQueues();
+  selectSwapchainFormat();
+  return OGE_TRUE;
+}
+
+b8 createSwapchainStep(void *userData) {
+  const rendererInitData *data = userData;
+
+  if (s_rendererState.headless) {
+    return createHeadlessImages(data->initInfo);
+  }
+
+  if (!createSwapchain()) { return OGE_FALSE; }
+  getSwapchainImages();
+  return OGE_TRUE;
+}
+
+b8 createSwapchainImageViewsStep(void *userData) {
+  (void)userData;
+  return createSwapchainImageViews();
+}
+
+b8 createRenderPassStep(void *userData) {
+  (void)userData;
+  return createRenderPass();
+}
+
+b8 createGraphicsPipelineLayoutStep(void *userData) {
+  (void)userData;
+  return createGraphicsPipelineLayout();
+}
+
+b8 createPipelineCacheStep(void *userData) {
+  (void)userData;
+  return createPipelineCache();
+}
+
+b8 createVertexShaderModuleStep(void *userData) {
+  rendererInitData *data = userData;
+  return createShaderModule(&data->vertexShader, &data->vertexShaderModule);
+}
+
+b8 createFragmentShaderModuleStep(void *userData) {
+  rendererInitData *data = userData;
+  return createShaderModule(&data->fragmentShader,
+                            &data->fragmentShaderModule);
+}
+
+// The default pipeline is compiled during init, other ones are
+// compiled by the compile queue
+b8 createGraphicsPipelineStep(void *userData) {
+  const rendererInitData *data = userData;
+  pipelineEntry *entry = &s_rendererState.pipelines[OGE_PIPELINES_DEFAULT_ID];
+
+  OgePipelineDesc desc;
+  getPipelineDesc(entry, &desc);
+  if (!createGraphicsPipeline(&desc, data->vertexShaderModule,
+                              data->fragmentShaderModule,
+                              &entry->pipeline)) {
+    return OGE_FALSE;
+  }
+
+  entry->state = PIPELINE_STATE_READY;
+  return OGE_TRUE;
+}
+
+b8 createFramebuffersStep(void *userData) {
+  (void)userData;
+  return createFramebuffers();
+}
+
+b8 createCommandPoolsStep(void *userData) {
+  (void)userData;
+  return createCommandPools();
+}
+
+b8 createCommandBuffersStep(void *userData) {
+  (void)userData;
+  return createCommandBuffers();
+}
+
+b8 createSyncObjectsStep(void *userData) {
+  (void)userData;
+  return createSyncObjects();
+}
+
+b8 createTimestampQueryPoolStep(void *userData) {
+  (void)userData;
+  createTimestampQueryPool();
+  return OGE_TRUE;
+}
+
+// A step per creation function, so the startup report breaks the
+// renderer down. Shader files are read while the instance and the
+// device are created, the pipeline is compiled while the swapchain
+// is. The surface and the swapchain stay on the calling thread, some
+// platforms only allow them on the main one.
+static const OgeStartupStep s_rendererInitSteps[] = {
+  [RENDERER_INIT_STEP_LOAD_VERTEX_SHADER] = {
+    "loadShaderCode vertex", loadVertexShaderStep, 0, OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_LOAD_FRAGMENT_SHADER] = {
+    "loadShaderCode fragment", loadFragmentShaderStep, 0, OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_INSTANCE] = {
+    "createInstance", createInstanceStep, 0, OGE_FALSE,
+  },
+  [RENDERER_INIT_STEP_SURFACE] = {
+    "createSurface", createSurfaceStep, AFTER(INSTANCE), OGE_FALSE,
+  },
+  [RENDERER_INIT_STEP_GPU] = {
+    "selectGPU", selectGPUStep, AFTER(SURFACE), OGE_FALSE,
+  },
+  [RENDERER_INIT_STEP_DEVICE] = {
+    "createLogicalDevice", createLogicalDeviceStep, AFTER(GPU), OGE_FALSE,
+  },
+  [RENDERER_INIT_STEP_SWAPCHAIN] = {
+    "createSwapchain", createSwapchainStep, AFTER(DEVICE), OGE_FALSE,
+  },
+  [RENDERER_INIT_STEP_IMAGE_VIEWS] = {
+    "createSwapchainImageViews", createSwapchainImageViewsStep,
+    AFTER(SWAPCHAIN), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_RENDER_PASS] = {
+    "createRenderPass", createRenderPassStep, AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_PIPELINE_LAYOUT] = {
+    "createGraphicsPipelineLayout", createGraphicsPipelineLayoutStep,
+    AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_PIPELINE_CACHE] = {
+    "createPipelineCache", createPipelineCacheStep, AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_VERTEX_SHADER_MODULE] = {
+    "createShaderModule vertex", createVertexShaderModuleStep,
+    AFTER(LOAD_VERTEX_SHADER) | AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_FRAGMENT_SHADER_MODULE] = {
+    "createShaderModule fragment", createFragmentShaderModuleStep,
+    AFTER(LOAD_FRAGMENT_SHADER) | AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_PIPELINE] = {
+    "createGraphicsPipeline", createGraphicsPipelineStep,
+    AFTER(RENDER_PASS) | AFTER(PIPELINE_LAYOUT) | AFTER(PIPELINE_CACHE) |
+    AFTER(VERTEX_SHADER_MODULE) | AFTER(FRAGMENT_SHADER_MODULE),
+    OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_FRAMEBUFFERS] = {
+    "createFramebuffers", createFramebuffersStep,
+    AFTER(IMAGE_VIEWS) | AFTER(RENDER_PASS), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_COMMAND_POOLS] = {
+    "createCommandPools", createCommandPoolsStep, AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_COMMAND_BUFFERS] = {
+    "createCommandBuffers", createCommandBuffersStep,
+    AFTER(COMMAND_POOLS), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_SYNC_OBJECTS] = {
+    "createSyncObjects", createSyncObjectsStep, AFTER(DEVICE), OGE_TRUE,
+  },
+  [RENDERER_INIT_STEP_TIMESTAMP_QUERY_POOL] = {
+    "createTimestampQueryPool", createTimestampQueryPoolStep,
+    AFTER(DEVICE), OGE_TRUE,
+  },
+};
+
+/************************************************
+ *                  renderer                    *
+ ************************************************/
 b8 ogeRendererInit(const OgeRendererInitInfo *initInfo) {
   OGE_ASSERT(
     !s_rendererState.initialized,
@@ -1172,7 +2231,7 @@ b8 ogeRendererInit(const OgeRendererInitInfo *initInfo) {
   OGE_WARN("Vulkan uses default allocator, write custom one.");
 
   const VkClearValue clearColor = {
-    .color = {
+    .color.float32 = {
       initInfo->clearColor.r,
       initInfo->clearColor.g,
       initInfo->clearColor.b,
@@ -1181,32 +2240,50 @@ b8 ogeRendererInit(const OgeRendererInitInfo *initInfo) {
   };
   s_rendererState.frameClearColor = clearColor;
 
-  if (!createInstance(initInfo)) { return OGE_FALSE; }
+  s_rendererState.pipelineCacheFileName = initInfo->pipelineCacheFileName
+    ? initInfo->pipelineCacheFileName
+    : OGE_RENDERER_DEFAULT_PIPELINE_CACHE_FILE_NAME;
+  ogeMemSet(&s_rendererState.pipelineCacheStats, 0,
+            sizeof(s_rendererState.pipelineCacheStats));
 
-  #ifdef OGE_DEBUG
-  createDebugMessenger();
-  #endif
+  s_rendererState.headless = initInfo->headless || ogePlatformIsHeadless();
+  s_rendererState.deviceExtensionCount = s_rendererState.headless
+                                       ? REQUIRED_DEVICE_EXTENSIONS_COUNT - 1
+                                       : REQUIRED_DEVICE_EXTENSIONS_COUNT;
 
-  if (!createSurface())                   { return OGE_FALSE; }
-  if (!selectGPU())                       { return OGE_FALSE; }
-  if (!createLogicalDevice())             { return OGE_FALSE; }
+  ogeMutexCreate(&s_rendererState.shaderModulesMutex);
+  s_rendererState.shaderModules = ogeDArrayAlloc(8, sizeof(shaderModule));
 
-  getQueues();
+  if (!createPipelines(initInfo)) { return OGE_FALSE; }
 
-  if (!createSwapchain())                 { return OGE_FALSE; }
+  rendererInitData data = {
+    .initInfo       = initInfo,
+    .vertexShader   = { .fileName = initInfo->vertexShaderFileName },
+    .fragmentShader = { .fileName = initInfo->fragmentShaderFileName },
+  };
 
-  getSwapchainImages();
+  const b8 result = ogeStartupRun("Renderer", s_rendererInitSteps,
+                                  RENDERER_INIT_STEP_MAX_ENUM, &data, 0);
 
-  if (!createSwapchainImageViews())      { return OGE_FALSE; }
-  if (!createRenderPass())               { return OGE_FALSE; }
-  if (!createGraphicsPipelineLayout())   { return OGE_FALSE; }
-  if (!createGraphicsPipeline(initInfo)) { return OGE_FALSE; }
-  if (!createFramebuffers())             { return OGE_FALSE; }
-  if (!createCommandPools())             { return OGE_FALSE; }
-  if (!createCommandBuffers())           { return OGE_FALSE; }
-  if (!createSyncObjects())              { return OGE_FALSE; }
+  // Mappings of reused modules or of steps that failed, the cache
+  // owns the rest of them
+  ogeFileUnmap(&data.vertexShader.mapping);
+  ogeFileUnmap(&data.fragmentShader.mapping);
+
+  if (!result) { return OGE_FALSE; }
+
+  const OgeRendererPipelineCacheStats *cacheStats =
+    &s_rendererState.pipelineCacheStats;
+  OGE_INFO("Pipelines created in %.3f ms: %u from cache, %u compiled.",
+           OGE_NS_TO_MILLISECONDS(cacheStats->creationTime),
+           cacheStats->hitCount, cacheStats->missCount);
 
   s_rendererState.initialized = OGE_TRUE;
+  if (s_rendererState.headless) {
+    OGE_INFO("Renderer draws into %ux%u headless images.",
+             s_rendererState.swapchainExtent.width,
+             s_rendererState.swapchainExtent.height);
+  }
   OGE_INFO("Renderer initialized.");
   return OGE_TRUE;
 }
@@ -1218,6 +2295,16 @@ void ogeRendererTerminate() {
   );
 
   OGE_TRACE("Terminating Vulkan renderer.");
+
+  if (s_rendererState.timestampQueryPool != VK_NULL_HANDLE) {
+    vkDestroyQueryPool(s_rendererState.logicalDevice,
+                       s_rendererState.timestampQueryPool,
+                       s_rendererState.pAllocator);
+  }
+  ogeMemSet(s_rendererState.timestampsWritten, 0,
+            sizeof(s_rendererState.timestampsWritten));
+  ogeMemSet(&s_rendererState.frameStats, 0,
+            sizeof(s_rendererState.frameStats));
   
   // Sync objects
   for (u32 i = 0; i < s_rendererState.swapchainImageCount; ++i) {
@@ -1288,14 +2375,19 @@ void ogeRendererTerminate() {
                          s_rendererState.pAllocator);
   }
 
-  vkDestroyPipeline(s_rendererState.logicalDevice,
-                    s_rendererState.graphicsPipeline,
-                    s_rendererState.pAllocator);
+  destroyPipelines();
 
   vkDestroyPipelineLayout(s_rendererState.logicalDevice,
                           s_rendererState.graphicsPipelineLayout,
                           s_rendererState.pAllocator);
 
+  savePipelineCache();
+  vkDestroyPipelineCache(s_rendererState.logicalDevice,
+                         s_rendererState.pipelineCache,
+                         s_rendererState.pAllocator);
+
+  destroyShaderModules();
+
   vkDestroyRenderPass(s_rendererState.logicalDevice,
                       s_rendererState.renderPass,
                       s_rendererState.pAllocator);
@@ -1307,18 +2399,32 @@ void ogeRendererTerminate() {
                        s_rendererState.pAllocator);
   }
   ogeFree(s_rendererState.swapchainImageViews);
-  ogeFree(s_rendererState.swapchainImages);
 
-  vkDestroySwapchainKHR(s_rendererState.logicalDevice,
-                        s_rendererState.swapchain,
-                        s_rendererState.pAllocator);
+  if (s_rendererState.headless) {
+    for (u32 i = 0; i < s_rendererState.swapchainImageCount; ++i) {
+      vkDestroyImage(s_rendererState.logicalDevice,
+                     s_rendererState.swapchainImages[i],
+                     s_rendererState.pAllocator);
+      vkFreeMemory(s_rendererState.logicalDevice,
+                   s_rendererState.headlessImageMemory[i],
+                   s_rendererState.pAllocator);
+    }
+    ogeFree(s_rendererState.headlessImageMemory);
+  } else {
+    vkDestroySwapchainKHR(s_rendererState.logicalDevice,
+                          s_rendererState.swapchain,
+                          s_rendererState.pAllocator);
+  }
+  ogeFree(s_rendererState.swapchainImages);
 
   vkDestroyDevice(s_rendererState.logicalDevice, s_rendererState.pAllocator);
 
-  vkDestroySurfaceKHR(s_rendererState.instance,
-                      s_rendererState.surface,
-                      s_rendererState.pAllocator);
-  OGE_TRACE("Vulkan surface destroyed.");
+  if (!s_rendererState.headless) {
+    vkDestroySurfaceKHR(s_rendererState.instance,
+                        s_rendererState.surface,
+                        s_rendererState.pAllocator);
+    OGE_TRACE("Vulkan surface destroyed.");
+  }
 
   #ifdef OGE_DEBUG
   vkDestroyDebugUtilsMessengerEXT(
@@ -1334,26 +2440,73 @@ void ogeRendererTerminate() {
   OGE_INFO("Renderer terminated.");
 }
 
+// Every frame in flight has its own headless image
+static OGE_INLINE VkResult acquireHeadlessImage() {
+  s_rendererState.currentImageIndex = s_rendererState.currentFrameIndex;
+  return VK_SUCCESS;
+}
+
+// Called once the fence of a frame in flight is signaled, so its
+// timestamps are available
+static OGE_INLINE void readTimestamps(u32 frameIndex) {
+  if (s_rendererState.timestampQueryPool == VK_NULL_HANDLE ||
+      !s_rendererState.timestampsWritten[frameIndex]) {
+    return;
+  }
+
+  u64 timestamps[2];
+  const VkResult result =
+    vkGetQueryPoolResults(s_rendererState.logicalDevice,
+                          s_rendererState.timestampQueryPool,
+                          frameIndex * 2, 2, sizeof(timestamps), timestamps,
+                          sizeof(u64), VK_QUERY_RESULT_64_BIT);
+  if (result != VK_SUCCESS) { return; }
+
+  // Timestamp period is a number of nanoseconds per tick
+  const f32 period =
+    s_rendererState.physicalDeviceProperties.limits.timestampPeriod;
+  s_rendererState.frameStats.gpuTime      =
+    (u64)((f64)(timestamps[1] - timestamps[0]) * period);
+  s_rendererState.frameStats.gpuTimeValid = OGE_TRUE;
+}
+
 void ogeRendererStartScene() {
+  if (!s_rendererState.initialized) { return; }
+
+  const u32 frameIndex = s_rendererState.currentFrameIndex;
+
+  OGE_PROFILE_BEGIN("fence wait");
+  const u64 fenceWaitStart = ogeClockNow();
   vkWaitForFences(
     s_rendererState.logicalDevice, 1,
-    &s_rendererState.inFlightFences[s_rendererState.currentFrameIndex],
+    &s_rendererState.inFlightFences[frameIndex],
     VK_TRUE, UINT64_MAX);
-
-  VkResult result = vkAcquireNextImageKHR(
-    s_rendererState.logicalDevice,
-    s_rendererState.swapchain,
-    UINT64_MAX,
-    s_rendererState.
-      imageAvailableSemaphores[s_rendererState.currentFrameIndex],
-    VK_NULL_HANDLE,
-    &s_rendererState.currentImageIndex
-  );
+  s_rendererState.frameStats.fenceWaitTime = ogeClockNow() - fenceWaitStart;
+  OGE_PROFILE_END();
+
+  readTimestamps(frameIndex);
+
+  OGE_PROFILE_BEGIN("acquire");
+  const u64 acquireStart = ogeClockNow();
+  VkResult result = s_rendererState.headless
+    ? acquireHeadlessImage()
+    : vkAcquireNextImageKHR(
+        s_rendererState.logicalDevice,
+        s_rendererState.swapchain,
+        UINT64_MAX,
+        s_rendererState.
+          imageAvailableSemaphores[s_rendererState.currentFrameIndex],
+        VK_NULL_HANDLE,
+        &s_rendererState.currentImageIndex
+      );
+  OGE_PROFILE_END();
+
+  s_rendererState.frameStats.acquireTime = ogeClockNow() - acquireStart;
 
   if (result == VK_ERROR_OUT_OF_DATE_KHR)
   {
     // recreateSwapchain();
-    OGE_WARN("Swapchain recreation reuquired.");
+    OGE_WARN_LIMITED("Swapchain recreation required.");
     return;
   }
   OGE_ASSERT(result == VK_SUCCESS ||
@@ -1383,6 +2536,14 @@ void ogeRendererStartScene() {
                                 &graphicsCommandBufferBeginInfo);
   OGE_ASSERT(result == VK_SUCCESS, "Failed to begin Vulkan graphics command buffer.");
 
+  // Queries should be reset outside of a render pass
+  if (s_rendererState.timestampQueryPool != VK_NULL_HANDLE) {
+    vkCmdResetQueryPool(commandBuffer, s_rendererState.timestampQueryPool,
+                        frameIndex * 2, 2);
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT,
+                        s_rendererState.timestampQueryPool, frameIndex * 2);
+  }
+
   // Begin render pass
   const VkRenderPassBeginInfo renderPassBeginInfo = {
     .sType             = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO,
@@ -1399,8 +2560,10 @@ void ogeRendererStartScene() {
   vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo,
                        VK_SUBPASS_CONTENTS_INLINE);
 
-  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                    s_rendererState.graphicsPipeline);
+  vkCmdBindPipeline(
+    commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+    s_rendererState.pipelines[OGE_PIPELINES_DEFAULT_ID].pipeline
+  );
 
   const VkViewport viewport = {
     .x = 0.0f,
@@ -1419,11 +2582,46 @@ void ogeRendererStartScene() {
   vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 }
 
+static void presentImage(const VkSemaphore *waitSemaphores) {
+  const VkPresentInfoKHR presentInfo = {
+    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
+    .pNext = 0,
+    .waitSemaphoreCount = 1,
+    .pWaitSemaphores = waitSemaphores,
+    .swapchainCount = 1,
+    .pSwapchains = &s_rendererState.swapchain,
+    .pImageIndices = &s_rendererState.currentImageIndex,
+  };
+
+  OGE_PROFILE_BEGIN("present");
+  const VkResult result =
+    vkQueuePresentKHR(s_rendererState.queues.present, &presentInfo);
+  OGE_PROFILE_END();
+  if (result == VK_ERROR_OUT_OF_DATE_KHR ||
+      result == VK_SUBOPTIMAL_KHR /*|| m_frameBufferResized */)
+  {
+    // m_frameBufferResized = false;
+    // recreateSwapchain();
+    OGE_WARN_LIMITED("Swapchain recreation required.");
+  }
+  OGE_ASSERT(result == VK_SUCCESS, "Failed to present Vulkan image.");
+}
+
 void ogeRendererEndScene() {
+  if (!s_rendererState.initialized) { return; }
+
   const VkCommandBuffer commandBuffer = 
     s_rendererState.commandBuffers.graphics[s_rendererState.currentFrameIndex];
   vkCmdEndRenderPass(commandBuffer);
 
+  if (s_rendererState.timestampQueryPool != VK_NULL_HANDLE) {
+    const u32 frameIndex = s_rendererState.currentFrameIndex;
+    vkCmdWriteTimestamp(commandBuffer, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                        s_rendererState.timestampQueryPool,
+                        frameIndex * 2 + 1);
+    s_rendererState.timestampsWritten[frameIndex] = OGE_TRUE;
+  }
+
   VkResult result = vkEndCommandBuffer(commandBuffer);
   OGE_ASSERT(result == VK_SUCCESS, "Failed to end Vulkan graphics command buffer.");
 
@@ -1443,47 +2641,111 @@ void ogeRendererEndScene() {
     s_rendererState.renderFinishedSemaphores[s_rendererState.currentFrameIndex]
   };
 
+  // Headless images aren't acquired or presented, there's
+  // nothing to wait for or signal
   const VkSubmitInfo submitInfo = {
     .sType                = VK_STRUCTURE_TYPE_SUBMIT_INFO,
     .pNext                = 0,
-    .waitSemaphoreCount   = 1,
+    .waitSemaphoreCount   = s_rendererState.headless ? 0 : 1,
     .pWaitSemaphores      = waitSemaphores,
     .pWaitDstStageMask    = waitStages,
     .commandBufferCount   = 1,
     .pCommandBuffers      = commandBuffers,
-    .signalSemaphoreCount = 1,
+    .signalSemaphoreCount = s_rendererState.headless ? 0 : 1,
     .pSignalSemaphores    = signalSemaphores,
   };
 
+  OGE_PROFILE_BEGIN("submit");
   result = vkQueueSubmit(
     s_rendererState.queues.graphics, 1, &submitInfo,
     s_rendererState.inFlightFences[s_rendererState.currentFrameIndex]);
+  OGE_PROFILE_END();
   OGE_ASSERT(result == VK_SUCCESS, "Failed to submit Vulkan graphics command buffer.");
+  (void)result; // Only the assertions check it
 
-  const VkPresentInfoKHR presentInfo = {
-    .sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR,
-    .pNext = 0,
-    .waitSemaphoreCount = 1,
-    .pWaitSemaphores = signalSemaphores,
-    .swapchainCount = 1,
-    .pSwapchains = &s_rendererState.swapchain,
-    .pImageIndices = &s_rendererState.currentImageIndex,
-  };
-
-  result = vkQueuePresentKHR(s_rendererState.queues.present, &presentInfo);
-  if (result == VK_ERROR_OUT_OF_DATE_KHR ||
-      result == VK_SUBOPTIMAL_KHR /*|| m_frameBufferResized */)
-  {
-    // m_frameBufferResized = false;
-    // recreateSwapchain();
-    OGE_WARN("Swapchain recreation required.");
-  }
-  OGE_ASSERT(result == VK_SUCCESS, "Failed to present Vulkan image.");
+  if (!s_rendererState.headless) { presentImage(signalSemaphores); }
 
   s_rendererState.currentFrameIndex = 
     (s_rendererState.currentFrameIndex + 1) % MAX_FRAMES_IN_FLIGHT;
 }
 
 void ogeRendererWaitIdle() {
+  if (!s_rendererState.initialized) { return; }
+
   vkDeviceWaitIdle(s_rendererState.logicalDevice);
 }
+
+const OgeRendererFrameStats* ogeRendererGetFrameStats() {
+  return &s_rendererState.frameStats;
+}
+
+const OgeRendererPipelineCacheStats* ogeRendererGetPipelineCacheStats() {
+  return &s_rendererState.pipelineCacheStats;
+}
+
+/************************************************
+ *                pipeline queue                *
+ ************************************************/
+u32 ogePipelinesRequest(const OgePipelineDesc *desc) {
+  if (!s_rendererState.initialized) { return OGE_PIPELINES_INVALID_ID; }
+
+  if (!isPipelineDescValid(desc)) {
+    OGE_ERROR("ogePipelinesRequest(): invalid pipeline description.");
+    return OGE_PIPELINES_INVALID_ID;
+  }
+
+  pipelineKey key;
+  initPipelineKey(&key, desc);
+  const u64 hash = hashData(&key, sizeof(key));
+
+  pipelineEntry *entry = 0;
+
+  ogeMutexLock(&s_rendererState.pipelinesMutex);
+  const u32 index = findPipeline(hash, &key);
+  if (index == s_rendererState.pipelineCount &&
+      index < OGE_PIPELINES_MAX_PIPELINES) {
+    entry = addPipeline(hash, &key);
+  }
+  ogeMutexUnlock(&s_rendererState.pipelinesMutex);
+
+  if (index == OGE_PIPELINES_MAX_PIPELINES) {
+    OGE_ERROR("ogePipelinesRequest(): no more than %u pipelines.",
+              OGE_PIPELINES_MAX_PIPELINES);
+    return OGE_PIPELINES_INVALID_ID;
+  }
+
+  // Submitted outside of the lock, without workers a job runs right
+  // away on the calling thread
+  if (entry) {
+    const OgeJob job = { compilePipelineJob, entry };
+    ogeJobsSubmit(&job, 1, &s_rendererState.pipelineCompileCounter);
+  }
+  return index;
+}
+
+b8 ogePipelinesIsReady(u32 id) {
+  if (!s_rendererState.initialized ||
+      id >= __atomic_load_n(&s_rendererState.pipelineCount,
+                            __ATOMIC_ACQUIRE)) {
+    return OGE_FALSE;
+  }
+
+  return __atomic_load_n(&s_rendererState.pipelines[id].state,
+                         __ATOMIC_ACQUIRE) == PIPELINE_STATE_READY;
+}
+
+b8 ogePipelinesBind(u32 id) {
+  if (!ogePipelinesIsReady(id)) { return OGE_FALSE; }
+
+  const VkCommandBuffer commandBuffer =
+    s_rendererState.commandBuffers.graphics[s_rendererState.currentFrameIndex];
+  vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                    s_rendererState.pipelines[id].pipeline);
+  return OGE_TRUE;
+}
+
+void ogePipelinesWait() {
+  if (!s_rendererState.pipelines) { return; }
+
+  ogeJobsWait(&s_rendererState.pipelineCompileCounter);
+}
@@ -4,6 +4,11 @@
 #include <vulkan/vulkan_core.h>
 
 #include "oge/defines.h"
+#include "oge/core/file.h"
+#include "oge/renderer/pipelines.h"
+
+// A queue family index that wasn't found
+#define QUEUE_FAMILY_NONE ((u32)-1)
 
 typedef struct queueFamilyIndicies {
   u32 graphics;
@@ -19,3 +24,30 @@ typedef struct swapchainSupport {
   u32                      presentModeCount;
   VkPresentModeKHR         pPresentModes[16];
 } swapchainSupport;
+
+// Keeps the mapping of the code, equal hashes don't prove equal code
+typedef struct shaderModule {
+  u64            hash;
+  OgeFileMapping mapping;
+  VkShaderModule module;
+} shaderModule;
+
+typedef enum pipelineState {
+  PIPELINE_STATE_QUEUED,
+  PIPELINE_STATE_READY,
+  PIPELINE_STATE_FAILED,
+} pipelineState;
+
+typedef struct pipelineKey {
+  char            vertexShaderFileName[OGE_PIPELINES_MAX_NAME_LENGTH];
+  char            fragmentShaderFileName[OGE_PIPELINES_MAX_NAME_LENGTH];
+  OgePipelineDesc desc;
+} pipelineKey;
+
+// A state is accessed atomically, a pipeline is valid once it's
+// PIPELINE_STATE_READY
+typedef struct pipelineEntry {
+  pipelineKey key;
+  VkPipeline  pipeline;
+  u32         state;
+} pipelineEntry;